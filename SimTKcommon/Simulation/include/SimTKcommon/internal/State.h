@@ -284,14 +284,38 @@ void initializeSubsystem(SubsystemIndex, const String& name,
 /// state variables and not the cache. If the source state hasn't
 /// been realized to Model stage, then we don't copy its state
 /// variables either, except those associated with the Topology stage.
+/// Every discrete variable and cache entry value is cloned, so references
+/// obtained from either State are unaffected by the copy. See 
+/// assignSharingValues() for a cheaper copy that defers the cloning.
 State(const State&);
 
 /// Make the current State a copy of the source state, copying only
 /// state variables and not the cache. If the source state hasn't
 /// been realized to Model stage, then we don't copy its state
 /// variables either, except those associated with the Topology stage.
+/// Discrete variable and cache entry values are cloned as for the copy
+/// constructor.
 State& operator=(const State&);
 
+/// Make the current State a copy of the source state as operator=() does,
+/// except that discrete variable and cache entry values are not cloned. 
+/// Instead the two States share each value, and it is cloned only when one of
+/// them first writes to it with updDiscreteVariable() or updCacheEntry() 
+/// (copy on write). That makes the copy cheap when most of its values are 
+/// only read, or are never touched again, as with a saved State used for 
+/// rollback. Continuous variables are copied as usual.
+///
+/// <b>Reference lifetime:</b> while a value is shared, a reference obtained
+/// from either State with getDiscreteVariable() or getCacheEntry() refers to
+/// the shared value. Such a reference must not be used after an "upd" call
+/// for the same variable or cache entry on either State, or after either
+/// State is assigned to, cleared, or destroyed; the value it refers to may 
+/// then belong only to the other State, or be gone. Get the reference again
+/// instead. A reference obtained with an "upd" method refers to this State's
+/// own value; it becomes subject to the same rule once that value is shared
+/// again by a later call to this method on either State.
+State& assignSharingValues(const State&);
+
 /// Register a new subsystem as a client of this State. The
 /// supplied strings are stored with the State but are not
 /// interpreted by it. The intent is that they can be used to
@@ -516,7 +540,9 @@ Stage getDiscreteVarInvalidatesStage(SubsystemIndex, DiscreteVariableIndex) cons
 
 
 /** Get the current value of the indicated discrete variable. This requires
-only that the variable has already been allocated and will fail otherwise. **/
+only that the variable has already been allocated and will fail otherwise. 
+If the value is shared with another State the returned reference is valid 
+only as described for assignSharingValues(). **/
 const AbstractValue& 
 getDiscreteVariable(SubsystemIndex, DiscreteVariableIndex) const;
 /** Return the time of last update for this discrete variable. **/
@@ -658,7 +684,8 @@ Stage getCacheEntryAllocationStage(SubsystemIndex, CacheEntryIndex) const;
 /** Retrieve a const reference to the value contained in a particular cache 
 entry. The value must be up to date with respect to the state variables it 
 depends on or this will throw an exception. No calculation will be 
-performed here.
+performed here. If the value is shared with another State the returned 
+reference is valid only as described for assignSharingValues().
 @see updCacheEntry()
 @see allocateCacheEntry(), isCacheValueRealized(), markCacheValueRealized() **/
 const AbstractValue& getCacheEntry(SubsystemIndex, CacheEntryIndex) const;
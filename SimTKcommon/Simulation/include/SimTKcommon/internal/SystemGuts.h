@@ -96,6 +96,8 @@ public:
     State&       updDefaultState();
 
     void realize(const State& s, Stage g = Stage::HighestRuntime) const;
+    void realizeBatch(const Array_<State*>& states, Stage g,
+                      ParallelExecutor* executor) const;
 
     SubsystemIndex adoptSubsystem(Subsystem& child);
 
@@ -258,6 +260,19 @@ private:
     Guts& operator=(const Guts&); // suppress default copy assignment operator
 
     class EventTriggerInfoRep;
+    class BatchRealizeTask;
+
+    // Take State s from the stage just below g to stage g, realizing the
+    // subclass and then any Subsystems it didn't handle. No stage checks are
+    // done and the realization counters are not touched.
+    void realizeOneStage(const State& s, Stage g) const;
+
+    // Realize states[begin..end) to stage g, stage by stage across a few 
+    // States of the range at a time.
+    // Each State advanced at stage k is counted in nRealized[k], which must
+    // have Stage::NValid entries.
+    void realizeBatchRange(const Array_<State*>& states, int begin, int end,
+                           Stage g, int* nRealized) const;
 
 };
 
@@ -26,8 +26,11 @@
 #include "SimTKcommon/internal/Event.h"
 #include "SimTKcommon/internal/State.h"
 
+#include "gmx_atomic.h"
+
 #include <cassert>
 #include <algorithm>
+#include <new>
 #include <ostream>
 #include <set>
 
@@ -43,7 +46,7 @@ namespace SimTK {
 // The method are templatized and expect the stacks to be in Arrays
 // of the same template. The template value must be a type that supports
 // three methods (the template analog to virtual functions):
-//      deepAssign()            a non-shallow assignment, i.e. clone the value
+//      deepAssign()            a non-shallow assignment, i.e. copy the value
 //      deepDestruct()          destroy any owned heap space
 //      getAllocationStage()    return the stage being worked on when this was 
 //                              allocated
@@ -108,6 +111,237 @@ static void copyAllocationStackThroughStage
 // means the actual value object will not be deleted by the destructor; be sure
 // to do that explicitly in the higher-level destructor or you'll have a nasty
 // leak.
+//
+// Discrete variable and cache entry values are copied separately from the 
+// other allocation stacks because they can be copied in two ways. An ordinary
+// State copy clones each value so that it and the source have values of 
+// their own. State::assignSharingValues() instead shares each value with the
+// source, and a value is cloned only when one of the States sharing it asks
+// for write access (copy on write). Then a reference obtained from either 
+// State by a "get" method may be left referring to the other State's value 
+// after a write; the rule is documented with assignSharingValues().
+
+
+
+//==============================================================================
+//                                VALUE SLAB
+//==============================================================================
+// A slab is a single block of heap memory divided into equal-sized blocks, 
+// each of which holds the SharedValue holder (below) for one discrete variable
+// or cache entry value. Holders allocated together thus sit together in 
+// memory rather than being scattered over the heap, and they carry their 
+// reference counts inline. Freed blocks go on the slab's free list and are
+// handed out again before any unused space. Every block in use owns a
+// reference to its slab, as does the arena that allocates from it, and the 
+// whole slab goes back to the heap in one piece when the last reference is
+// released. A block may be freed in a different thread than the one that 
+// allocated it (by a copy of the State) so the slab has its own lock.
+class ValueSlab {
+public:
+    // Blocks are rounded up to a multiple of this so that anything placed in
+    // a slab is suitably aligned.
+    enum {Alignment = 16, BlocksPerSlab = 64};
+
+    static size_t roundUp(size_t nBytes) 
+    {   return (nBytes + Alignment-1) / Alignment * Alignment; }
+
+    // Create a slab of blocks of at least the given size, with one reference
+    // held by the caller.
+    static ValueSlab* create(size_t blockSize) {
+        blockSize = roundUp(blockSize);
+        void* mem = ::operator new(getHeaderSize() + BlocksPerSlab*blockSize);
+        return new(mem) ValueSlab(blockSize);
+    }
+
+    // Return a block from this slab, or null if they are all in use. A 
+    // reference to the slab is added on behalf of whatever gets put there.
+    void* allocate() {
+        gmx_spinlock_lock(&lock);
+        void* p = 0;
+        if (freeList) {
+            p = freeList;
+            freeList = *reinterpret_cast<void**>(freeList);
+        } else if (nUsed < BlocksPerSlab)
+            p = getBlock(nUsed++);
+        if (p) ++refCount;
+        gmx_spinlock_unlock(&lock);
+        return p;
+    }
+
+    // Give up a reference, returning the block (if any) to the free list and
+    // freeing the slab if that was the last reference.
+    static void release(ValueSlab* slab, void* block=0) {
+        gmx_spinlock_lock(&slab->lock);
+        if (block) {
+            *reinterpret_cast<void**>(block) = slab->freeList;
+            slab->freeList = block;
+        }
+        const bool isLast = (--slab->refCount == 0);
+        gmx_spinlock_unlock(&slab->lock);
+        if (isLast) {
+            slab->~ValueSlab();
+            ::operator delete(slab);
+        }
+    }
+
+private:
+    explicit ValueSlab(size_t blockSize) 
+    :   blockSize(blockSize), nUsed(0), freeList(0), refCount(1)
+    {   gmx_spinlock_init(&lock); }
+
+    static size_t getHeaderSize() {return roundUp(sizeof(ValueSlab));}
+    void* getBlock(int i) 
+    {   return reinterpret_cast<char*>(this) + getHeaderSize() + i*blockSize; }
+
+    size_t          blockSize;
+    int             nUsed;      // blocks ever handed out; never decreases
+    void*           freeList;   // linked through the first word of each block
+    int             refCount;
+    gmx_spinlock_t  lock;
+};
+
+
+
+//==============================================================================
+//                                VALUE ARENA
+//==============================================================================
+// Each subsystem has one of these for each stage at which values can be 
+// allocated (Topology, Model, and Instance), holding the SharedValue holders
+// of the values allocated at that stage. The arena keeps a reference to 
+// every slab it has started and hands out blocks from any of them, starting
+// a new slab only when all are full, so the number of slabs is bounded by the
+// most holders this arena has ever had in use at once no matter how many 
+// times values are unshared and released. Clearing the arena just drops its 
+// references; each slab is freed once the holders in it are gone too.
+// Allocation is locked because cache entries are written, and hence may need
+// to be unshared, from const States.
+class ValueArena {
+public:
+    ValueArena() {gmx_spinlock_init(&lock);}
+    ~ValueArena() {clear();}
+
+    void clear() {
+        gmx_spinlock_lock(&lock);
+        for (unsigned i=0; i < slabs.size(); ++i)
+            ValueSlab::release(slabs[i]);
+        slabs.clear();
+        gmx_spinlock_unlock(&lock);
+    }
+
+    // Return a block of at least blockSize bytes, and the slab it came from.
+    // The block size must be the same for every call.
+    void* allocate(size_t blockSize, ValueSlab*& where) {
+        gmx_spinlock_lock(&lock);
+        void* p = 0;
+        // The newest slab is the most likely to have room.
+        for (int i=(int)slabs.size()-1; i >= 0 && !p; --i)
+            if ((p = slabs[i]->allocate()) != 0)
+                where = slabs[i];
+        if (!p) {
+            slabs.push_back(ValueSlab::create(blockSize));
+            where = slabs.back();
+            p = where->allocate();
+        }
+        gmx_spinlock_unlock(&lock);
+        return p;
+    }
+
+private:
+    Array_<ValueSlab*>  slabs;
+    gmx_spinlock_t      lock;
+
+    // Each arena belongs to one subsystem of one State.
+    ValueArena(const ValueArena&);
+    ValueArena& operator=(const ValueArena&);
+};
+
+
+
+//==============================================================================
+//                               SHARED VALUE
+//==============================================================================
+// This is a reference-counted holder for a discrete variable or cache entry
+// value. The count is atomic because copies of a State that share values may
+// be used concurrently in different threads; each thread's writes clone its
+// own values so the shared one is only ever read. The holder is placed in an
+// arena but the value itself is not: it is the heap object the State was 
+// given, or one made by AbstractValue::clone(). The State sees values only
+// as AbstractValues, which can't copy themselves anywhere but the heap, so
+// only the holders and their counts are kept together in slabs.
+class SharedValue {
+public:
+    // Take over ownership of a heap-allocated value.
+    static SharedValue* adopt(AbstractValue* v, ValueArena& arena) {
+        assert(v);
+        ValueSlab* slab;
+        void* mem = arena.allocate(sizeof(SharedValue), slab);
+        return new(mem) SharedValue(v, slab);
+    }
+
+    // Make a holder for a copy of the given value.
+    static SharedValue* create(const AbstractValue& v, ValueArena& arena)
+    {   return adopt(v.clone(), arena); }
+
+    // Return a new reference to a shared value.
+    static SharedValue* share(SharedValue* sv) 
+    {   assert(sv); gmx_atomic_add_return(&sv->refCount, 1); return sv; }
+
+    // Give up a reference, destroying the value if this was the last one. The
+    // pointer is cleared.
+    static void release(SharedValue*& sv) {
+        if (sv && gmx_atomic_add_return(&sv->refCount, -1) == 0) {
+            ValueSlab* slab = sv->slab;
+            delete sv->value;
+            sv->~SharedValue();
+            ValueSlab::release(slab, sv);
+        }
+        sv = 0;
+    }
+
+    // Make sv hold a copy of the source's value that it doesn't share. A
+    // value that sv already holds the only reference to is assigned to in 
+    // place so that references to it stay valid; otherwise the source value
+    // is cloned into the given arena.
+    static void assignUnshared(SharedValue*& sv, const SharedValue* src, 
+                               ValueArena& arena) {
+        assert(src);
+        if (sv && sv != src && gmx_atomic_read(&sv->refCount) == 1) {
+            *sv->value = *src->value;
+            return;
+        }
+        SharedValue* mine = create(*src->value, arena);
+        release(sv);
+        sv = mine;
+    }
+
+    // Make sure the caller holds the only reference to the value, cloning it
+    // into the given arena if necessary, and return a writable reference to 
+    // the value.
+    static AbstractValue& updUnshared(SharedValue*& sv, ValueArena& arena) {
+        assert(sv);
+        if (gmx_atomic_read(&sv->refCount) != 1) {
+            SharedValue* mine = create(*sv->value, arena);
+            release(sv);
+            sv = mine;
+        }
+        return *sv->value;
+    }
+
+    const AbstractValue& getValue() const {return *value;}
+
+private:
+    SharedValue(AbstractValue* v, ValueSlab* slab)
+    :   value(v), slab(slab) 
+    {   gmx_atomic_set(&refCount, 1); }
+
+    AbstractValue*  value;
+    ValueSlab*      slab;
+    gmx_atomic_t    refCount;
+
+    // Not copyable; share by pointer instead.
+    SharedValue(const SharedValue&);
+    SharedValue& operator=(const SharedValue&);
+};
 
 
 
@@ -120,40 +354,48 @@ public:
     :   allocationStage(Stage::Empty), invalidatedStage(Stage::Empty),
         value(0), timeLastUpdated(NaN) {}
 
-    DiscreteVarInfo(Stage allocation, Stage invalidated, AbstractValue* v)
-    :   allocationStage(allocation), invalidatedStage(invalidated), value(v),
-        autoUpdateEntry(), timeLastUpdated(NaN) 
+    DiscreteVarInfo(Stage allocation, Stage invalidated, SharedValue* v)
+    :   allocationStage(allocation), invalidatedStage(invalidated), 
+        autoUpdateEntry(), value(v), timeLastUpdated(NaN) 
     {   assert(isReasonable()); }
 
     // Default copy constructor, copy assignment, destructor are shallow.
 
-    // Use this to make this entry contain a *copy* of the source value.
-    // If the destination already has a value, the new value must be
-    // assignment compatible.
-    DiscreteVarInfo& deepAssign(const DiscreteVarInfo& src) {
+    // Use this to make this entry contain a copy of the source value. If
+    // shareValue is set the value is shared with the source until one of 
+    // them is updated; otherwise it is copied into this entry's own value,
+    // cloning into the given arena if necessary.
+    DiscreteVarInfo& deepAssign(const DiscreteVarInfo& src, ValueArena& arena,
+                                bool shareValue) {
         assert(src.isReasonable());
          
         allocationStage   = src.allocationStage;
         invalidatedStage  = src.invalidatedStage;
         autoUpdateEntry   = src.autoUpdateEntry;
-        if (value) *value = *src.value;
-        else        value = src.value->clone();
+        if (!shareValue)
+            SharedValue::assignUnshared(value, src.value, arena);
+        else if (value != src.value) {
+            SharedValue::release(value);
+            value = SharedValue::share(src.value);
+        }
         timeLastUpdated   = src.timeLastUpdated;
         return *this;
     }
 
     // For use in the containing class's destructor.
-    void deepDestruct() {delete value; value=0;}
+    void deepDestruct() {SharedValue::release(value);}
     const Stage& getAllocationStage()  const {return allocationStage;}
 
     // Exchange value pointers (should be from this dv's update cache entry).
-    void swapValue(Real updTime, AbstractValue*& other) 
+    void swapValue(Real updTime, SharedValue*& other) 
     {   std::swap(value, other); timeLastUpdated=updTime; }
 
-    const AbstractValue& getValue() const {assert(value); return *value;}
+    const AbstractValue& getValue() const 
+    {   assert(value); return value->getValue(); }
     Real                 getTimeLastUpdated() const {assert(value); return timeLastUpdated;}
-    AbstractValue&       updValue(Real updTime)
-    {   assert(value); timeLastUpdated=updTime; return *value; }
+    AbstractValue&       updValue(Real updTime, ValueArena& arena)
+    {   assert(value); timeLastUpdated=updTime; 
+        return SharedValue::updUnshared(value, arena); }
 
     const Stage&    getInvalidatedStage() const {return invalidatedStage;}
     CacheEntryIndex getAutoUpdateEntry()  const {return autoUpdateEntry;}
@@ -166,7 +408,7 @@ private:
     CacheEntryIndex autoUpdateEntry;
 
     // These change at run time.
-    AbstractValue*  value;
+    SharedValue*    value;
     Real            timeLastUpdated;
 
     bool isReasonable() const
@@ -187,7 +429,7 @@ public:
     :   allocationStage(Stage::Empty), dependsOnStage(Stage::Empty), computedByStage(Stage::Empty),
         value(0), versionWhenLastComputed(-1) {}
 
-    CacheEntryInfo(Stage allocation, Stage dependsOn, Stage computedBy, AbstractValue* v)
+    CacheEntryInfo(Stage allocation, Stage dependsOn, Stage computedBy, SharedValue* v)
     :   allocationStage(allocation), dependsOnStage(dependsOn), computedByStage(computedBy),
         value(v), versionWhenLastComputed(0) 
     {   assert(isReasonable()); }
@@ -207,22 +449,28 @@ public:
 
     // Default copy constructor, copy assignment, destructor are shallow.
 
-    // Use this to make this entry contain a *copy* of the source value.
-    CacheEntryInfo& deepAssign(const CacheEntryInfo& src) {
+    // Use this to make this entry contain a copy of the source value, shared
+    // or not as for DiscreteVarInfo::deepAssign().
+    CacheEntryInfo& deepAssign(const CacheEntryInfo& src, ValueArena& arena,
+                               bool shareValue) {
         assert(src.isReasonable());
 
         allocationStage   = src.allocationStage;
         dependsOnStage    = src.dependsOnStage;
         computedByStage   = src.computedByStage;
         associatedVar     = src.associatedVar;
-        if (value) *value = *src.value;
-        else        value = src.value->clone();
+        if (!shareValue)
+            SharedValue::assignUnshared(value, src.value, arena);
+        else if (value != src.value) {
+            SharedValue::release(value);
+            value = SharedValue::share(src.value);
+        }
         versionWhenLastComputed = src.versionWhenLastComputed;
         return *this;
     }
 
     // For use in the containing class's destructor.
-    void deepDestruct() {delete value; value=0;}
+    void deepDestruct() {SharedValue::release(value);}
     const Stage& getAllocationStage() const {return allocationStage;}
 
     // Exchange values with a discrete variable (presumably this
@@ -230,8 +478,10 @@ public:
     // entry but we're not checking here).
     void swapValue(Real updTime, DiscreteVarInfo& dv) 
     {   dv.swapValue(updTime, value); }
-    const AbstractValue& getValue() const {assert(value); return *value;}
-    AbstractValue&       updValue()       {assert(value); return *value;}
+    const AbstractValue& getValue() const 
+    {   assert(value); return value->getValue(); }
+    AbstractValue&       updValue(ValueArena& arena)
+    {   assert(value); return SharedValue::updUnshared(value, arena); }
 
     const Stage&          getDependsOnStage()  const {return dependsOnStage;}
     const Stage&          getComputedByStage() const {return computedByStage;}
@@ -245,7 +495,7 @@ private:
     DiscreteVariableIndex   associatedVar;  // if this is an auto-update entry
 
     // These change at run time.
-    AbstractValue*          value;
+    SharedValue*            value;
     StageVersion            versionWhenLastComputed; // version of Stage dependsOn
 
     bool isReasonable() const
@@ -444,12 +694,27 @@ public:
         return *this;
     }
 
+    // Like assignment, but sharing discrete variable and cache entry values
+    // copy-on-write with the source rather than copying them.
+    void assignSharingValues(const PerSubsystemInfo& src) {
+        if (&src != this)
+            copyFrom(src, Stage::Instance, true);
+    }
+
+    // Return the arena for values allocated at the given stage.
+    ValueArena& updValueArena(const Stage& allocationStage) const {
+        assert(Stage::Topology <= allocationStage 
+               && allocationStage <= Stage::Instance);
+        return valueArenas[allocationStage - Stage::Topology];
+    }
+
     // Back up to the stage just before g if this subsystem thinks
     // it is already at g or beyond. Note that we may be backing up
     // over many stages here. Careful: invalidating the stage
     // for a subsystem must also invalidate the same stage for all
     // the other subsystems and the system as a whole but we don't
     // take care of that here. Also, you can't invalidate Stage::Empty.
+
     void invalidateStageJustThisSubsystem(Stage g) {
         assert(g > Stage::Empty);
         restoreToStage(g.prev());
@@ -559,6 +824,10 @@ public:
     mutable Array_<ConstraintErrInfo>   qerrInfo, uerrInfo, udoterrInfo;
     mutable Array_<TriggerInfo>         triggerInfo[Stage::NValid];
     mutable Array_<CacheEntryInfo>      cacheInfo;
+
+    // Storage for the holders of the discrete variable and cache entry values
+    // allocated at Topology, Model, and Instance stage, in that order.
+    mutable ValueArena                  valueArenas[3];
    
         // GLOBAL RESOURCE ALLOCATIONS //
 
@@ -631,11 +900,18 @@ private:
     void clearEventTriggers(int g)   {clearAllocationStack(triggerInfo[g]);}
     void clearCache()           {clearAllocationStack(cacheInfo);}
 
+    // Arena i holds the holders of values allocated at Stage i+1.
+    void clearValueArenasAfterStage(const Stage& g) {
+        for (int i=g; i < 3; ++i)
+            valueArenas[i].clear();
+    }
+
     void clearAllStacks() {
         clearContinuousVars(); clearDiscreteVars();
         clearConstraintErrs(); clearCache();
         for (int i=0; i < Stage::NValid; ++i)
             clearEventTriggers(i);
+        clearValueArenasAfterStage(Stage::Empty);
     }
 
     void popContinuousVarsBackToStage(const Stage& g) 
@@ -660,7 +936,8 @@ private:
         popDiscreteVarsBackToStage(g);
         popConstraintErrsBackToStage(g);
         popCacheBackToStage(g);
-        popEventTriggersBackToStage(g); }
+        popEventTriggersBackToStage(g);
+        clearValueArenasAfterStage(g); }
 
     // Call once each for qInfo, uInfo, zInfo.
     void copyContinuousVarInfoThroughStage
@@ -668,9 +945,25 @@ private:
         Array_<ContinuousVarInfo>& dest)
     {   copyAllocationStackThroughStage(dest, src, g); }
 
+    // Like copyAllocationStackThroughStage(), for the discrete variable and
+    // cache entry stacks whose values may be shared with the source.
+    template <class T>
+    void copyValueStackThroughStage
+       (Array_<T>& stack, const Array_<T>& src, const Stage& g, 
+        bool shareValues)
+    {
+        unsigned nVarsToCopy = src.size(); // assume we'll copy all
+        while (nVarsToCopy && src[nVarsToCopy-1].getAllocationStage() > g)
+            --nVarsToCopy;
+        resizeAllocationStack(stack, nVarsToCopy);
+        for (unsigned i=0; i < nVarsToCopy; ++i)
+            stack[i].deepAssign(src[i], 
+                updValueArena(src[i].getAllocationStage()), shareValues);
+    }
+
     void copyDiscreteVarsThroughStage
-       (const Array_<DiscreteVarInfo>& src, const Stage& g)
-    {   copyAllocationStackThroughStage(discreteInfo, src, g); }
+       (const Array_<DiscreteVarInfo>& src, const Stage& g, bool shareValues)
+    {   copyValueStackThroughStage(discreteInfo, src, g, shareValues); }
 
     // Call once each for qerrInfo, uerrInfo, udoterrInfo.
     void copyConstraintErrInfoThroughStage
@@ -679,27 +972,28 @@ private:
     {   copyAllocationStackThroughStage(dest, src, g); }
 
     void copyCacheThroughStage
-       (const Array_<CacheEntryInfo>& src, const Stage& g)
-    {   copyAllocationStackThroughStage(cacheInfo, src, g); }
+       (const Array_<CacheEntryInfo>& src, const Stage& g, bool shareValues)
+    {   copyValueStackThroughStage(cacheInfo, src, g, shareValues); }
 
     void copyEventsThroughStage
        (const Array_<TriggerInfo>& src, const Stage& g,
         Array_<TriggerInfo>& dest)
     {   copyAllocationStackThroughStage(dest, src, g); }
 
-    void copyAllStacksThroughStage(const PerSubsystemInfo& src, const Stage& g)
+    void copyAllStacksThroughStage(const PerSubsystemInfo& src, const Stage& g,
+                                   bool shareValues)
     {
         copyContinuousVarInfoThroughStage(src.qInfo, g, qInfo);
         copyContinuousVarInfoThroughStage(src.uInfo, g, uInfo);
         copyContinuousVarInfoThroughStage(src.zInfo, g, zInfo);
 
-        copyDiscreteVarsThroughStage(src.discreteInfo, g);
+        copyDiscreteVarsThroughStage(src.discreteInfo, g, shareValues);
 
         copyConstraintErrInfoThroughStage(src.qerrInfo,    g, qerrInfo);
         copyConstraintErrInfoThroughStage(src.uerrInfo,    g, uerrInfo);
         copyConstraintErrInfoThroughStage(src.udoterrInfo, g, udoterrInfo);
 
-        copyCacheThroughStage(src.cacheInfo, g);
+        copyCacheThroughStage(src.cacheInfo, g, shareValues);
         for (int i=0; i < Stage::NValid; ++i)
             copyEventsThroughStage(src.triggerInfo[i], g, triggerInfo[i]);
     }
@@ -742,8 +1036,11 @@ private:
     // all the subsystem-private state variables will be copied, but only
     // cached computations up through maxStage come through. We clear
     // our references to global variables regardless -- those will have to
-    // be repaired at the System (State global) level.
-    void copyFrom(const PerSubsystemInfo& src, Stage maxStage) {
+    // be repaired at the System (State global) level. Discrete variable and
+    // cache entry values are shared copy-on-write with the source if 
+    // shareValues is set, otherwise copied.
+    void copyFrom(const PerSubsystemInfo& src, Stage maxStage, 
+                  bool shareValues=false) {
         const Stage targetStage = std::min<Stage>(src.currentStage, maxStage);
 
         // Forget any references to global resources.
@@ -755,7 +1052,7 @@ private:
 
         name     = src.name;
         version  = src.version;
-        copyAllStacksThroughStage(src, targetStage);
+        copyAllStacksThroughStage(src, targetStage, shareValues);
 
         // Set stage versions so that any cache entries we copied can still
         // be valid if they were valid in the source and depended only on
@@ -825,8 +1122,15 @@ public:
         }
     }
 
-    StateImpl& operator=(const StateImpl& src) {
-        if (&src == this) return *this;
+    StateImpl& operator=(const StateImpl& src) 
+    {   assignFrom(src, false); return *this; }
+
+    // As for assignment, but discrete variable and cache entry values are
+    // shared copy-on-write with the source rather than copied.
+    void assignSharingValues(const StateImpl& src) {assignFrom(src, true);}
+
+    void assignFrom(const StateImpl& src, bool shareValues) {
+        if (&src == this) return;
         invalidateJustSystemStage(Stage::Topology);
         for (SubsystemIndex i(0); i<(int)subsystems.size(); ++i)
             subsystems[i].invalidateStageJustThisSubsystem(Stage::Topology);
@@ -837,7 +1141,12 @@ public:
         for (int i=1; i <= src.currentSystemStage; ++i)
             systemStageVersions[i] = src.systemStageVersions[i]+1;
 
-        subsystems = src.subsystems;
+        if (shareValues) {
+            subsystems.resize(src.subsystems.size());
+            for (unsigned i=0; i < subsystems.size(); ++i)
+                subsystems[i].assignSharingValues(src.subsystems[i]);
+        } else
+            subsystems = src.subsystems;
         if (src.currentSystemStage >= Stage::Topology) {
             advanceSystemToStage(Stage::Topology);
             systemStageVersions[Stage::Topology] = 
@@ -861,7 +1170,6 @@ public:
                 uerrWeights = src.uerrWeights;
             }
         }
-        return *this;
     }
 
     ~StateImpl() {   // default destructor
@@ -1346,7 +1654,8 @@ public:
         PerSubsystemInfo& ss = subsystems[subsys];
         const DiscreteVariableIndex nxt(ss.getNextDiscreteVariableIndex());
         ss.discreteInfo.push_back
-           (DiscreteVarInfo(allocStage,invalidates,vp));
+           (DiscreteVarInfo(allocStage,invalidates,
+                    SharedValue::adopt(vp, ss.updValueArena(allocStage))));
         return nxt;
     }
     
@@ -1367,7 +1676,8 @@ public:
         const PerSubsystemInfo& ss = subsystems[subsys];
         const CacheEntryIndex nxt(ss.getNextCacheEntryIndex());
         ss.cacheInfo.push_back(CacheEntryInfo(allocStage,
-                                              dependsOn,computedBy,vp));//mutable
+            dependsOn,computedBy,
+            SharedValue::adopt(vp, ss.updValueArena(allocStage))));//mutable
         return nxt;
     }
 
@@ -2042,7 +2352,7 @@ public:
         }
     
         // We're now marking this variable as having been updated at the current time.
-        return dv.updValue(t);
+        return dv.updValue(t, ss.updValueArena(dv.getAllocationStage()));
     }
     
     Stage getCacheEntryAllocationStage(SubsystemIndex subsys, CacheEntryIndex index) const {
@@ -2097,7 +2407,7 @@ public:
         SimTK_INDEXCHECK(index,(int)ss.cacheInfo.size(),"StateImpl::updCacheEntry()");
         CacheEntryInfo& ce = ss.cacheInfo[index];
     
-        return ce.updValue();
+        return ce.updValue(ss.updValueArena(ce.getAllocationStage()));
     }
 
     bool isCacheValueRealized(SubsystemIndex subx, CacheEntryIndex cx) const {
@@ -2463,6 +2773,15 @@ State& State::operator=(const State& src) {
     return *this;
 }
 
+// copy assignment sharing discrete variable and cache entry values
+State& State::assignSharingValues(const State& src) {
+    if (&src == this) return *this;
+    if (!src.impl) {delete impl; impl=0; return *this;}
+    if (!impl) impl = new StateImpl();
+    impl->assignSharingValues(*src.impl);
+    return *this;
+}
+
 
 void State::setNumSubsystems(int i) {
     updImpl().setNumSubsystems(i);
@@ -36,9 +36,11 @@
 #include "SimTKcommon/internal/SystemGuts.h"
 #include "SimTKcommon/internal/EventHandler.h"
 #include "SimTKcommon/internal/EventReporter.h"
+#include "SimTKcommon/internal/ParallelExecutor.h"
 
 #include "SystemGutsRep.h"
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <set>
@@ -169,6 +171,9 @@ void System::invalidateSystemTopologyCache() const
 const State& System::realizeTopology() const {return getSystemGuts().realizeTopology();}
 void System::realizeModel(State& s) const {getSystemGuts().realizeModel(s);}
 void System::realize(const State& s, Stage g) const {getSystemGuts().realize(s,g);}
+void System::realizeBatch(const Array_<State*>& states, Stage g, 
+                          ParallelExecutor* executor) const
+{   getSystemGuts().realizeBatch(states,g,executor); }
 void System::calcDecorativeGeometryAndAppend
    (const State& s, Stage g, Array_<DecorativeGeometry>& geom) const 
 {   getSystemGuts().calcDecorativeGeometryAndAppend(s,g,geom); }
@@ -415,14 +420,7 @@ void System::Guts::realizeInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Instance).prev(), 
         "System::Guts::realizeInstance()");
     if (s.getSystemStage() < Stage::Instance) {
-        realizeInstanceImpl(s);    // take care of the Subsystems
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Instance)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemInstance(s);
-        s.advanceSystemToStage(Stage::Instance);
-
+        realizeOneStage(s, Stage::Instance);
         getRep().nRealizationsOfStage[Stage::Instance]++; // mutable counter
     }
 }
@@ -436,15 +434,7 @@ void System::Guts::realizeTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Time).prev(), 
         "System::Guts::realizeTime()");
     if (s.getSystemStage() < Stage::Time) {
-        // Allow the subclass to do processing.
-        realizeTimeImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Time)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemTime(s);
-        s.advanceSystemToStage(Stage::Time);
-
+        realizeOneStage(s, Stage::Time);
         getRep().nRealizationsOfStage[Stage::Time]++; // mutable counter
     }
 }
@@ -458,15 +448,7 @@ void System::Guts::realizePosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Position).prev(), 
         "System::Guts::realizePosition()");
     if (s.getSystemStage() < Stage::Position) {
-        // Allow the subclass to do processing.
-        realizePositionImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Position)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemPosition(s);
-        s.advanceSystemToStage(Stage::Position);
-
+        realizeOneStage(s, Stage::Position);
         getRep().nRealizationsOfStage[Stage::Position]++; // mutable counter
     }
 }
@@ -480,15 +462,7 @@ void System::Guts::realizeVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Velocity).prev(), 
         "System::Guts::realizeVelocity()");
     if (s.getSystemStage() < Stage::Velocity) {
-        // Allow the subclass to do processing.
-        realizeVelocityImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Velocity)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemVelocity(s);
-        s.advanceSystemToStage(Stage::Velocity);
-
+        realizeOneStage(s, Stage::Velocity);
         getRep().nRealizationsOfStage[Stage::Velocity]++; // mutable counter
     }
 }
@@ -502,15 +476,7 @@ void System::Guts::realizeDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Dynamics).prev(), 
         "System::Guts::realizeDynamics()");
     if (s.getSystemStage() < Stage::Dynamics) {
-        // Allow the subclass to do processing.
-        realizeDynamicsImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Dynamics)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemDynamics(s);
-        s.advanceSystemToStage(Stage::Dynamics);
-
+        realizeOneStage(s, Stage::Dynamics);
         getRep().nRealizationsOfStage[Stage::Dynamics]++; // mutable counter
     }
 }
@@ -524,15 +490,7 @@ void System::Guts::realizeAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Acceleration).prev(), 
         "System::Guts::realizeAcceleration()");
     if (s.getSystemStage() < Stage::Acceleration) {
-        // Allow the subclass to do processing.
-        realizeAccelerationImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Acceleration)
-                getRep().subsystems[i].getSubsystemGuts()
-                                      .realizeSubsystemAcceleration(s);
-        s.advanceSystemToStage(Stage::Acceleration);
-
+        realizeOneStage(s, Stage::Acceleration);
         getRep().nRealizationsOfStage[Stage::Acceleration]++; // mutable counter
     }
 }
@@ -546,14 +504,7 @@ void System::Guts::realizeReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Report).prev(), 
         "System::Guts::realizeReport()");
     if (s.getSystemStage() < Stage::Report) {
-        // Allow the subclass to do processing.
-        realizeReportImpl(s);
-        // Realize any subsystems that the subclass didn't already take care of.
-        for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
-            if (getRep().subsystems[i].getStage(s) < Stage::Report)
-                getRep().subsystems[i].getSubsystemGuts().realizeSubsystemReport(s);
-        s.advanceSystemToStage(Stage::Report);
-
+        realizeOneStage(s, Stage::Report);
         getRep().nRealizationsOfStage[Stage::Report]++; // mutable counter
     }
 }
@@ -791,6 +742,236 @@ void System::Guts::realize(const State& s, Stage g) const {
     }
 }
 
+//------------------------------------------------------------------------------
+//                            REALIZE ONE STAGE
+//------------------------------------------------------------------------------
+// This is the common body of realizeInstance() through realizeReport(). The
+// caller is responsible for stage checking and statistics.
+void System::Guts::realizeOneStage(const State& s, Stage g) const {
+    // Allow the subclass to do processing.
+    switch (g) {
+    case Stage::Instance:     realizeInstanceImpl(s);     break;
+    case Stage::Time:         realizeTimeImpl(s);         break;
+    case Stage::Position:     realizePositionImpl(s);     break;
+    case Stage::Velocity:     realizeVelocityImpl(s);     break;
+    case Stage::Dynamics:     realizeDynamicsImpl(s);     break;
+    case Stage::Acceleration: realizeAccelerationImpl(s); break;
+    case Stage::Report:       realizeReportImpl(s);       break;
+    default: assert(!"System::Guts::realizeOneStage(): bad stage");
+    }
+
+    // Realize any subsystems that the subclass didn't already take care of.
+    for (SubsystemIndex i(0); i<getNumSubsystems(); ++i) {
+        const Subsystem& sub = getRep().subsystems[i];
+        if (sub.getStage(s) >= g)
+            continue;
+        const Subsystem::Guts& guts = sub.getSubsystemGuts();
+        switch (g) {
+        case Stage::Instance:     guts.realizeSubsystemInstance(s);     break;
+        case Stage::Time:         guts.realizeSubsystemTime(s);         break;
+        case Stage::Position:     guts.realizeSubsystemPosition(s);     break;
+        case Stage::Velocity:     guts.realizeSubsystemVelocity(s);     break;
+        case Stage::Dynamics:     guts.realizeSubsystemDynamics(s);     break;
+        case Stage::Acceleration: guts.realizeSubsystemAcceleration(s); break;
+        case Stage::Report:       guts.realizeSubsystemReport(s);       break;
+        default: break;
+        }
+    }
+
+    s.advanceSystemToStage(g);
+}
+
+
+
+//------------------------------------------------------------------------------
+//                              REALIZE BATCH
+//------------------------------------------------------------------------------
+// Each chunk of the batch is realized stage-major by a single thread. 
+// Realization counts are kept per chunk and summed by the caller afterwards so
+// the System's mutable statistics are only updated from the calling thread.
+// Exceptions are caught and recorded by chunk (ParallelExecutor would 
+// otherwise just print and discard them). The caller then finishes the first
+// failed chunk itself, which repeats the failure on the calling thread and 
+// so throws the original exception with its original type. The recorded 
+// message is used only if that somehow succeeds.
+class System::Guts::BatchRealizeTask : public ParallelExecutor::Task {
+public:
+    BatchRealizeTask(const System::Guts& guts, const Array_<State*>& states,
+                     Stage g, int nChunks)
+    :   guts(guts), states(states), g(g), nChunks(nChunks), 
+        nRealized(nChunks*Stage::NValid, 0), errors(nChunks) {}
+
+    void execute(int chunk) {
+        int begin, end;
+        getChunkRange(chunk, begin, end);
+        try {guts.realizeBatchRange(states, begin, end, g, 
+                                    &nRealized[chunk*Stage::NValid]);}
+        catch (const std::exception& e) {errors[chunk] = e.what();}
+        catch (...) {errors[chunk] = "unknown exception";}
+    }
+
+    // Return the index of the first chunk that failed, or -1.
+    int getFirstFailedChunk() const {
+        for (int i=0; i < nChunks; ++i)
+            if (!errors[i].empty())
+                return i;
+        return -1;
+    }
+
+    void getChunkRange(int chunk, int& begin, int& end) const {
+        const int n = (int)states.size();
+        begin = (int)(((long long)n * chunk) / nChunks);
+        end   = (int)(((long long)n * (chunk+1)) / nChunks);
+    }
+
+    void addCounts(int* total) const {
+        for (int i=0; i < nChunks; ++i)
+            for (int k=0; k < Stage::NValid; ++k)
+                total[k] += nRealized[i*Stage::NValid + k];
+    }
+
+    void throwError(int chunk) const {
+        SimTK_THROW1(Exception::Cant, errors[chunk]);
+    }
+
+private:
+    const System::Guts&             guts;
+    const Array_<State*>&           states;
+    const Stage                     g;
+    const int                       nChunks;
+    Array_<int>                     nRealized; // nChunks x Stage::NValid
+    Array_<std::string>             errors;
+};
+
+// This does what realizeOneStage() does for each State in the range, but 
+// decides which System and Subsystem methods to call once per stage rather 
+// than once per State and Subsystem. The range is realized stage-major a 
+// few States at a time; the States' caches for a whole long range would not
+// all stay in the processor cache from one stage to the next.
+typedef int  (System::Guts::*SystemStageImpl)(const State&) const;
+typedef void (Subsystem::Guts::*SubsystemStageRealizer)(const State&) const;
+
+static const int StatesPerStageMajorBlock = 8;
+
+void System::Guts::realizeBatchRange(const Array_<State*>& states, 
+                                     int begin, int end, Stage g,
+                                     int* nRealized) const 
+{
+    const int nSubsystems = getNumSubsystems();
+    Array_<const Subsystem::Guts*> subsystems(nSubsystems);
+    for (SubsystemIndex j(0); j < nSubsystems; ++j)
+        subsystems[j] = &getRep().subsystems[j].getSubsystemGuts();
+
+    SystemStageImpl        realizeImpl[Stage::NValid];
+    SubsystemStageRealizer realizeSubsystem[Stage::NValid];
+    for (Stage k = Stage::Instance; k <= g; ++k) {
+        switch (k) {
+        case Stage::Instance:
+            realizeImpl[k]      = &System::Guts::realizeInstanceImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemInstance;
+            break;
+        case Stage::Time:
+            realizeImpl[k]      = &System::Guts::realizeTimeImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemTime;
+            break;
+        case Stage::Position:
+            realizeImpl[k]      = &System::Guts::realizePositionImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemPosition;
+            break;
+        case Stage::Velocity:
+            realizeImpl[k]      = &System::Guts::realizeVelocityImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemVelocity;
+            break;
+        case Stage::Dynamics:
+            realizeImpl[k]      = &System::Guts::realizeDynamicsImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemDynamics;
+            break;
+        case Stage::Acceleration:
+            realizeImpl[k]      = &System::Guts::realizeAccelerationImpl;
+            realizeSubsystem[k] = 
+                &Subsystem::Guts::realizeSubsystemAcceleration;
+            break;
+        case Stage::Report:
+            realizeImpl[k]      = &System::Guts::realizeReportImpl;
+            realizeSubsystem[k] = &Subsystem::Guts::realizeSubsystemReport;
+            break;
+        default: assert(!"System::Guts::realizeBatchRange(): bad stage");
+        }
+    }
+
+    for (int first=begin; first < end; first += StatesPerStageMajorBlock) {
+        const int last = std::min(end, first + StatesPerStageMajorBlock);
+        for (Stage k = Stage::Instance; k <= g; ++k)
+            for (int i=first; i < last; ++i) {
+                const State& s = *states[i];
+                if (s.getSystemStage() >= k)
+                    continue;
+                (this->*realizeImpl[k])(s);
+                for (SubsystemIndex j(0); j < nSubsystems; ++j)
+                    if (s.getSubsystemStage(j) < k)
+                        (subsystems[j]->*realizeSubsystem[k])(s);
+                s.advanceSystemToStage(k);
+                ++nRealized[k];
+            }
+    }
+}
+
+void System::Guts::realizeBatch(const Array_<State*>& states, Stage g,
+                                ParallelExecutor* executor) const 
+{
+    const int n = (int)states.size();
+    for (int i=0; i < n; ++i)
+        SimTK_STAGECHECK_GE_ALWAYS(states[i]->getSystemStage(), Stage::Model, 
+            "System::Guts::realizeBatch()");
+
+    // A State that appeared twice could be realized by two threads at once.
+    // This costs a sort, so is checked only in Debug builds.
+    #ifndef NDEBUG
+    {   Array_<const State*> sorted(states.begin(), states.end());
+        std::sort(sorted.begin(), sorted.end());
+        SimTK_ERRCHK_ALWAYS(
+            std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end(),
+            "System::Guts::realizeBatch()",
+            "The same State appears more than once in the batch.");
+    }
+    #endif
+
+    int nRealized[Stage::NValid];
+    for (int k=0; k < Stage::NValid; ++k) nRealized[k] = 0;
+
+    if (!executor || n < 2 || ParallelExecutor::isWorkerThread()) {
+        realizeBatchRange(states, 0, n, g, nRealized);
+    } else {
+        // Chunks need to be big enough to benefit from stage-major ordering
+        // but there should be enough of them to balance the load.
+        const int MinStatesPerChunk = 8, MaxChunks = 64;
+        const int nChunks = 
+            std::max(1, std::min(n/MinStatesPerChunk, MaxChunks));
+        BatchRealizeTask task(*this, states, g, nChunks);
+        executor->execute(task, nChunks);
+        task.addCounts(nRealized);
+        const int failed = task.getFirstFailedChunk();
+        if (failed >= 0) {
+            int begin, end;
+            task.getChunkRange(failed, begin, end);
+            try {realizeBatchRange(states, begin, end, g, nRealized);}
+            catch (...) {
+                for (int k=0; k < Stage::NValid; ++k)
+                    getRep().nRealizationsOfStage[k] += nRealized[k];
+                throw;
+            }
+            for (int k=0; k < Stage::NValid; ++k)
+                getRep().nRealizationsOfStage[k] += nRealized[k];
+            task.throwError(failed);
+        }
+    }
+
+    for (int k=0; k < Stage::NValid; ++k)
+        getRep().nRealizationsOfStage[k] += nRealized[k]; // mutable counter
+}
+
+
+
 //------------------------------------------------------------------------------
 //                   CALC DECORATIVE GEOMETRY AND APPEND
 //------------------------------------------------------------------------------
@@ -176,6 +176,246 @@ void testCacheValidity() {
 
 }
 
+// A State copied with assignSharingValues() shares discrete variable and 
+// cache entry values with its source until one of them writes to a value.
+void testCopyOnWrite() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dx = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<int>(3));
+    const CacheEntryIndex cx = s.allocateCacheEntry(Sub0, 
+        Stage::Model, Stage::Time, new Value<int>(7));
+    s.advanceSubsystemToStage(Sub0, Stage::Topology);
+    s.advanceSystemToStage(Stage::Topology);
+    s.advanceSubsystemToStage(Sub0, Stage::Model);
+    s.advanceSystemToStage(Stage::Model);
+    s.markCacheValueRealized(Sub0, cx);
+
+    State copy;
+    copy.assignSharingValues(s);
+    SimTK_TEST(&copy.getDiscreteVariable(Sub0, dx) 
+               == &s.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(&copy.getCacheEntry(Sub0, cx) == &s.getCacheEntry(Sub0, cx));
+    SimTK_TEST(copy.isCacheValueRealized(Sub0, cx));
+
+    // Writing to the copy must not be visible in the source.
+    Value<int>::updDowncast(copy.updDiscreteVariable(Sub0, dx)) = 4;
+    Value<int>::updDowncast(copy.updCacheEntry(Sub0, cx)) = 8;
+    SimTK_TEST(Value<int>::downcast(s.getDiscreteVariable(Sub0, dx)) == 3);
+    SimTK_TEST(Value<int>::downcast(copy.getDiscreteVariable(Sub0, dx)) == 4);
+    SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub0, cx)) == 7);
+    SimTK_TEST(Value<int>::downcast(copy.getCacheEntry(Sub0, cx)) == 8);
+    SimTK_TEST(&copy.getDiscreteVariable(Sub0, dx) 
+               != &s.getDiscreteVariable(Sub0, dx));
+
+    // Once unshared, writes go to the same place again.
+    const AbstractValue* mine = &copy.updCacheEntry(Sub0, cx);
+    SimTK_TEST(&copy.updCacheEntry(Sub0, cx) == mine);
+
+    // The source can be written after the copy goes away; sharing again
+    // and then writing to the source leaves the other State alone.
+    {   State temp; temp.assignSharingValues(s); }
+    Value<int>::updDowncast(s.updCacheEntry(Sub0, cx)) = 9;
+    copy.assignSharingValues(s);
+    SimTK_TEST(&copy.getCacheEntry(Sub0, cx) == &s.getCacheEntry(Sub0, cx));
+    Value<int>::updDowncast(s.updDiscreteVariable(Sub0, dx)) = 5;
+    SimTK_TEST(Value<int>::downcast(copy.getDiscreteVariable(Sub0, dx)) == 3);
+    SimTK_TEST(Value<int>::downcast(copy.getCacheEntry(Sub0, cx)) == 9);
+
+    // An ordinary copy or assignment never shares.
+    State plain(s);
+    SimTK_TEST(&plain.getCacheEntry(Sub0, cx) != &s.getCacheEntry(Sub0, cx));
+    SimTK_TEST(Value<int>::downcast(plain.getCacheEntry(Sub0, cx)) == 9);
+    copy = s;
+    SimTK_TEST(&copy.getDiscreteVariable(Sub0, dx) 
+               != &s.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(Value<int>::downcast(copy.getDiscreteVariable(Sub0, dx)) == 5);
+}
+
+// References obtained from a State stay valid and keep tracking that State's
+// values across ordinary copies. With sharing, a "get" reference may be left
+// referring to the other State's value after a write, as documented.
+void testReferenceValidity() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    const DiscreteVariableIndex dx = 
+        s.allocateDiscreteVariable(Sub0, Stage::Instance, new Value<int>(3));
+    const CacheEntryIndex cx = s.allocateCacheEntry(Sub0, 
+        Stage::Model, Stage::Model, new Value<Vector>(Vector(10, 1.)));
+    s.advanceSubsystemToStage(Sub0, Stage::Topology);
+    s.advanceSystemToStage(Stage::Topology);
+    s.advanceSubsystemToStage(Sub0, Stage::Model);
+    s.advanceSystemToStage(Stage::Model);
+
+    // Without a copy, get and upd refer to the same object.
+    const AbstractValue& before = s.getDiscreteVariable(Sub0, dx);
+    Value<int>::updDowncast(s.updDiscreteVariable(Sub0, dx)) = 4;
+    SimTK_TEST(&before == &s.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(Value<int>::downcast(before) == 4);
+
+    // Ordinary copies don't disturb references held on either State, even
+    // across writes and after the copy is gone.
+    const AbstractValue& ceRef = s.getCacheEntry(Sub0, cx);
+    {   State copy(s);
+        const AbstractValue& copyRef = copy.getDiscreteVariable(Sub0, dx);
+        Value<int>::updDowncast(copy.updDiscreteVariable(Sub0, dx)) = 5;
+        Value<int>::updDowncast(s.updDiscreteVariable(Sub0, dx)) = 6;
+        Value<Vector>::updDowncast(s.updCacheEntry(Sub0, cx)).upd()[0] = 2.;
+        SimTK_TEST(Value<int>::downcast(copyRef) == 5);
+        SimTK_TEST(&copyRef == &copy.getDiscreteVariable(Sub0, dx)); }
+    SimTK_TEST(&before == &s.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(Value<int>::downcast(before) == 6);
+    SimTK_TEST(&ceRef == &s.getCacheEntry(Sub0, cx));
+    SimTK_TEST(Value<Vector>::downcast(ceRef).get()[0] == 2);
+
+    // With sharing, a get reference taken before a write refers to the value
+    // the other State still has; getting again sees the update.
+    State shared;
+    shared.assignSharingValues(s);
+    const AbstractValue& dvRef = shared.getDiscreteVariable(Sub0, dx);
+    Value<int>::updDowncast(shared.updDiscreteVariable(Sub0, dx)) = 7;
+    SimTK_TEST(&dvRef == &s.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(&dvRef != &shared.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(Value<int>::downcast(dvRef) == 6);
+    SimTK_TEST(Value<int>::downcast(shared.getDiscreteVariable(Sub0, dx))==7);
+
+    // Once unshared, get and upd agree again.
+    const AbstractValue& ownRef = shared.getDiscreteVariable(Sub0, dx);
+    Value<int>::updDowncast(shared.updDiscreteVariable(Sub0, dx)) = 8;
+    SimTK_TEST(&ownRef == &shared.getDiscreteVariable(Sub0, dx));
+    SimTK_TEST(Value<int>::downcast(ownRef) == 8);
+}
+
+// A value type that keeps track of how many of it exist.
+class CountedValue : public Value<int> {
+public:
+    explicit CountedValue(int i) : Value<int>(i) {++count;}
+    CountedValue(const CountedValue& src) : Value<int>(src.get()) {++count;}
+    ~CountedValue() {--count;}
+    AbstractValue* clone() const {return new CountedValue(*this);}
+    static int count;
+};
+int CountedValue::count = 0;
+
+// The State keeps the value objects it is given rather than copying them,
+// clones them when the State is copied (or, for a State that shares them,
+// when one of the States writes to one), and destroys them when their 
+// allocation stage is invalidated.
+void testValueLifetime() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    s.advanceSubsystemToStage(Sub0, Stage::Topology);
+    s.advanceSystemToStage(Stage::Topology);
+
+    for (int pass=0; pass < 3; ++pass) {
+        CountedValue* counted = new CountedValue(4);
+        const CacheEntryIndex cx1 = s.allocateCacheEntry(Sub0, 
+            Stage::Instance, new Value<int>(1));
+        const CacheEntryIndex cxBig = s.allocateCacheEntry(Sub0, 
+            Stage::Instance, new Value< Vec<500> >(Vec<500>(3)));
+        const CacheEntryIndex cxCounted = s.allocateCacheEntry(Sub0, 
+            Stage::Instance, counted);
+        SimTK_TEST(CountedValue::count == 1);
+        s.advanceSubsystemToStage(Sub0, Stage::Model);
+        s.advanceSystemToStage(Stage::Model);
+        s.advanceSubsystemToStage(Sub0, Stage::Instance);
+        s.advanceSystemToStage(Stage::Instance);
+
+        SimTK_TEST(&s.getCacheEntry(Sub0, cxCounted) == counted);
+        SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub0, cx1)) == 1);
+        SimTK_TEST(Value< Vec<500> >::downcast(s.getCacheEntry(Sub0, cxBig))
+                   .get() == Vec<500>(3));
+        SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub0, cxCounted))
+                   == 4);
+
+        // An ordinary copy has its own values right away.
+        {   State copy(s);
+            SimTK_TEST(CountedValue::count == 2);
+            SimTK_TEST(&copy.getCacheEntry(Sub0, cxCounted) != counted); }
+        SimTK_TEST(CountedValue::count == 1);
+
+        // Writing to a sharing copy clones into the copy's own storage.
+        {   State copy;
+            copy.assignSharingValues(s);
+            SimTK_TEST(CountedValue::count == 1);
+            Value<int>::updDowncast(copy.updCacheEntry(Sub0, cxCounted)) = 5;
+            Value< Vec<500> >::updDowncast(copy.updCacheEntry(Sub0, cxBig))
+                = Vec<500>(6);
+            SimTK_TEST(CountedValue::count == 2);
+            SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub0, cxCounted))
+                       == 4);
+            SimTK_TEST(Value< Vec<500> >::downcast
+                       (s.getCacheEntry(Sub0, cxBig)).get() == Vec<500>(3)); }
+        SimTK_TEST(CountedValue::count == 1);
+
+        // Back up to Topology stage; the Model-stage entries are forgotten.
+        s.invalidateAll(Stage::Model);
+        SimTK_TEST(CountedValue::count == 0);
+    }
+}
+
+// A long-lived State that is copied with shared values and written to over 
+// and over, with the copies sometimes outliving later writes, must neither leak values nor get
+// them mixed up. Value holders freed by the copies are reused by later 
+// unsharing so the State's storage doesn't keep growing.
+void testRepeatedCopyAndWrite() {
+    const SubsystemIndex Sub0(0);
+    const int NValues = 100; // enough to need more than one slab of holders
+    State s;
+    s.setNumSubsystems(1);
+    Array_<DiscreteVariableIndex> dx(NValues);
+    Array_<CacheEntryIndex> cx(NValues);
+    for (int i=0; i < NValues; ++i) {
+        dx[i] = s.allocateDiscreteVariable(Sub0, Stage::Instance, 
+                                           new CountedValue(i));
+        cx[i] = s.allocateCacheEntry(Sub0, Stage::Model, Stage::Model,
+                                     new CountedValue(-i));
+    }
+    s.advanceSubsystemToStage(Sub0, Stage::Topology);
+    s.advanceSystemToStage(Stage::Topology);
+    s.advanceSubsystemToStage(Sub0, Stage::Model);
+    s.advanceSystemToStage(Stage::Model);
+    SimTK_TEST(CountedValue::count == 2*NValues);
+
+    State saved; // outlives many writes below
+    saved.assignSharingValues(s);
+    for (int iter=1; iter <= 2000; ++iter) {
+        State copy;
+        copy.assignSharingValues(s);
+        const int i = iter % NValues;
+        Value<int>::updDowncast(copy.updDiscreteVariable(Sub0, dx[i])) = -1;
+        Value<int>::updDowncast(s.updDiscreteVariable(Sub0, dx[i])) += NValues;
+        Value<int>::updDowncast(s.updCacheEntry(Sub0, cx[i])) -= NValues;
+        SimTK_TEST(Value<int>::downcast(copy.getDiscreteVariable(Sub0, dx[i]))
+                   == -1);
+        if (iter % 500 == 0) saved.assignSharingValues(s);
+
+        // The source, the copy, and the saved State each hold at most one
+        // value of their own per slot.
+        SimTK_TEST(CountedValue::count <= 6*NValues);
+    }
+    SimTK_TEST(CountedValue::count <= 4*NValues);
+
+    // Every value ended up where it was written.
+    for (int i=0; i < NValues; ++i) {
+        const int nWrites = 2000/NValues;
+        SimTK_TEST(Value<int>::downcast(s.getDiscreteVariable(Sub0, dx[i]))
+                   == i + nWrites*NValues);
+        SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub0, cx[i]))
+                   == -i - nWrites*NValues);
+        SimTK_TEST(Value<int>::downcast(saved.getDiscreteVariable(Sub0,dx[i]))
+                   == i + nWrites*NValues);
+    }
+
+    saved.clear();
+    SimTK_TEST(CountedValue::count == 2*NValues);
+    s.clear();
+    SimTK_TEST(CountedValue::count == 0);
+}
+
 void testMisc() {
     State s;
     s.setNumSubsystems(1);
@@ -252,6 +492,10 @@ int main() {
     SimTK_START_TEST("StateTest");
         //SimTK_SUBTEST(testLowestModified);
         SimTK_SUBTEST(testCacheValidity);
+        SimTK_SUBTEST(testCopyOnWrite);
+        SimTK_SUBTEST(testReferenceValidity);
+        SimTK_SUBTEST(testValueLifetime);
+        SimTK_SUBTEST(testRepeatedCopyAndWrite);
         SimTK_SUBTEST(testMisc);
     SimTK_END_TEST();
 }
@@ -30,6 +30,7 @@
 #include "simmath/internal/Contact.h"
 
 #include <map>
+#include <pthread.h>
 
 namespace SimTK {
 
@@ -204,32 +205,45 @@ private:
 class SimTK_SIMMATH_EXPORT CollisionDetectionAlgorithm::TriangleMeshTriangleMesh
 :   public CollisionDetectionAlgorithm {
 public:
-    virtual ~TriangleMeshTriangleMesh() {}
+    TriangleMeshTriangleMesh() : meshExecutor(0), meshThreads(1) 
+    {   pthread_mutex_init(&meshExecutorLock, NULL); }
+    virtual ~TriangleMeshTriangleMesh() 
+    {   delete meshExecutor; pthread_mutex_destroy(&meshExecutorLock); }
     void processObjects
        (ContactSurfaceIndex index1, const ContactGeometry& object1, 
         const Transform& transform1,
         ContactSurfaceIndex index2, const ContactGeometry& object2, 
         const Transform& transform2, 
         Array_<Contact>& contacts) const;
+    /**
+     * Enable or disable spreading the work for large mesh-mesh contacts across
+     * multiple threads. The threads are created here and reused by every
+     * processObjects() call. The contacts found are the same either way. 
+     * Small contacts, calls made from a thread that is already a 
+     * ParallelExecutor worker, and calls made while another thread is using
+     * the threads are always handled serially. This is off by default.
+     *
+     * @param useParallel    set true to enable parallel processing
+     * @param numThreads     the number of worker threads to use; by default
+     *                       this is the number of available processors
+     */
+    void setUseParallel
+       (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+    /**
+     * Get whether parallel processing has been enabled with more than one
+     * thread.
+     */
+    bool getUseParallel() const {return meshExecutor != 0;}
 private:
-    void processNodes(const ContactGeometry::TriangleMesh& mesh1, 
-                      const ContactGeometry::TriangleMesh& mesh2,
-                      const ContactGeometry::TriangleMesh::OBBTreeNode& node1, 
-                      const ContactGeometry::TriangleMesh::OBBTreeNode& node2,
-                      const OrientedBoundingBox& node2Bounds, 
-                      const Transform& transform, std::set<int>& triangles1, 
-                      std::set<int>& triangles2) const;
-    void findInsideTriangles(const ContactGeometry::TriangleMesh& mesh, 
-                             const ContactGeometry::TriangleMesh& otherMesh,
-                             const Transform& transform, 
-                             std::set<int>& triangles) const;
-    void tagFaces(const ContactGeometry::TriangleMesh& mesh, 
-                  Array_<int>& faceType, std::set<int>& triangles, 
-                  int index, int depth) const;
-    static const int OUTSIDE = -1;
-    static const int UNKNOWN = 0;
-    static const int BOUNDARY = 1;
-    static const int INSIDE = 2;
+    // The executor owns threads, so this can't be copied.
+    TriangleMeshTriangleMesh(const TriangleMeshTriangleMesh&);
+    TriangleMeshTriangleMesh& operator=(const TriangleMeshTriangleMesh&);
+
+    // Null unless parallel processing is on.
+    ParallelExecutor*       meshExecutor;
+    int                     meshThreads;
+    // Held while a processObjects() call is using meshExecutor.
+    mutable pthread_mutex_t meshExecutorLock;
 };
 
 /**
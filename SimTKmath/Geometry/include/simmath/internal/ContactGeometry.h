@@ -1125,6 +1125,28 @@ triangulated.
                  If false, it will be treated as a faceted mesh with a constant
                  normal vector over each face. **/
 explicit TriangleMesh(const PolygonalMesh& mesh, bool smooth=false);
+/** Create a TriangleMesh, loading its OBB tree from a cache file if 
+possible. Building the tree is the bulk of the cost of constructing a large
+mesh; if \a obbTreeCacheFile holds a tree built for a mesh with exactly the
+same vertices and faces it is used instead, otherwise the tree is built and 
+then written to that file for next time. The file is in native binary format
+and is not portable between platforms, but one written elsewhere or for a
+different mesh will just be ignored and overwritten.
+@param vertices         The positions of all vertices in the mesh.
+@param faceIndices      The indices of the vertices that make up each face.
+@param smooth           See the other constructors.
+@param obbTreeCacheFile The name of the file in which to cache the tree. **/
+TriangleMesh(const ArrayViewConst_<Vec3>& vertices, 
+             const ArrayViewConst_<int>& faceIndices, bool smooth,
+             const String& obbTreeCacheFile);
+/** Create a TriangleMesh based on a PolygonalMesh object, loading its OBB 
+tree from a cache file if possible. See the previous constructor.
+@param mesh             The PolygonalMesh from which to construct a triangle
+                        mesh.
+@param smooth           See the other constructors.
+@param obbTreeCacheFile The name of the file in which to cache the tree. **/
+TriangleMesh(const PolygonalMesh& mesh, bool smooth, 
+             const String& obbTreeCacheFile);
 /** Get the number of edges in the mesh. **/
 int getNumEdges() const;
 /** Get the number of faces in the mesh. **/
@@ -1283,7 +1305,7 @@ triangles contained within it or its  children. This is a binary tree: each
 non-leaf node has two children. Triangles are stored only in the leaf nodes. **/
 class SimTK_SIMMATH_EXPORT ContactGeometry::TriangleMesh::OBBTreeNode {
 public:
-OBBTreeNode(const OBBTreeNodeImpl& impl);
+OBBTreeNode(const OBBTreeNodeImpl& impl, const TriangleMesh::Impl& mesh);
 /** Get the OrientedBoundingBox which encloses all triangles in this node or 
 its children. **/
 const OrientedBoundingBox& getBounds() const;
@@ -1304,7 +1326,8 @@ node. **/
 int getNumTriangles() const;
 
 private:
-const OBBTreeNodeImpl* impl;
+const OBBTreeNodeImpl*      impl;
+const TriangleMesh::Impl*   mesh;
 };
 
 //==============================================================================
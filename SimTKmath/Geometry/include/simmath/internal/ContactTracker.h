@@ -28,6 +28,8 @@
 #include "simmath/internal/common.h"
 #include "simmath/internal/Contact.h"
 
+#include <pthread.h>
+
 namespace SimTK {
 
 //==============================================================================
@@ -68,6 +70,7 @@ class HalfSpaceTriangleMesh;
 class SphereTriangleMesh;
 class TriangleMeshTriangleMesh;
 class ConvexImplicitPair;
+class ConvexSupportPair;
 class GeneralImplicitPair;
 
 /** Base class constructor for use by the concrete classes. **/
@@ -451,9 +454,27 @@ class SimTK_SIMMATH_EXPORT ContactTracker::TriangleMeshTriangleMesh
 public:
 TriangleMeshTriangleMesh() 
 :   ContactTracker(ContactGeometry::TriangleMesh::classTypeId(),
-                   ContactGeometry::TriangleMesh::classTypeId()) {}
-
-virtual ~TriangleMeshTriangleMesh() {}
+                   ContactGeometry::TriangleMesh::classTypeId()),
+    m_executor(0), m_numThreads(1) 
+{   pthread_mutex_init(&m_executorLock, NULL); }
+
+virtual ~TriangleMeshTriangleMesh() 
+{   delete m_executor; pthread_mutex_destroy(&m_executorLock); }
+
+/** Enable or disable spreading the narrow phase of large mesh-mesh contacts
+across multiple threads. The threads are created here and reused by every
+trackContact() call. The faces found are the same either way. Small contacts,
+calls made from a thread that is already a ParallelExecutor worker, and calls
+made while another thread is using the threads are always handled serially.
+This is off by default.
+@param useParallel  set true to enable the parallel narrow phase
+@param numThreads   the number of worker threads to use; by default this is
+                    the number of available processors **/
+void setUseParallel
+   (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+/** Get whether the parallel narrow phase has been enabled with more than
+one thread. **/
+bool getUseParallel() const {return m_executor != 0;}
 
 virtual bool trackContact
    (const Contact&         priorStatus,
@@ -484,25 +505,15 @@ virtual bool initializeContact
     Contact&               contactStatus) const;
 
 private:
-void findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      insideFaces1, 
-    std::set<int>&                                      insideFaces2) const; 
-void findBuriedFaces
-   (const ContactGeometry::TriangleMesh&    mesh,
-    const ContactGeometry::TriangleMesh&    otherMesh,
-    const Transform&                        X_OM, 
-    std::set<int>&                          insideFaces) const;
-void tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
-              Array_<int>&                           faceType,
-              std::set<int>&                         triangles, 
-              int                                    index,
-              int                                    depth) const;
+// The executor owns threads, so this can't be copied.
+TriangleMeshTriangleMesh(const TriangleMeshTriangleMesh&);
+TriangleMeshTriangleMesh& operator=(const TriangleMeshTriangleMesh&);
+
+// Null unless the parallel narrow phase is on.
+ParallelExecutor*       m_executor;
+int                     m_numThreads;
+// Held while a trackContact() call is using m_executor.
+mutable pthread_mutex_t m_executorLock;
 };
 
 
@@ -550,6 +561,59 @@ virtual bool initializeContact
 };
 
 
+//==============================================================================
+//              CONVEX SUPPORT FUNCTION PAIR CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between two smooth, strictly convex,
+finite objects using only their support functions and surface curvatures. The
+penetration depth is the minimum of the support function of the Minkowski
+difference of the two shapes, and we find it with a Newton iteration over
+directions whose Hessian comes from the principal curvatures at the support
+points. A contact that was present at the previous evaluation warm-starts the
+iteration from the prior contact normal, so persistent contacts usually
+converge in one or two iterations; finding a separating direction ends the
+search immediately. If the iteration doesn't converge this falls back to the
+method used by ConvexImplicitPair, so the shapes must also provide implicit
+functions. Create one of these for each possible pair that you want handled
+this way. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::ConvexSupportPair 
+:   public ContactTracker {
+public:
+ConvexSupportPair(ContactGeometryTypeId type1, ContactGeometryTypeId type2) 
+:   ContactTracker(type1, type2) {}
+
+virtual ~ConvexSupportPair() {}
+
+virtual bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, 
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, 
+    const ContactGeometry& surface2,
+    Real                   cutoff,
+    Contact&               currentStatus) const;
+
+virtual bool predictContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, const SpatialVec& V_GS1, const SpatialVec& A_GS1,
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, const SpatialVec& V_GS2, const SpatialVec& A_GS2,
+    const ContactGeometry& surface2,
+    Real                   cutoff,
+    Real                   intervalOfInterest,
+    Contact&               predictedStatus) const;
+
+virtual bool initializeContact
+   (const Transform& X_GS1, const SpatialVec& V_GS1,
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, const SpatialVec& V_GS2,
+    const ContactGeometry& surface2,
+    Real                   cutoff,
+    Real                   intervalOfInterest,
+    Contact&               contactStatus) const;
+};
+
+
 //==============================================================================
 //                GENERAL IMPLICIT SURFACE PAIR CONTACT TRACKER
 //==============================================================================
@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKmath.h"
+#include "TriangleMeshIntersection.h"
 
 #include <set>
 
@@ -354,6 +355,23 @@ void CollisionDetectionAlgorithm::SphereTriangleMesh::processBox
 //==============================================================================
 //                        TRIANGLE MESH - TRIANGLE MESH
 //==============================================================================
+void CollisionDetectionAlgorithm::TriangleMeshTriangleMesh::
+setUseParallel(bool useParallel, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "CollisionDetectionAlgorithm::TriangleMeshTriangleMesh", 
+        "setUseParallel",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete meshExecutor;
+    meshExecutor = 0;
+    meshThreads  = 1;
+
+    if (useParallel && numThreads > 1) {
+        meshExecutor = new ParallelExecutor(numThreads);
+        meshThreads  = numThreads;
+    }
+}
+
 void CollisionDetectionAlgorithm::TriangleMeshTriangleMesh::
 processObjects
    (ContactSurfaceIndex index1, const ContactGeometry& object1, 
@@ -367,149 +385,27 @@ processObjects
     const ContactGeometry::TriangleMesh& mesh2 = 
         ContactGeometry::TriangleMesh::getAs(object2);
 
+    // If another thread is using the executor for a different pair of 
+    // meshes, this pair is handled serially.
+    const TryLockedExecutor executor(meshExecutor, meshExecutorLock);
+
     // Get mesh2's frame measured and expressed in mesh1's frame.
     const Transform X_M1M2 = (~X_GM1)*X_GM2; 
     set<int> triangles1;
     set<int> triangles2;
-    OrientedBoundingBox mesh2Bounds = X_M1M2*mesh2.getOBBTreeNode().getBounds();
-    processNodes(mesh1, mesh2, mesh1.getOBBTreeNode(), mesh2.getOBBTreeNode(), 
-                 mesh2Bounds, X_M1M2, triangles1, triangles2);
+    findIntersectingMeshFaces(mesh1, mesh2, X_M1M2, triangles1, triangles2,
+                              executor.getExecutor(), meshThreads);
     if (triangles1.size() == 0)
         return; // No intersection.
     
     // There was an intersection.  We now need to identify every triangle and vertex of each mesh that is inside the other mesh.
     
-    findInsideTriangles(mesh1, mesh2, ~X_M1M2, triangles1);
-    findInsideTriangles(mesh2, mesh1,  X_M1M2, triangles2);
+    findBuriedMeshFaces(mesh1, mesh2, X_M1M2, triangles1, triangles2, 
+                        executor.getExecutor());
     contacts.push_back(TriangleMeshContact(index1, index2, X_M1M2,
                                            triangles1, triangles2));
 }
 
-void CollisionDetectionAlgorithm::TriangleMeshTriangleMesh::
-processNodes
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds,
-    const Transform&                                    X_M1M2, 
-    set<int>&                                           triangles1, 
-    set<int>&                                           triangles2) const 
-{   // See if the bounding boxes intersect.
-    
-    if (!node1.getBounds().intersectsBox(node2Bounds))
-        return;
-    
-    // If either node is not a leaf node, process the children recursively.
-    
-    if (!node1.isLeafNode()) {
-        if (!node2.isLeafNode()) {
-            OrientedBoundingBox firstChildBounds = X_M1M2*node2.getFirstChildNode().getBounds();
-            OrientedBoundingBox secondChildBounds = X_M1M2*node2.getSecondChildNode().getBounds();
-            processNodes(mesh1, mesh2, node1.getFirstChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            processNodes(mesh1, mesh2, node1.getFirstChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-            processNodes(mesh1, mesh2, node1.getSecondChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            processNodes(mesh1, mesh2, node1.getSecondChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        }
-        else {
-            processNodes(mesh1, mesh2, node1.getFirstChildNode(), node2, node2Bounds, X_M1M2, triangles1, triangles2);
-            processNodes(mesh1, mesh2, node1.getSecondChildNode(), node2, node2Bounds, X_M1M2, triangles1, triangles2);
-        }
-        return;
-    }
-    else if (!node2.isLeafNode()) {
-        OrientedBoundingBox firstChildBounds = X_M1M2*node2.getFirstChildNode().getBounds();
-        OrientedBoundingBox secondChildBounds = X_M1M2*node2.getSecondChildNode().getBounds();
-        processNodes(mesh1, mesh2, node1, node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-        processNodes(mesh1, mesh2, node1, node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        return;
-    }
-    
-    // These are both leaf nodes, so check triangles for intersections.
-    
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
-    for (int i = 0; i < (int) node2triangles.size(); i++) {
-        Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(node2triangles[i], 0));
-        Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(node2triangles[i], 1));
-        Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(node2triangles[i], 2));
-        Geo::Triangle A(a1,a2,a3);
-        for (int j = 0; j < (int) node1triangles.size(); j++) {
-            const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(node1triangles[j], 0));
-            const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(node1triangles[j], 1));
-            const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(node1triangles[j], 2));
-            Geo::Triangle B(b1,b2,b3);
-            if (A.overlapsTriangle(B)) {
-                // The triangles intersect.            
-                triangles1.insert(node1triangles[j]);
-                triangles2.insert(node2triangles[i]);
-            }
-        }
-    }
-}
-
-void CollisionDetectionAlgorithm::TriangleMeshTriangleMesh::
-findInsideTriangles(const ContactGeometry::TriangleMesh&    mesh,       // M 
-                    const ContactGeometry::TriangleMesh&    otherMesh,  // O
-                    const Transform&                        X_OM, 
-                    set<int>&                               triangles) const 
-{   // Find which triangles are inside.
-    const int Unknown = UNKNOWN; // work around gcc bug
-    Array_<int> faceType(mesh.getNumFaces(), Unknown);
-    for (set<int>::iterator iter = triangles.begin(); 
-                            iter != triangles.end(); ++iter)
-        faceType[*iter] = BOUNDARY;
-
-    for (int i = 0; i < (int) faceType.size(); i++) {
-        if (faceType[i] == UNKNOWN) {
-            // Trace a ray from its center to determine whether it is inside.           
-            const Vec3     origin_O    = X_OM    * mesh.findCentroid(i);
-            const UnitVec3 direction_O = X_OM.R()* mesh.getFaceNormal(i);
-            Real distance;
-            int face;
-            Vec2 uv;
-            if (   otherMesh.intersectsRay(origin_O, direction_O, distance, 
-                                           face, uv) 
-                && ~direction_O*otherMesh.getFaceNormal(face) > 0) 
-            {
-                faceType[i] = INSIDE;
-                triangles.insert(i);
-            } else
-                faceType[i] = OUTSIDE;
-            
-            // Recursively mark adjacent triangles.           
-            tagFaces(mesh, faceType, triangles, i, 0);
-        }
-    }
-}
-
-//TODO: the following method uses depth-first recursion to iterate through
-//unmarked faces. For a large mesh this was observed to produce a stack
-//overflow in OpenSim. Here we limit the recursion depth; after we get that
-//deep we'll pop back out and do another expensive intersectsRay() test in
-//the method above.
-static const int MaxRecursionDepth = 500;
-
-void CollisionDetectionAlgorithm::TriangleMeshTriangleMesh::
-tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
-         Array_<int>&                           faceType,
-         set<int>&                              triangles, 
-         int                                    index,
-         int                                    depth) const 
-{
-    for (int i = 0; i < 3; i++) {
-        int edge = mesh.getFaceEdge(index, i);
-        int face = (mesh.getEdgeFace(edge, 0) == index ? mesh.getEdgeFace(edge, 1) : mesh.getEdgeFace(edge, 0));
-        if (faceType[face] == UNKNOWN) {
-            faceType[face] = faceType[index];
-            if (faceType[index] > 0)
-                triangles.insert(face);
-            if (depth < MaxRecursionDepth)
-                tagFaces(mesh, faceType, triangles, face, depth+1);
-        }
-    }
-}
-
 
 
 //==============================================================================
@@ -1141,8 +1141,6 @@ continueGeodesic(const Vec3& xP, const Vec3& xQ, const Geodesic& prevGeod,
     if (prevGeod.getNumPoints() 
         && prevGeod.getPointP()==P && prevGeod.getPointQ()==Q) {
             geod = prevGeod;
-            cout << "REUSING OLD GEODESIC of length=" 
-                << prevGeod.getLength() << "\n";
             return;
     }
    
@@ -1150,7 +1148,6 @@ continueGeodesic(const Vec3& xP, const Vec3& xQ, const Geodesic& prevGeod,
     const Real PQlength = PQ.norm();
     const UnitVec3 PQdir =
         PQlength == 0 ? UnitVec3(XAxis) : UnitVec3(PQ/PQlength, true);
-    cout << "  PQlen=" << PQlength << " PQdir=" << PQdir << "\n";
 
     // If the length is less than this fraction of the maximum radius of
     // curvature (1/kdP) then the geodesic is indistinguishable from a 
@@ -1160,7 +1157,6 @@ continueGeodesic(const Vec3& xP, const Vec3& xQ, const Geodesic& prevGeod,
     // that matter?
     const Real kdP = std::abs(calcSurfaceCurvatureInDirection(P,PQdir));
     if (PQlength*kdP <= StraightLineGeoFrac) {
-        cout << "STRAIGHT LINE GEO length=" << PQlength << "\n";
         makeStraightLineGeodesic(P, Q, PQdir, options, geod);
         return;
     }
@@ -1208,8 +1204,6 @@ continueGeodesic(const Vec3& xP, const Vec3& xQ, const Geodesic& prevGeod,
             tPhint = PQdir;
             tQhint = PQdir;
             sHint = PQlength;
-            cout << "GEODESIC FLIPPED. Prev len was " 
-                 << prevGeod.getLength() << endl;
         }
     }
 
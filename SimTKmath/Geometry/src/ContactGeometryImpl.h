@@ -913,17 +913,29 @@ private:
 //==============================================================================
 //                            OBB TREE NODE IMPL
 //==============================================================================
+// The nodes of a mesh's OBB tree are stored contiguously in depth-first order
+// in a single array owned by the mesh, so traversals touch memory roughly 
+// sequentially and no node is separately heap allocated. A non-leaf node's
+// first child immediately follows it; its second child is found at a stored
+// offset from the node, so that the array can be copied without fixups. The
+// triangles of all the leaves are likewise stored contiguously by the mesh;
+// each leaf's "triangles" array is a non-owning view of its own range there.
 class OBBTreeNodeImpl {
 public:
-    OBBTreeNodeImpl() : child1(NULL), child2(NULL) {
-    }
-    OBBTreeNodeImpl(const OBBTreeNodeImpl& copy);
-    ~OBBTreeNodeImpl();
+    OBBTreeNodeImpl() 
+    :   secondChildOffset(0), firstTriangle(0), numTriangles(0) {}
+
+    bool isLeaf() const {return secondChildOffset == 0;}
+    const OBBTreeNodeImpl* getFirstChild() const  
+    {   assert(!isLeaf()); return this + 1; }
+    const OBBTreeNodeImpl* getSecondChild() const 
+    {   assert(!isLeaf()); return this + secondChildOffset; }
+
     OrientedBoundingBox bounds;
-    OBBTreeNodeImpl* child1;
-    OBBTreeNodeImpl* child2;
-    Array_<int> triangles;
-    int numTriangles;
+    int secondChildOffset;  // 0 for a leaf
+    int firstTriangle;      // leaves only; index into the mesh's obbFaces
+    int numTriangles;       // for a non-leaf, the total of its descendents
+
     Vec3 findNearestPoint(const ContactGeometry::TriangleMesh::Impl& mesh, 
                           const Vec3& position, Real cutoff2, Real& distance2, 
                           int& face, Vec2& uv) const;
@@ -944,8 +956,11 @@ public:
     class Vertex;
 
     Impl(const ArrayViewConst_<Vec3>& vertexPositions, 
-         const ArrayViewConst_<int>& faceIndices, bool smooth);
-    Impl(const PolygonalMesh& mesh, bool smooth);
+         const ArrayViewConst_<int>& faceIndices, bool smooth,
+         const String& obbTreeCacheFile="");
+    Impl(const PolygonalMesh& mesh, bool smooth, 
+         const String& obbTreeCacheFile="");
+    Impl(const Impl& src);
     ContactGeometryImpl* clone() const {
         return new Impl(*this);
     }
@@ -973,28 +988,53 @@ public:
 
     void createPolygonalMesh(PolygonalMesh& mesh) const;
 
+    // Build the subtree for the given faces; see createObbTree().
+    int  createObbTree(const Array_<int>& faceIndices, 
+                       Array_<OBBTreeNodeImpl>& nodes,
+                       Array_<int>& leafFaces) const;
+
+    const OBBTreeNodeImpl& getObbRoot() const {return obbNodes[0];}
+    // Return the indices of the given leaf node's numTriangles faces.
+    const int* getObbLeafFaces(const OBBTreeNodeImpl& leaf) const 
+    {   return obbFaces.begin() + leaf.firstTriangle; }
+
     static ContactGeometryTypeId classTypeId() {
         static const ContactGeometryTypeId id = 
             createNewContactGeometryTypeId();
         return id;
     }
 private:
-    void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices);
-    void createObbTree(OBBTreeNodeImpl& node, const Array_<int>& faceIndices);
+    void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices,
+              const String& obbTreeCacheFile);
+    void createObbTree();
+    void shareObbFaces();
+    unsigned long long calcObbTreeChecksum() const;
+    bool readObbTree(const String& fileName);
+    void writeObbTree(const String& fileName) const;
+    bool splitObbNode(const Array_<int>& faceIndices, 
+                      OrientedBoundingBox& bounds,
+                      Array_<int>& child1Indices, 
+                      Array_<int>& child2Indices) const;
     void splitObbAxis(const Array_<int>& parentIndices, 
                       Array_<int>& child1Indices, 
-                      Array_<int>& child2Indices, int axis);
+                      Array_<int>& child2Indices, 
+                      const UnitVec3& axis) const;
     void findBoundingSphere(Vec3* point[], int p, int b, 
                             Vec3& center, Real& radius);
     friend class ContactGeometry::TriangleMesh;
     friend class OBBTreeNodeImpl;
+    friend class ContactGeometry::TriangleMesh::OBBTreeNode;
 
     Array_<Edge>    edges;
     Array_<Face>    faces;
     Array_<Vertex>  vertices;
     Vec3            boundingSphereCenter;
     Real            boundingSphereRadius;
-    OBBTreeNodeImpl obb;
+    Array_<OBBTreeNodeImpl> obbNodes;   // depth first; root is first
+    Array_<int>             obbFaces;   // all leaves' triangles
+    // Views of obbFaces, by node, to be returned from 
+    // OBBTreeNode::getTriangles(); empty for non-leaf nodes.
+    Array_< Array_<int> >   obbNodeTriangles;
     bool            smooth;
 };
 
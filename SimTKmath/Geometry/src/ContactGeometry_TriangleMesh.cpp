@@ -34,6 +34,17 @@
 #include <cmath>
 #include <map>
 #include <set>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <pthread.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 using namespace SimTK;
 using std::map;
@@ -55,6 +66,17 @@ ContactGeometry::TriangleMesh::TriangleMesh
    (const PolygonalMesh& mesh, bool smooth) 
 :   ContactGeometry(new TriangleMesh::Impl(mesh, smooth)) {}
 
+ContactGeometry::TriangleMesh::TriangleMesh
+   (const ArrayViewConst_<Vec3>& vertices, 
+    const ArrayViewConst_<int>& faceIndices, bool smooth,
+    const String& obbTreeCacheFile) 
+:   ContactGeometry(new TriangleMesh::Impl(vertices, faceIndices, smooth,
+                                           obbTreeCacheFile)) {}
+
+ContactGeometry::TriangleMesh::TriangleMesh
+   (const PolygonalMesh& mesh, bool smooth, const String& obbTreeCacheFile) 
+:   ContactGeometry(new TriangleMesh::Impl(mesh, smooth, obbTreeCacheFile)) {}
+
 /*static*/ ContactGeometryTypeId ContactGeometry::TriangleMesh::classTypeId() 
 {   return ContactGeometry::TriangleMesh::Impl::classTypeId(); }
 
@@ -185,7 +207,7 @@ bool ContactGeometry::TriangleMesh::intersectsRay
 
 ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::getOBBTreeNode() const {
-    return OBBTreeNode(getImpl().obb);
+    return OBBTreeNode(getImpl().getObbRoot(), getImpl());
 }
 
 PolygonalMesh ContactGeometry::TriangleMesh::createPolygonalMesh() const {
@@ -257,7 +279,7 @@ Vec3 ContactGeometry::TriangleMesh::Impl::
 findNearestPoint(const Vec3& position, bool& inside, int& face, Vec2& uv) const 
 {
     Real distance2;
-    Vec3 nearestPoint = obb.findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
+    Vec3 nearestPoint = getObbRoot().findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
     Vec3 delta = position-nearestPoint;
     inside = (~delta*faces[face].normal < 0);
     return nearestPoint;
@@ -278,9 +300,10 @@ bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
     Real boundsDistance;
-    if (!obb.bounds.intersectsRay(origin, direction, boundsDistance))
+    const OBBTreeNodeImpl& root = getObbRoot();
+    if (!root.bounds.intersectsRay(origin, direction, boundsDistance))
         return false;
-    return obb.intersectsRay(*this, origin, direction, distance, face, uv);
+    return root.intersectsRay(*this, origin, direction, distance, face, uv);
 }
 
 void ContactGeometry::TriangleMesh::Impl::
@@ -302,13 +325,24 @@ createPolygonalMesh(PolygonalMesh& mesh) const {
 
 ContactGeometry::TriangleMesh::Impl::Impl
    (const ArrayViewConst_<Vec3>& vertexPositions, 
-    const ArrayViewConst_<int>& faceIndices, bool smooth) 
+    const ArrayViewConst_<int>& faceIndices, bool smooth,
+    const String& obbTreeCacheFile) 
 :   ContactGeometryImpl(), smooth(smooth) {
-    init(vertexPositions, faceIndices);
+    init(vertexPositions, faceIndices, obbTreeCacheFile);
+}
+
+// The OBB tree nodes are copied but the leaves' triangle views must be
+// pointed at our own copy of the face storage.
+ContactGeometry::TriangleMesh::Impl::Impl(const Impl& src) 
+:   ContactGeometryImpl(src), edges(src.edges), faces(src.faces), 
+    vertices(src.vertices), boundingSphereCenter(src.boundingSphereCenter),
+    boundingSphereRadius(src.boundingSphereRadius), obbNodes(src.obbNodes),
+    obbFaces(src.obbFaces), smooth(src.smooth) {
+    shareObbFaces();
 }
 
 ContactGeometry::TriangleMesh::Impl::Impl
-   (const PolygonalMesh& mesh, bool smooth) 
+   (const PolygonalMesh& mesh, bool smooth, const String& obbTreeCacheFile) 
 :   ContactGeometryImpl(), smooth(smooth) 
 {   // Create the mesh, triangulating faces as necessary.
     Array_<Vec3>    vertexPositions;
@@ -350,7 +384,7 @@ ContactGeometry::TriangleMesh::Impl::Impl
             }
         }
     }
-    init(vertexPositions, faceIndices);
+    init(vertexPositions, faceIndices, obbTreeCacheFile);
     
     // Make sure the mesh normals are oriented correctly.
     
@@ -369,7 +403,7 @@ ContactGeometry::TriangleMesh::Impl::Impl
     // face's normal will be pointing back at us. If it is wrong, the face 
     // normal will also be pointing inwards, in roughly the same direction as 
     // the ray.
-    origin -= max(obb.bounds.getSize())*direction;
+    origin -= max(getObbRoot().bounds.getSize())*direction;
     Real distance;
     int face;
     Vec2 uv;
@@ -396,7 +430,8 @@ ContactGeometry::TriangleMesh::Impl::Impl
 }
 
 void ContactGeometry::TriangleMesh::Impl::init
-   (const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices) 
+   (const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices,
+    const String& obbTreeCacheFile) 
 {   SimTK_APIARGCHECK_ALWAYS(faceIndices.size()%3 == 0, 
         "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl", 
         "The number of indices must be a multiple of 3.");
@@ -525,12 +560,14 @@ void ContactGeometry::TriangleMesh::Impl::init
     for (int i = 0; i < (int) vertices.size(); i++)
         vertices[i].normal = UnitVec3(vertNorm[i]);
     
-    // Create the OBBTree.
+    // Create the OBBTree, or load it if there is a valid cached copy.
     
-    Array_<int> allFaces(faces.size());
-    for (int i = 0; i < (int) allFaces.size(); i++)
-        allFaces[i] = i;
-    createObbTree(obb, allFaces);
+    if (obbTreeCacheFile.empty() || !readObbTree(obbTreeCacheFile)) {
+        createObbTree();
+        if (!obbTreeCacheFile.empty())
+            writeObbTree(obbTreeCacheFile);
+    }
+    shareObbFaces();
     
     // Find the bounding sphere.
     Array_<const Vec3*> points(vertices.size());
@@ -541,99 +578,535 @@ void ContactGeometry::TriangleMesh::Impl::init
     boundingSphereRadius = bnd.getRadius();
 }
 
-void ContactGeometry::TriangleMesh::Impl::createObbTree
-   (OBBTreeNodeImpl& node, const Array_<int>& faceIndices) 
+//==============================================================================
+//                          OBB TREE CONSTRUCTION
+//==============================================================================
+// Large meshes have the top of their tree built serially, until there are 
+// enough independent subtrees to keep all the processors busy. The subtrees
+// are then built in parallel into their own arrays and spliced into obbNodes
+// in depth-first order; that is just a copy since child links are relative.
+// The resulting tree is identical to the one built serially.
+
+namespace {
+
+// Meshes with fewer faces than this are always built serially.
+const int ParallelObbTreeMinFaces = 4096;
+
+// All trees are built with the same executor, created the first time a large
+// mesh needs one, so that its threads are started only once per process. It 
+// is used by one build at a time; a build that finds it busy (another thread
+// is constructing a mesh) builds its subtrees serially instead.
+pthread_mutex_t     obbExecutorLock = PTHREAD_MUTEX_INITIALIZER;
+ParallelExecutor*   obbExecutor = 0;
+
+// One independent subtree to be built by a worker.
+struct ObbSubtree {
+    Array_<int>             faceIndices;
+    Array_<OBBTreeNodeImpl> nodes;
+    Array_<int>             leafFaces;
+};
+
+// A node in the serially built top of the tree. Exactly one of subtree or
+// the children is valid.
+struct ObbTopNode {
+    ObbTopNode() : child1(-1), child2(-1), subtree(-1) {}
+    OBBTreeNodeImpl node;
+    int child1, child2, subtree;
+};
+
+class BuildObbSubtreesTask : public ParallelExecutor::Task {
+public:
+    BuildObbSubtreesTask(const ContactGeometry::TriangleMesh::Impl& mesh,
+                         Array_<ObbSubtree>&                        subtrees)
+    :   mesh(mesh), subtrees(subtrees), errors(subtrees.size()) {}
+
+    void execute(int i) OVERRIDE_11 {
+        ObbSubtree& sub = subtrees[i];
+        try {mesh.createObbTree(sub.faceIndices, sub.nodes, sub.leafFaces);}
+        catch (const std::exception& e) {errors[i] = e.what();}
+        catch (...) {errors[i] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned i=0; i < errors.size(); ++i)
+            if (!errors[i].empty())
+                SimTK_THROW1(Exception::Cant, errors[i]);
+    }
+private:
+    const ContactGeometry::TriangleMesh::Impl&  mesh;
+    Array_<ObbSubtree>&                         subtrees;
+    Array_<std::string>                         errors;
+};
+
+}
+
+// Build the tree for all the faces into obbNodes and obbFaces.
+void ContactGeometry::TriangleMesh::Impl::createObbTree() {
+    Array_<int> allFaces(faces.size());
+    for (int i = 0; i < (int) allFaces.size(); i++)
+        allFaces[i] = i;
+    obbNodes.clear(); obbFaces.clear();
+    obbNodes.reserve(2*faces.size()); // at most 2n-1 nodes
+    obbFaces.reserve(faces.size());
+
+    if ((int)faces.size() < ParallelObbTreeMinFaces) {
+        createObbTree(allFaces, obbNodes, obbFaces);
+        return;
+    }
+
+    // Split serially until the pieces are small enough that there will be
+    // several for each processor.
+    const int numProcessors = ParallelExecutor::getNumProcessors();
+    const int grain = std::max(ParallelObbTreeMinFaces/4, 
+                               (int)faces.size()/(4*numProcessors));
+    Array_<ObbTopNode>  top;
+    Array_<ObbSubtree>  subtrees;
+    Array_<Array_<int> > pending(1, allFaces);
+    Array_<int>         pendingTop(1, 0);
+    top.push_back();
+    while (!pending.empty()) {
+        Array_<int> faceIndices; faceIndices.swap(pending.back());
+        const int t = pendingTop.back();
+        pending.pop_back(); pendingTop.pop_back();
+
+        Array_<int> child1Indices, child2Indices;
+        if ((int)faceIndices.size() <= grain
+            || !splitObbNode(faceIndices, top[t].node.bounds, 
+                             child1Indices, child2Indices)) {
+            top[t].subtree = subtrees.size();
+            subtrees.push_back();
+            subtrees.back().faceIndices.swap(faceIndices);
+            continue;
+        }
+        top[t].node.numTriangles = faceIndices.size();
+        top[t].child1 = top.size(); top.push_back();
+        top[t].child2 = top.size(); top.push_back();
+        pending.push_back(Array_<int>()); 
+        pending.back().swap(child2Indices); pendingTop.push_back(top[t].child2);
+        pending.push_back(Array_<int>()); 
+        pending.back().swap(child1Indices); pendingTop.push_back(top[t].child1);
+    }
+
+    BuildObbSubtreesTask task(*this, subtrees);
+    if (   numProcessors > 1 && !ParallelExecutor::isWorkerThread()
+        && pthread_mutex_trylock(&obbExecutorLock) == 0) {
+        if (!obbExecutor)
+            obbExecutor = new ParallelExecutor(numProcessors);
+        obbExecutor->execute(task, subtrees.size());
+        pthread_mutex_unlock(&obbExecutorLock);
+    } else {
+        for (int i=0; i < (int)subtrees.size(); ++i)
+            task.execute(i);
+    }
+    task.rethrowFirstError();
+
+    // Emit the top nodes and subtrees in depth-first order.
+    Array_<int> stack(1, 0), parentOfSecond(1, -1);
+    while (!stack.empty()) {
+        const ObbTopNode& t = top[stack.back()]; stack.pop_back();
+        const int parent = parentOfSecond.back(); parentOfSecond.pop_back();
+        const int nodeIndex = obbNodes.size();
+        if (parent >= 0)
+            obbNodes[parent].secondChildOffset = nodeIndex - parent;
+        if (t.subtree >= 0) {
+            const ObbSubtree& sub = subtrees[t.subtree];
+            const int faceBase = obbFaces.size();
+            obbNodes.insert(obbNodes.end(), sub.nodes.begin(), sub.nodes.end());
+            for (int i = nodeIndex; i < (int) obbNodes.size(); i++)
+                obbNodes[i].firstTriangle += faceBase;
+            obbFaces.insert(obbFaces.end(), sub.leafFaces.begin(), 
+                            sub.leafFaces.end());
+            continue;
+        }
+        obbNodes.push_back(t.node);
+        stack.push_back(t.child2); parentOfSecond.push_back(nodeIndex);
+        stack.push_back(t.child1); parentOfSecond.push_back(-1);
+    }
+}
+
+// Append a node for the given faces, followed by all its descendents, to 
+// "nodes", and the faces of its leaves to "leafFaces". Returns the index of
+// the new node. This uses only the mesh's vertices and faces, so separate
+// subtrees can be built concurrently.
+int ContactGeometry::TriangleMesh::Impl::createObbTree
+   (const Array_<int>& faceIndices, Array_<OBBTreeNodeImpl>& nodes,
+    Array_<int>& leafFaces) const
+{   const int nodeIndex = nodes.size();
+    nodes.push_back(OBBTreeNodeImpl());
+    nodes.back().numTriangles = faceIndices.size();
+
+    Array_<int> child1Indices, child2Indices;
+    if (splitObbNode(faceIndices, nodes.back().bounds, 
+                     child1Indices, child2Indices)) {
+        // The first child immediately follows this node.
+        createObbTree(child1Indices, nodes, leafFaces);
+        const int child2 = createObbTree(child2Indices, nodes, leafFaces);
+        nodes[nodeIndex].secondChildOffset = child2 - nodeIndex;
+        return nodeIndex;
+    }
+    
+    // This is a leaf node.
+    
+    nodes[nodeIndex].firstTriangle = leafFaces.size();
+    leafFaces.insert(leafFaces.end(), faceIndices.begin(), faceIndices.end());
+    return nodeIndex;
+}
+
+// Calculate the bounding box for a node containing the given faces and, if
+// it should have children, divide the faces between them. Returns false if
+// this should be a leaf node.
+bool ContactGeometry::TriangleMesh::Impl::splitObbNode
+   (const Array_<int>& faceIndices, OrientedBoundingBox& bounds,
+    Array_<int>& child1Indices, Array_<int>& child2Indices) const
 {   // Find all vertices in the node and build the OrientedBoundingBox.
-    node.numTriangles = faceIndices.size();
-    set<int> vertexIndices;
+    Array_<int> vertexIndices;
+    vertexIndices.reserve(3*faceIndices.size());
     for (int i = 0; i < (int) faceIndices.size(); i++) 
         for (int j = 0; j < 3; j++)
-            vertexIndices.insert(faces[faceIndices[i]].vertices[j]);
+            vertexIndices.push_back(faces[faceIndices[i]].vertices[j]);
+    std::sort(vertexIndices.begin(), vertexIndices.end());
+    vertexIndices.erase(std::unique(vertexIndices.begin(),vertexIndices.end()),
+                        vertexIndices.end());
     Vector_<Vec3> points((int)vertexIndices.size());
-    int index = 0;
-    for (set<int>::iterator iter = vertexIndices.begin(); 
-                            iter != vertexIndices.end(); ++iter)
-        points[index++] = vertices[*iter].pos;
-    node.bounds = OrientedBoundingBox(points);
-    if (faceIndices.size() > 3) {
-
-        // Order the axes by size.
-
-        int axisOrder[3];
-        const Vec3& size = node.bounds.getSize();
-        if (size[0] > size[1]) {
-            if (size[0] > size[2]) {
-                axisOrder[0] = 0;
-                if (size[1] > size[2]) {
-                    axisOrder[1] = 1;
-                    axisOrder[2] = 2;
-                }
-                else {
-                    axisOrder[1] = 2;
-                    axisOrder[2] = 1;
-                }
+    for (int i = 0; i < (int) vertexIndices.size(); i++)
+        points[i] = vertices[vertexIndices[i]].pos;
+    bounds = OrientedBoundingBox(points);
+    if (faceIndices.size() <= 3)
+        return false;
+
+    // Order the axes by size.
+
+    int axisOrder[3];
+    const Vec3& size = bounds.getSize();
+    if (size[0] > size[1]) {
+        if (size[0] > size[2]) {
+            axisOrder[0] = 0;
+            if (size[1] > size[2]) {
+                axisOrder[1] = 1;
+                axisOrder[2] = 2;
             }
             else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 0;
+                axisOrder[1] = 2;
                 axisOrder[2] = 1;
             }
         }
-        else if (size[0] > size[2]) {
-            axisOrder[0] = 1;
+        else {
+            axisOrder[0] = 2;
             axisOrder[1] = 0;
-            axisOrder[2] = 2;
+            axisOrder[2] = 1;
+        }
+    }
+    else if (size[0] > size[2]) {
+        axisOrder[0] = 1;
+        axisOrder[1] = 0;
+        axisOrder[2] = 2;
+    }
+    else {
+        if (size[1] > size[2]) {
+            axisOrder[0] = 1;
+            axisOrder[1] = 2;
         }
         else {
-            if (size[1] > size[2]) {
-                axisOrder[0] = 1;
-                axisOrder[1] = 2;
-            }
-            else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 1;
-            }
-            axisOrder[2] = 0;
+            axisOrder[0] = 2;
+            axisOrder[1] = 1;
         }
+        axisOrder[2] = 0;
+    }
 
-        // Try splitting along each axis.
+    // Try splitting along each of the box's axes, longest first.
 
-        for (int i = 0; i < 3; i++) {
-            Array_<int> child1Indices, child2Indices;
-            splitObbAxis(faceIndices, child1Indices, child2Indices, 
-                         axisOrder[i]);
-            if (child1Indices.size() > 0 && child2Indices.size() > 0) {
-                // It was successfully split, so create the child nodes.
+    const Rotation& R = bounds.getTransform().R();
+    for (int i = 0; i < 3; i++) {
+        child1Indices.clear(); child2Indices.clear();
+        splitObbAxis(faceIndices, child1Indices, child2Indices, 
+                     R(axisOrder[i]));
+        if (child1Indices.size() > 0 && child2Indices.size() > 0)
+            return true; // It was successfully split.
+    }
+    return false;
+}
 
-                node.child1 = new OBBTreeNodeImpl();
-                node.child2 = new OBBTreeNodeImpl();
-                createObbTree(*node.child1, child1Indices);
-                createObbTree(*node.child2, child2Indices);
-                return;
+//==============================================================================
+//                            OBB TREE CACHE FILE
+//==============================================================================
+// A cache file holds a header identifying the mesh it was built from, then
+// the nodes' boxes as 15 Reals each (rotation by rows, origin, size), the
+// nodes' secondChildOffset, firstTriangle, and numTriangles, and finally 
+// obbFaces. Everything is written in native binary form; a file written on
+// an incompatible platform or for a different mesh is detected by the header
+// and ignored. The file is read by mapping it into memory where that is 
+// possible, so its contents are copied only once, straight into the tree.
+
+namespace {
+
+const char  ObbCacheMagic[8]  = {'S','i','m','T','K','O','B','B'};
+// Version 3 trees split each node along its box's own axes.
+const int   ObbCacheVersion   = 3;
+
+struct ObbCacheHeader {
+    char            magic[8];
+    int             version, sizeofReal, sizeofInt;
+    int             numVertices, numFaces, numNodes, numLeafFaces;
+    unsigned long long checksum;
+};
+
+// The whole contents of a cache file. On POSIX systems the file is mapped 
+// read-only; elsewhere it is read into a buffer. Empty if the file can't be
+// read.
+class ObbCacheContents {
+public:
+    explicit ObbCacheContents(const String& fileName) 
+    :   data(0), bytes(0), mapped(false) {
+    #ifndef _WIN32
+        const int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd == -1)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* region = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (region != MAP_FAILED) {
+                data   = (const char*)region;
+                bytes  = (size_t)info.st_size;
+                mapped = true;
             }
         }
+        close(fd);
+    #else
+        std::ifstream in(fileName.c_str(), 
+                         std::ios::in | std::ios::binary | std::ios::ate);
+        const std::streamoff n = in.good() ? (std::streamoff)in.tellg() : 0;
+        if (n <= 0)
+            return;
+        buffer.resize((unsigned)n);
+        in.seekg(0);
+        if (in.read(buffer.begin(), n)) {
+            data  = buffer.begin();
+            bytes = (size_t)n;
+        }
+    #endif
+    }
+    ~ObbCacheContents() {
+    #ifndef _WIN32
+        if (mapped)
+            munmap((void*)data, bytes);
+    #endif
+    }
+    const char* begin() const {return data;}
+    size_t      size()  const {return bytes;}
+private:
+    ObbCacheContents(const ObbCacheContents&);            // suppress
+    ObbCacheContents& operator=(const ObbCacheContents&); // suppress
+    const char*     data;
+    size_t          bytes;
+    bool            mapped;
+    Array_<char>    buffer; // used only if the file isn't mapped
+};
+
+// Sequential reads from a cache file's contents. A read or skip that would
+// go past the end fails and does nothing. The contents need not be aligned 
+// for the types read from them.
+class ObbCacheReader {
+public:
+    explicit ObbCacheReader(const ObbCacheContents& contents)
+    :   next(contents.begin()), end(contents.begin()+contents.size()) {}
+    bool skip(size_t n) {
+        if (n > (size_t)(end-next))
+            return false;
+        next += n;
+        return true;
+    }
+    bool read(void* dest, size_t n) {
+        if (n > (size_t)(end-next))
+            return false;
+        std::memcpy(dest, next, n);
+        next += n;
+        return true;
+    }
+private:
+    const char* next;
+    const char* end;
+};
+
+// The header is written and read one field at a time so that the padding
+// the compiler may put in ObbCacheHeader never reaches the file.
+template <class T> void writeField(std::ostream& out, const T& field) 
+{   out.write((const char*)&field, sizeof(field)); }
+template <class T> bool readField(ObbCacheReader& in, T& field) 
+{   return in.read(&field, sizeof(field)); }
+
+void writeHeader(std::ostream& out, const ObbCacheHeader& hdr) {
+    out.write(hdr.magic, sizeof(hdr.magic));
+    writeField(out, hdr.version);     writeField(out, hdr.sizeofReal);
+    writeField(out, hdr.sizeofInt);   writeField(out, hdr.numVertices);
+    writeField(out, hdr.numFaces);    writeField(out, hdr.numNodes);
+    writeField(out, hdr.numLeafFaces); writeField(out, hdr.checksum);
+}
+
+bool readHeader(ObbCacheReader& in, ObbCacheHeader& hdr) {
+    return in.read(hdr.magic, sizeof(hdr.magic))
+        && readField(in, hdr.version)   && readField(in, hdr.sizeofReal)
+        && readField(in, hdr.sizeofInt) && readField(in, hdr.numVertices)
+        && readField(in, hdr.numFaces)  && readField(in, hdr.numNodes)
+        && readField(in, hdr.numLeafFaces) && readField(in, hdr.checksum);
+}
+
+// 64-bit FNV-1a hash.
+void hashBytes(unsigned long long& h, const void* data, size_t n) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i=0; i < n; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+}
+
+// Hash the vertex positions and the faces' vertex indices, which are all
+// that the tree depends on.
+unsigned long long ContactGeometry::TriangleMesh::Impl::
+calcObbTreeChecksum() const {
+    unsigned long long h = 14695981039346656037ULL;
+    for (int i = 0; i < (int) vertices.size(); i++)
+        hashBytes(h, &vertices[i].pos[0], 3*sizeof(Real));
+    for (int i = 0; i < (int) faces.size(); i++)
+        hashBytes(h, faces[i].vertices, 3*sizeof(int));
+    return h;
+}
+
+// Fill in obbNodes and obbFaces from a cache file. Returns false, leaving
+// them empty, if the file can't be read or wasn't written for this mesh.
+bool ContactGeometry::TriangleMesh::Impl::
+readObbTree(const String& fileName) {
+    const ObbCacheContents contents(fileName);
+    ObbCacheReader in(contents);
+    ObbCacheHeader hdr;
+    if (!readHeader(in, hdr)
+        || std::memcmp(hdr.magic, ObbCacheMagic, sizeof(ObbCacheMagic))
+        || hdr.version != ObbCacheVersion
+        || hdr.sizeofReal != (int)sizeof(Real)
+        || hdr.sizeofInt != (int)sizeof(int)
+        || hdr.numVertices != (int)vertices.size()
+        || hdr.numFaces != (int)faces.size()
+        || hdr.numNodes < 1 || hdr.numNodes > 2*hdr.numFaces
+        || hdr.numLeafFaces != hdr.numFaces
+        || hdr.checksum != calcObbTreeChecksum())
+        return false;
+
+    // The boxes, links, and obbFaces follow one another; read them side by
+    // side. Once obbFaces has been read, the others are known to be there.
+    ObbCacheReader boxes(in), links(in), leafFaces(in);
+    if (   !links.skip(15*sizeof(Real)*hdr.numNodes)
+        || !leafFaces.skip((15*sizeof(Real) + 3*sizeof(int))*hdr.numNodes))
+        return false;
+    obbFaces.resize(hdr.numLeafFaces);
+    if (!leafFaces.read(obbFaces.begin(), obbFaces.size()*sizeof(int))) {
+        obbFaces.clear();
+        return false;
+    }
+
+    // Don't trust the contents any further than necessary to be sure that 
+    // traversing the tree can't go out of bounds.
+    obbNodes.resize(hdr.numNodes);
+    for (int i = 0; i < hdr.numNodes; i++) {
+        OBBTreeNodeImpl& node = obbNodes[i];
+        Real b[15];
+        int  link[3];
+        boxes.read(b, sizeof(b)); 
+        links.read(link, sizeof(link));
+        const Mat33 R(b[0],b[1],b[2], b[3],b[4],b[5], b[6],b[7],b[8]);
+        node.bounds = OrientedBoundingBox
+           (Transform(Rotation(R, true), Vec3(b[9],b[10],b[11])),
+            Vec3(b[12],b[13],b[14]));
+        node.secondChildOffset = link[0];
+        node.firstTriangle     = link[1];
+        node.numTriangles      = link[2];
+        const bool ok = node.isLeaf()
+            ?  node.firstTriangle >= 0 && node.numTriangles >= 0
+               && node.firstTriangle + node.numTriangles <= hdr.numLeafFaces
+            :  node.secondChildOffset > 1 
+               && i + node.secondChildOffset < hdr.numNodes;
+        if (!ok) {
+            obbNodes.clear(); obbFaces.clear();
+            return false;
+        }
+    }
+    for (int i = 0; i < (int) obbFaces.size(); i++)
+        if (obbFaces[i] < 0 || obbFaces[i] >= (int)faces.size()) {
+            obbNodes.clear(); obbFaces.clear();
+            return false;
+        }
+    return true;
+}
+
+// Save obbNodes and obbFaces to a cache file. Failure to write the file is
+// not an error; the tree will just be rebuilt next time.
+void ContactGeometry::TriangleMesh::Impl::
+writeObbTree(const String& fileName) const {
+    ObbCacheHeader hdr;
+    std::memcpy(hdr.magic, ObbCacheMagic, sizeof(ObbCacheMagic));
+    hdr.version      = ObbCacheVersion;
+    hdr.sizeofReal   = sizeof(Real);
+    hdr.sizeofInt    = sizeof(int);
+    hdr.numVertices  = vertices.size();
+    hdr.numFaces     = faces.size();
+    hdr.numNodes     = obbNodes.size();
+    hdr.numLeafFaces = obbFaces.size();
+    hdr.checksum     = calcObbTreeChecksum();
+
+    Array_<Real> boxes(15*obbNodes.size());
+    Array_<int>  links(3*obbNodes.size());
+    for (int i = 0; i < (int) obbNodes.size(); i++) {
+        const OBBTreeNodeImpl& node = obbNodes[i];
+        const Transform& X = node.bounds.getTransform();
+        Real* b = &boxes[15*i];
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                b[3*r+c] = X.R()[r][c];
+        for (int k = 0; k < 3; k++) {
+            b[9+k]  = X.p()[k];
+            b[12+k] = node.bounds.getSize()[k];
+        }
+        links[3*i]   = node.secondChildOffset;
+        links[3*i+1] = node.firstTriangle;
+        links[3*i+2] = node.numTriangles;
+    }
+
+    std::ofstream out(fileName.c_str(), 
+                      std::ios::out | std::ios::binary | std::ios::trunc);
+    writeHeader(out, hdr);
+    out.write((const char*)boxes.begin(), boxes.size()*sizeof(Real));
+    out.write((const char*)links.begin(), links.size()*sizeof(int));
+    out.write((const char*)obbFaces.begin(), obbFaces.size()*sizeof(int));
+}
+
+// Point each leaf node's entry in obbNodeTriangles at its range of obbFaces.
+// These are used only by the OBBTreeNode API; the tree queries index 
+// obbFaces directly.
+void ContactGeometry::TriangleMesh::Impl::shareObbFaces() {
+    obbNodeTriangles.clear();
+    obbNodeTriangles.resize(obbNodes.size());
+    for (int i = 0; i < (int) obbNodes.size(); i++) {
+        const OBBTreeNodeImpl& node = obbNodes[i];
+        if (node.isLeaf())
+            obbNodeTriangles[i].shareData(&obbFaces[node.firstTriangle], 
+                                          node.numTriangles);
     }
-    
-    // This is a leaf node.
-    
-    node.triangles.insert(node.triangles.begin(), faceIndices.begin(), 
-                          faceIndices.end());
 }
 
 void ContactGeometry::TriangleMesh::Impl::splitObbAxis
    (const Array_<int>& parentIndices, Array_<int>& child1Indices, 
-    Array_<int>& child2Indices, int axis) 
-{   // For each face, find its minimum and maximum extent along the axis.
+    Array_<int>& child2Indices, const UnitVec3& axis) const
+{   // For each face, find its minimum and maximum extent along the axis, which
+    // is one of the parent box's axes expressed in the mesh frame.
     Vector minExtent(parentIndices.size());
     Vector maxExtent(parentIndices.size());
     for (int i = 0; i < (int) parentIndices.size(); i++) {
-        int* vertexIndices = faces[parentIndices[i]].vertices;
-        Real minVal = vertices[vertexIndices[0]].pos[axis];
-        Real maxVal = vertices[vertexIndices[0]].pos[axis];
-        minVal = std::min(minVal, vertices[vertexIndices[1]].pos[axis]);
-        maxVal = std::max(maxVal, vertices[vertexIndices[1]].pos[axis]);
-        minExtent[i] = std::min(minVal, vertices[vertexIndices[2]].pos[axis]);
-        maxExtent[i] = std::max(maxVal, vertices[vertexIndices[2]].pos[axis]);
+        const int* vertexIndices = faces[parentIndices[i]].vertices;
+        const Real v0 = ~axis*vertices[vertexIndices[0]].pos;
+        const Real v1 = ~axis*vertices[vertexIndices[1]].pos;
+        const Real v2 = ~axis*vertices[vertexIndices[2]].pos;
+        minExtent[i] = std::min(v0, std::min(v1, v2));
+        maxExtent[i] = std::max(v0, std::max(v1, v2));
     }
     
     // Select a split point that tries to put as many faces as possible 
@@ -767,33 +1240,15 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
 //                            OBB TREE NODE IMPL
 //==============================================================================
 
-OBBTreeNodeImpl::OBBTreeNodeImpl(const OBBTreeNodeImpl& copy) 
-:   bounds(copy.bounds), triangles(copy.triangles), 
-    numTriangles(copy.numTriangles) {
-    if (copy.child1 == NULL) {
-        child1 = NULL;
-        child2 = NULL;
-    }
-    else {
-        child1 = new OBBTreeNodeImpl(*copy.child1);
-        child2 = new OBBTreeNodeImpl(*copy.child2);
-    }
-}
-
-OBBTreeNodeImpl::~OBBTreeNodeImpl() {
-    if (child1 != NULL)
-        delete child1;
-    if (child2 != NULL)
-        delete child2;
-}
-
 Vec3 OBBTreeNodeImpl::findNearestPoint
    (const ContactGeometry::TriangleMesh::Impl& mesh, 
     const Vec3& position, Real cutoff2, 
     Real& distance2, int& face, Vec2& uv) const 
 {
     Real tol = 100*Eps;
-    if (child1 != NULL) {
+    if (!isLeaf()) {
+        const OBBTreeNodeImpl* child1 = getFirstChild();
+        const OBBTreeNodeImpl* child2 = getSecondChild();
         // Recursively check the child nodes.
         
         Real child1distance2 = MostPositiveReal, 
@@ -844,9 +1299,10 @@ Vec3 OBBTreeNodeImpl::findNearestPoint
     }    
     // This is a leaf node, so check each triangle for its distance to the point.
     
+    const int* triangles = mesh.getObbLeafFaces(*this);
     distance2 = MostPositiveReal;
     Vec3 nearestPoint;
-    for (int i = 0; i < (int) triangles.size(); i++) {
+    for (int i = 0; i < numTriangles; i++) {
         Vec2 triangleUV;
         Vec3 p = mesh.findNearestPointToFace(position, triangles[i], triangleUV);
         Vec3 offset = p-position;
@@ -866,7 +1322,9 @@ bool OBBTreeNodeImpl::
 intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
               const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
-    if (child1 != NULL) {
+    if (!isLeaf()) {
+        const OBBTreeNodeImpl* child1 = getFirstChild();
+        const OBBTreeNodeImpl* child2 = getSecondChild();
         // Recursively check the child nodes.
         
         Real child1distance, child2distance;
@@ -915,8 +1373,9 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
     // This is a leaf node, so check each triangle for an intersection with the 
     // ray.
     
+    const int* triangles = mesh.getObbLeafFaces(*this);
     bool foundIntersection = false;
-    for (int i = 0; i < (int) triangles.size(); i++) {
+    for (int i = 0; i < numTriangles; i++) {
         const UnitVec3& faceNormal = mesh.faces[triangles[i]].normal;
         Real vd = ~faceNormal*direction;
         if (vd == 0.0)
@@ -990,7 +1449,8 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
 //==============================================================================
 
 ContactGeometry::TriangleMesh::OBBTreeNode::
-OBBTreeNode(const OBBTreeNodeImpl& impl) : impl(&impl) {}
+OBBTreeNode(const OBBTreeNodeImpl& impl, const TriangleMesh::Impl& mesh) 
+:   impl(&impl), mesh(&mesh) {}
 
 const OrientedBoundingBox& 
 ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
@@ -998,28 +1458,28 @@ ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
 }
 
 bool ContactGeometry::TriangleMesh::OBBTreeNode::isLeafNode() const {
-    return (impl->child1 == NULL);
+    return impl->isLeaf();
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getFirstChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child1, 
+    SimTK_ASSERT_ALWAYS(!impl->isLeaf(), 
         "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child1);
+    return OBBTreeNode(*impl->getFirstChild(), *mesh);
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getSecondChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child2, 
+    SimTK_ASSERT_ALWAYS(!impl->isLeaf(), 
         "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child2);
+    return OBBTreeNode(*impl->getSecondChild(), *mesh);
 }
 
 const Array_<int>& ContactGeometry::TriangleMesh::OBBTreeNode::
 getTriangles() const {
-    SimTK_ASSERT_ALWAYS(impl->child2 == NULL, 
+    SimTK_ASSERT_ALWAYS(impl->isLeaf(), 
         "Called getTriangles() on a non-leaf node");
-    return impl->triangles;
+    return mesh->obbNodeTriangles[impl - &mesh->getObbRoot()];
 }
 
 int ContactGeometry::TriangleMesh::OBBTreeNode::getNumTriangles() const {
@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKmath.h"
+#include "TriangleMeshIntersection.h"
 
 #include <algorithm>
 using std::pair; using std::make_pair;
@@ -1069,7 +1070,25 @@ bool ContactTracker::SphereTriangleMesh::initializeContact
 //==============================================================================
 //               TRIANGLE MESH - TRIANGLE MESH CONTACT TRACKER
 //==============================================================================
-// Cost is TODO
+// The narrow phase is shared with CollisionDetectionAlgorithm; see
+// TriangleMeshIntersection.h.
+void ContactTracker::TriangleMeshTriangleMesh::setUseParallel
+   (bool useParallel, int numThreads) 
+{
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "ContactTracker::TriangleMeshTriangleMesh", "setUseParallel",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete m_executor;
+    m_executor   = 0;
+    m_numThreads = 1;
+
+    if (useParallel && numThreads > 1) {
+        m_executor   = new ParallelExecutor(numThreads);
+        m_numThreads = numThreads;
+    }
+}
+
 bool ContactTracker::TriangleMeshTriangleMesh::trackContact
    (const Contact&         priorStatus,
     const Transform&       X_GM1, 
@@ -1094,19 +1113,18 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
     const ContactGeometry::TriangleMesh& mesh2 = 
         ContactGeometry::TriangleMesh::getAs(geoMesh2);
 
+    // If another thread is using the executor for a different pair of 
+    // meshes, this pair is handled serially.
+    const TryLockedExecutor executor(m_executor, m_executorLock);
+
     // Transform giving mesh2 (M2) frame in the mesh1 (M1) frame.
     const Transform X_M1M2 = ~X_GM1*X_GM2; 
     std::set<int> insideFaces1, insideFaces2;
 
-    // Get M2's bounding box in M1's frame.
-    const OrientedBoundingBox 
-        mesh2Bounds_M1 = X_M1M2*mesh2.getOBBTreeNode().getBounds();
-
     // Find the faces that are actually intersecting faces on the other
     // surface (this doesn't yet include faces that may be completely buried).
-    findIntersectingFaces(mesh1, mesh2, 
-                          mesh1.getOBBTreeNode(), mesh2.getOBBTreeNode(), 
-                          mesh2Bounds_M1, X_M1M2, insideFaces1, insideFaces2);
+    findIntersectingMeshFaces(mesh1, mesh2, X_M1M2, insideFaces1, insideFaces2,
+                              executor.getExecutor(), m_numThreads);
     
     // It should never be the case that one set of faces is empty and the
     // other isn't, however it is conceivable that roundoff error could cause
@@ -1119,8 +1137,8 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
     // There was an intersection. We now need to identify every triangle and 
     // vertex of each mesh that is inside the other mesh. We found the border
     // intersections above; now we have to fill in the buried faces.
-    findBuriedFaces(mesh1, mesh2, ~X_M1M2, insideFaces1);
-    findBuriedFaces(mesh2, mesh1,  X_M1M2, insideFaces2);
+    findBuriedMeshFaces(mesh1, mesh2, X_M1M2, insideFaces1, insideFaces2,
+                        executor.getExecutor());
 
     currentStatus = TriangleMeshContact(priorStatus.getSurface1(), 
                                         priorStatus.getSurface2(), 
@@ -1129,146 +1147,6 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
     return true; // success
 }
 
-void ContactTracker::TriangleMeshTriangleMesh::
-findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      triangles1, 
-    std::set<int>&                                      triangles2) const 
-{   // See if the bounding boxes intersect.
-    
-    if (!node1.getBounds().intersectsBox(node2Bounds_M1))
-        return;
-    
-    // If either node is not a leaf node, process the children recursively.
-    
-    if (!node1.isLeafNode()) {
-        if (!node2.isLeafNode()) {
-            const OrientedBoundingBox firstChildBounds = 
-                X_M1M2*node2.getFirstChildNode().getBounds();
-            const OrientedBoundingBox secondChildBounds = 
-                X_M1M2*node2.getSecondChildNode().getBounds();
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        }
-        else {
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-        }
-        return;
-    }
-    else if (!node2.isLeafNode()) {
-        const OrientedBoundingBox firstChildBounds = 
-            X_M1M2*node2.getFirstChildNode().getBounds();
-        const OrientedBoundingBox secondChildBounds = 
-            X_M1M2*node2.getSecondChildNode().getBounds();
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        return;
-    }
-    
-    // These are both leaf nodes, so check triangles for intersections.
-    
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
-    for (unsigned i = 0; i < node2triangles.size(); i++) {
-        const int face2 = node2triangles[i];
-        Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
-        Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
-        Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
-        const Geo::Triangle A(a1,a2,a3);
-        for (unsigned j = 0; j < node1triangles.size(); j++) {
-            const int face1 = node1triangles[j];
-            const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
-            const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
-            const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
-            const Geo::Triangle B(b1,b2,b3);
-            if (A.overlapsTriangle(B)) 
-            {   // The triangles intersect.
-                triangles1.insert(face1);
-                triangles2.insert(face2);
-            }
-        }
-    }
-}
-
-static const int Outside  = -1;
-static const int Unknown  =  0;
-static const int Boundary =  1;
-static const int Inside   =  2;
-
-void ContactTracker::TriangleMeshTriangleMesh::
-findBuriedFaces(const ContactGeometry::TriangleMesh&    mesh,       // M 
-                const ContactGeometry::TriangleMesh&    otherMesh,  // O
-                const Transform&                        X_OM, 
-                std::set<int>&                          insideFaces) const 
-{  
-    // Find which faces are inside.
-    // We're passed in the list of Boundary faces, that is, those faces of
-    // "mesh" that intersect faces of "otherMesh".
-    Array_<int> faceType(mesh.getNumFaces(), Unknown);
-    for (std::set<int>::iterator iter = insideFaces.begin(); 
-                                 iter != insideFaces.end(); ++iter)
-        faceType[*iter] = Boundary;
-
-    for (int i = 0; i < (int) faceType.size(); i++) {
-        if (faceType[i] == Unknown) {
-            // Trace a ray from its center to determine whether it is inside.           
-            const Vec3     origin_O    = X_OM    * mesh.findCentroid(i);
-            const UnitVec3 direction_O = X_OM.R()* mesh.getFaceNormal(i);
-            Real distance;
-            int face;
-            Vec2 uv;
-            if (   otherMesh.intersectsRay(origin_O, direction_O, distance, 
-                                           face, uv) 
-                && ~direction_O*otherMesh.getFaceNormal(face) > 0) 
-            {
-                faceType[i] = Inside;
-                insideFaces.insert(i);
-            } else
-                faceType[i] = Outside;
-            
-            // Recursively mark adjacent inside or outside Faces.           
-            tagFaces(mesh, faceType, insideFaces, i, 0);
-        }
-    }
-}
-
-//TODO: the following method uses depth-first recursion to iterate through
-//unmarked faces. For a large mesh this was observed to produce a stack
-//overflow in OpenSim. Here we limit the recursion depth; after we get that
-//deep we'll pop back out and do another expensive intersectsRay() test in
-//the method above.
-static const int MaxRecursionDepth = 500;
-
-void ContactTracker::TriangleMeshTriangleMesh::
-tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
-         Array_<int>&                           faceType,
-         std::set<int>&                         triangles, 
-         int                                    index,
-         int                                    depth) const 
-{
-    for (int i = 0; i < 3; i++) {
-        const int edge = mesh.getFaceEdge(index, i);
-        const int face = (mesh.getEdgeFace(edge, 0) == index 
-                            ? mesh.getEdgeFace(edge, 1) 
-                            : mesh.getEdgeFace(edge, 0));
-        if (faceType[face] == Unknown) {
-            faceType[face] = faceType[index];
-            if (faceType[index] > 0)
-                triangles.insert(face);
-            if (depth < MaxRecursionDepth)
-                tagFaces(mesh, faceType, triangles, face, depth+1);
-        }
-    }
-}
-
 
 bool ContactTracker::TriangleMeshTriangleMesh::predictContact
    (const Contact&         priorStatus,
@@ -1421,6 +1299,230 @@ bool ContactTracker::ConvexImplicitPair::initializeContact
 
 
 
+//==============================================================================
+//              CONVEX SUPPORT FUNCTION PAIR CONTACT TRACKER
+//==============================================================================
+// We work in shape A's frame with the Minkowski difference D = A - B, whose
+// support function is h(n) = max_{v in D} v.n for unit direction n. The support
+// point of D in direction n is s(n) = P(n) - Q(-n), where P is A's support
+// point in direction n and Q is B's support point in direction -n; then
+// h(n) = s(n).n. For smooth, strictly convex shapes the signed penetration
+// depth is the minimum of h over the unit sphere; it is negative (a separation
+// distance) if the shapes aren't touching. At the minimizing direction s(n) is
+// parallel to n, n is A's outward normal at P, and -n is B's outward normal
+// at Q. So these are exactly the contact points and normal we need.
+//
+// We minimize h by Newton iteration on the sphere. The gradient of h on the
+// sphere is the tangential part of s(n), and its derivative with respect to a
+// tangential change in n is the radius of curvature tensor of D at s(n)
+// minus h(n) times the identity. D's radius of curvature tensor is just the
+// sum of A's at P and B's at Q, and those come from the principal curvatures
+// and directions at the support points, which we need anyway to generate the
+// contact. Convergence is quadratic; starting from the previous contact normal
+// a persistent contact typically converges in one or two iterations. Any
+// direction with h(n) <= 0 proves separation so we can quit immediately
+// without further work in that case.
+namespace {
+
+enum ConvexSupportResult {
+    ConvexSupportSeparated, // found a separating direction
+    ConvexSupportConverged, // found the contact points
+    ConvexSupportFailed     // gave up; use some other method
+};
+
+// On entry dirInA is the starting guess for the contact normal, expressed in
+// A. On return it is the final normal if we converged or the separating
+// direction if we found one. If we converged, the points, depth, and curvature
+// information are filled in for the final direction.
+ConvexSupportResult refineConvexSupportPair
+   (const ContactGeometry& shapeA, const ContactGeometry& shapeB,
+    const Transform& X_AB, Real tol, UnitVec3& dirInA,
+    Vec3& pointP_A, Vec3& pointQ_B, Real& depth,
+    Rotation& R_AP, Vec2& curvatureP, Rotation& R_BQ, Vec2& curvatureQ,
+    int& numIterations)
+{
+    const int  MaxIterations = 10;
+    const Real MaxStep       = Real(0.5); // radians, roughly
+
+    const Rotation& R_AB = X_AB.R();
+    Support s(shapeA, shapeB, X_AB, dirInA);
+
+    numIterations = 0;
+    while (true) {
+        if (isNaN(s.depth))
+            return ConvexSupportFailed;
+        if (s.depth <= 0) { // found a separating plane
+            dirInA = s.dir;
+            return ConvexSupportSeparated;
+        }
+
+        // Curvatures at the support points. We'll need these either for the
+        // Newton step or for the final contact geometry.
+        shapeA.calcCurvature(s.A, curvatureP, R_AP);
+        shapeB.calcCurvature(s.B, curvatureQ, R_BQ);
+
+        const UnitVec3 t1 = s.dir.perp();
+        const Vec3     t2 = s.dir % t1;
+        const Vec2 grad(~s.v*t1, ~s.v*t2); // tangential part of s(n)
+
+        if (grad.norm() <= tol) {
+            dirInA   = s.dir;
+            pointP_A = s.A;
+            pointQ_B = s.B;
+            depth    = s.depth;
+            return ConvexSupportConverged;
+        }
+
+        if (++numIterations > MaxIterations)
+            return ConvexSupportFailed;
+
+        // Radii of curvature; these shapes must be strictly convex.
+        if (   curvatureP[1] <= 0 || curvatureQ[1] <= 0
+            || isNaN(curvatureP[0]) || isNaN(curvatureQ[0]))
+            return ConvexSupportFailed;
+        const Vec2 rhoP(1/curvatureP[0], 1/curvatureP[1]);
+        const Vec2 rhoQ(1/curvatureQ[0], 1/curvatureQ[1]);
+
+        // Principal directions, all expressed in A.
+        const Vec3 xP = R_AP.x(), yP = R_AP.y();
+        const Vec3 xQ = R_AB*R_BQ.x(), yQ = R_AB*R_BQ.y();
+
+        // Project the summed radius tensor onto the tangent basis.
+        const Vec2 xP2(~xP*t1, ~xP*t2), yP2(~yP*t1, ~yP*t2);
+        const Vec2 xQ2(~xQ*t1, ~xQ*t2), yQ2(~yQ*t1, ~yQ*t2);
+        Mat22 H = rhoP[0]*xP2*~xP2 + rhoP[1]*yP2*~yP2
+                + rhoQ[0]*xQ2*~xQ2 + rhoQ[1]*yQ2*~yQ2;
+        H(0,0) -= s.depth; H(1,1) -= s.depth;
+
+        // This is a minimum only if H is positive definite. That fails if
+        // the penetration is deeper than the composite radius of curvature,
+        // which would be a very strange contact anyway.
+        const Real det = H(0,0)*H(1,1) - H(0,1)*H(1,0);
+        if (H(0,0) <= 0 || det <= 0)
+            return ConvexSupportFailed;
+
+        Vec2 step(-( H(1,1)*grad[0] - H(0,1)*grad[1])/det,
+                  -(-H(1,0)*grad[0] + H(0,0)*grad[1])/det);
+        const Real stepLen = step.norm();
+        if (stepLen > MaxStep)
+            step *= MaxStep/stepLen;
+
+        s.computeSupport(UnitVec3(s.dir + step[0]*t1 + step[1]*t2));
+    }
+}
+
+}
+
+
+// This will return an elliptical point contact.
+bool ContactTracker::ConvexSupportPair::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GA,
+    const ContactGeometry& shapeA,
+    const Transform&       X_GB,
+    const ContactGeometry& shapeB,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT_ALWAYS
+       (   shapeA.isConvex() && shapeA.isSmooth() 
+        && shapeB.isConvex() && shapeB.isSmooth(),
+       "ContactTracker::ConvexSupportPair::trackContact()");
+
+    // We'll work in the shape A frame.
+    const Transform X_AB = ~X_GA*X_GB; // 63 flops
+    const Rotation& R_AB = X_AB.R();
+
+    Vec3 cA, cB; Real rA, rB;
+    shapeA.getBoundingSphere(cA,rA); shapeB.getBoundingSphere(cB,rB);
+
+    // 1. Pick a starting direction. If these surfaces were already in contact
+    //    the previous contact normal (Cz, in A) is an excellent guess.
+    //    Otherwise use the line between the bounding sphere centers.
+    UnitVec3 norm_A;
+    if (EllipticalPointContact::isInstance(priorStatus))
+        norm_A = EllipticalPointContact::getAs(priorStatus)
+                                            .getContactFrame().z();
+    else {
+        const Vec3 c = X_AB*cB - cA;
+        norm_A = c == 0 ? UnitVec3(XAxis) : UnitVec3(c);
+    }
+
+    // 2. Find the contact points by minimizing the support function of the
+    //    Minkowski difference. The gradient tolerance is a length so scale it
+    //    by the problem size.
+    const Real tol = SignificantReal*(rA + rB + X_AB.p().norm());
+    Vec3 pointP_A, pointQ_B; Real depth;
+    Rotation R_AP, R_BQ; Vec2 curvatureP, curvatureQ;
+    int numIters;
+    const ConvexSupportResult result = refineConvexSupportPair
+       (shapeA, shapeB, X_AB, tol, norm_A, pointP_A, pointQ_B, depth,
+        R_AP, curvatureP, R_BQ, curvatureQ, numIters);
+
+    if (result == ConvexSupportSeparated) {
+        currentStatus.clear(); // definitely not touching
+        return true; // successful return
+    }
+
+    // This is rare; it can happen if the Newton iteration doesn't see a
+    // minimum from where it started (very deep penetration, for example).
+    // Fall back to MPR followed by the implicit function Newton iteration.
+    if (result == ConvexSupportFailed) {
+        const ConvexImplicitPair fallback(getContactGeometryTypeIds().first,
+                                          getContactGeometryTypeIds().second);
+        return fallback.trackContact(priorStatus, X_GA, shapeA, X_GB, shapeB,
+                                     cutoff, currentStatus);
+    }
+
+    // 3. The surfaces are in contact. Compute the effective contact frame C
+    //    and corresponding relative curvatures.
+    const Vec3 pointQ_A = X_AB*pointQ_B;  // Q on B, measured & expressed in A
+    const UnitVec3 maxDirB_A(R_AB*R_BQ.x()); // re-express in A
+    Transform X_AC; Vec2 curvatureC;
+
+    // Define the contact frame origin to be at the midpoint of P and Q.
+    X_AC.updP() = (pointP_A+pointQ_A)/2;
+
+    // Determine the contact frame orientations and composite curvatures.
+    ContactGeometry::combineParaboloids(R_AP, curvatureP,
+                                        maxDirB_A, curvatureQ,
+                                        X_AC.updR(), curvatureC);
+
+    // 4. Return the elliptical point contact for force generation.
+    currentStatus = EllipticalPointContact(priorStatus.getSurface1(),
+                                           priorStatus.getSurface2(),
+                                           X_AB, X_AC, curvatureC, depth);
+    return true; // success
+}
+
+
+bool ContactTracker::ConvexSupportPair::predictContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, const SpatialVec& V_GS1, const SpatialVec& A_GS1,
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, const SpatialVec& V_GS2, const SpatialVec& A_GS2,
+    const ContactGeometry& surface2,
+    Real                   cutoff,
+    Real                   intervalOfInterest,
+    Contact&               predictedStatus) const
+{   SimTK_ASSERT_ALWAYS(!"implemented",
+    "ContactTracker::ConvexSupportPair::predictContact() not implemented yet.");
+    return false; }
+
+bool ContactTracker::ConvexSupportPair::initializeContact
+   (const Transform& X_GS1, const SpatialVec& V_GS1,
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, const SpatialVec& V_GS2,
+    const ContactGeometry& surface2,
+    Real                   cutoff,
+    Real                   intervalOfInterest,
+    Contact&               contactStatus) const
+{   SimTK_ASSERT_ALWAYS(!"implemented",
+    "ContactTracker::ConvexSupportPair::initializeContact() not implemented yet.");
+    return false; }
+
+
+
 //==============================================================================
 //                GENERAL IMPLICIT SURFACE PAIR CONTACT TRACKER
 //==============================================================================
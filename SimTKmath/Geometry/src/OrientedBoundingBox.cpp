@@ -149,7 +149,13 @@ bool OrientedBoundingBox::intersectsBox(const OrientedBoundingBox& box) const {
     // From the other box's frame to this one's
     const Transform t = ~getTransform()*box.getTransform(); 
     const Mat33& r = t.R().asMat33();
-    const Mat33 rabs = r.abs();
+    // The small addition to each element of rabs prevents a false negative 
+    // from roundoff when an edge of one box is parallel to an edge of the 
+    // other, so that the axis formed from their cross product is nearly zero.
+    Mat33 rabs = r.abs();
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            rabs(i, j) += SignificantReal;
     const Vec3 a = getSize()/2;
     const Vec3 b = box.getSize()/2;
     const Vec3 center1 = a;
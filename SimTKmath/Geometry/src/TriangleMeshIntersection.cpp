@@ -0,0 +1,501 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+#include "ContactGeometryImpl.h"
+#include "TriangleMeshIntersection.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+namespace SimTK {
+
+//==============================================================================
+//                        FIND INTERSECTING MESH FACES
+//==============================================================================
+// This is done in three passes:
+//  1. The OBB trees are traversed to collect the pairs of leaves whose boxes 
+//     overlap. The top of the traversal is done breadth first on the calling
+//     thread until there are enough independent node pairs to share among
+//     the threads; each thread then finishes its share depth first.
+//  2. Every face in those leaves gets its triangle, in mesh1's frame, and an
+//     axis-aligned box around that. Each mesh2 face is thus transformed only
+//     once no matter how many leaves it is tested against.
+//  3. The triangles in each leaf pair are tested in fixed-size batches, each
+//     batch recording its own hits so batches can run on separate threads.
+//     The face boxes give an exact and cheap rejection before the full 
+//     triangle-triangle test; that matters because leaf boxes overlap much
+//     more often than the triangles in them do.
+// The results are the same as testing every pair of triangles.
+
+namespace {
+
+typedef ContactGeometry::TriangleMesh::Impl MeshImpl;
+
+// Don't start threads for a traversal whose first breadth-first pass finishes
+// with fewer node pairs than this per thread still pending.
+const int NodePairsPerThread     = 32;
+// Below this many overlapping leaf pairs the triangle tests are done on the
+// calling thread since starting worker threads would cost more than it saves.
+const int MinLeafPairsForThreads = 1024;
+const int LeafPairsPerBatch      = 128;
+
+// The faces of two overlapping leaves, as ranges of each mesh's obbFaces;
+// faces[0] belongs to mesh1 and faces[1] to mesh2.
+struct LeafPair {
+    LeafPair(const MeshImpl& mesh1, const OBBTreeNodeImpl& leaf1,
+             const MeshImpl& mesh2, const OBBTreeNodeImpl& leaf2) {
+        faces[0] = mesh1.getObbLeafFaces(leaf1); 
+        faces[1] = mesh2.getObbLeafFaces(leaf2);
+        numFaces[0] = leaf1.numTriangles;
+        numFaces[1] = leaf2.numTriangles;
+    }
+    const int*  faces[2];
+    int         numFaces[2];
+};
+
+// A pair of nodes whose boxes overlap, still to be examined, with node2's box
+// in mesh1's frame.
+struct NodePair {
+    NodePair(const OBBTreeNodeImpl* node1, const OBBTreeNodeImpl* node2, 
+             const OrientedBoundingBox& node2Bounds_M1)
+    :   node1(node1), node2(node2), node2Bounds_M1(node2Bounds_M1) {}
+    const OBBTreeNodeImpl*  node1;
+    const OBBTreeNodeImpl*  node2;
+    OrientedBoundingBox     node2Bounds_M1;
+};
+
+// Faces, in mesh1's frame, together with their axis-aligned bounding boxes.
+// The boxes are kept as one array per bound so that the box tests in a leaf
+// pair run over contiguous Reals.
+struct BoxedFaces {
+    void resize(int n) {
+        triangles.resize(n);
+        for (int k=0; k < 3; ++k) {lo[k].resize(n); hi[k].resize(n);}
+    }
+    void set(int f, const Vec3& a, const Vec3& b, const Vec3& c) {
+        triangles[f] = Geo::Triangle(a,b,c);
+        for (int k=0; k < 3; ++k) {
+            lo[k][f] = std::min(a[k], std::min(b[k], c[k]));
+            hi[k][f] = std::max(a[k], std::max(b[k], c[k]));
+        }
+    }
+    Array_<Geo::Triangle>   triangles;
+    Array_<Real>            lo[3], hi[3];
+};
+
+// Either record a node pair as a leaf pair or append the overlapping pairs 
+// formed from the children of its bigger node. Descending into only one node
+// at a time visits fewer pairs than descending into both, and testing the 
+// children before appending them keeps the many pairs that turn out not to 
+// overlap off the stack.
+void expandNodePair(const NodePair& pair, const MeshImpl& mesh1, 
+                    const MeshImpl& mesh2, const Transform& X_M1M2,
+                    Array_<NodePair>& pending, Array_<LeafPair>& leafPairs) 
+{
+    const OBBTreeNodeImpl& node1 = *pair.node1;
+    const OBBTreeNodeImpl& node2 = *pair.node2;
+    const bool leaf1 = node1.isLeaf();
+    const bool leaf2 = node2.isLeaf();
+    if (leaf1 && leaf2) {
+        leafPairs.push_back(LeafPair(mesh1, node1, mesh2, node2));
+        return;
+    }
+    if (leaf2 || (!leaf1 && node1.bounds.getSize().normSqr()
+                            >= pair.node2Bounds_M1.getSize().normSqr())) {
+        const OBBTreeNodeImpl* second1 = node1.getSecondChild();
+        const OBBTreeNodeImpl* first1  = node1.getFirstChild();
+        if (second1->bounds.intersectsBox(pair.node2Bounds_M1))
+            pending.push_back(NodePair(second1, pair.node2, 
+                                       pair.node2Bounds_M1));
+        if (first1->bounds.intersectsBox(pair.node2Bounds_M1))
+            pending.push_back(NodePair(first1, pair.node2, 
+                                       pair.node2Bounds_M1));
+    } else {
+        const OBBTreeNodeImpl* second2 = node2.getSecondChild();
+        const OBBTreeNodeImpl* first2  = node2.getFirstChild();
+        const OrientedBoundingBox second2Bounds_M1 = X_M1M2*second2->bounds;
+        const OrientedBoundingBox first2Bounds_M1  = X_M1M2*first2->bounds;
+        if (node1.bounds.intersectsBox(second2Bounds_M1))
+            pending.push_back(NodePair(pair.node1, second2, 
+                                       second2Bounds_M1));
+        if (node1.bounds.intersectsBox(first2Bounds_M1))
+            pending.push_back(NodePair(pair.node1, first2, first2Bounds_M1));
+    }
+}
+
+// Traverse everything below a set of node pairs, each one independently.
+class CollectLeafPairsTask : public ParallelExecutor::Task {
+public:
+    CollectLeafPairsTask(const Array_<NodePair>& startPairs, 
+                         const MeshImpl& mesh1, const MeshImpl& mesh2,
+                         const Transform& X_M1M2)
+    :   startPairs(startPairs), mesh1(mesh1), mesh2(mesh2), X_M1M2(X_M1M2), 
+        leafPairs(startPairs.size()), errors(startPairs.size()) {}
+
+    void execute(int i) OVERRIDE_11 {
+        try {
+            Array_<NodePair> stack(1, startPairs[i]);
+            while (!stack.empty()) {
+                const NodePair pair = stack.back();
+                stack.pop_back();
+                expandNodePair(pair, mesh1, mesh2, X_M1M2, 
+                               stack, leafPairs[i]);
+            }
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        } catch (...) {
+            errors[i] = "unknown exception";
+        }
+    }
+
+    // Append the leaf pairs found below every start pair, in order.
+    void collectLeafPairs(Array_<LeafPair>& allLeafPairs) const {
+        for (unsigned i=0; i < leafPairs.size(); ++i) {
+            if (!errors[i].empty())
+                SimTK_THROW1(Exception::Cant, errors[i]);
+            allLeafPairs.insert(allLeafPairs.end(), 
+                                leafPairs[i].begin(), leafPairs[i].end());
+        }
+    }
+
+private:
+    const Array_<NodePair>&     startPairs;
+    const MeshImpl&             mesh1;
+    const MeshImpl&             mesh2;
+    const Transform&            X_M1M2;
+    Array_<Array_<LeafPair> >   leafPairs;
+    Array_<std::string>         errors;
+};
+
+// Fill in boxedFaces for every face of "mesh" that appears in the given leaves
+// (faces[which] of leafPairs).
+void boxLeafFaces(const ContactGeometry::TriangleMesh& mesh, 
+                  const Transform& X_M1M, const Array_<LeafPair>& leafPairs,
+                  int which, BoxedFaces& boxedFaces)
+{
+    Array_<bool> isBoxed(mesh.getNumFaces(), false);
+    boxedFaces.resize(mesh.getNumFaces());
+    for (unsigned i=0; i < leafPairs.size(); ++i) {
+        const int* leafFaces = leafPairs[i].faces[which];
+        for (int j=0; j < leafPairs[i].numFaces[which]; ++j) {
+            const int f = leafFaces[j];
+            if (isBoxed[f])
+                continue;
+            isBoxed[f] = true;
+            boxedFaces.set(f,
+                X_M1M*mesh.getVertexPosition(mesh.getFaceVertex(f, 0)),
+                X_M1M*mesh.getVertexPosition(mesh.getFaceVertex(f, 1)),
+                X_M1M*mesh.getVertexPosition(mesh.getFaceVertex(f, 2)));
+        }
+    }
+}
+
+// For each leaf pair, the boxes of the mesh1 faces are first gathered into
+// contiguous arrays. Each mesh2 face is then tested against all of them at
+// once with a loop that has no branches (the comparisons are combined with
+// bitwise &), so the compiler is free to vectorize it, and only the faces 
+// that pass get the full triangle-triangle test.
+class TestLeafPairsTask : public ParallelExecutor::Task {
+public:
+    TestLeafPairsTask(const Array_<LeafPair>&  leafPairs,
+                      const BoxedFaces&        boxedFaces1,
+                      const BoxedFaces&        boxedFaces2)
+    :   leafPairs(leafPairs), boxedFaces1(boxedFaces1), 
+        boxedFaces2(boxedFaces2), 
+        numBatches((leafPairs.size()+LeafPairsPerBatch-1)/LeafPairsPerBatch),
+        hits1(numBatches), hits2(numBatches), errors(numBatches) {}
+
+    int getNumBatches() const {return numBatches;}
+
+    void execute(int batch) OVERRIDE_11 {
+        try {
+            Array_<Real> lo1[3], hi1[3];
+            Array_<unsigned char> overlaps;
+            const int end = std::min((int)leafPairs.size(), 
+                                     (batch+1)*LeafPairsPerBatch);
+            for (int i=batch*LeafPairsPerBatch; i < end; ++i) {
+                const int* faces1 = leafPairs[i].faces[0];
+                const int* faces2 = leafPairs[i].faces[1];
+                const int n1 = leafPairs[i].numFaces[0];
+                const int n2 = leafPairs[i].numFaces[1];
+                for (int k=0; k < 3; ++k) {
+                    lo1[k].resize(n1); hi1[k].resize(n1);
+                    for (int m=0; m < n1; ++m) {
+                        lo1[k][m] = boxedFaces1.lo[k][faces1[m]];
+                        hi1[k][m] = boxedFaces1.hi[k][faces1[m]];
+                    }
+                }
+                overlaps.resize(n1);
+                const Real *lo1x = lo1[0].begin(), *hi1x = hi1[0].begin();
+                const Real *lo1y = lo1[1].begin(), *hi1y = hi1[1].begin();
+                const Real *lo1z = lo1[2].begin(), *hi1z = hi1[2].begin();
+                unsigned char* overlap = overlaps.begin();
+
+                for (int j=0; j < n2; ++j) {
+                    const int f2 = faces2[j];
+                    const Real lo2x = boxedFaces2.lo[0][f2], 
+                               hi2x = boxedFaces2.hi[0][f2];
+                    const Real lo2y = boxedFaces2.lo[1][f2], 
+                               hi2y = boxedFaces2.hi[1][f2];
+                    const Real lo2z = boxedFaces2.lo[2][f2], 
+                               hi2z = boxedFaces2.hi[2][f2];
+                    for (int m=0; m < n1; ++m)
+                        overlap[m] = (unsigned char)
+                           (  (lo1x[m] <= hi2x) & (lo2x <= hi1x[m])
+                            & (lo1y[m] <= hi2y) & (lo2y <= hi1y[m])
+                            & (lo1z[m] <= hi2z) & (lo2z <= hi1z[m]));
+
+                    const Geo::Triangle& A = boxedFaces2.triangles[f2];
+                    for (int m=0; m < n1; ++m) {
+                        if (!overlap[m])
+                            continue;
+                        const int f1 = faces1[m];
+                        if (A.overlapsTriangle(boxedFaces1.triangles[f1])) {
+                            hits1[batch].push_back(f1);
+                            hits2[batch].push_back(f2);
+                        }
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            errors[batch] = e.what();
+        } catch (...) {
+            errors[batch] = "unknown exception";
+        }
+    }
+
+    // Merge the results of all the batches into the given sets.
+    void collectHits(std::set<int>& faces1, std::set<int>& faces2) const {
+        for (int b=0; b < numBatches; ++b) {
+            if (!errors[b].empty())
+                SimTK_THROW1(Exception::Cant, errors[b]);
+            faces1.insert(hits1[b].begin(), hits1[b].end());
+            faces2.insert(hits2[b].begin(), hits2[b].end());
+        }
+    }
+
+private:
+    const Array_<LeafPair>&     leafPairs;
+    const BoxedFaces&           boxedFaces1;
+    const BoxedFaces&           boxedFaces2;
+    const int                   numBatches;
+    Array_<Array_<int> >        hits1, hits2;
+    Array_<std::string>         errors;
+};
+
+}
+
+void findIntersectingMeshFaces(const ContactGeometry::TriangleMesh& mesh1,
+                               const ContactGeometry::TriangleMesh& mesh2,
+                               const Transform&                     X_M1M2,
+                               std::set<int>&                       faces1,
+                               std::set<int>&                       faces2,
+                               ParallelExecutor*                    executor,
+                               int                                  numThreads)
+{
+    if (!executor || ParallelExecutor::isWorkerThread())
+        numThreads = 1;
+
+    // Expand the traversal breadth first until there is enough to share out.
+    // The leaf pairs found along the way are kept.
+    const MeshImpl& impl1 = mesh1.getImpl();
+    const MeshImpl& impl2 = mesh2.getImpl();
+    Array_<LeafPair> leafPairs;
+    Array_<NodePair> pending;
+    const OrientedBoundingBox root2Bounds_M1 = X_M1M2*impl2.getObbRoot().bounds;
+    if (impl1.getObbRoot().bounds.intersectsBox(root2Bounds_M1))
+        pending.push_back(NodePair(&impl1.getObbRoot(), &impl2.getObbRoot(),
+                                   root2Bounds_M1));
+    int next = 0; // pending[next] is the first not yet expanded
+    while (next < (int)pending.size() 
+           && (int)pending.size()-next < NodePairsPerThread*numThreads)
+        expandNodePair(NodePair(pending[next++]), impl1, impl2, X_M1M2, 
+                       pending, leafPairs);
+    const Array_<NodePair> startPairs(pending.begin()+next, pending.end());
+    pending.clear();
+
+    if (!startPairs.empty()) {
+        CollectLeafPairsTask task(startPairs, impl1, impl2, X_M1M2);
+        if (numThreads > 1 
+            && (int)startPairs.size() >= NodePairsPerThread*numThreads) {
+            executor->execute(task, startPairs.size());
+        } else {
+            for (int i=0; i < (int)startPairs.size(); ++i)
+                task.execute(i);
+        }
+        task.collectLeafPairs(leafPairs);
+    }
+
+    if (!leafPairs.empty()) {
+        BoxedFaces boxedFaces1, boxedFaces2;
+        boxLeafFaces(mesh1, Transform(), leafPairs, 0, boxedFaces1);
+        boxLeafFaces(mesh2, X_M1M2, leafPairs, 1, boxedFaces2);
+
+        TestLeafPairsTask task(leafPairs, boxedFaces1, boxedFaces2);
+        if (numThreads > 1 && task.getNumBatches() > 1
+            && (int)leafPairs.size() >= MinLeafPairsForThreads) {
+            executor->execute(task, task.getNumBatches());
+        } else {
+            for (int b=0; b < task.getNumBatches(); ++b)
+                task.execute(b);
+        }
+        task.collectHits(faces1, faces2);
+    }
+}
+
+
+
+//==============================================================================
+//                          FIND BURIED MESH FACES
+//==============================================================================
+// Each mesh's faces are classified by flood filling from the faces that were
+// found to intersect the other mesh. A connected region that isn't reached
+// that way needs a ray cast, from one of its faces, to decide whether it is 
+// inside or outside. The fill uses an explicit stack so there is no limit on
+// the size of a region. The two meshes are independent so are done on 
+// separate threads when they are big enough to make that worthwhile.
+
+namespace {
+
+const int Outside  = -1;
+const int Unknown  =  0;
+const int Boundary =  1;
+const int Inside   =  2;
+
+// Combined face count of the two meshes below which both are done serially.
+const int MinFacesForThreads = 8192;
+
+void findBuriedFaces(const ContactGeometry::TriangleMesh& mesh,      // M
+                     const ContactGeometry::TriangleMesh& otherMesh, // O
+                     const Transform&                     X_OM,
+                     std::set<int>&                       insideFaces)
+{
+    // We're passed in the list of Boundary faces, that is, those faces of
+    // "mesh" that intersect faces of "otherMesh".
+    Array_<int> faceType(mesh.getNumFaces(), Unknown);
+    for (std::set<int>::const_iterator p = insideFaces.begin(); 
+         p != insideFaces.end(); ++p)
+        faceType[*p] = Boundary;
+
+    Array_<int> stack;
+    for (int i = 0; i < (int) faceType.size(); i++) {
+        if (faceType[i] != Unknown)
+            continue;
+
+        // Trace a ray from its center to determine whether it is inside.
+        const Vec3     origin_O    = X_OM    * mesh.findCentroid(i);
+        const UnitVec3 direction_O = X_OM.R()* mesh.getFaceNormal(i);
+        Real distance;
+        int face;
+        Vec2 uv;
+        const int type = 
+               otherMesh.intersectsRay(origin_O, direction_O, distance, 
+                                       face, uv) 
+            && ~direction_O*otherMesh.getFaceNormal(face) > 0
+            ? Inside : Outside;
+
+        // Give the same type to every face that can be reached from this one
+        // without crossing a boundary face.
+        faceType[i] = type;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            for (int j = 0; j < 3; j++) {
+                const int edge = mesh.getFaceEdge(index, j);
+                const int next = (mesh.getEdgeFace(edge, 0) == index 
+                                    ? mesh.getEdgeFace(edge, 1) 
+                                    : mesh.getEdgeFace(edge, 0));
+                if (faceType[next] == Unknown) {
+                    faceType[next] = type;
+                    stack.push_back(next);
+                }
+            }
+        }
+    }
+
+    // Insertion in increasing order with an end() hint is cheap.
+    for (int i = 0; i < (int) faceType.size(); i++)
+        if (faceType[i] == Inside)
+            insideFaces.insert(insideFaces.end(), i);
+}
+
+class FindBuriedFacesTask : public ParallelExecutor::Task {
+public:
+    FindBuriedFacesTask(const ContactGeometry::TriangleMesh& mesh1,
+                        const ContactGeometry::TriangleMesh& mesh2,
+                        const Transform&                     X_M1M2,
+                        std::set<int>&                       faces1,
+                        std::set<int>&                       faces2)
+    :   mesh1(mesh1), mesh2(mesh2), X_M1M2(X_M1M2), 
+        faces1(faces1), faces2(faces2), errors(2) {}
+
+    void execute(int which) OVERRIDE_11 {
+        try {
+            if (which == 0) findBuriedFaces(mesh1, mesh2, ~X_M1M2, faces1);
+            else            findBuriedFaces(mesh2, mesh1,  X_M1M2, faces2);
+        } catch (const std::exception& e) {
+            errors[which] = e.what();
+        } catch (...) {
+            errors[which] = "unknown exception";
+        }
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned i=0; i < errors.size(); ++i)
+            if (!errors[i].empty())
+                SimTK_THROW1(Exception::Cant, errors[i]);
+    }
+
+private:
+    const ContactGeometry::TriangleMesh&    mesh1;
+    const ContactGeometry::TriangleMesh&    mesh2;
+    const Transform&                        X_M1M2;
+    std::set<int>&                          faces1;
+    std::set<int>&                          faces2;
+    Array_<std::string>                     errors;
+};
+
+}
+
+void findBuriedMeshFaces(const ContactGeometry::TriangleMesh& mesh1,
+                         const ContactGeometry::TriangleMesh& mesh2,
+                         const Transform&                     X_M1M2,
+                         std::set<int>&                       faces1,
+                         std::set<int>&                       faces2,
+                         ParallelExecutor*                    executor)
+{
+    FindBuriedFacesTask task(mesh1, mesh2, X_M1M2, faces1, faces2);
+    if (   !executor || ParallelExecutor::isWorkerThread()
+        || mesh1.getNumFaces() + mesh2.getNumFaces() < MinFacesForThreads) {
+        task.execute(0);
+        task.execute(1);
+    } else {
+        executor->execute(task, 2);
+    }
+    task.rethrowFirstError();
+}
+
+} // namespace SimTK
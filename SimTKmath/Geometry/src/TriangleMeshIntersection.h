@@ -0,0 +1,92 @@
+#ifndef SimTK_SIMMATH_TRIANGLE_MESH_INTERSECTION_H_
+#define SimTK_SIMMATH_TRIANGLE_MESH_INTERSECTION_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Narrow phase for contact between two TriangleMesh surfaces, shared by
+ContactTracker::TriangleMeshTriangleMesh and 
+CollisionDetectionAlgorithm::TriangleMeshTriangleMesh. */
+
+#include "simmath/internal/common.h"
+#include "simmath/internal/ContactGeometry.h"
+
+#include <set>
+#include <pthread.h>
+
+namespace SimTK {
+
+/* Find the faces of mesh1 and mesh2 that intersect a face of the other mesh,
+where X_M1M2 gives mesh2's frame in mesh1's frame. The faces found are 
+added to faces1 and faces2. Overlapping pairs of OBB tree leaves are 
+collected first and the triangle pairs they contain are then tested in 
+batches. If an executor with numThreads threads is supplied, the traversal 
+and the batches are spread across its threads when there are enough of them;
+otherwise, or when called from a worker thread, everything is done on the 
+calling thread. The executor belongs to the caller, who should keep it 
+rather than create one for each call, and who must see that no other thread
+uses it until this returns. */
+void findIntersectingMeshFaces(const ContactGeometry::TriangleMesh& mesh1,
+                               const ContactGeometry::TriangleMesh& mesh2,
+                               const Transform&                     X_M1M2,
+                               std::set<int>&                       faces1,
+                               std::set<int>&                       faces2,
+                               ParallelExecutor*                    executor,
+                               int                                  numThreads);
+
+/* Given in faces1 and faces2 the faces found by findIntersectingMeshFaces(),
+add all the faces of each mesh that are buried inside the other mesh. The
+two meshes are done concurrently on the executor, if one is supplied and the 
+meshes are big enough; as above, no other thread may use the executor 
+meanwhile. */
+void findBuriedMeshFaces(const ContactGeometry::TriangleMesh& mesh1,
+                         const ContactGeometry::TriangleMesh& mesh2,
+                         const Transform&                     X_M1M2,
+                         std::set<int>&                       faces1,
+                         std::set<int>&                       faces2,
+                         ParallelExecutor*                    executor);
+
+/* A ParallelExecutor isn't reentrant, so an object that owns one and may be 
+used from several threads at once also owns a mutex to guard it. This takes 
+the mutex with trylock for the lifetime of this object and gives back the
+executor if that succeeded, or null (meaning work serially) if the executor is
+null or another thread is using it. */
+class TryLockedExecutor {
+public:
+    TryLockedExecutor(ParallelExecutor* executor, pthread_mutex_t& lock)
+    :   lock(lock), 
+        executor(executor && pthread_mutex_trylock(&lock) == 0 ? executor : 0)
+    {}
+    ~TryLockedExecutor() {if (executor) pthread_mutex_unlock(&lock);}
+    ParallelExecutor* getExecutor() const {return executor;}
+private:
+    TryLockedExecutor(const TryLockedExecutor&);
+    TryLockedExecutor& operator=(const TryLockedExecutor&);
+
+    pthread_mutex_t&    lock;
+    ParallelExecutor*   executor;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_TRIANGLE_MESH_INTERSECTION_H_
@@ -73,6 +73,24 @@ public:
      * again with a larger value will fail.
      */
     void setOrderLimit(int order);
+    /**
+     * Solve the linear systems arising in the Newton iteration with a matrix-free Krylov iterative method rather than
+     * the default dense direct solver.  The dense solver forms an ny X ny Jacobian by difference quotients, costing ny
+     * realizations, and factors it in O(ny^3) time; a Krylov method instead costs one realization per linear iteration
+     * and needs no Jacobian, so it is much cheaper for large systems.  The Newton matrix I - gamma*J is preconditioned
+     * with its kinematic block, which captures the coupling qdot = N*u exactly and is applied using the System's fast
+     * multiplyByN() operator.  maxKrylovDimension limits the size of the Krylov subspace; 0 means use the CPODES default.
+     * This is used only with Newton iteration.
+     *
+     * This method must be invoked before the integrator is initialized.  Invoking it after initialization
+     * will produce an exception.
+     */
+    void setUseKrylovLinearSolver(CPodes::KrylovMethod method=CPodes::GMRES, int maxKrylovDimension=0);
+    /**
+     * Get the total number of Krylov linear solver iterations performed since the last call to resetAllStatistics().
+     * This is always zero unless setUseKrylovLinearSolver() was used.
+     */
+    int getNumLinearSolverIterations() const;
 };
 
 } // namespace SimTK
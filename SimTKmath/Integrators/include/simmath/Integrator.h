@@ -320,6 +320,16 @@ public:
     /// when projecting the state (either a Q- or U-projection) since
     /// the last call to resetAllStatistics().
     int getNumProjectionFailures() const;
+    /// Get the number of times a constraint Jacobian was factored while
+    /// projecting Q's or U's since the last call to resetAllStatistics().
+    /// Without factorization reuse this is one per projection iteration.
+    int getNumProjectionFactorizations() const;
+    /// Get the number of projection iterations that reused an existing
+    /// factorization of the constraint Jacobian instead of refactoring,
+    /// since the last call to resetAllStatistics(). This is zero unless 
+    /// the System permits reuse; see 
+    /// SimbodyMatterSubsystem::setProjectionFactorizationReuseLimit().
+    int getNumProjectionFactorizationReuses() const;
     /// For iterative methods, get the number of internal step iterations in steps that led to 
     /// convergence (not necessarily successful steps). Reset to zero by resetAllStatistics().
     int getNumConvergentIterations() const;
@@ -0,0 +1,109 @@
+#ifndef SimTK_SIMMATH_MULTIRATE_INTEGRATOR_H_
+#define SimTK_SIMMATH_MULTIRATE_INTEGRATOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+
+namespace SimTK {
+class MultirateIntegratorRep;
+
+/**
+ * This is an error controlled, explicit multirate integrator for systems in 
+ * which some auxiliary continuous state variables z (for example actuator,
+ * muscle activation, or contact state variables) evolve on a much faster time
+ * scale than the rest of the system. You designate those variables as "fast
+ * groups", each consisting of either all the z's of a Subsystem or a range of
+ * the System's z's, and give each group its own number of substeps. The
+ * remaining "slow" variables (all the q's and u's and any z's not in a fast
+ * group) are advanced with a step size that is limited only by their own
+ * accuracy requirements.
+ *
+ * Each step from t0 to t1=t0+h is a symmetric (Strang) splitting in which 
+ * time counts as a slow variable: the fast groups are advanced for h/2 with 
+ * time and the slow variables held at their t0 values, then the slow 
+ * variables are advanced from t0 to t1 with the fast groups held at the values
+ * they reached, then the fast groups are advanced for another h/2, in the 
+ * reverse order, with time and the slow variables held at their t1 values. 
+ * The slow and fast parts each use the 3rd order Runge-Kutta method of 
+ * RungeKutta3Integrator. The splitting itself is 2nd order accurate when the
+ * fast groups don't depend directly on time; see below.
+ *
+ * <b>Accuracy:</b> the step size is controlled by the embedded error 
+ * estimates of the slow and fast Runge-Kutta parts only. The error made by 
+ * the splitting, that is, by holding the slow variables and time fixed while
+ * the fast groups move and vice versa, is <em>not</em> estimated, so the 
+ * accuracy set with setAccuracy() does not bound the error of the coupled
+ * solution. That error grows with the strength of the coupling between the
+ * fast and slow variables and with the step size; if it matters, check a 
+ * result against one obtained with a smaller maximum step size (see
+ * setMaximumStepSize()) or with a single rate integrator. In particular, a
+ * fast group whose derivatives depend directly on time, for example an
+ * activation driven by an excitation e(t), sees time only at the ends of each
+ * step and lags by about h/2. If that is a problem, supply such inputs the
+ * way a controller would, in a discrete variable that a periodic event
+ * handler updates; the fast group is then exact between events.
+ *
+ * Because only the z's of a fast group change during its substeps, the 
+ * System's kinematics are calculated once for all of them, and accelerations
+ * need not be recalculated unless the group's derivatives depend on them. If
+ * a group's derivatives are available after realizing Dynamics stage you 
+ * should say so, in which case its substeps realize only Dynamics stage.
+ *
+ * Fast groups are resolved against the State when the integrator is 
+ * initialized, so they must be specified before calling initialize() and 
+ * must not overlap.
+ */
+class SimTK_SIMMATH_EXPORT MultirateIntegrator : public Integrator {
+public:
+    explicit MultirateIntegrator(const System& sys);
+
+    /** Make all the z's of the given Subsystem a fast group, advanced with
+    \a numSubsteps substeps in each half of every step. \a zDotStage is the
+    lowest stage through which the System must be realized to calculate 
+    these z's derivatives. **/
+    void addFastSubsystem(SubsystemIndex subsys, int numSubsteps,
+                          Stage zDotStage=Stage::Acceleration);
+    /** Make the \a nz z's starting at System z index \a zStart a fast group,
+    advanced with \a numSubsteps substeps in each half of every step. 
+    \a zDotStage is the lowest stage through which the System must be realized
+    to calculate these z's derivatives. **/
+    void addFastZRange(SystemZIndex zStart, int nz, int numSubsteps,
+                       Stage zDotStage=Stage::Acceleration);
+    /** Remove all fast groups so that the integrator behaves as an ordinary
+    single rate integrator. **/
+    void clearFastGroups();
+    /** Get the number of fast groups that have been specified. **/
+    int getNumFastGroups() const;
+
+    /** Get the total number of fast group substeps taken (including those of
+    rejected steps) since the last call to resetAllStatistics(). **/
+    int getNumFastSubsteps() const;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_MULTIRATE_INTEGRATOR_H_
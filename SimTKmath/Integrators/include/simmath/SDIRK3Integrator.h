@@ -0,0 +1,78 @@
+#ifndef SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
+#define SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+
+namespace SimTK {
+class SDIRK3IntegratorRep;
+
+/**
+ * This is a 3rd order, L-stable, singly diagonally implicit Runge-Kutta 
+ * (SDIRK) integrator intended for stiff systems such as those with compliant
+ * contact. It is an error controlled, three stage, stiffly accurate method 
+ * (R. Alexander, "Diagonally implicit Runge-Kutta methods for stiff O.D.E.'s",
+ * SIAM J. Numer. Anal. 14(6):1006-1021, 1977) with an embedded 2nd order 
+ * error estimate. Because the method is L-stable, the step size is limited 
+ * by the requested accuracy rather than by the stiffness of the system.
+ *
+ * Each stage is solved with a modified Newton iteration. The iteration matrix
+ * I - h*gamma*J uses a finite difference approximation to the Jacobian 
+ * J=df/dy of the state derivatives, which is kept across steps as long
+ * as the iteration continues to converge well. The factored iteration matrix
+ * is kept too, and is refactored only when the step size shrinks or grows 
+ * by more than 20%. Constraints are handled by projection after each step as
+ * for the explicit integrators.
+ *
+ * <b>Cost:</b> with n=nq+nu+nz state variables, forming J costs n 
+ * realizations (those for the u's and z's start from Velocity or Dynamics
+ * stage), and each factorization of the iteration matrix costs O(n^3) 
+ * operations and n^2 storage. That is cheap compared with the many tiny 
+ * steps an explicit integrator would need on a stiff system of modest size,
+ * but it grows quickly; for systems with more than a few hundred state 
+ * variables, or when J must be formed at most steps (for example with 
+ * intermittent contact), consider CPodesIntegrator with its matrix-free 
+ * Krylov linear solver (CPodesIntegrator::setUseKrylovLinearSolver()). 
+ * This integrator sees only the System's state derivatives, so it can't use
+ * the multibody structure (M^-1, N) to form J more cheaply.
+ */
+class SimTK_SIMMATH_EXPORT SDIRK3Integrator : public Integrator {
+public:
+    explicit SDIRK3Integrator(const System& sys);
+
+    /** Get the number of times the Jacobian df/dy has been formed since the
+    last call to resetAllStatistics(). Each of these costs one realization
+    per state variable; see the class description. **/
+    int getNumJacobianEvaluations() const;
+    /** Get the number of times the Newton iteration matrix has been 
+    factored since the last call to resetAllStatistics(). **/
+    int getNumIterationMatrixFactorizations() const;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_SDIRK3_INTEGRATOR_H_
@@ -69,6 +69,20 @@ public:
     virtual void errorHandler(int error_code, const char* module,
                               const char* function, char* msg) const;
 
+    // These are used only with the Krylov linear solvers, and only if 
+    // requested with CPodes::spilsSetPreconditioner(). Setup is called 
+    // occasionally to (re)evaluate any data the preconditioner P needs; set
+    // jacobianWasUpdated true if that data was recomputed rather than reused.
+    // Solve is called on every iteration to solve P z = r approximately. Here
+    // gamma is the scalar in the Newton matrix I - gamma*J, and lr is 1 for
+    // the left and 2 for the right preconditioner.
+    virtual int  preconditionerSetup(Real t, const Vector& y, const Vector& fy,
+                                     bool jacobianIsOK, bool& jacobianWasUpdated,
+                                     Real gamma) const;
+    virtual int  preconditionerSolve(Real t, const Vector& y, const Vector& fy,
+                                     const Vector& r, Vector& z, 
+                                     Real gamma, Real delta, int lr) const;
+
     //TODO: Jacobian functions
 };
 
@@ -111,6 +125,17 @@ static void errorHandler_static(const CPodesSystem& sys,
                                 const char* function, char* msg)
   { sys.errorHandler(error_code,module,function,msg); }
 
+static int preconditionerSetup_static(const CPodesSystem& sys,
+                                      Real t, const Vector& y, const Vector& fy,
+                                      bool jok, bool& jcur, Real gamma)
+  { return sys.preconditionerSetup(t,y,fy,jok,jcur,gamma); }
+
+static int preconditionerSolve_static(const CPodesSystem& sys,
+                                      Real t, const Vector& y, const Vector& fy,
+                                      const Vector& r, Vector& z,
+                                      Real gamma, Real delta, int lr)
+  { return sys.preconditionerSolve(t,y,fy,r,z,gamma,delta,lr); }
+
 /**
  * This is a straightforward translation of the Sundials CPODES C 
  * interface into C++. The class CPodes represents a single instance
@@ -177,6 +202,23 @@ public:
         OneStepTstop
     };
 
+    // These select one of the matrix-free Krylov iterative linear solvers
+    // as an alternative to the dense direct solver.
+    enum KrylovMethod {
+        UnspecifiedKrylovMethod=0,
+        GMRES,      // scaled preconditioned GMRES (CPSpgmr)
+        BiCGStab,   // scaled preconditioned Bi-CGStab (CPSpbcg)
+        TFQMR       // scaled preconditioned TFQMR (CPSptfqmr)
+    };
+
+    enum PreconditioningType {
+        UnspecifiedPreconditioningType=0,
+        NoPreconditioning,
+        LeftPreconditioning,
+        RightPreconditioning,
+        BothPreconditioning
+    };
+
     explicit CPodes
        (ODEType                      ode=UnspecifiedODEType, 
         LinearMultistepMethod        lmm=UnspecifiedLinearMultistepMethod, 
@@ -342,6 +384,25 @@ public:
     int lapackBand(int N, int mupper, int mlower);
     int lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType);
 
+    // Select a Krylov linear solver. A maximum Krylov subspace dimension
+    // maxl <= 0 means use the default (5).
+    int spils(KrylovMethod, PreconditioningType, int maxl=0);
+
+    // This tells CPodes to make use of the user's preconditionerSetup() and
+    // preconditionerSolve() methods from CPodesSystem.
+    int spilsSetPreconditioner();
+
+    int spilsSetMaxl(int maxl);
+    int spilsSetDelt(Real delt);
+
+    int spilsGetNumPrecEvals(int* npevals);
+    int spilsGetNumPrecSolves(int* npsolves);
+    int spilsGetNumLinIters(int* nliters);
+    int spilsGetNumConvFails(int* nlcfails);
+    int spilsGetNumJtimesEvals(int* njvevals);
+    int spilsGetNumFctEvals(int* nfevalsLS);
+    int spilsGetLastFlag(int* flag);
+
 private:
     // This is how we get the client-side virtual functions to
     // be callable from library-side code while maintaining binary
@@ -366,6 +427,13 @@ private:
     typedef void (*ErrorHandlerFunc)(const CPodesSystem&, 
                                      int error_code, const char* module, 
                                      const char* function, char* msg);
+    typedef int (*PreconditionerSetupFunc)(const CPodesSystem&,
+                                   Real t, const Vector& y, const Vector& fy,
+                                   bool jok, bool& jcur, Real gamma);
+    typedef int (*PreconditionerSolveFunc)(const CPodesSystem&,
+                                   Real t, const Vector& y, const Vector& fy,
+                                   const Vector& r, Vector& z,
+                                   Real gamma, Real delta, int lr);
 
     // Note that these routines do not tell CPodes to use the supplied
     // functions. They merely provide the client-side addresses of functions
@@ -383,6 +451,8 @@ private:
     void registerRootFunc(RootFunc);
     void registerWeightFunc(WeightFunc);
     void registerErrorHandlerFunc(ErrorHandlerFunc);
+    void registerPreconditionerSetupFunc(PreconditionerSetupFunc);
+    void registerPreconditionerSolveFunc(PreconditionerSolveFunc);
 
 
     // This is the library-side part of the CPodes constructor. This must
@@ -401,6 +471,8 @@ private:
         registerRootFunc(root_static);
         registerWeightFunc(weight_static);
         registerErrorHandlerFunc(errorHandler_static);
+        registerPreconditionerSetupFunc(preconditionerSetup_static);
+        registerPreconditionerSolveFunc(preconditionerSolve_static);
     }
 
     // FOR INTERNAL USE ONLY
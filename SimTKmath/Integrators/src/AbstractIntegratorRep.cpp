@@ -90,6 +90,57 @@ void AbstractIntegratorRep::createInterpolatedState(Real t) {
 }
 
 
+//==============================================================================
+//                   REALIZE INTERPOLATED EVENT TRIGGERS
+//==============================================================================
+// Evaluate the witness functions of the given event candidates at the 
+// interpolated state, which has already been realized through Velocity stage
+// by createInterpolatedState(). We realize only as far as the highest stage 
+// at which any of the candidates is evaluated, so that localizing events 
+// whose triggers depend only on time, q, or u root-finds on the interpolant
+// without paying for an Acceleration-stage realization at each probe. 
+// Entries of the returned vector that don't belong to candidates are copied
+// from eFill; they are never examined during localization.
+const Vector& AbstractIntegratorRep::realizeInterpolatedEventTriggers
+   (const Array_<SystemEventTriggerIndex>& candidates, const Vector& eFill)
+{
+    const State& interp = getInterpolatedState();
+
+    // Triggers are stored in order of stage, so the highest stage we need is
+    // the one whose block of triggers contains the highest-numbered candidate.
+    int lastCandidate = -1;
+    for (unsigned i=0; i < candidates.size(); ++i)
+        lastCandidate = std::max(lastCandidate, (int)candidates[i]);
+    Stage needed = Stage::Time;
+    for (Stage g = Stage::LowestRuntime; g <= Stage::HighestRuntime; 
+         g = g.next())
+    {
+        if (interp.getNEventTriggersByStage(g) > 0
+            && interp.getEventTriggerStartByStage(g) <= lastCandidate)
+            needed = std::max(needed, g);
+    }
+
+    if (needed >= Stage::Acceleration) {
+        realizeStateDerivatives(interp);
+        if (needed > Stage::Acceleration)
+            getSystem().realize(interp, needed);
+        return interp.getEventTriggers();
+    }
+
+    getSystem().realize(interp, needed); // usually nothing to do
+    interpEventTriggers = eFill;
+    for (Stage g = Stage::LowestRuntime; g <= needed; g = g.next()) {
+        const int n = interp.getNEventTriggersByStage(g);
+        if (n == 0) continue;
+        const int start = interp.getEventTriggerStartByStage(g);
+        const Vector& eg = interp.getEventTriggersByStage(g);
+        for (int i=0; i < n; ++i)
+            interpEventTriggers[start+i] = eg[i];
+    }
+    return interpEventTriggers;
+}
+
+
 //==============================================================================
 //                  BACK UP ADVANCED STATE BY INTERPOLATION
 //==============================================================================
@@ -528,7 +579,10 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
               nz = advanced.getNZ(), 
               ny = nq+nu+nz;
     
-    Vector yErrEst(ny);
+    // These are resized only when the number of state variables changes.
+    yErrEst.resize(ny);
+    ytrial.resize(ny);
+
     bool stepSucceeded = false;
     do {
         // If we lose more than a small fraction of the step size we wanted
@@ -682,9 +736,8 @@ bool AbstractIntegratorRep::takeOneStep(Real tMax, Real tReport)
         // Failure to evaluate at the interpolated state is a disaster of some
         // kind, not something we expect to be able to recover from, so this 
         // will throw an exception if it fails.
-        realizeStateDerivatives(getInterpolatedState());
-
-        const Vector& eMid = getInterpolatedState().getEventTriggers();
+        const Vector& eMid = 
+            realizeInterpolatedEventTriggers(eventCandidates, eLow);
 
         // TODO: should search in the wider interval first
 
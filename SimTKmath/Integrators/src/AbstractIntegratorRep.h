@@ -158,8 +158,18 @@ protected:
     // Iterative methods should count iterations and then classify them as 
     // iterations that led to successful convergence and those that didn't.
     int statsConvergentIterations, statsDivergentIterations;
+
+    // Workspace for a trial value of y at an intermediate stage of a step. Use
+    // this rather than a temporary Vector so that taking a step doesn't
+    // allocate heap space. It has already been sized to ny when 
+    // attemptDAEStep() is called.
+    Vector ytrial;
 private:
     bool takeOneStep(Real tMax, Real tReport);
+    const Vector& realizeInterpolatedEventTriggers
+       (const Array_<SystemEventTriggerIndex>& candidates, const Vector& eFill);
+    Vector yErrEst; // workspace for takeOneStep()
+    Vector interpEventTriggers; // workspace for event localization
     bool initialized, hasErrorControl;
     Real currentStepSize, lastStepSize, actualInitialStepSizeTaken;
     int minOrder, maxOrder;
@@ -30,6 +30,9 @@
 #include "nvector_SimTK.h"
 #include "cpodes/cpodes.h"
 #include "cpodes/cpodes_dense.h"
+#include "cpodes/cpodes_spgmr.h"
+#include "cpodes/cpodes_spbcgs.h"
+#include "cpodes/cpodes_sptfqmr.h"
 #include "cpodes/cpodes_lapack_exports.h"
 
 #include <limits>
@@ -66,6 +69,8 @@ public:
     CPodes::RootFunc            rootFunc;
     CPodes::WeightFunc          weightFunc;
     CPodes::ErrorHandlerFunc    errorHandlerFunc;
+    CPodes::PreconditionerSetupFunc preconditionerSetupFunc;
+    CPodes::PreconditionerSolveFunc preconditionerSolveFunc;
 
     void zeroFunctionPointers() {
         explicitODEFunc  = 0;
@@ -76,6 +81,8 @@ public:
         rootFunc         = 0;
         weightFunc       = 0;
         errorHandlerFunc = 0;
+        preconditionerSetupFunc = 0;
+        preconditionerSolveFunc = 0;
     }
 
     void setMyHandle(CPodes& cp) {myHandle = &cp;}
@@ -183,6 +190,36 @@ static void errorHandlerWrapper(int error_code,
     return rep.errorHandlerFunc(rep.getCPodesSystem(), error_code,module,function,msg);
 }
 
+static int preconditionerSetupWrapper(realtype t, N_Vector nv_y, N_Vector nv_fy,
+                                      booleantype jok, booleantype *jcurPtr,
+                                      realtype gamma, void *P_data,
+                                      N_Vector, N_Vector, N_Vector)
+{
+    const Vector& y    = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy   = N_Vector_SimTK::getVector(nv_fy);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(P_data);
+    bool jcur = false;
+    const int flag = rep.preconditionerSetupFunc(rep.getCPodesSystem(), 
+                                                 t, y, fy, jok != FALSE, jcur,
+                                                 gamma);
+    *jcurPtr = (jcur ? TRUE : FALSE);
+    return flag;
+}
+
+static int preconditionerSolveWrapper(realtype t, N_Vector nv_y, N_Vector nv_fy,
+                                      N_Vector nv_r, N_Vector nv_z,
+                                      realtype gamma, realtype delta,
+                                      int lr, void *P_data, N_Vector)
+{
+    const Vector& y    = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy   = N_Vector_SimTK::getVector(nv_fy);
+    const Vector& r    = N_Vector_SimTK::getVector(nv_r);
+    Vector&       z    = N_Vector_SimTK::updVector(nv_z);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(P_data);
+    return rep.preconditionerSolveFunc(rep.getCPodesSystem(), 
+                                       t, y, fy, r, z, gamma, delta, lr);
+}
+
 ////////////////////////////////////////
 // CLASS SimTK::CPodes IMPLEMENTATION //
 ////////////////////////////////////////
@@ -248,6 +285,16 @@ static int mapProjectionFactorizationType(CPodes::ProjectionFactorizationType ft
     }
 }
 
+static int mapPreconditioningType(CPodes::PreconditioningType type) {
+    switch(type) {
+    case CPodes::NoPreconditioning:     return PREC_NONE;
+    case CPodes::LeftPreconditioning:   return PREC_LEFT;
+    case CPodes::RightPreconditioning:  return PREC_RIGHT;
+    case CPodes::BothPreconditioning:   return PREC_BOTH;
+    default: return std::numeric_limits<int>::min();
+    }
+}
+
 static int mapStepMode(CPodes::StepMode mode) {
     switch(mode) {
     case CPodes::Normal:       return CP_NORMAL;
@@ -681,6 +728,66 @@ int CPodes::lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType fact_typ
         mapProjectionFactorizationType(fact_type));
 }
 
+int CPodes::spils(KrylovMethod method, PreconditioningType pretype, int maxl) {
+    const int ptype = mapPreconditioningType(pretype);
+    switch(method) {
+    case BiCGStab:  return CPSpbcg(updRep().cpode_mem, ptype, maxl);
+    case TFQMR:     return CPSptfqmr(updRep().cpode_mem, ptype, maxl);
+    default:        return CPSpgmr(updRep().cpode_mem, ptype, maxl);
+    }
+}
+int CPodes::spilsSetPreconditioner() {
+    return CPSpilsSetPreconditioner(updRep().cpode_mem, 
+                                    (void*)preconditionerSetupWrapper,
+                                    (void*)preconditionerSolveWrapper,
+                                    (void*)rep);
+}
+int CPodes::spilsSetMaxl(int maxl) {
+    return CPSpilsSetMaxl(updRep().cpode_mem,maxl);
+}
+int CPodes::spilsSetDelt(Real delt) {
+    return CPSpilsSetDelt(updRep().cpode_mem,delt);
+}
+int CPodes::spilsGetNumPrecEvals(int* npevals) {
+    long lnpevals;
+    int stat = CPSpilsGetNumPrecEvals(updRep().cpode_mem,&lnpevals);
+    *npevals = (int)lnpevals;
+    return stat;
+}
+int CPodes::spilsGetNumPrecSolves(int* npsolves) {
+    long lnpsolves;
+    int stat = CPSpilsGetNumPrecSolves(updRep().cpode_mem,&lnpsolves);
+    *npsolves = (int)lnpsolves;
+    return stat;
+}
+int CPodes::spilsGetNumLinIters(int* nliters) {
+    long lnliters;
+    int stat = CPSpilsGetNumLinIters(updRep().cpode_mem,&lnliters);
+    *nliters = (int)lnliters;
+    return stat;
+}
+int CPodes::spilsGetNumConvFails(int* nlcfails) {
+    long lnlcfails;
+    int stat = CPSpilsGetNumConvFails(updRep().cpode_mem,&lnlcfails);
+    *nlcfails = (int)lnlcfails;
+    return stat;
+}
+int CPodes::spilsGetNumJtimesEvals(int* njvevals) {
+    long lnjvevals;
+    int stat = CPSpilsGetNumJtimesEvals(updRep().cpode_mem,&lnjvevals);
+    *njvevals = (int)lnjvevals;
+    return stat;
+}
+int CPodes::spilsGetNumFctEvals(int* nfevalsLS) {
+    long lnfevalsLS;
+    int stat = CPSpilsGetNumFctEvals(updRep().cpode_mem,&lnfevalsLS);
+    *nfevalsLS = (int)lnfevalsLS;
+    return stat;
+}
+int CPodes::spilsGetLastFlag(int* flag) {
+    return CPSpilsGetLastFlag(updRep().cpode_mem,flag);
+}
+
 
 
 // Client-side function registration
@@ -708,6 +815,12 @@ void CPodes::registerWeightFunc(CPodes::WeightFunc f) {
 void CPodes::registerErrorHandlerFunc(CPodes::ErrorHandlerFunc f) {
     updRep().errorHandlerFunc = f;
 }
+void CPodes::registerPreconditionerSetupFunc(CPodes::PreconditionerSetupFunc f) {
+    updRep().preconditionerSetupFunc = f;
+}
+void CPodes::registerPreconditionerSolveFunc(CPodes::PreconditionerSolveFunc f) {
+    updRep().preconditionerSolveFunc = f;
+}
 
 /////////////////////////////////
 // CPodesSystem IMPLEMENTATION //
@@ -757,6 +870,18 @@ void CPodesSystem::errorHandler(int, const char*, const char*, char*) const {
     SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "errorHandler"); 
 }
 
+int CPodesSystem::preconditionerSetup(Real, const Vector&, const Vector&, 
+                                      bool, bool&, Real) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "preconditionerSetup"); 
+    return std::numeric_limits<int>::min();
+}
+
+int CPodesSystem::preconditionerSolve(Real, const Vector&, const Vector&, 
+                                      const Vector&, Vector&, Real, Real, int) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "preconditionerSolve"); 
+    return std::numeric_limits<int>::min();
+}
+
 } // namespace SimTK
 
 
@@ -51,6 +51,18 @@ void CPodesIntegrator::setOrderLimit(int order) {
     cprep.setOrderLimit(order);
 }
 
+void CPodesIntegrator::setUseKrylovLinearSolver
+   (CPodes::KrylovMethod method, int maxKrylovDimension) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setUseKrylovLinearSolver(method, maxKrylovDimension);
+}
+
+int CPodesIntegrator::getNumLinearSolverIterations() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getNumLinearSolverIterations();
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -124,9 +136,52 @@ public:
         gout = integ.getAdvancedState().getEventTriggers();
         return CPodes::Success;
     }
+
+    // The preconditioner for the Krylov linear solvers is the kinematic part
+    // of the Newton matrix I - gamma*J, that is
+    //          [ I  -gamma*N  0 ]
+    //      P = [ 0     I      0 ]      since d qdot/du = N.
+    //          [ 0     0      I ]
+    // Its inverse is just as simple, so P z = r is solved exactly with one
+    // multiplication by N. N depends only on q so we evaluate it at the y
+    // given here during setup and reuse that until CPodes asks again.
+    int preconditionerSetup(Real t, const Vector& y, const Vector& fy,
+                            bool jacobianIsOK, bool& jacobianWasUpdated,
+                            Real gamma) const 
+    {
+        try { 
+            integ.setAdvancedStateAndRealizeKinematics(t,y);
+        }
+        catch(...) { return CPodes::RecoverableError; } // assume recoverable
+        precState = integ.getAdvancedState();
+        jacobianWasUpdated = true;
+        return CPodes::Success;
+    }
+
+    int preconditionerSolve(Real t, const Vector& y, const Vector& fy,
+                            const Vector& r, Vector& z, 
+                            Real gamma, Real delta, int lr) const
+    {
+        const int nq = precState.getNQ(), nu = precState.getNU();
+        z = r;
+        if (nq == 0 || nu == 0)
+            return CPodes::Success;
+        precU = r(nq, nu);
+        try {
+            system.multiplyByN(precState, precU, precQ);
+        }
+        catch(...) { return CPodes::RecoverableError; } // assume recoverable
+        for (int i=0; i < nq; ++i)
+            z[i] += gamma*precQ[i];
+        return CPodes::Success;
+    }
 private:
     CPodesIntegratorRep& integ;
     const System& system;
+
+    // Preconditioner state and workspace.
+    mutable State  precState;
+    mutable Vector precU, precQ;
 };
 
 void CPodesIntegratorRep::init
@@ -137,6 +192,9 @@ void CPodesIntegratorRep::init
     cps = new CPodesSystemImpl(*this, getSystem());
     initialized = false;
     useCpodesProjection = false;
+    krylovMethod = CPodes::UnspecifiedKrylovMethod;
+    krylovMaxl = 0;
+    statsLinearIterations = 0;
 }
 
 CPodesIntegratorRep::CPodesIntegratorRep
@@ -189,7 +247,12 @@ void CPodesIntegratorRep::methodInitialize(const State& state) {
         printf("init() returned %d\n", retval);
         SimTK_THROW1(Integrator::InitializationFailed, "init() failed");
     }
-    cpodes->lapackDense(ny);
+    if (krylovMethod == CPodes::UnspecifiedKrylovMethod)
+        cpodes->lapackDense(ny);
+    else {
+        cpodes->spils(krylovMethod, CPodes::LeftPreconditioning, krylovMaxl);
+        cpodes->spilsSetPreconditioner();
+    }
     cpodes->setNonlinConvCoef(Real(0.01)); // TODO (default is 0.1)
     if (useCpodesProjection) {
         const int nqerr = state.getNQErr(), nuerr = state.getNUErr();
@@ -383,11 +446,13 @@ stepTo(Real reportTime, Real scheduledEventTime) {
             Vector yout(getAdvancedState().getY().size());
             Vector ypout(getAdvancedState().getY().size()); // ignored
             int oldSteps=0, oldTestFailures=0, oldNonlinIterations=0, 
-                oldNonlinConvFailures=0;
+                oldNonlinConvFailures=0, oldLinIterations=0;
             cpodes->getNumSteps(&oldSteps);
             cpodes->getNumErrTestFails(&oldTestFailures);
             cpodes->getNumNonlinSolvIters(&oldNonlinIterations);
             cpodes->getNumNonlinSolvConvFails(&oldNonlinConvFailures);
+            if (krylovMethod != CPodes::UnspecifiedKrylovMethod)
+                cpodes->spilsGetNumLinIters(&oldLinIterations);
 
             //---------------------step------------------------
             res = cpodes->step(tMax, &tret, yout, ypout, mode);
@@ -408,11 +473,18 @@ stepTo(Real reportTime, Real scheduledEventTime) {
             }
 
             int newSteps=0, newTestFailures=0, newNonlinIterations=0, 
-                newNonlinConvFailures=0;
+                newNonlinConvFailures=0, newLinIterations=0;
             cpodes->getNumSteps(&newSteps);
             cpodes->getNumErrTestFails(&newTestFailures);
             cpodes->getNumNonlinSolvIters(&newNonlinIterations);
             cpodes->getNumNonlinSolvConvFails(&newNonlinConvFailures);
+            if (krylovMethod != CPodes::UnspecifiedKrylovMethod)
+                cpodes->spilsGetNumLinIters(&newLinIterations);
+            // The Krylov solver zeroes its counters when it is initialized
+            // inside the first step following a (re)initialization.
+            statsLinearIterations += (newLinIterations >= oldLinIterations
+                                      ? newLinIterations-oldLinIterations
+                                      : newLinIterations);
             statsStepsTaken += newSteps-oldSteps;
             statsErrorTestFailures += newTestFailures-oldTestFailures;
             // Project stats were already updated in project() above.
@@ -614,6 +686,7 @@ void CPodesIntegratorRep::resetMethodStatistics() {
     statsErrorTestFailures = 0;
     statsConvergenceTestFailures = 0;
     statsIterations = 0;
+    statsLinearIterations = 0;
 }
 
 const char* CPodesIntegratorRep::getMethodName() const {
@@ -643,4 +716,14 @@ void CPodesIntegratorRep::setOrderLimit(int order) {
     cpodes->setMaxOrd(order);
 }
 
+void CPodesIntegratorRep::setUseKrylovLinearSolver
+   (CPodes::KrylovMethod method, int maxl) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setUseKrylovLinearSolver",
+        "This method may not be invoked after the integrator has been initialized.");
+    krylovMethod = (method == CPodes::UnspecifiedKrylovMethod ? CPodes::GMRES 
+                                                              : method);
+    krylovMaxl = maxl;
+}
+
 
@@ -64,6 +64,8 @@ public:
     bool methodHasErrorControl() const;
     void setUseCPodesProjection();
     void setOrderLimit(int order);
+    void setUseKrylovLinearSolver(CPodes::KrylovMethod method, int maxl);
+    int getNumLinearSolverIterations() const {return statsLinearIterations;}
     class CPodesSystemImpl;
     friend class CPodesSystemImpl;
 private:
@@ -71,11 +73,13 @@ private:
     CPodesSystemImpl* cps;
     bool initialized, useCpodesProjection;
     int statsStepsTaken, statsErrorTestFailures, statsConvergenceTestFailures;
-    int statsIterations;
+    int statsIterations, statsLinearIterations;
     int pendingReturnCode;
     Real previousStartTime, previousTimeReturned;
     Vector savedY;
     CPodes::LinearMultistepMethod method;
+    CPodes::KrylovMethod krylovMethod; // unspecified means use dense solver
+    int krylovMaxl;
     void init(CPodes::LinearMultistepMethod method, CPodes::NonlinearSystemIterationType iterationType);
 };
 
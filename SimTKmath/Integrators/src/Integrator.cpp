@@ -223,6 +223,12 @@ int Integrator::getNumProjectionFailures() const {
     return getRep().getNumQProjectionFailures()
          + getRep().getNumUProjectionFailures();
 }
+int Integrator::getNumProjectionFactorizations() const {
+    return getRep().getNumProjectionFactorizations();
+}
+int Integrator::getNumProjectionFactorizationReuses() const {
+    return getRep().getNumProjectionFactorizationReuses();
+}
 int Integrator::getNumConvergentIterations() const {
     return getRep().getNumConvergentIterations();
 }
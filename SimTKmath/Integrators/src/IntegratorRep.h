@@ -450,26 +450,24 @@ public:
     }
 
     // Calculate the error norm using RMS or Inf norm, and report which y
-    // was dominant.
+    // was dominant. The q, u, and z parts are copied into workspace rather
+    // than viewed since creating a view allocates.
     Real calcErrorNorm(const State& s, const Vector& yErrEst, 
                        int& worstY) const {
         const int nq=s.getNQ(), nu=s.getNU(), nz=s.getNZ();
+        copySegment(yErrEst, 0,     nq, qErrWork);
+        copySegment(yErrEst, nq,    nu, uErrWork);
+        copySegment(yErrEst, nq+nu, nz, zErrWork);
         int worstQ, worstU, worstZ;
         Real qNorm, uNorm, zNorm, maxNorm;
         if (userUseInfinityNorm == 1) {
-            qNorm = calcWeightedInfNormQ(s, s.getUWeights(), yErrEst(0,nq),
-                                         worstQ);
-            uNorm = calcWeightedInfNorm(getPreviousUScale(), yErrEst(nq,nu),
-                                        worstU);
-            zNorm = calcWeightedInfNorm(getPreviousZScale(), yErrEst(nq+nu,nz),
-                                        worstZ);
+            qNorm = calcWeightedInfNormQ(s, s.getUWeights(), qErrWork, worstQ);
+            uNorm = calcWeightedInfNorm(getPreviousUScale(), uErrWork, worstU);
+            zNorm = calcWeightedInfNorm(getPreviousZScale(), zErrWork, worstZ);
         } else {
-            qNorm = calcWeightedRMSNormQ(s, s.getUWeights(), yErrEst(0,nq),
-                                         worstQ);
-            uNorm = calcWeightedRMSNorm(getPreviousUScale(), yErrEst(nq,nu),
-                                        worstU);
-            zNorm = calcWeightedRMSNorm(getPreviousZScale(), yErrEst(nq+nu,nz),
-                                        worstZ);
+            qNorm = calcWeightedRMSNormQ(s, s.getUWeights(), qErrWork, worstQ);
+            uNorm = calcWeightedRMSNorm(getPreviousUScale(), uErrWork, worstU);
+            zNorm = calcWeightedRMSNorm(getPreviousZScale(), zErrWork, worstZ);
         }
 
         // Find the largest of the three norms and report the corresponding
@@ -507,28 +505,37 @@ public:
         assert(Wu.size() == nu);
         dqw.resize(nq);
         if (nq==0) return;
-        Vector du(nu);
-        system.multiplyByNPInv(state, dq, du);
-        du.rowScaleInPlace(Wu);
-        system.multiplyByN(state, du, dqw);
+        duWork.resize(nu);
+        system.multiplyByNPInv(state, dq, duWork);
+        for (int i=0; i < nu; ++i) // rowScaleInPlace() would allocate a view
+            duWork[i] *= Wu[i];
+        system.multiplyByN(state, duWork, dqw);
     }
     // Calculate |Wq*dq|_RMS=|N*Wu*pinv(N)*dq|_RMS
     Real calcWeightedRMSNormQ(const State& state, const Vector& Wu,
                               const Vector& dq, int& worstQ) const
     {
-        const int nq = state.getNQ();
-        Vector dqw(nq);
-        scaleDQ(state, Wu, dq, dqw);
-        return dqw.normRMS(&worstQ);
+        scaleDQ(state, Wu, dq, dqwWork);
+        return dqwWork.normRMS(&worstQ);
     }
     // Calculate |Wq*dq|_Inf=|N*Wu*pinv(N)*dq|_Inf
     Real calcWeightedInfNormQ(const State& state, const Vector& Wu,
                               const Vector& dq, int& worstQ) const
     {
-        const int nq = state.getNQ();
-        Vector dqw(nq);
-        scaleDQ(state, Wu, dq, dqw);
-        return dqw.normInf(&worstQ);
+        scaleDQ(state, Wu, dq, dqwWork);
+        return dqwWork.normInf(&worstQ);
+    }
+
+    // Copy n elements of v starting at v[start] into seg, or copy them back.
+    // These don't allocate once seg has the right size.
+    static void copySegment(const Vector& v, int start, int n, Vector& seg) {
+        seg.resize(n);
+        for (int i=0; i < n; ++i)
+            seg[i] = v[start+i];
+    }
+    static void copySegmentBack(const Vector& seg, int start, Vector& v) {
+        for (int i=0; i < seg.size(); ++i)
+            v[start+i] = seg[i];
     }
 
     // TODO: these utilities don't really belong here
@@ -665,9 +672,7 @@ protected:
         tPrev        = s.getTime();
 
         yPrev        = s.getY();
-        qPrev.viewAssign(yPrev(0,     nq));
-        uPrev.viewAssign(yPrev(nq,    nu));
-        zPrev.viewAssign(yPrev(nq+nu, nz));
+        viewSegments(yPrev, nq, nu, nz, qPrev, uPrev, zPrev);
 
         calcRelativeScaling(s.getU(), s.getUWeights(), uScalePrev); 
         calcRelativeScaling(s.getZ(), s.getZWeights(), zScalePrev);
@@ -682,14 +687,26 @@ protected:
         const int nq = s.getNQ(), nu = s.getNU(), nz = s.getNZ();
 
         ydotPrev     = s.getYDot();
-        qdotPrev.viewAssign(ydotPrev(0,     nq));
-        udotPrev.viewAssign(ydotPrev(nq,    nu));
-        zdotPrev.viewAssign(ydotPrev(nq+nu, nz));
+        viewSegments(ydotPrev, nq, nu, nz, qdotPrev, udotPrev, zdotPrev);
 
         qdotdotPrev  = s.getQDotDot();
         triggersPrev = s.getEventTriggers();
     }
 
+    // Make q, u, and z views of the corresponding parts of y. Creating a view
+    // allocates, so we don't redo them unless y's data has been reallocated,
+    // which happens only when the number of state variables changes.
+    static void viewSegments(Vector& y, int nq, int nu, int nz,
+                             Vector& q, Vector& u, Vector& z) {
+        if (   q.size()==nq && u.size()==nu && z.size()==nz
+            && (nq==0 || &q[0]==&y[0]) && (nu==0 || &u[0]==&y[nq])
+            && (nz==0 || &z[0]==&y[nq+nu]))
+            return;
+        q.viewAssign(y(0,     nq));
+        u.viewAssign(y(nq,    nu));
+        z.viewAssign(y(nq+nu, nz));
+    }
+
     // State must already have been evaluated through Stage::Acceleration
     // or this will throw a stage violation.
     void saveStateAndDerivsAsPrevious(const State& s) {
@@ -787,11 +804,13 @@ protected:
         // Nothing happens here if position constraints were already satisfied
         // unless we set the ForceProjection option above.
         if (yErrEst.size()) {
-            VectorView qErrEst = yErrEst(0, s.getNQ());
-            getSystem().projectQ(s, qErrEst, options, results);
+            copySegment(yErrEst, 0, s.getNQ(), qErrWork);
+            getSystem().projectQ(s, qErrWork, options, results);
+            copySegmentBack(qErrWork, 0, yErrEst);
         } else {
             getSystem().projectQ(s, yErrEst, options, results);
         }
+        noteProjectionFactorizations(results);
         if (results.getExitStatus() != ProjectResults::Succeeded) {
             ++statsQProjectionFailures;
             return false;
@@ -830,11 +849,13 @@ protected:
         // Nothing happens here if velocity constraints were already satisfied
         // unless we set the ForceProjection option above.
         if (yErrEst.size()) {
-            VectorView uErrEst = yErrEst(s.getNQ(), s.getNU());
-            getSystem().projectU(s, uErrEst, options, results);
+            copySegment(yErrEst, s.getNQ(), s.getNU(), uErrWork);
+            getSystem().projectU(s, uErrWork, options, results);
+            copySegmentBack(uErrWork, s.getNQ(), yErrEst);
         } else {
             getSystem().projectU(s, yErrEst, options, results);
         }
+        noteProjectionFactorizations(results);
         if (results.getExitStatus() != ProjectResults::Succeeded) {
             ++statsUProjectionFailures;
             return false;
@@ -882,6 +903,7 @@ protected:
         ++statsQProjectionFailures; // assume failure, then fix if no throw
         system.projectQ(s, dummy, options, results);
         --statsQProjectionFailures; // false alarm -- it succeeded
+        noteProjectionFactorizations(results);
         if (results.getAnyChangeMade())
             ++statsQProjections;
 
@@ -892,6 +914,7 @@ protected:
         ++statsUProjectionFailures; // assume failure, then fix if no throw
         system.projectU(s, dummy, options, results);
         --statsUProjectionFailures; // false alarm -- it succeeded
+        noteProjectionFactorizations(results);
         if (results.getAnyChangeMade())
             ++statsUProjections;
     }
@@ -939,6 +962,7 @@ protected:
         statsQProjections = statsUProjections = 0;
         statsRealizationFailures = 0;
         statsQProjectionFailures = statsUProjectionFailures = 0;
+        statsProjectionFactorizations = statsProjectionFactorizationReuses = 0;
     }
 
     int getNumRealizations() const {return statsRealizations;} 
@@ -949,6 +973,20 @@ protected:
     int getNumQProjectionFailures() const {return statsQProjectionFailures;} 
     int getNumUProjectionFailures() const {return statsUProjectionFailures;} 
 
+    int getNumProjectionFactorizations() const 
+    {   return statsProjectionFactorizations; }
+    int getNumProjectionFactorizationReuses() const 
+    {   return statsProjectionFactorizationReuses; }
+
+    // Accumulate the factorization counts from a projectQ() or projectU()
+    // call, whether or not it succeeded.
+    void noteProjectionFactorizations(const ProjectResults& results) const {
+        if (!results.isValid()) return;
+        statsProjectionFactorizations += results.getNumFactorizations();
+        statsProjectionFactorizationReuses += 
+            results.getNumFactorizationReuses();
+    }
+
 private:
     class EventSorter {
     public:
@@ -1004,6 +1042,8 @@ protected:
     mutable int statsQProjections, statsUProjections;
     mutable int statsRealizations;
     mutable int statsRealizationFailures;
+    mutable int statsProjectionFactorizations;
+    mutable int statsProjectionFactorizationReuses;
 private:
 
         // SYSTEM INFORMATION
@@ -1109,6 +1149,11 @@ private:
     Vector qPrev, uPrev, zPrev;
     Vector qdotPrev, udotPrev, zdotPrev;
 
+    // Workspace for error norms and error estimate projection so that taking
+    // a step doesn't allocate once these have been sized for this System.
+    mutable Vector qErrWork, uErrWork, zErrWork;
+    mutable Vector dqwWork, duWork;
+
     // We'll leave the various arrays above sized as they are and full
     // of garbage. They'll be resized when first assigned to something
     // meaningful.
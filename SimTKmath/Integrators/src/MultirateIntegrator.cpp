@@ -0,0 +1,298 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the 
+ * MultirateIntegrator and MultirateIntegratorRep classes.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/Integrator.h"
+#include "simmath/MultirateIntegrator.h"
+
+#include "IntegratorRep.h"
+#include "MultirateIntegratorRep.h"
+
+#include <exception>
+#include <limits>
+
+using namespace SimTK;
+
+//------------------------------------------------------------------------------
+//                          MULTIRATE INTEGRATOR
+//------------------------------------------------------------------------------
+
+MultirateIntegrator::MultirateIntegrator(const System& sys) 
+{
+    rep = new MultirateIntegratorRep(this, sys);
+}
+
+void MultirateIntegrator::addFastSubsystem
+   (SubsystemIndex subsys, int numSubsteps, Stage zDotStage) {
+    SimTK_APIARGCHECK_ALWAYS(subsys.isValid(), "MultirateIntegrator",
+        "addFastSubsystem", "The Subsystem index must be valid.");
+    MultirateIntegratorRep& mrep = dynamic_cast<MultirateIntegratorRep&>(*rep);
+    mrep.addFastGroup(subsys, SystemZIndex(), 0, numSubsteps, zDotStage);
+}
+
+void MultirateIntegrator::addFastZRange
+   (SystemZIndex zStart, int nz, int numSubsteps, Stage zDotStage) {
+    SimTK_APIARGCHECK2_ALWAYS(zStart.isValid() && nz >= 0, 
+        "MultirateIntegrator", "addFastZRange", 
+        "Illegal z range start %d, size %d.", (int)zStart, nz);
+    MultirateIntegratorRep& mrep = dynamic_cast<MultirateIntegratorRep&>(*rep);
+    mrep.addFastGroup(SubsystemIndex(), zStart, nz, numSubsteps, zDotStage);
+}
+
+void MultirateIntegrator::clearFastGroups() {
+    MultirateIntegratorRep& mrep = dynamic_cast<MultirateIntegratorRep&>(*rep);
+    mrep.clearFastGroups();
+}
+
+int MultirateIntegrator::getNumFastGroups() const {
+    const MultirateIntegratorRep& mrep = 
+        dynamic_cast<const MultirateIntegratorRep&>(*rep);
+    return mrep.getNumFastGroups();
+}
+
+int MultirateIntegrator::getNumFastSubsteps() const {
+    const MultirateIntegratorRep& mrep = 
+        dynamic_cast<const MultirateIntegratorRep&>(*rep);
+    return mrep.getNumFastSubsteps();
+}
+
+//------------------------------------------------------------------------------
+//                        MULTIRATE INTEGRATOR REP
+//------------------------------------------------------------------------------
+
+MultirateIntegratorRep::MultirateIntegratorRep
+   (Integrator* handle, const System& sys) 
+:   AbstractIntegratorRep(handle, sys, 2, 3, "Multirate",  true),
+    statsFastSubsteps(0) {
+}
+
+void MultirateIntegratorRep::addFastGroup
+   (SubsystemIndex subsys, SystemZIndex zStart, int nz, int numSubsteps, 
+    Stage zDotStage) {
+    SimTK_APIARGCHECK1_ALWAYS(numSubsteps >= 1, "MultirateIntegrator",
+        "addFastGroup", "Illegal number of substeps %d.", numSubsteps);
+    SimTK_APIARGCHECK1_ALWAYS(Stage::Dynamics <= zDotStage 
+                              && zDotStage <= Stage::Acceleration,
+        "MultirateIntegrator", "addFastGroup", 
+        "Stage %s is not a legal stage at which to obtain z derivatives; it"
+        " must be Dynamics or Acceleration.", zDotStage.getName().c_str());
+    FastGroup group;
+    group.subsys      = subsys;
+    group.zStart      = zStart;
+    group.nz          = nz;
+    group.numSubsteps = numSubsteps;
+    group.zDotStage   = zDotStage;
+    fastGroups.push_back(group);
+}
+
+// Resolve the fast groups against the now-known layout of the State's z's
+// and make sure they make sense.
+void MultirateIntegratorRep::methodInitialize(const State& state) {
+    AbstractIntegratorRep::methodInitialize(state);
+
+    const int nz = state.getNZ();
+    Array_<bool> isFast(nz, false);
+    int maxGroupNZ = 0;
+    for (unsigned g=0; g < fastGroups.size(); ++g) {
+        FastGroup& group = fastGroups[g];
+        if (group.subsys.isValid()) {
+            SimTK_ERRCHK2_ALWAYS(group.subsys < state.getNumSubsystems(),
+                "MultirateIntegrator::initialize()",
+                "Fast group %d refers to Subsystem %d which does not exist.",
+                (int)g, (int)group.subsys);
+            group.zStart = state.getZStart(group.subsys);
+            group.nz     = state.getNZ(group.subsys);
+        }
+        const int zStart = (int)group.zStart;
+        SimTK_ERRCHK4_ALWAYS(zStart + group.nz <= nz,
+            "MultirateIntegrator::initialize()",
+            "Fast group %d has z's %d-%d but there are only %d z's.",
+            (int)g, zStart, zStart+group.nz-1, nz);
+        for (int i=0; i < group.nz; ++i) {
+            SimTK_ERRCHK2_ALWAYS(!isFast[zStart+i],
+                "MultirateIntegrator::initialize()",
+                "Fast group %d overlaps an earlier group at z %d.",
+                (int)g, zStart+i);
+            isFast[zStart+i] = true;
+        }
+        maxGroupNZ = std::max(maxGroupNZ, group.nz);
+    }
+
+    // Substep workspace is sized for the largest group; smaller groups use
+    // just the initial part.
+    zg.resize(maxGroupNZ); zg0.resize(maxGroupNZ);
+    for (int i=0; i < 3; ++i) 
+        fz[i].resize(maxGroupNZ);
+}
+
+void MultirateIntegratorRep::resetMethodStatistics() {
+    AbstractIntegratorRep::resetMethodStatistics();
+    statsFastSubsteps = 0;
+}
+
+void MultirateIntegratorRep::calcFastZDot
+   (const FastGroup& group, const Vector& zg, Vector& zgdot) {
+    State& advanced = updAdvancedState();
+    Vector& z = advanced.updZ(); // invalidates only Dynamics and above
+    for (int i=0; i < group.nz; ++i)
+        z[group.zStart+i] = zg[i];
+
+    ++statsRealizations; ++statsRealizationFailures;
+    getSystem().realize(advanced, group.zDotStage);
+    --statsRealizationFailures;
+
+    const Vector& zdot = advanced.getZDot();
+    for (int i=0; i < group.nz; ++i)
+        zgdot[i] = zdot[group.zStart+i];
+}
+
+// Take numSubsteps steps of the same 3rd order Runge-Kutta method as 
+// RungeKutta3Integrator over an interval of length h, with only this group's
+// z's changing. Time is one of the slow variables, so it stays put; that 
+// way the substeps never invalidate Time stage and the System's position and
+// velocity kinematics are calculated once for all of them.
+void MultirateIntegratorRep::advanceFastGroup
+   (const FastGroup& group, Real h, Vector& yErrEst) {
+    const int nz = group.nz;
+    if (nz == 0) return;
+
+    const Real hs = h / group.numSubsteps;
+    const int  yStart = getAdvancedState().getZStart() + (int)group.zStart;
+    const Vector& z = getAdvancedState().getZ();
+    for (int i=0; i < nz; ++i)
+        zg0[i] = z[group.zStart+i];
+
+    for (int s=0; s < group.numSubsteps; ++s) {
+        ++statsFastSubsteps;
+        calcFastZDot(group, zg0, fz[0]);
+
+        for (int i=0; i < nz; ++i)
+            zg[i] = zg0[i] + (hs/2)*fz[0][i];
+        calcFastZDot(group, zg, fz[1]);
+
+        for (int i=0; i < nz; ++i)
+            zg[i] = zg0[i] + hs*(2*fz[1][i]-fz[0][i]);
+        calcFastZDot(group, zg, fz[2]);
+
+        for (int i=0; i < nz; ++i) {
+            const Real z1 = zg0[i] + (hs/6)*(fz[0][i] + 4*fz[1][i] + fz[2][i]);
+            yErrEst[yStart+i] += std::abs(z1 - (zg0[i] + hs*fz[1][i]));
+            zg0[i] = z1;
+        }
+    }
+
+    // Leave the final values in the advanced state.
+    Vector& zAdv = updAdvancedState().updZ();
+    for (int i=0; i < nz; ++i)
+        zAdv[group.zStart+i] = zg0[i];
+}
+
+// On return only the fast groups' z's have changed, so the advanced state 
+// is still realized through Velocity stage.
+void MultirateIntegratorRep::advanceFastGroups
+   (Real h, bool reverse, Vector& yErrEst) {
+    const int ng = (int)fastGroups.size();
+    for (int g=0; g < ng; ++g)
+        advanceFastGroup(fastGroups[reverse ? ng-1-g : g], h, yErrEst);
+}
+
+void MultirateIntegratorRep::getSlowYDot(Vector& f) const {
+    const State& advanced = getAdvancedState();
+    f = advanced.getYDot();
+    const int zStart = advanced.getZStart();
+    for (unsigned g=0; g < fastGroups.size(); ++g)
+        for (int i=0; i < fastGroups[g].nz; ++i)
+            f[zStart + fastGroups[g].zStart + i] = 0;
+}
+
+// The slow variables are advanced with the same 3rd order Runge-Kutta method
+// as in RungeKutta3Integrator, but with the fast groups' derivatives zeroed so
+// that they are held fixed. See RungeKutta3Integrator.cpp for the method.
+bool MultirateIntegratorRep::attemptODEStep
+   (Real t1, Vector& y1err, int& errOrder, int& numIterations)
+{
+    const Real t0 = getPreviousTime();
+    assert(t1 > t0);
+
+    statsStepsAttempted++;
+    errOrder = 3;
+    const Vector& y0 = getPreviousY();
+    if (ytmp[0].size() != y0.size())
+        for (int i=0; i<NTemps; ++i)
+            ytmp[i].resize(y0.size());
+    Vector& ya    = ytmp[0]; // rename temps
+    Vector& f0    = ytmp[1];
+    Vector& f1    = ytmp[2];
+    Vector& f2    = ytmp[3];
+
+    const Real h = t1-t0;
+    const int  ny = y0.size();
+    y1err.setToZero(); // error estimates are accumulated
+
+    // First half step for the fast groups, of length h/2 from (t0,y0). The 
+    // slow variables, and time, are held at their t0 values.
+    if (fastGroups.empty())
+        f0 = getPreviousYDot();
+    else {
+        setAdvancedStateAndRealizeKinematics(t0, y0);
+        advanceFastGroups(h/2, false, y1err);
+        // Only the fast z's changed, so the kinematics are still valid.
+        realizeStateDerivatives(getAdvancedState());
+        ya = getAdvancedState().getY();
+        getSlowYDot(f0);
+    }
+    const Vector& yStart = fastGroups.empty() ? y0 : ya;
+
+    // Full step for the slow variables from t0 to t1, with the fast groups
+    // held at their midpoint values.
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = yStart[i] + (h/2)*f0[i];
+    setAdvancedStateAndRealizeDerivatives(t0+h/2, ytrial);
+    getSlowYDot(f1);
+
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = yStart[i] + h*(2*f1[i]-f0[i]);
+    setAdvancedStateAndRealizeDerivatives(t1, ytrial);
+    getSlowYDot(f2);
+
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = yStart[i] + (h/6)*(f0[i] + 4*f1[i] + f2[i]);
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
+
+    const Vector& y1 = getAdvancedState().getY();
+    for (int i=0; i<ny; ++i)
+        y1err[i] += std::abs(y1[i]-(yStart[i] + h*f1[i]));
+
+    // Second half step for the fast groups, in reverse order to keep the 
+    // splitting symmetric. The slow variables, and time, are held at their
+    // t1 values.
+    if (!fastGroups.empty())
+        advanceFastGroups(h/2, true, y1err);
+
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef SimTK_SIMMATH_MULTIRATE_INTEGRATOR_REP_H_
+#define SimTK_SIMMATH_MULTIRATE_INTEGRATOR_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "AbstractIntegratorRep.h"
+
+namespace SimTK {
+
+/**
+ * This is the private (library side) implementation of the 
+ * MultirateIntegrator class which is a concrete class
+ * implementing the abstract IntegratorRep.
+ */
+
+class MultirateIntegratorRep : public AbstractIntegratorRep {
+public:
+    MultirateIntegratorRep(Integrator* handle, const System& sys);
+
+    void methodInitialize(const State&);
+    void resetMethodStatistics();
+
+    void addFastGroup(SubsystemIndex subsys, SystemZIndex zStart, int nz,
+                      int numSubsteps, Stage zDotStage);
+    void clearFastGroups() {fastGroups.clear();}
+    int getNumFastGroups() const {return (int)fastGroups.size();}
+    int getNumFastSubsteps() const {return statsFastSubsteps;}
+protected:
+    bool attemptODEStep
+       (Real t1, Vector& yErrEst, int& errOrder, int& numIterations);
+private:
+    // If subsys is valid the group is all of that Subsystem's z's, otherwise
+    // it is the given range. Either way zStart and nz are filled in with the 
+    // System z range when the integrator is initialized.
+    struct FastGroup {
+        SubsystemIndex  subsys;
+        SystemZIndex    zStart;
+        int             nz;
+        int             numSubsteps;
+        Stage           zDotStage;
+    };
+
+    // Advance all the fast groups over an interval of length h with time and
+    // the slow variables held fixed, accumulating their error estimates into
+    // yErrEst. Groups are processed in reverse order if reverse is true.
+    void advanceFastGroups(Real h, bool reverse, Vector& yErrEst);
+    void advanceFastGroup(const FastGroup& group, Real h, Vector& yErrEst);
+    // Set a group's z's in the advanced state and calculate the z's 
+    // derivatives, realizing only through the group's zDotStage.
+    void calcFastZDot(const FastGroup& group, const Vector& zg, 
+                      Vector& zgdot);
+    // Get the full derivative of the advanced state, with zeroes for the 
+    // fast groups so that they are held fixed.
+    void getSlowYDot(Vector& f) const;
+
+    Array_<FastGroup> fastGroups;
+
+    static const int NTemps = 4;
+    Vector ytmp[NTemps];            // slow step workspace
+    Vector zg, zg0, fz[3];          // fast substep workspace
+
+    int statsFastSubsteps;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_MULTIRATE_INTEGRATOR_REP_H_
@@ -95,9 +95,15 @@ bool RungeKutta2IntegratorRep::attemptODEStep
     Vector& f1    = ytmp[0]; // rename temp
 
     const Real h = t1-t0;
+    const int  ny = y0.size();
+
+    // Stage values are formed in the ytrial workspace an element at a time
+    // so that we don't allocate temporaries.
 
     // First stage f1 = f(t1, y0+h*f0)
-    setAdvancedStateAndRealizeDerivatives(t1, y0 + h*f0);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*f0[i];
+    setAdvancedStateAndRealizeDerivatives(t1, ytrial);
     f1 = getAdvancedState().getYDot();
 
     // Final value. This is the 2nd order accurate estimate for 
@@ -105,7 +111,9 @@ bool RungeKutta2IntegratorRep::attemptODEStep
     // Evaluate through kinematics only; it is a waste of a stage to 
     // evaluate derivatives here since the caller will muck with this before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1, y0 + (h/2)*(f0 + f1));
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/2)*(f0[i] + f1[i]);
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
     // YErr is valid now
 
     // This is an embedded 1st-order estimate y1hat=y(t1)+O(h^2), with
@@ -98,11 +98,19 @@ bool RungeKutta3IntegratorRep::attemptODEStep
     Vector& f2    = ytmp[1];
 
     const Real h = t1-t0;
+    const int  ny = y0.size();
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/2, y0 + (h/2)*f0);
+    // Stage values are formed in the ytrial workspace an element at a time
+    // so that we don't allocate temporaries.
+
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/2)*f0[i];
+    setAdvancedStateAndRealizeDerivatives(t0+h/2, ytrial);
     f1 = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t1,     y0 + h*(2*f1-f0));
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*(2*f1[i]-f0[i]);
+    setAdvancedStateAndRealizeDerivatives(t1, ytrial);
     f2 = getAdvancedState().getYDot();
 
     // Final value. This is the 3rd order accurate estimate for 
@@ -110,7 +118,9 @@ bool RungeKutta3IntegratorRep::attemptODEStep
     // Evaluate through kinematics only; it is a waste of a stage to 
     // evaluate derivatives here since the caller will muck with this before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1,      y0 + (h/6)*(f0 + 4*f1 + f2));
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/6)*(f0[i] + 4*f1[i] + f2[i]);
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
     // YErr is valid now
 
     // This is an embedded 2nd-order estimate y1hat=y(t1)+O(h^3), with
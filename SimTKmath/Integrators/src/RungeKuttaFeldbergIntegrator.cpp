@@ -110,45 +110,59 @@ bool RungeKuttaFeldbergIntegratorRep::attemptODEStep
     if (ytmp[0].size() != y0.size())
         for (int i=0; i<NTemps; ++i)
             ytmp[i].resize(y0.size());
-    Vector& ysave = ytmp[0]; // rename temps
-    Vector& fa    = ytmp[1];
-    Vector& fb    = ytmp[2];
 
     const Real h = t1-t0;
-
-    // Calculate the intermediate states.
+    const int  ny = y0.size();
+    const Vector& k1 = ytmp[0]; // stage derivatives, after they're computed
+    const Vector& k2 = ytmp[1];
+    const Vector& k3 = ytmp[2];
+    const Vector& k4 = ytmp[3];
+    const Vector& k5 = ytmp[4];
+
+    // Calculate the intermediate states. Stage values are formed in the 
+    // ytrial workspace an element at a time so that we don't allocate 
+    // temporaries.
     
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C21, 
-        y0 + h*C22*f0);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*C22*f0[i];
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C21, ytrial);
     ytmp[0] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C31, 
-        y0 + h*C32*f0 + h*C33*ytmp[0]);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*C32*f0[i] + h*C33*k1[i];
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C31, ytrial);
     ytmp[1] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C41, 
-        y0 + h*C42*f0 + h*C43*ytmp[0] + h*C44*ytmp[1]);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*C42*f0[i] + h*C43*k1[i] + h*C44*k2[i];
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C41, ytrial);
     ytmp[2] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C51, 
-        y0 + h*C52*f0 + h*C53*ytmp[0] + h*C54*ytmp[1] + h*C55*ytmp[2]);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*C52*f0[i] + h*C53*k1[i] + h*C54*k2[i] 
+                          + h*C55*k3[i];
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C51, ytrial);
     ytmp[3] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C61, 
-        y0 + h*C62*f0 + h*C63*ytmp[0] + h*C64*ytmp[1] + h*C65*ytmp[2] 
-           + h*C66*ytmp[3]);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*C62*f0[i] + h*C63*k1[i] + h*C64*k2[i] 
+                          + h*C65*k3[i] + h*C66*k4[i];
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C61, ytrial);
     ytmp[4] = getAdvancedState().getYDot();
     
     // Calculate the final state but don't evaluate the derivatives. That
     // would be a wasted stage since the caller will muck with the state before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1, 
-        y0 + h*CY1*f0 + h*CY2*ytmp[1] + h*CY3*ytmp[2] + h*CY4*ytmp[3]);
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + h*CY1*f0[i] + h*CY2*k2[i] + h*CY3*k3[i] 
+                          + h*CY4*k4[i];
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
     // YErr is valid now, but not YDot.
     
     // Calculate the error estimate.
-    y1err = h*CE1*f0 + h*CE2*ytmp[1] + h*CE3*ytmp[2] + h*CE4*ytmp[3] 
-                     + h*CE5*ytmp[4];
+    for (int i=0; i<ny; ++i)
+        y1err[i] = h*CE1*f0[i] + h*CE2*k2[i] + h*CE3*k3[i] + h*CE4*k4[i] 
+                               + h*CE5*k5[i];
 
     return true;
 }
@@ -101,18 +101,29 @@ bool RungeKuttaMersonIntegratorRep::attemptODEStep
     Vector& fb    = ytmp[2];
 
     const Real h = t1-t0;
+    const int  ny = y0.size();
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/3, y0 + (h/3)*f0);
+    // Stage values are formed in the ytrial workspace an element at a time
+    // so that we don't allocate temporaries.
+
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/3)*f0[i];
+    setAdvancedStateAndRealizeDerivatives(t0+h/3, ytrial);
     fa = getAdvancedState().getYDot(); // fa=f1
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/3, y0 + (h/6)*(f0+fa)); // f0+f1
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/6)*(f0[i]+fa[i]); // f0+f1
+    setAdvancedStateAndRealizeDerivatives(t0+h/3, ytrial);
     fa = getAdvancedState().getYDot(); // fa=f2
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/2, y0 + (h/8)*(f0 + 3*fa)); // f0+3f2
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/8)*(f0[i] + 3*fa[i]); // f0+3f2
+    setAdvancedStateAndRealizeDerivatives(t0+h/2, ytrial);
     fb = getAdvancedState().getYDot(); // fb=f3
 
     // We'll need this for error estimation.
-    ysave = y0 + (h/2)*(f0 - 3*fa + 4*fb); // f0-3f2+4f3
+    for (int i=0; i<ny; ++i)
+        ysave[i] = y0[i] + (h/2)*(f0[i] - 3*fa[i] + 4*fb[i]); // f0-3f2+4f3
     setAdvancedStateAndRealizeDerivatives(t1, ysave);
     fa = getAdvancedState().getYDot(); // fa=f4
 
@@ -121,7 +132,9 @@ bool RungeKuttaMersonIntegratorRep::attemptODEStep
     // Evaluate through kinematics only; it is a waste of a stage to 
     // evaluate derivatives here since the caller will muck with this before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1, y0 + (h/6)*(f0 + 4*fb + fa));
+    for (int i=0; i<ny; ++i)
+        ytrial[i] = y0[i] + (h/6)*(f0[i] + 4*fb[i] + fa[i]);
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
     // YErr is valid now
 
     // This is an embedded 3rd-order estimate y1hat=y(t0+h)+O(h^4). (Apparently
@@ -0,0 +1,351 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the 
+ * SDIRK3Integrator and SDIRK3IntegratorRep classes.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/Integrator.h"
+#include "simmath/SDIRK3Integrator.h"
+
+#include "IntegratorRep.h"
+#include "SDIRK3IntegratorRep.h"
+
+#include <exception>
+#include <limits>
+
+using namespace SimTK;
+
+//------------------------------------------------------------------------------
+//                            SDIRK3 INTEGRATOR
+//------------------------------------------------------------------------------
+
+SDIRK3Integrator::SDIRK3Integrator(const System& sys) 
+{
+    rep = new SDIRK3IntegratorRep(this, sys);
+}
+
+int SDIRK3Integrator::getNumJacobianEvaluations() const {
+    const SDIRK3IntegratorRep& srep = 
+        dynamic_cast<const SDIRK3IntegratorRep&>(*rep);
+    return srep.getNumJacobianEvaluations();
+}
+
+int SDIRK3Integrator::getNumIterationMatrixFactorizations() const {
+    const SDIRK3IntegratorRep& srep = 
+        dynamic_cast<const SDIRK3IntegratorRep&>(*rep);
+    return srep.getNumIterationMatrixFactorizations();
+}
+
+//------------------------------------------------------------------------------
+//                          SDIRK3 INTEGRATOR REP
+//------------------------------------------------------------------------------
+
+// This is the 3-stage, 3rd order, L-stable SDIRK method from R. Alexander,
+// "Diagonally implicit Runge-Kutta methods for stiff O.D.E.'s", SIAM J.
+// Numer. Anal. 14(6):1006-1021, 1977. Gamma is the root of
+// x^3 - 3x^2 + 3x/2 - 1/6 = 0 that lies in (1/6,1/2). This is the Butcher
+// diagram, with c2=(1+gamma)/2:
+//
+//      gamma |  gamma
+//         c2 |  c2-gamma  gamma
+//          1 |  b1        b2      gamma
+//         ---|---------------------------
+//          1 |  b1        b2      gamma    3rd order propagated solution
+//         ---|---------------------------
+//          1 |  bh1       bh2     0        2nd order for error estimate
+//
+// where b1=-(6 gamma^2 - 16 gamma + 1)/4 and b2=(6 gamma^2 - 20 gamma + 5)/4.
+// The method is stiffly accurate: the last stage value is the solution. The
+// embedded weights bh are the unique 2nd order ones with bh3=0. Because 
+// that error estimate is not itself L-stable, it is filtered through
+// (I - h gamma J)^-1 as suggested in Hairer & Wanner, Solving ODEs II, 2nd
+// rev. ed., page 123, so that stiff components don't produce spurious step
+// size reductions.
+//
+// Each stage requires the solution of the nonlinear system
+//      Y_i = psi_i + h gamma f(t0 + c_i h, Y_i),  
+//      psi_i = y0 + h sum_{j<i} a_ij k_j
+// which we do with a modified Newton iteration using the iteration matrix
+// I - h gamma J, where J=df/dy is approximated at the start of a step. J is
+// kept across steps until the iteration fails or converges slowly. The 
+// factored iteration matrix is kept too, as long as h has grown by no more
+// than MaxStepRatioForOldMatrix since it was factored (as in RADAU5; Hairer
+// & Wanner, page 124); modified Newton still converges to the stage values 
+// for this h, only a little more slowly. The stage derivatives 
+// are recovered as k_i = (Y_i - psi_i)/(h gamma) rather than by evaluating 
+// f(Y_i), since f amplifies any residual Newton error in stiff components.
+
+static const Real Gamma = Real(0.43586652150845899941601945);
+static const Real C2    = (1+Gamma)/2;
+static const Real B1    = -(6*Gamma*Gamma - 16*Gamma + 1)/4;
+static const Real B2    =  (6*Gamma*Gamma - 20*Gamma + 5)/4;
+static const Real BH2   = (Real(0.5)-Gamma)/(C2-Gamma);
+static const Real BH1   = 1-BH2;
+
+// Stage times and the strictly lower triangular part of the Butcher matrix.
+static const Real C[3]    = {Gamma, C2, 1};
+static const Real A[3][2] = {{0,         0 },
+                             {C2-Gamma,  0 },
+                             {B1,        B2}};
+
+// The Newton iteration is considered converged when the estimated remaining
+// error in a stage value is below this fraction of the accuracy. It is 
+// abandoned if it is converging more slowly than MaxConvergenceRate, and we 
+// ask for a new Jacobian before the next step if any stage converged more
+// slowly than SlowConvergenceRate.
+static const Real NewtonTolerance     = Real(0.05);
+static const Real MaxConvergenceRate  = Real(0.9);
+static const Real SlowConvergenceRate = Real(0.5);
+static const int  MaxNewtonIterations = 7;
+static const Real MaxStepRatioForOldMatrix = Real(1.2);
+
+SDIRK3IntegratorRep::SDIRK3IntegratorRep
+   (Integrator* handle, const System& sys) 
+:   AbstractIntegratorRep(handle, sys, 3, 3, "SDIRK3",  true),
+    jacobianIsValid(false), jacobianTime(NaN), hFactored(NaN),
+    statsJacobianEvaluations(0), statsIterationMatrixFactorizations(0) {
+}
+
+void SDIRK3IntegratorRep::methodInitialize(const State& state) {
+    AbstractIntegratorRep::methodInitialize(state);
+    jacobianIsValid = false;
+    hFactored = NaN;
+}
+
+// An event handler may have changed the system discontinuously so we can't
+// trust the old Jacobian.
+void SDIRK3IntegratorRep::methodReinitialize
+   (Stage stage, bool shouldTerminate) {
+    jacobianIsValid = false;
+    hFactored = NaN;
+}
+
+void SDIRK3IntegratorRep::resetMethodStatistics() {
+    AbstractIntegratorRep::resetMethodStatistics();
+    statsJacobianEvaluations = 0;
+    statsIterationMatrixFactorizations = 0;
+}
+
+// Approximate J=df/dy at (t0,y0) by forward differences, using the 
+// already-known derivatives f0 there. This costs one realization per state
+// variable. Perturbing a q changes the kinematics so those columns need 
+// full realizations, but perturbing a u or z leaves the positions alone; 
+// those columns start from y0 realized through Position stage and are 
+// realized only from Velocity (for a u) or Dynamics (for a z) stage on.
+void SDIRK3IntegratorRep::calcJacobian() {
+    const Real    t0 = getPreviousTime();
+    const Vector& y0 = getPreviousY();
+    const Vector& f0 = getPreviousYDot();
+    const int     ny = y0.size();
+    const int     nq = getAdvancedState().getNQ();
+    const int     nu = getAdvancedState().getNU();
+
+    jacobian.resize(ny, ny);
+    ytrial = y0;
+    for (int j=0; j < nq; ++j) {
+        const Real yj = y0[j];
+        ytrial[j] = yj + SqrtEps*std::max(std::abs(yj), Real(1));
+        const Real dy = ytrial[j] - yj; // the perturbation actually made
+        setAdvancedStateAndRealizeDerivatives(t0, ytrial);
+        const Vector& f = getAdvancedState().getYDot();
+        for (int i=0; i < ny; ++i)
+            jacobian(i,j) = (f[i] - f0[i]) / dy;
+        ytrial[j] = yj;
+    }
+
+    if (nq < ny) {
+        setAdvancedStateAndRealizeKinematics(t0, y0);
+        State& advanced = updAdvancedState();
+        for (int j=nq; j < ny; ++j) {
+            const bool isU = (j < nq+nu);
+            const int  k   = isU ? j-nq : j-nq-nu;
+            const Real yj  = y0[j];
+            const Real yjp = yj + SqrtEps*std::max(std::abs(yj), Real(1));
+            // Each upd call invalidates the stages that depend on it.
+            if (isU) {
+                advanced.updU()[k] = yjp;
+                getSystem().prescribeU(advanced); // set u_p
+            } else
+                advanced.updZ()[k] = yjp;
+            realizeStateDerivatives(advanced);
+            const Vector& f = advanced.getYDot();
+            for (int i=0; i < ny; ++i)
+                jacobian(i,j) = (f[i] - f0[i]) / (yjp - yj);
+            if (isU) advanced.updU()[k] = yj;
+            else     advanced.updZ()[k] = yj;
+        }
+    }
+
+    ++statsJacobianEvaluations;
+    jacobianIsValid = true;
+    jacobianTime = t0;
+    hFactored = NaN; // iteration matrix is out of date
+}
+
+bool SDIRK3IntegratorRep::canUseIterationMatrix(Real h) const {
+    return h >= hFactored && h <= MaxStepRatioForOldMatrix*hFactored;
+}
+
+bool SDIRK3IntegratorRep::factorIterationMatrix(Real h) {
+    iterationMatrix = jacobian;
+    iterationMatrix *= -h*Gamma;
+    for (int i=0; i < iterationMatrix.nrow(); ++i)
+        iterationMatrix(i,i) += 1;
+    iterationMatrixLU.factor(iterationMatrix);
+    ++statsIterationMatrixFactorizations;
+
+    if (iterationMatrixLU.isSingular()) {
+        hFactored = NaN;
+        return false;
+    }
+    hFactored = h;
+    return true;
+}
+
+bool SDIRK3IntegratorRep::solveStages(Real h, int& numIterations) {
+    const Real    t0 = getPreviousTime();
+    const Vector& y0 = getPreviousY();
+    const Vector& f0 = getPreviousYDot();
+    const int     ny = y0.size();
+    const Real    hg = h*Gamma;
+    const Real    tol = NewtonTolerance*getAccuracyInUse();
+
+    Real slowestRate = 0;
+    for (int s=0; s < NStages; ++s) {
+        for (int i=0; i < ny; ++i) {
+            Real sum = 0;
+            for (int j=0; j < s; ++j)
+                sum += A[s][j]*k[j][i];
+            psi[i] = y0[i] + h*sum;
+        }
+
+        // Predict the stage value from the most recent derivative.
+        const Vector& kPrev = (s == 0 ? f0 : k[s-1]);
+        for (int i=0; i < ny; ++i)
+            ytrial[i] = psi[i] + hg*kPrev[i];
+
+        bool converged = false;
+        Real prevNorm = Infinity;
+        for (int iter=0; iter < MaxNewtonIterations && !converged; ++iter) {
+            ++numIterations;
+            setAdvancedStateAndRealizeDerivatives(t0 + C[s]*h, ytrial);
+            const Vector& f = getAdvancedState().getYDot();
+            for (int i=0; i < ny; ++i)
+                residual[i] = psi[i] + hg*f[i] - ytrial[i];
+            iterationMatrixLU.solve(residual, delta);
+
+            int worstOne;
+            const Real deltaNorm = 
+                calcErrorNorm(getAdvancedState(), delta, worstOne);
+            if (!isFinite(deltaNorm))
+                return false;
+            for (int i=0; i < ny; ++i)
+                ytrial[i] += delta[i];
+
+            if (iter == 0)
+                converged = (deltaNorm <= tol);
+            else {
+                const Real rate = deltaNorm/prevNorm;
+                if (rate >= MaxConvergenceRate)
+                    return false; // diverging, or too slow to be worth it
+                slowestRate = std::max(slowestRate, rate);
+                converged = (rate/(1-rate)*deltaNorm <= tol);
+            }
+            prevNorm = deltaNorm;
+        }
+        if (!converged)
+            return false;
+
+        for (int i=0; i < ny; ++i)
+            k[s][i] = (ytrial[i] - psi[i]) / hg;
+    }
+
+    if (slowestRate > SlowConvergenceRate)
+        jacobianIsValid = false; // get a fresh one for the next step
+    return true;
+}
+
+bool SDIRK3IntegratorRep::attemptODEStep
+   (Real t1, Vector& y1err, int& errOrder, int& numIterations)
+{
+    const Real t0 = getPreviousTime();
+    assert(t1 > t0);
+
+    statsStepsAttempted++;
+    errOrder = 3;
+    const Vector& y0 = getPreviousY();
+    const int     ny = y0.size();
+    const Real    h  = t1-t0;
+
+    if (ny == 0) { // nothing to integrate
+        setAdvancedStateAndRealizeKinematics(t1, y0);
+        return true;
+    }
+
+    if (psi.size() != ny) { // first step, or the number of states changed
+        for (int s=0; s < NStages; ++s)
+            k[s].resize(ny);
+        psi.resize(ny); residual.resize(ny); delta.resize(ny);
+        jacobianIsValid = false;
+    }
+
+    // A Jacobian formed at t0 is current even if it was formed for an 
+    // earlier, rejected attempt at this step; those start from the same y0.
+    if (!jacobianIsValid)
+        calcJacobian();
+
+    // If the iteration fails with an iteration matrix factored for a 
+    // different h, refactor it for this h; if it fails with an old Jacobian,
+    // try once more with a fresh one before giving up and letting the caller
+    // reduce the step size.
+    numIterations = 0;
+    while (!(   (canUseIterationMatrix(h) || factorIterationMatrix(h))
+             && solveStages(h, numIterations))) 
+    {
+        if (isFinite(hFactored) && hFactored != h) {
+            hFactored = NaN;
+            continue;
+        }
+        if (jacobianIsValid && jacobianTime == t0)
+            return false;
+        calcJacobian();
+    }
+
+    // The method is stiffly accurate so the last stage value in ytrial is the
+    // 3rd order solution. As for the explicit methods, we only realize 
+    // kinematics here since the caller will project this before the end of 
+    // the step.
+    setAdvancedStateAndRealizeKinematics(t1, ytrial);
+
+    // The filtered error estimate is (I - h gamma J)^-1 h sum (b_i-bh_i) k_i;
+    // the filter may use a slightly smaller h than this step's.
+    for (int i=0; i < ny; ++i)
+        residual[i] = h*(  (B1-BH1)*k[0][i] + (B2-BH2)*k[1][i] 
+                         + Gamma*k[2][i]);
+    iterationMatrixLU.solve(residual, y1err);
+
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
+#define SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "simmath/LinearAlgebra.h"
+
+#include "AbstractIntegratorRep.h"
+
+namespace SimTK {
+
+/**
+ * This is the private (library side) implementation of the 
+ * SDIRK3Integrator class which is a concrete class
+ * implementing the abstract IntegratorRep.
+ */
+
+class SDIRK3IntegratorRep : public AbstractIntegratorRep {
+public:
+    SDIRK3IntegratorRep(Integrator* handle, const System& sys);
+
+    void methodInitialize(const State&);
+    void methodReinitialize(Stage stage, bool shouldTerminate);
+    void resetMethodStatistics();
+
+    int getNumJacobianEvaluations() const 
+    {   return statsJacobianEvaluations; }
+    int getNumIterationMatrixFactorizations() const 
+    {   return statsIterationMatrixFactorizations; }
+protected:
+    bool attemptODEStep
+       (Real t1, Vector& yErrEst, int& errOrder, int& numIterations);
+private:
+    // Form a finite difference approximation to J=df/dy at the start of the
+    // current step, where the derivatives are already known.
+    void calcJacobian();
+    // Can the currently factored iteration matrix be used for a step of h?
+    bool canUseIterationMatrix(Real h) const;
+    // Form and factor I - h*gamma*J. Returns false if it is singular.
+    bool factorIterationMatrix(Real h);
+    // Solve all three stages with the current iteration matrix. Returns
+    // false if the Newton iteration fails to converge in any stage.
+    bool solveStages(Real h, int& numIterations);
+
+    Matrix      jacobian;           // df/dy
+    Matrix      iterationMatrix;    // I - h*gamma*J
+    FactorLU    iterationMatrixLU;
+    bool        jacobianIsValid;
+    Real        jacobianTime;       // t0 of the step it was formed for
+    Real        hFactored;          // h used in iterationMatrixLU (NaN if none)
+
+    static const int NStages = 3;
+    Vector      k[NStages];         // stage derivatives
+    Vector      psi;                // explicit part of a stage value
+    Vector      residual, delta;    // Newton iteration workspace
+
+    int statsJacobianEvaluations;
+    int statsIterationMatrixFactorizations;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_SDIRK3_INTEGRATOR_REP_H_
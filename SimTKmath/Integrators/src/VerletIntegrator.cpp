@@ -52,6 +52,19 @@ VerletIntegratorRep::VerletIntegratorRep(Integrator* handle, const System& sys)
 
 
 
+// Return |a-b|/|b| (2-norms), computed without allocating a temporary for
+// a-b. The tiny constant protects against division by zero.
+static Real calcRelativeChange(const Vector& a, const Vector& b) {
+    assert(a.size() == b.size());
+    Real diffSqr = 0, bSqr = 0;
+    for (int i=0; i < a.size(); ++i) {
+        diffSqr += square(a[i]-b[i]);
+        bSqr    += square(b[i]);
+    }
+    return std::sqrt(diffSqr) / (std::sqrt(bSqr)+TinyReal);
+}
+
+
 //==============================================================================
 //                            ATTEMPT DAE STEP
 //==============================================================================
@@ -63,7 +76,6 @@ bool VerletIntegratorRep::attemptDAEStep
 {
     const System& system   = getSystem();
     State& advanced = updAdvancedState();
-    Vector dummyErrEst; // for when we don't want the error estimate projected
     
     statsStepsAttempted++;
 
@@ -91,24 +103,28 @@ bool VerletIntegratorRep::attemptDAEStep
   {
     numIterations = 0;
 
-    VectorView qErrEst  = yErrEst(    0, nq);       // all 3rd order estimates
-    VectorView uErrEst  = yErrEst(   nq, nu);
-    VectorView zErrEst  = yErrEst(nq+nu, nz);
-    VectorView uzErrEst = yErrEst(   nq, nu+nz);    // all 2nd order estimates
+    // Vector arithmetic here is done an element at a time into workspace to
+    // avoid allocating temporaries; these are no-ops after the first step.
+    u1Est.resize(nu); uSave.resize(nu); uNext.resize(nu);
+    z1Est.resize(nz); zSave.resize(nz); zNext.resize(nz);
     
     // Calculate the new positions q (3rd order) and initial (1st order) 
     // estimate for the velocities u and auxiliary variables z.
     
     // These are final values (the q's will get projected, though).
     advanced.updTime() = t1;
-    advanced.updQ()    = q0 + h*qdot0 + (h*h/2)*qdotdot0;
+    Vector& qNew = advanced.updQ();
+    for (int i=0; i < nq; ++i)
+        qNew[i] = q0[i] + h*qdot0[i] + (h*h/2)*qdotdot0[i];
 
     // Now make an initial estimate of first-order variable u and z.
-    const Vector u1_est = u0 + h*udot0;
-    const Vector z1_est = z0 + h*zdot0;
+    for (int i=0; i < nu; ++i)
+        u1Est[i] = u0[i] + h*udot0[i];
+    for (int i=0; i < nz; ++i)
+        z1Est[i] = z0[i] + h*zdot0[i];
 
-    advanced.updU() = u1_est; // u's and z's will change in advanced below
-    advanced.updZ() = z1_est;
+    advanced.updU() = u1Est; // u's and z's will change in advanced below
+    advanced.updZ() = z1Est;
 
     system.realize(advanced, Stage::Time);
     system.prescribeQ(advanced);
@@ -143,7 +159,6 @@ bool VerletIntegratorRep::attemptDAEStep
     // here which has a very limited radius of convergence.
     
     const Real tol = std::min(Real(1e-4), Real(0.1)*getAccuracyInUse());
-    Vector usave(nu), zsave(nz); // temporaries
     bool converged = false;
     Real prevChange = Infinity; // use this to quit early
     for (int i = 0; !converged && i < 10; ++i) {
@@ -151,8 +166,8 @@ bool VerletIntegratorRep::attemptDAEStep
         // At this point we know that the advanced state has been realized
         // through the Acceleration level, so its uDot and zDot reflect
         // the u and z state values it contains.
-        usave = advanced.getU();
-        zsave = advanced.getZ();
+        uSave = advanced.getU();
+        zSave = advanced.getZ();
 
         // Get these references now -- as soon as we change u or z they
         // will be invalid.
@@ -160,8 +175,12 @@ bool VerletIntegratorRep::attemptDAEStep
         const Vector& zdot1 = advanced.getZDot();
         
         // Refine u and z estimates.
-        advanced.setU(u0 + (h/2)*(udot0 + udot1));
-        advanced.setZ(z0 + (h/2)*(zdot0 + zdot1));
+        for (int j=0; j < nu; ++j)
+            uNext[j] = u0[j] + (h/2)*(udot0[j] + udot1[j]);
+        for (int j=0; j < nz; ++j)
+            zNext[j] = z0[j] + (h/2)*(zdot0[j] + zdot1[j]);
+        advanced.setU(uNext);
+        advanced.setZ(zNext);
 
         // Fix prescribed u's which may have been changed here.
         system.prescribeU(advanced);
@@ -177,10 +196,8 @@ bool VerletIntegratorRep::attemptDAEStep
         // 2-norm but this ratio would be the same if we used the RMS norm. 
         // TinyReal is there to keep us out of trouble if we started at zero.
         
-        const Real convergenceU = (advanced.getU()-usave).norm()
-                                  / (usave.norm()+TinyReal);
-        const Real convergenceZ = (advanced.getZ()-zsave).norm()
-                                  / (zsave.norm()+TinyReal);
+        const Real convergenceU = calcRelativeChange(advanced.getU(), uSave);
+        const Real convergenceZ = calcRelativeChange(advanced.getZ(), zSave);
         const Real change = std::max(convergenceU,convergenceZ);
         converged = (change <= tol);
         if (i > 1 && (change > prevChange))
@@ -193,12 +210,20 @@ bool VerletIntegratorRep::attemptDAEStep
     // estimates for u and z. Note that we have already realized the state with
     // the new values, so QDot reflects the new u's.
 
-    qErrEst = q0 + (h/2)*(qdot0+advanced.getQDot()) // implicit trapezoid rule integral
-              - advanced.getQ();                    // Verlet integral
-
-    uErrEst = u1_est                    // explicit Euler integral
-              - advanced.getU();        // implicit trapezoid rule integral
-    zErrEst = z1_est - advanced.getZ(); // ditto for z's
+    // The q, u, and z parts of yErrEst are filled in directly rather than
+    // through views since creating a view allocates.
+    const Vector& qdot1 = advanced.getQDot();
+    const Vector& q1Final = advanced.getQ();
+    const Vector& u1 = advanced.getU();
+    const Vector& z1 = advanced.getZ();
+    for (int i=0; i < nq; ++i)     // all 3rd order estimates
+        yErrEst[i] = q0[i] + (h/2)*(qdot0[i]+qdot1[i]) // implicit trapezoid rule integral
+                     - q1Final[i];                      // Verlet integral
+    for (int i=0; i < nu; ++i)     // all 2nd order estimates
+        yErrEst[nq+i] = u1Est[i]   // explicit Euler integral
+                        - u1[i];   // implicit trapezoid rule integral
+    for (int i=0; i < nz; ++i)
+        yErrEst[nq+nu+i] = z1Est[i] - z1[i]; // ditto for z's
 
     // TODO: because we're only projecting velocities here, we aren't going to 
     // get our position errors reduced here, which is a shame. Should be able 
@@ -220,7 +245,8 @@ bool VerletIntegratorRep::attemptDAEStep
     // decides to accept the step. Instead, a different error order should
     // be used when one of these is driving the step size.
 
-    uErrEst *= h; zErrEst *= h; // everything is 3rd order in h now
+    for (int i=nq; i < nq+nu+nz; ++i)
+        yErrEst[i] *= h; // everything is 3rd order in h now
     errOrder = 3;
 
     //errOrder = qErrRMS > uzErrRMS ? 3 : 2;
@@ -34,6 +34,11 @@ public:
 protected:
     bool attemptDAEStep
        (Real t1, Vector& yErrEst, int& errOrder, int& numIterations);
+private:
+    // Workspace so that taking a step doesn't allocate; these are resized
+    // only when the number of state variables changes.
+    Vector u1Est, z1Est, uSave, zSave, uNext, zNext;
+    Vector dummyErrEst; // for when we don't want the error estimate projected
 };
 
 } // namespace SimTK
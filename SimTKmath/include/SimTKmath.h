@@ -62,5 +62,7 @@
 #include "simmath/VerletIntegrator.h"
 #include "simmath/SemiExplicitEulerIntegrator.h"
 #include "simmath/SemiExplicitEuler2Integrator.h"
+#include "simmath/SDIRK3Integrator.h"
+#include "simmath/MultirateIntegrator.h"
 
 #endif // SimTK_SIMMATH_H_
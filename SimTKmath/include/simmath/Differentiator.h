@@ -73,6 +73,14 @@ namespace SimTK {
  * Then the derivative, gradient element, or Jacobian column is computed 
  * as df/dy=[f(x+h)-f(x)]/h (1st order) or df/dy=[f(x+h)-f(x-h)]/(2h) 
  * (2nd order).
+ *
+ * @par Threads
+ *
+ * Although its calc methods are const, a Differentiator keeps workspace and
+ * statistics that they update, so a Differentiator must not be used by more
+ * than one thread at a time. Give each thread its own Differentiator; they 
+ * may share a thread-safe Function. This is true whether or not parallel 
+ * evaluation has been requested with setUseParallel().
  */
 class SimTK_SIMMATH_EXPORT Differentiator {
 public:
@@ -123,6 +131,39 @@ public:
     Vector calcGradient  (const Vector& y0, Method=UnspecifiedMethod) const;
     Matrix calcJacobian  (const Vector& y0, Method=UnspecifiedMethod) const;
 
+    // Request that the perturbed function evaluations needed by 
+    // calcGradient() and calcJacobian() be made concurrently, one gradient
+    // element or Jacobian column (or column group, see below) per task.
+    // This is used only if the Function has been declared thread safe with
+    // Function::setIsThreadSafe(); otherwise evaluation remains serial. 
+    // Results are identical to serial evaluation. This is off by default;
+    // one thread means serial execution, and calls made from a thread that
+    // is already a ParallelExecutor worker are always evaluated serially. If
+    // the user function fails in more than one perturbation, the failure 
+    // reported is the one for the lowest-numbered parameter. The worker 
+    // threads belong to this Differentiator, which as noted above must not 
+    // be used by more than one thread at a time.
+    void setUseParallel(bool useParallel, 
+                        int  numThreads=ParallelExecutor::getNumProcessors());
+    bool getUseParallel() const;
+
+    // If the Jacobian of a JacobianFunction is known to be sparse, you can
+    // supply its pattern here as the list of rows that may be nonzero in
+    // each column (there must be one entry per parameter). Columns that have
+    // no nonzero rows in common are then perturbed together, so calcJacobian()
+    // needs only one function evaluation (two for central differences) per
+    // group of columns rather than per column. Entries outside the pattern are
+    // returned as zero. The pattern is ignored for calcGradient() and 
+    // calcDerivative().
+    void setJacobianSparsityPattern
+       (const Array_< Array_<int> >& nonzeroRowsByColumn);
+    void clearJacobianSparsityPattern();
+    bool hasJacobianSparsityPattern() const;
+    // Number of groups of columns that are perturbed together by 
+    // calcJacobian(); this is the number of parameters if no sparsity
+    // pattern has been set.
+    int  getNumJacobianColumnGroups() const;
+
     // Statistics (mutable)
     void resetAllStatistics();                 // reset all stats to zero
     int getNumDifferentiations() const;        // total # calls of calcWhatever
@@ -154,11 +195,16 @@ public:
     Function& setNumFunctions(int);
     Function& setNumParameters(int);
     Function& setEstimatedAccuracy(Real);
+    // Declare that f() may be called concurrently from several threads (with
+    // different arguments), allowing a Differentiator to evaluate it in
+    // parallel. This is false by default.
+    Function& setIsThreadSafe(bool);
 
     // These values are fixed after construction.
     int  getNumFunctions()  const;
     int  getNumParameters() const;
     Real getEstimatedAccuracy() const; // approx. "roundoff" in f calculation
+    bool isThreadSafe() const;
 
     // Statistics (mutable)
     void resetAllStatistics();
@@ -30,6 +30,7 @@
 #include "simmath/Differentiator.h"
 
 #include <exception>
+#include <string>
 
 namespace SimTK {
 
@@ -86,6 +87,15 @@ static Real cleanUpH(Real hEst, Real y0) {
     return temp-y0;
 }
 
+// Report a failed user function call made with tryCall(), in the same way
+// call() does.
+static void throwUserFunctionFailure(bool threw, int status, 
+                                     const std::string& msg) {
+    if (threw)
+        SimTK_THROW1(Differentiator::UserFunctionThrewAnException, msg.c_str());
+    SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
+}
+
 static void throwIfMethodInvalid(Differentiator::Method m, const char* op) {
     if (!Differentiator::isValidMethod(m))
         SimTK_THROW3(Differentiator::UnknownMethodSpecified, (int)m,
@@ -120,7 +130,8 @@ public:
     DifferentiatorRep(Differentiator* handle,
                       const Differentiator::Function::FunctionRep&,
                       Differentiator::Method defaultMethod);
-    // default destructor, no default constructor, no copy or copy assign
+    ~DifferentiatorRep() {delete executor;}
+    // no default constructor, no copy or copy assign
 
     // This constant is the algorithm we'll use by default.
     static const Differentiator::Method DefaultDefaultMethod 
@@ -144,6 +155,44 @@ public:
         nDifferentiations = nDifferentiationFailures = nCallsToUserFunction = 0;
     }
 
+    void setUseParallel(bool useParallel, int numThreads);
+    void setJacobianSparsityPattern(const Array_< Array_<int> >& rowsByColumn);
+    void clearJacobianSparsityPattern()
+    {   sparsityPattern.clear(); columnGroups.clear(); }
+
+    // Calculate the perturbation to use for each parameter.
+    void calcPerturbations(int order, const Vector& y0) const;
+
+    // A work item perturbs one gradient element or Jacobian column, or one
+    // group of Jacobian columns if we have a sparsity pattern. This returns
+    // the parameters perturbed by item k; "one" is used for single columns.
+    const Array_<int>& getItemColumns(bool grouped, int k, 
+                                      Array_<int>& one) const
+    {   if (grouped) return columnGroups[k]; one[0]=k; return one; }
+
+    // Set parameters cols of y to y0 + sign*h.
+    void perturb(const Array_<int>& cols, const Vector& y0, Real sign,
+                 Vector& y) const
+    {   for (unsigned c=0; c < cols.size(); ++c)
+            y[cols[c]] = y0[cols[c]] + sign*htmp[cols[c]]; }
+
+    // Fill in the Jacobian columns cols given the function values with those
+    // parameters perturbed by +h (fyp) and -h (fym, central difference only).
+    void storeJacobianColumns(const Array_<int>& cols, int order, 
+                              const Vector& fy0, const Vector& fyp,
+                              const Vector& fym, Matrix& dfdy) const;
+
+    // Return true if we should make the nItems perturbed calls to f on worker
+    // threads.
+    bool shouldUseParallel(const Function::FunctionRep& f, int nItems) const;
+
+    // Make all the perturbed calls to f on worker threads, leaving the 
+    // results in workFyp and workFym. Statistics are updated and the first
+    // failure (if any) is thrown here, in item order.
+    template <class F>
+    void calcPerturbedValuesInParallel(const F& f, int order, bool grouped,
+                                       const Vector& y0, int nItems) const;
+
     // Statistics
     mutable int nDifferentiations; 
     mutable int nDifferentiationFailures; 
@@ -167,11 +216,25 @@ private:
     // upon construction.
     const Real AccFac1, AccFac2;
 
+    // Parallel evaluation; executor is null if we're running serially. The
+    // executor isn't reentrant, but it needs no lock: like the workspace 
+    // below, it may only be used by one thread at a time (see the class doc).
+    ParallelExecutor* executor;
+
+    // If the user gave us a Jacobian sparsity pattern, this is the list of
+    // possibly nonzero rows for each column, and the columns are partitioned
+    // into groups that have no rows in common. Both are empty otherwise.
+    Array_< Array_<int> > sparsityPattern; // [NParameters]
+    Array_< Array_<int> > columnGroups;
+
     // These temporaries are kept here so we can reuse their storage space
     // from call to call once they have been allocated at construction. 
     // The *values* do not persist across calls.
     mutable Vector ytmp;           // [NParameters]
+    mutable Vector htmp;           // [NParameters]
     mutable Vector fyptmp, fymtmp; // [NFunctions]
+    // Perturbed function values for each work item when running in parallel.
+    mutable Array_<Vector> workFyp, workFym;
 
     // suppress
     DifferentiatorRep(const DifferentiatorRep&);
@@ -186,7 +249,7 @@ class Differentiator::Function::FunctionRep {
     friend class Differentiator::Function;
 public:
     FunctionRep(int nf, int np, Real acc)
-      : nFunc(nf), nParam(np), estimatedAccuracy(acc)
+      : nFunc(nf), nParam(np), estimatedAccuracy(acc), threadSafe(false)
     {
         if (estimatedAccuracy < 0) // use default
             estimatedAccuracy = SignificantReal; // ~1e-14 in double
@@ -217,10 +280,15 @@ public:
         return estimatedAccuracy;
     }
 
+    bool isThreadSafe() const {return threadSafe;}
+
     void resetAllStatistics() {
         nCalls = nFailures = 0;
     }
 
+    // Count a call that was made with tryCall().
+    void countCall(bool failed) const {++nCalls; if (failed) ++nFailures;}
+
 protected:
     // Stats
     mutable int nCalls;
@@ -229,6 +297,7 @@ protected:
 private:
     int  nFunc, nParam;
     Real estimatedAccuracy;
+    bool threadSafe;
 
 };
 
@@ -343,19 +412,32 @@ public:
         nCalls++;
         nFailures++; // assume failure unless proven otherwise
 
-        int status;
+        bool threw; std::string msg;
+        const int status = tryCall(y, fy, threw, msg);
+        if (threw || status != 0)
+            throwUserFunctionFailure(threw, status, msg);
+
+        --nFailures;
+    }
+
+    // Call the user function without counting the call or throwing, so that
+    // this can be used from a worker thread. If the function threw an 
+    // exception, threw is set and its message is returned in msg.
+    int tryCall(const Vector& y, Real& fy, bool& threw, std::string& msg) const {
+        threw = false;
         try 
-          { status = gf.f(y,fy); } 
+          { return gf.f(y,fy); } 
         catch (const std::exception& e)
-          { SimTK_THROW1(Differentiator::UserFunctionThrewAnException, e.what()); }
+          { msg = e.what(); }
         catch (...)
-          { SimTK_THROW1(Differentiator::UserFunctionThrewAnException, 
-                         "UNRECOGNIZED EXCEPTION TYPE"); }
-
-        if (status != 0)
-            SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
-
-        --nFailures;
+          { msg = "UNRECOGNIZED EXCEPTION TYPE"; }
+        threw = true;
+        return -1;
+    }
+    // Same, with the function value returned as a 1-element Vector.
+    int tryCall(const Vector& y, Vector& fy, bool& threw, std::string& msg) const {
+        fy.resize(1);
+        return tryCall(y, fy[0], threw, msg);
     }
 
     const Differentiator::GradientFunction&       gf;
@@ -413,19 +495,27 @@ public:
         nCalls++;
         nFailures++; // assume failure unless proven otherwise
 
-        int status;
+        bool threw; std::string msg;
+        const int status = tryCall(y, fy, threw, msg);
+        if (threw || status != 0)
+            throwUserFunctionFailure(threw, status, msg);
+
+        nFailures--;
+    }
+
+    // Call the user function without counting the call or throwing, so that
+    // this can be used from a worker thread. If the function threw an 
+    // exception, threw is set and its message is returned in msg.
+    int tryCall(const Vector& y, Vector& fy, bool& threw, std::string& msg) const {
+        threw = false;
         try 
-          { status = jf.f(y,fy); } 
+          { return jf.f(y,fy); } 
         catch (const std::exception& e)
-          { SimTK_THROW1(Differentiator::UserFunctionThrewAnException, e.what()); }
+          { msg = e.what(); }
         catch (...)
-          { SimTK_THROW1(Differentiator::UserFunctionThrewAnException, 
-                         "UNRECOGNIZED EXCEPTION TYPE"); }
-
-        if (status != 0)
-            SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
-
-        nFailures--;
+          { msg = "UNRECOGNIZED EXCEPTION TYPE"; }
+        threw = true;
+        return -1;
     }
 
     const Differentiator::JacobianFunction&       jf;
@@ -545,6 +635,32 @@ Matrix Differentiator::calcJacobian
     return dfdy;
 }
 
+void Differentiator::setUseParallel(bool useParallel, int numThreads) {
+    rep->setUseParallel(useParallel, numThreads);
+}
+
+bool Differentiator::getUseParallel() const {
+    return rep->executor != 0;
+}
+
+void Differentiator::setJacobianSparsityPattern
+   (const Array_< Array_<int> >& nonzeroRowsByColumn) {
+    rep->setJacobianSparsityPattern(nonzeroRowsByColumn);
+}
+
+void Differentiator::clearJacobianSparsityPattern() {
+    rep->clearJacobianSparsityPattern();
+}
+
+bool Differentiator::hasJacobianSparsityPattern() const {
+    return !rep->sparsityPattern.empty();
+}
+
+int Differentiator::getNumJacobianColumnGroups() const {
+    return hasJacobianSparsityPattern() ? (int)rep->columnGroups.size()
+                                        : rep->NParameters;
+}
+
 void Differentiator::resetAllStatistics() {
     rep->resetAllStatistics();
 }
@@ -647,6 +763,15 @@ Real Differentiator::Function::getEstimatedAccuracy() const {
     return rep->estimatedAccuracy;
 }
 
+Differentiator::Function& 
+Differentiator::Function::setIsThreadSafe(bool threadSafe) {
+    rep->threadSafe = threadSafe;
+    return *this;
+}
+bool Differentiator::Function::isThreadSafe() const {
+    return rep->threadSafe;
+}
+
 void Differentiator::Function::resetAllStatistics(){
     rep->resetAllStatistics();
 }
@@ -687,13 +812,15 @@ Differentiator::DifferentiatorRep::DifferentiatorRep
     EstimatedAccuracy(fr.getEstimatedAccuracy()),
     defaultMethod(getMethodOrThrow(defMthd, DefaultDefaultMethod, "Differentiator")),
     AccFac1(std::sqrt(EstimatedAccuracy)),
-    AccFac2(std::pow(EstimatedAccuracy, OneThird))
+    AccFac2(std::pow(EstimatedAccuracy, OneThird)),
+    executor(0)
 {
     //TODO
     assert(NParameters >= 0 && NFunctions >= 0 && EstimatedAccuracy > 0);
 
     resetAllStatistics();
     ytmp.resize(NParameters);
+    htmp.resize(NParameters);
     fyptmp.resize(NFunctions);
     fymtmp.resize(NFunctions);
 }
@@ -736,9 +863,19 @@ void Differentiator::DifferentiatorRep::calcGradient
 
     gradf.resize(NParameters);
 
-    ytmp = y0;
     const int order = Differentiator::getMethodOrder(method);
 
+    if (shouldUseParallel(f, NParameters)) {
+        calcPerturbations(order, y0);
+        calcPerturbedValuesInParallel(f, order, false, y0, NParameters);
+        for (int i=0; i < NParameters; ++i) {
+            if (order==1) gradf[i] = (workFyp[i][0]-fy0)/htmp[i];
+            else gradf[i] = (workFyp[i][0]-workFym[i][0])/(2*htmp[i]);
+        }
+        return;
+    }
+
+    ytmp = y0;
     for (int i=0; i < f.getNumParameters(); ++i) {
         const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
         const Real h = cleanUpH(hEst, y0[i]);
@@ -771,22 +908,202 @@ void Differentiator::DifferentiatorRep::calcJacobian
     dfdy.resize(NFunctions,NParameters);
 
     const int order = Differentiator::getMethodOrder(method);
+    calcPerturbations(order, y0);
+
+    // With a sparsity pattern we perturb groups of columns at once and
+    // fill in only the entries that can be nonzero.
+    const bool grouped = !columnGroups.empty();
+    const int  nItems  = grouped ? (int)columnGroups.size() : NParameters;
+    if (grouped) dfdy = 0;
+
+    Array_<int> one(1);
+    if (shouldUseParallel(f, nItems)) {
+        calcPerturbedValuesInParallel(f, order, grouped, y0, nItems);
+        for (int k=0; k < nItems; ++k)
+            storeJacobianColumns(getItemColumns(grouped, k, one), order, fy0,
+                                 workFyp[k], order==2 ? workFym[k] : fymtmp,
+                                 dfdy);
+        return;
+    }
 
     ytmp = y0;
-    for (int i=0; i < NParameters; ++i) {
-        const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
-        const Real h = cleanUpH(hEst, y0[i]);
-        ytmp[i] = y0[i]+h; 
+    for (int k=0; k < nItems; ++k) {
+        const Array_<int>& cols = getItemColumns(grouped, k, one);
+        perturb(cols, y0, 1, ytmp);
         nCallsToUserFunction++; f.call(ytmp, fyptmp);
-        if (order==1) {
-            dfdy(i) = (fyptmp-fy0)/h;
-        } else {
-            ytmp[i] = y0[i]-h; 
+        if (order==2) {
+            perturb(cols, y0, -1, ytmp);
             nCallsToUserFunction++; f.call(ytmp, fymtmp);
-            dfdy(i) = (fyptmp-fymtmp)/(2*h);
         }
-        ytmp[i] = y0[i]; // restore
+        storeJacobianColumns(cols, order, fy0, fyptmp, fymtmp, dfdy);
+        perturb(cols, y0, 0, ytmp); // restore
+    }
+}
+
+void Differentiator::DifferentiatorRep::calcPerturbations
+   (int order, const Vector& y0) const 
+{
+    for (int i=0; i < NParameters; ++i) {
+        const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
+        htmp[i] = cleanUpH(hEst, y0[i]);
+    }
+}
+
+void Differentiator::DifferentiatorRep::storeJacobianColumns
+   (const Array_<int>& cols, int order, const Vector& fy0, const Vector& fyp,
+    const Vector& fym, Matrix& dfdy) const 
+{
+    for (unsigned c=0; c < cols.size(); ++c) {
+        const int  i = cols[c];
+        const Real h = htmp[i];
+        if (sparsityPattern.empty()) {
+            if (order==1) dfdy(i) = (fyp-fy0)/h;
+            else dfdy(i) = (fyp-fym)/(2*h);
+            continue;
+        }
+        // Vector division scales by the reciprocal; do the same here so
+        // we get exactly the dense result for the nonzero entries.
+        const Array_<int>& rows = sparsityPattern[i];
+        const Real scale = order==1 ? 1/h : 1/(2*h);
+        for (unsigned r=0; r < rows.size(); ++r) {
+            const int j = rows[r];
+            if (order==1) dfdy(j,i) = (fyp[j]-fy0[j])*scale;
+            else dfdy(j,i) = (fyp[j]-fym[j])*scale;
+        }
+    }
+}
+
+void Differentiator::DifferentiatorRep::setUseParallel
+   (bool useParallel, int numThreads) 
+{
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "Differentiator", "setUseParallel",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete executor;
+    executor = 0;
+    if (useParallel && numThreads > 1)
+        executor = new ParallelExecutor(numThreads);
+}
+
+bool Differentiator::DifferentiatorRep::shouldUseParallel
+   (const Function::FunctionRep& f, int nItems) const
+{
+    return executor && f.isThreadSafe() && nItems > 1 
+        && !ParallelExecutor::isWorkerThread();
+}
+
+// Partition the columns greedily, in order, into groups whose nonzero rows
+// don't overlap; each column goes into the first group it fits.
+void Differentiator::DifferentiatorRep::setJacobianSparsityPattern
+   (const Array_< Array_<int> >& rowsByColumn) 
+{
+    SimTK_APIARGCHECK2_ALWAYS((int)rowsByColumn.size()==NParameters, 
+        "Differentiator", "setJacobianSparsityPattern",
+        "Expecting a list of rows for each of the %d parameters but got %d", 
+        NParameters, (int)rowsByColumn.size());
+
+    Array_< Array_<bool> > rowUsedByGroup; // [group][row]
+    columnGroups.clear();
+    for (int i=0; i < NParameters; ++i) {
+        const Array_<int>& rows = rowsByColumn[i];
+        for (unsigned r=0; r < rows.size(); ++r)
+            SimTK_APIARGCHECK3_ALWAYS(0 <= rows[r] && rows[r] < NFunctions, 
+                "Differentiator", "setJacobianSparsityPattern",
+                "Row %d for column %d is out of range; there are %d functions",
+                rows[r], i, NFunctions);
+
+        unsigned g = 0;
+        for (; g < columnGroups.size(); ++g) {
+            unsigned r = 0;
+            while (r < rows.size() && !rowUsedByGroup[g][rows[r]]) ++r;
+            if (r == rows.size()) break; // fits in this group
+        }
+        if (g == columnGroups.size()) {
+            columnGroups.push_back();
+            rowUsedByGroup.push_back(Array_<bool>(NFunctions, false));
+        }
+        columnGroups[g].push_back(i);
+        for (unsigned r=0; r < rows.size(); ++r)
+            rowUsedByGroup[g][rows[r]] = true;
     }
+    sparsityPattern = rowsByColumn;
+}
+
+namespace {
+
+// Make the perturbed calls to the user function for each work item, with no
+// side effects other than filling in the item's function values. Failures 
+// are recorded so they can be reported after all the threads are done.
+template <class F>
+class PerturbedCallsTask : public ParallelExecutor::Task {
+public:
+    PerturbedCallsTask(const Differentiator::DifferentiatorRep& diff,
+                       const F& f, int order, bool grouped, const Vector& y0,
+                       Array_<Vector>& fyp, Array_<Vector>& fym)
+    :   diff(diff), f(f), order(order), grouped(grouped), y0(y0), 
+        fyp(fyp), fym(fym), numCalls(fyp.size(), 0), 
+        status(fyp.size(), 0), threw(fyp.size(), false), 
+        messages(fyp.size()) {}
+
+    void execute(int k) OVERRIDE_11 {
+        Array_<int> one(1);
+        const Array_<int>& cols = diff.getItemColumns(grouped, k, one);
+        Vector y(y0);
+        for (int pass=0; pass < order; ++pass) {
+            diff.perturb(cols, y0, pass==0 ? Real(1) : Real(-1), y);
+            ++numCalls[k];
+            bool failed; 
+            status[k] = f.tryCall(y, pass==0 ? fyp[k] : fym[k], 
+                                  failed, messages[k]);
+            threw[k] = failed;
+            if (failed || status[k] != 0)
+                return;
+        }
+    }
+
+    // Count the calls in item order and throw the first failure, if any.
+    void countCallsAndRethrowFirstFailure(int& nCallsToUserFunction) const {
+        for (unsigned k=0; k < numCalls.size(); ++k) {
+            const bool failed = threw[k] || status[k] != 0;
+            nCallsToUserFunction += numCalls[k];
+            for (int c=0; c < numCalls[k]; ++c)
+                f.countCall(failed && c==numCalls[k]-1);
+        }
+        for (unsigned k=0; k < numCalls.size(); ++k)
+            if (threw[k] || status[k] != 0)
+                throwUserFunctionFailure(threw[k], status[k], messages[k]);
+    }
+private:
+    const Differentiator::DifferentiatorRep&    diff;
+    const F&                                    f;
+    const int                                   order;
+    const bool                                  grouped;
+    const Vector&                               y0;
+    Array_<Vector>&                             fyp;
+    Array_<Vector>&                             fym;
+    Array_<int>                                 numCalls;
+    Array_<int>                                 status;
+    Array_<bool>                                threw;
+    Array_<std::string>                         messages;
+};
+
+}
+
+template <class F>
+void Differentiator::DifferentiatorRep::calcPerturbedValuesInParallel
+   (const F& f, int order, bool grouped, const Vector& y0, int nItems) const
+{
+    workFyp.resize(nItems);
+    workFym.resize(order==2 ? nItems : 0);
+    for (int k=0; k < nItems; ++k) {
+        workFyp[k].resize(NFunctions);
+        if (order==2) workFym[k].resize(NFunctions);
+    }
+
+    PerturbedCallsTask<F> task(*this, f, order, grouped, y0, workFyp, workFym);
+    executor->execute(task, nItems);
+    task.countCallsAndRethrowFirstFailure(nCallsToUserFunction);
 }
 
 } // namespace SimTK
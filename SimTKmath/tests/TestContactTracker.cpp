@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+using namespace std;
+
+static const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                        ContactSurfaceIndex(1));
+
+// Random pose for shape 2 that puts its center about dist away from shape 1's.
+static Transform randomPose(Random::Uniform& random, Real dist) {
+    const Vec3 dir(random.getValue(), random.getValue(), random.getValue());
+    const Rotation R(2*Pi*random.getValue(), 
+        UnitVec3(random.getValue(), random.getValue(), random.getValue()));
+    return Transform(R, (dist*(1+.2*random.getValue()))*UnitVec3(dir));
+}
+
+// Check that two trackers agree on whether there is contact and, if so, on
+// the depth, the contact normal, and the contact frame origin.
+static void compareContacts(const Contact& c1, const Contact& c2, Real tol) {
+    SimTK_TEST(c1.isEmpty() == c2.isEmpty());
+    if (c1.isEmpty() || c2.isEmpty()) 
+        return;
+    const EllipticalPointContact& e1 = EllipticalPointContact::getAs(c1);
+    const EllipticalPointContact& e2 = EllipticalPointContact::getAs(c2);
+    SimTK_TEST_EQ_TOL(e1.getDepth(), e2.getDepth(), tol);
+    SimTK_TEST_EQ_TOL(e1.getContactFrame().z(), e2.getContactFrame().z(), tol);
+    SimTK_TEST_EQ_TOL(e1.getContactFrame().p(), e2.getContactFrame().p(), tol);
+    SimTK_TEST_EQ_TOL(e1.getCurvatures(), e2.getCurvatures(), 1e3*tol);
+}
+
+// The support function tracker should find the same contacts as the implicit 
+// function tracker, whether or not it is given a prior contact to start from.
+static void testConvexPair(const ContactGeometry& shape1, 
+                           const ContactGeometry& shape2, Real dist) {
+    const ContactGeometryTypeId id1 = shape1.getTypeId();
+    const ContactGeometryTypeId id2 = shape2.getTypeId();
+    const ContactTracker::ConvexImplicitPair implicitPair(id1, id2);
+    const ContactTracker::ConvexSupportPair  supportPair(id1, id2);
+
+    Random::Uniform random(-1, 1); random.setSeed(17);
+    int nContacts = 0;
+    for (int i=0; i < 200; ++i) {
+        const Transform X_GS1 = randomPose(random, .1);
+        const Transform X_GS2 = randomPose(random, dist);
+        Contact implicitContact, supportContact;
+        implicitPair.trackContact(untracked, X_GS1, shape1, X_GS2, shape2, 
+                                  0, implicitContact);
+        supportPair.trackContact(untracked, X_GS1, shape1, X_GS2, shape2, 
+                                 0, supportContact);
+        compareContacts(implicitContact, supportContact, 1e-8);
+        if (supportContact.isEmpty())
+            continue;
+        ++nContacts;
+
+        // Move shape 2 a little; a warm start must give the same answer
+        // as a cold one. That's only true for modest penetrations; a deep
+        // overlap can have more than one local minimum depth and the warm
+        // start is supposed to keep following the one it had.
+        if (EllipticalPointContact::getAs(supportContact).getDepth() > .1)
+            continue;
+        const Transform X_GS2b(
+            X_GS2.R()*Rotation(.02, UnitVec3(1,1,0)), X_GS2.p()*.995);
+        Contact cold, warm;
+        supportPair.trackContact(untracked, X_GS1, shape1, X_GS2b, shape2, 
+                                 0, cold);
+        supportPair.trackContact(supportContact, X_GS1, shape1, X_GS2b, shape2,
+                                 0, warm);
+        compareContacts(cold, warm, 1e-10);
+    }
+    // Make sure we actually tested something.
+    SimTK_TEST(nContacts > 20 && nContacts < 180);
+}
+
+void testSphereEllipsoid() {
+    testConvexPair(ContactGeometry::Sphere(.5),
+                   ContactGeometry::Ellipsoid(Vec3(1,.7,.4)), 1.);
+}
+
+void testEllipsoidEllipsoid() {
+    testConvexPair(ContactGeometry::Ellipsoid(Vec3(1,.6,.5)),
+                   ContactGeometry::Ellipsoid(Vec3(.4,.8,.3)), 1.2);
+    // Something more eccentric.
+    testConvexPair(ContactGeometry::Ellipsoid(Vec3(2,.3,.2)),
+                   ContactGeometry::Ellipsoid(Vec3(.1,.5,1.5)), 1.2);
+}
+
+// Compare with the analytic sphere-sphere tracker.
+void testSphereSphere() {
+    const ContactGeometry::Sphere sphere1(1), sphere2(.5);
+    const ContactTracker::SphereSphere analytic;
+    const ContactTracker::ConvexSupportPair supportPair
+       (sphere1.getTypeId(), sphere2.getTypeId());
+    Random::Uniform random(-1, 1); random.setSeed(3);
+    for (int i=0; i < 50; ++i) {
+        const Transform X_GS2 = randomPose(random, 1.4);
+        Contact exact, approx;
+        analytic.trackContact(untracked, Transform(), sphere1, 
+                              X_GS2, sphere2, 0, exact);
+        supportPair.trackContact(untracked, Transform(), sphere1, 
+                                 X_GS2, sphere2, 0, approx);
+        SimTK_TEST(exact.isEmpty() == approx.isEmpty());
+        if (exact.isEmpty()) continue;
+        const CircularPointContact& c = CircularPointContact::getAs(exact);
+        const EllipticalPointContact& e = EllipticalPointContact::getAs(approx);
+        SimTK_TEST_EQ(c.getDepth(), e.getDepth());
+        SimTK_TEST_EQ(c.getNormal(), e.getContactFrame().z());
+        SimTK_TEST_EQ(c.getEffectiveRadius(), 1/e.getCurvatures()[0]);
+    }
+}
+
+// Shapes that are well apart must be reported as not in contact, and a stale
+// prior contact must not fool the tracker.
+void testSeparated() {
+    const ContactGeometry::Ellipsoid ellipsoid1(Vec3(1,.6,.5));
+    const ContactGeometry::Ellipsoid ellipsoid2(Vec3(.4,.8,.3));
+    const ContactTracker::ConvexSupportPair supportPair
+       (ellipsoid1.getTypeId(), ellipsoid2.getTypeId());
+
+    Contact touching, apart;
+    supportPair.trackContact(untracked, Transform(), ellipsoid1, 
+                             Vec3(1.3,0,0), ellipsoid2, 0, touching);
+    SimTK_TEST(EllipticalPointContact::isInstance(touching));
+    supportPair.trackContact(touching, Transform(), ellipsoid1, 
+                             Vec3(0,3,0), ellipsoid2, 0, apart);
+    SimTK_TEST(apart.isEmpty());
+}
+
+int main() {
+    SimTK_START_TEST("TestContactTracker");
+        SimTK_SUBTEST(testSphereEllipsoid);
+        SimTK_SUBTEST(testEllipsoidEllipsoid);
+        SimTK_SUBTEST(testSphereSphere);
+        SimTK_SUBTEST(testSeparated);
+    SimTK_END_TEST();
+}
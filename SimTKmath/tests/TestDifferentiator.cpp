@@ -0,0 +1,223 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test parallel and sparsity-pattern (column grouping) modes of the
+ * Differentiator against its ordinary serial, dense evaluation.
+ */
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <string>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+static const int N = 30;
+
+// A vector function with a tridiagonal Jacobian. It will fail if y[0] is
+// ever moved above failAbove.
+class Tridiagonal : public Differentiator::JacobianFunction {
+public:
+    Tridiagonal() : Differentiator::JacobianFunction(N,N),
+                    failAbove(Infinity) {}
+
+    int f(const Vector& y, Vector& fy) const OVERRIDE_11 {
+        if (y[0] > failAbove) return 7;
+        for (int i=0; i < N; ++i) {
+            fy[i] = std::sin(y[i])*std::exp(y[i]/3);
+            if (i > 0)   fy[i] += y[i-1]*y[i];
+            if (i < N-1) fy[i] += y[i+1]*y[i+1]*y[i+1];
+        }
+        return 0;
+    }
+
+    Real failAbove;
+};
+
+// A scalar function of a vector.
+class SumOfCubes : public Differentiator::GradientFunction {
+public:
+    SumOfCubes() : Differentiator::GradientFunction(N) {}
+
+    int f(const Vector& y, Real& fy) const OVERRIDE_11 {
+        fy = 0;
+        for (int i=0; i < N; ++i)
+            fy += y[i]*y[i]*y[i] + std::cos(y[i]);
+        return 0;
+    }
+};
+
+static Vector makeY() {
+    Vector y(N);
+    for (int i=0; i < N; ++i) y[i] = 1 + Real(i)/N;
+    return y;
+}
+
+static Array_< Array_<int> > tridiagonalPattern() {
+    Array_< Array_<int> > pattern(N);
+    for (int j=0; j < N; ++j)
+        for (int i=std::max(j-1,0); i <= std::min(j+1,N-1); ++i)
+            pattern[j].push_back(i);
+    return pattern;
+}
+
+void testFlags() {
+    Tridiagonal func;
+    Differentiator diff(func);
+
+    SimTK_TEST(!func.isThreadSafe());
+    func.setIsThreadSafe(true);
+    SimTK_TEST(func.isThreadSafe());
+
+    SimTK_TEST(!diff.getUseParallel());
+    diff.setUseParallel(true, 3);
+    SimTK_TEST(diff.getUseParallel());
+    diff.setUseParallel(true, 1); // one thread means serial
+    SimTK_TEST(!diff.getUseParallel());
+    SimTK_TEST_MUST_THROW(diff.setUseParallel(true, 0));
+
+    SimTK_TEST(!diff.hasJacobianSparsityPattern());
+    SimTK_TEST(diff.getNumJacobianColumnGroups() == N);
+    diff.setJacobianSparsityPattern(tridiagonalPattern());
+    SimTK_TEST(diff.hasJacobianSparsityPattern());
+    SimTK_TEST(diff.getNumJacobianColumnGroups() == 3);
+    diff.clearJacobianSparsityPattern();
+    SimTK_TEST(!diff.hasJacobianSparsityPattern());
+
+    // Wrong number of columns, or a row that's out of range.
+    SimTK_TEST_MUST_THROW(
+        diff.setJacobianSparsityPattern(Array_< Array_<int> >(N-1)));
+    Array_< Array_<int> > bad = tridiagonalPattern();
+    bad[3].push_back(N);
+    SimTK_TEST_MUST_THROW(diff.setJacobianSparsityPattern(bad));
+}
+
+// Parallel evaluation must give exactly the serial result, for each method.
+void testParallelMatchesSerial() {
+    Tridiagonal func; func.setIsThreadSafe(true);
+    SumOfCubes  sum;  sum.setIsThreadSafe(true);
+    Differentiator jac(func), grad(sum);
+    const Vector y0 = makeY();
+
+    for (int m=Differentiator::ForwardDifference;
+             m <= Differentiator::CentralDifference; ++m)
+    {
+        const Differentiator::Method method = Differentiator::Method(m);
+        jac.setUseParallel(false); grad.setUseParallel(false);
+        const Matrix serialJ = jac.calcJacobian(y0, method);
+        const Vector serialG = grad.calcGradient(y0, method);
+
+        jac.resetAllStatistics(); func.resetAllStatistics();
+        grad.resetAllStatistics();
+        // Use more threads than this machine might have so that work really
+        // is handed off to workers.
+        jac.setUseParallel(true, 4); grad.setUseParallel(true, 4);
+        const Matrix parallelJ = jac.calcJacobian(y0, method);
+        const Vector parallelG = grad.calcGradient(y0, method);
+
+        SimTK_TEST(parallelJ.nrow() == N && parallelJ.ncol() == N);
+        for (int j=0; j < N; ++j) {
+            SimTK_TEST(parallelG[j] == serialG[j]);
+            for (int i=0; i < N; ++i)
+                SimTK_TEST(parallelJ(i,j) == serialJ(i,j));
+        }
+
+        // One unperturbed call, then one (or two) per column.
+        SimTK_TEST(jac.getNumCallsToUserFunction() == 1 + m*N);
+        SimTK_TEST(func.getNumCalls() == 1 + m*N);
+        SimTK_TEST(func.getNumFailures() == 0);
+        SimTK_TEST(grad.getNumCallsToUserFunction() == 1 + m*N);
+    }
+
+    // A function that isn't declared thread safe is done serially, with the
+    // same answer.
+    Tridiagonal unsafe;
+    Differentiator unsafeJac(unsafe);
+    unsafeJac.setUseParallel(true, 4);
+    SimTK_TEST_EQ(unsafeJac.calcJacobian(y0), jac.calcJacobian(y0));
+}
+
+// With a sparsity pattern a tridiagonal Jacobian takes only three perturbed
+// evaluations per order, and each entry is exactly what we'd get from
+// perturbing its column alone since the other columns in its group don't
+// affect that row.
+void testSparsityPattern() {
+    Tridiagonal func; func.setIsThreadSafe(true);
+    Differentiator dense(func), sparse(func);
+    sparse.setJacobianSparsityPattern(tridiagonalPattern());
+    const Vector y0 = makeY();
+    Vector fy0(N); func.f(y0, fy0);
+
+    for (int pass=0; pass < 2; ++pass) {
+        if (pass == 1) sparse.setUseParallel(true, 4);
+        for (int m=Differentiator::ForwardDifference;
+                 m <= Differentiator::CentralDifference; ++m)
+        {
+            const Differentiator::Method method = Differentiator::Method(m);
+            Matrix denseJ, sparseJ(2,2); // wrong size; must get fixed
+            dense.calcJacobian(y0, fy0, denseJ, method);
+            sparse.resetAllStatistics();
+            sparse.calcJacobian(y0, fy0, sparseJ, method);
+            SimTK_TEST(sparse.getNumCallsToUserFunction() == 3*m);
+
+            SimTK_TEST(sparseJ.nrow() == N && sparseJ.ncol() == N);
+            for (int j=0; j < N; ++j)
+                for (int i=0; i < N; ++i) {
+                    SimTK_TEST(sparseJ(i,j) == denseJ(i,j));
+                    if (std::abs(i-j) > 1) SimTK_TEST(sparseJ(i,j) == 0);
+                }
+        }
+    }
+}
+
+// A failure in a worker thread is reported the same way as a serial one.
+void testParallelFailure() {
+    Tridiagonal func; func.setIsThreadSafe(true);
+    Differentiator diff(func);
+    diff.setUseParallel(true, 4);
+    const Vector y0 = makeY();
+    Vector fy0(N); func.f(y0, fy0);
+    Matrix J;
+
+    func.failAbove = y0[0]; // only perturbing column 0 fails
+    func.resetAllStatistics();
+    std::string msg;
+    try {diff.calcJacobian(y0, fy0, J);}
+    catch (const std::exception& e) {msg = e.what();}
+    SimTK_TEST(msg.find("non-zero status 7") != std::string::npos);
+    SimTK_TEST(func.getNumCalls() == N);
+    SimTK_TEST(func.getNumFailures() == 1);
+    SimTK_TEST(diff.getNumDifferentiationFailures() == 1);
+}
+
+int main() {
+    SimTK_START_TEST("TestDifferentiator");
+        SimTK_SUBTEST(testFlags);
+        SimTK_SUBTEST(testParallelMatchesSerial);
+        SimTK_SUBTEST(testSparsityPattern);
+        SimTK_SUBTEST(testParallelFailure);
+    SimTK_END_TEST();
+}
@@ -24,6 +24,8 @@
 #include "SimTKmath.h"
 #include <vector>
 #include <exception>
+#include <cstdio>
+#include <fstream>
 
 using namespace SimTK;
 using namespace std;
@@ -201,6 +203,90 @@ void testOBBTree() {
         SimTK_TEST(faceReferenceCount[i] == 1);
 }
 
+void compareOBBTrees(ContactGeometry::TriangleMesh::OBBTreeNode node1,
+                     ContactGeometry::TriangleMesh::OBBTreeNode node2) {
+    SimTK_TEST(node1.isLeafNode() == node2.isLeafNode());
+    SimTK_TEST(node1.getNumTriangles() == node2.getNumTriangles());
+    SimTK_TEST_EQ(node1.getBounds().getSize(), node2.getBounds().getSize());
+    SimTK_TEST_EQ(node1.getBounds().getTransform().p(), 
+                  node2.getBounds().getTransform().p());
+    SimTK_TEST_EQ(node1.getBounds().getTransform().R(), 
+                  node2.getBounds().getTransform().R());
+    if (node1.isLeafNode()) {
+        SimTK_TEST(node1.getTriangles() == node2.getTriangles());
+    }
+    else {
+        compareOBBTrees(node1.getFirstChildNode(), node2.getFirstChildNode());
+        compareOBBTrees(node1.getSecondChildNode(), node2.getSecondChildNode());
+    }
+}
+
+void testLargeOBBTree() {
+    // This is big enough that the tree is built in parallel pieces.
+    PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 5);
+    ContactGeometry::TriangleMesh mesh(sphere);
+    vector<int> faceReferenceCount(mesh.getNumFaces(), 0);
+    validateOBBTree(mesh, mesh.getOBBTreeNode(), mesh.getOBBTreeNode(), faceReferenceCount);
+    for (int i = 0; i < (int) faceReferenceCount.size(); i++)
+        SimTK_TEST(faceReferenceCount[i] == 1);
+
+    // A second mesh reuses the threads started for the first one.
+    ContactGeometry::TriangleMesh again(sphere);
+    compareOBBTrees(mesh.getOBBTreeNode(), again.getOBBTreeNode());
+}
+
+int countOBBNodes(ContactGeometry::TriangleMesh::OBBTreeNode node) {
+    if (node.isLeafNode())
+        return 1;
+    return 1 + countOBBNodes(node.getFirstChildNode()) 
+             + countOBBNodes(node.getSecondChildNode());
+}
+
+void testOBBTreeCacheFile() {
+    const String cacheFile = "TestTriangleMesh_obbtree.bin";
+    std::remove(cacheFile.c_str());
+    PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 4);
+    ContactGeometry::TriangleMesh built(sphere);
+
+    // The first time writes the file; the second reads it.
+    ContactGeometry::TriangleMesh written(sphere, false, cacheFile);
+    compareOBBTrees(built.getOBBTreeNode(), written.getOBBTreeNode());
+    std::ifstream check(cacheFile.c_str(), std::ios::binary | std::ios::ate);
+    SimTK_TEST(check.good());
+    // The file holds the header fields and the arrays, and nothing else; in
+    // particular no padding from the header struct.
+    const long long headerSize = 8 + 7*sizeof(int) + sizeof(unsigned long long);
+    const long long nodeSize   = 15*sizeof(Real) + 3*sizeof(int);
+    SimTK_TEST((long long)check.tellg() == headerSize 
+               + countOBBNodes(built.getOBBTreeNode())*nodeSize
+               + built.getNumFaces()*(long long)sizeof(int));
+    check.close();
+    ContactGeometry::TriangleMesh loaded(sphere, false, cacheFile);
+    compareOBBTrees(built.getOBBTreeNode(), loaded.getOBBTreeNode());
+    bool inside;
+    UnitVec3 normal;
+    const Vec3 p(.3, .7, -.2);
+    SimTK_TEST_EQ(loaded.findNearestPoint(p, inside, normal), 
+                  built.findNearestPoint(p, inside, normal));
+
+    // A different mesh must not use the cached tree; it gets rebuilt and 
+    // replaces the file.
+    PolygonalMesh moved = PolygonalMesh::createSphereMesh(1, 4);
+    moved.transformMesh(Transform(Vec3(.01, 0, 0)));
+    ContactGeometry::TriangleMesh movedBuilt(moved);
+    ContactGeometry::TriangleMesh movedCached(moved, false, cacheFile);
+    compareOBBTrees(movedBuilt.getOBBTreeNode(), movedCached.getOBBTreeNode());
+    ContactGeometry::TriangleMesh movedLoaded(moved, false, cacheFile);
+    compareOBBTrees(movedBuilt.getOBBTreeNode(), movedLoaded.getOBBTreeNode());
+
+    // A truncated file is ignored.
+    {   std::ofstream out(cacheFile.c_str(), std::ios::binary | std::ios::trunc);
+        out << "SimTKOBB";  }
+    ContactGeometry::TriangleMesh truncated(sphere, false, cacheFile);
+    compareOBBTrees(built.getOBBTreeNode(), truncated.getOBBTreeNode());
+    std::remove(cacheFile.c_str());
+}
+
 void testRayIntersection() {
     // Create an octrohedral mesh.
     
@@ -312,6 +398,8 @@ int main() {
         SimTK_SUBTEST(testTriangleMesh);
         SimTK_SUBTEST(testIncorrectMeshes);
         SimTK_SUBTEST(testOBBTree);
+        SimTK_SUBTEST(testLargeOBBTree);
+        SimTK_SUBTEST(testOBBTreeCacheFile);
         SimTK_SUBTEST(testRayIntersection);
         SimTK_SUBTEST(testSmoothMesh);
         SimTK_SUBTEST(testFindNearestPoint);
@@ -0,0 +1,109 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Compare the cost of the ContactTrackers that can handle pairs of smooth
+convex shapes, for sphere and ellipsoid pairs. One shape moves along a smooth
+path in and out of contact with the other; each tracker is run cold (no prior
+contact) and warm (given its own result from the previous step, as the
+ContactTrackerSubsystem does during a simulation). The ContactGeometry::Cylinder
+is infinite and has no support point so it can't take part here. */
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+
+using namespace SimTK;
+
+static const int NSteps = 20000;
+
+// Pose of shape 2 at step i; it orbits shape 1 while tumbling slowly, dipping
+// in and out of contact.
+static Transform pose(int i, Real dist) {
+    const Real t = Real(i)/NSteps * 2*Pi;
+    const Vec3 dir(std::cos(3*t), std::sin(3*t), .3*std::sin(7*t));
+    return Transform(Rotation(5*t, UnitVec3(1,2,3)),
+                     (dist + .1*std::sin(11*t))*UnitVec3(dir));
+}
+
+static void runOne(const char* name, const ContactTracker& tracker,
+                   const ContactGeometry& shape1, const ContactGeometry& shape2,
+                   Real dist, bool warm) 
+{
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    Contact prior = untracked, current;
+    int nContacts = 0; Real sumDepth = 0;
+    const double t0 = realTime();
+    for (int i=0; i < NSteps; ++i) {
+        tracker.trackContact(prior, Transform(), shape1, 
+                             pose(i, dist), shape2, 0, current);
+        if (current.isEmpty()) {
+            prior = untracked;
+            continue;
+        }
+        ++nContacts;
+        if (EllipticalPointContact::isInstance(current))
+            sumDepth += EllipticalPointContact::getAs(current).getDepth();
+        else if (CircularPointContact::isInstance(current))
+            sumDepth += CircularPointContact::getAs(current).getDepth();
+        if (warm) prior = current;
+    }
+    const double t = realTime() - t0;
+    std::printf("  %-22s %-5s %7.2fus  (%d contacts, sum depth %.12g)\n", 
+                name, warm ? "warm" : "cold", 1e6*t/NSteps, nContacts, sumDepth);
+}
+
+static void runPair(const char* title, 
+                    ContactGeometry shape1, ContactGeometry shape2, Real dist)
+{
+    std::printf("%s\n", title);
+    const ContactGeometryTypeId id1 = shape1.getTypeId();
+    const ContactGeometryTypeId id2 = shape2.getTypeId();
+    const ContactTracker::ConvexImplicitPair implicitPair(id1, id2);
+    const ContactTracker::ConvexSupportPair  supportPair(id1, id2);
+    for (int warm=0; warm <= 1; ++warm) {
+        if (id1 == ContactGeometry::Sphere::classTypeId() 
+            && id2 == ContactGeometry::Sphere::classTypeId())
+            runOne("SphereSphere", ContactTracker::SphereSphere(), 
+                   shape1, shape2, dist, warm!=0);
+        runOne("ConvexImplicitPair", implicitPair, shape1, shape2, dist, 
+               warm!=0);
+        runOne("ConvexSupportPair", supportPair, shape1, shape2, dist, 
+               warm!=0);
+    }
+}
+
+int main() {
+    try {
+        runPair("sphere-sphere", ContactGeometry::Sphere(1), 
+                ContactGeometry::Sphere(.5), 1.45);
+        runPair("sphere-ellipsoid", ContactGeometry::Sphere(.5), 
+                ContactGeometry::Ellipsoid(Vec3(1,.7,.4)), 1.1);
+        runPair("ellipsoid-ellipsoid", ContactGeometry::Ellipsoid(Vec3(1,.6,.5)), 
+                ContactGeometry::Ellipsoid(Vec3(.4,.8,.3)), 1.4);
+    } catch (const std::exception& e) {
+        std::printf("EXCEPTION THROWN: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
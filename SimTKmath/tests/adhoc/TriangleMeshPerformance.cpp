@@ -0,0 +1,111 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measure the cost of building a ContactGeometry::TriangleMesh, with and
+without a cached OBB tree file, and of the queries that traverse its oriented
+bounding box tree: nearest point, ray intersection, and mesh-mesh contact, for
+sphere meshes of increasing size. */
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+
+using namespace SimTK;
+
+static void runOne(int resolution, int nQueries, int nContacts) {
+    const PolygonalMesh poly = PolygonalMesh::createSphereMesh(1, resolution);
+
+    double t0 = realTime();
+    const ContactGeometry::TriangleMesh mesh(poly);
+    const double buildTime = realTime() - t0;
+
+    // Build once more to write the OBB tree cache file, then time loading.
+    const String cacheFile = "TriangleMeshPerformance_obbtree.bin";
+    std::remove(cacheFile.c_str());
+    { const ContactGeometry::TriangleMesh writer(poly, false, cacheFile); }
+    t0 = realTime();
+    const ContactGeometry::TriangleMesh cached(poly, false, cacheFile);
+    const double cachedTime = realTime() - t0;
+    std::remove(cacheFile.c_str());
+
+    Random::Uniform random(-1.5, 1.5); random.setSeed(5);
+    Array_<Vec3> points(nQueries);
+    for (int i=0; i < nQueries; ++i)
+        points[i] = Vec3(random.getValue(), random.getValue(), 
+                         random.getValue());
+
+    // Nearest point queries.
+    Real sum = 0;
+    t0 = realTime();
+    for (int i=0; i < nQueries; ++i) {
+        bool inside; UnitVec3 normal;
+        sum += mesh.findNearestPoint(points[i], inside, normal)[0];
+    }
+    const double nearestTime = realTime() - t0;
+
+    // Rays from outside toward random interior points.
+    int nHits = 0;
+    t0 = realTime();
+    for (int i=0; i < nQueries; ++i) {
+        const Vec3 origin = 3*UnitVec3(points[i]);
+        Real distance; UnitVec3 normal;
+        if (mesh.intersectsRay(origin, UnitVec3(.3*points[i]-origin), 
+                               distance, normal))
+            ++nHits;
+    }
+    const double rayTime = realTime() - t0;
+
+    // Two overlapping spheres.
+    const ContactTracker::TriangleMeshTriangleMesh tracker;
+    const UntrackedContact untracked(ContactSurfaceIndex(0), 
+                                     ContactSurfaceIndex(1));
+    int nFaces = 0;
+    t0 = realTime();
+    for (int i=0; i < nContacts; ++i) {
+        const Transform X_GS2(Rotation(.1*i, ZAxis), Vec3(1.8+.01*(i%10),0,0));
+        Contact contact;
+        tracker.trackContact(untracked, Transform(), mesh, 
+                             X_GS2, mesh, 0, contact);
+        if (TriangleMeshContact::isInstance(contact))
+            nFaces += (int)TriangleMeshContact::getAs(contact)
+                                                .getSurface1Faces().size();
+    }
+    const double contactTime = realTime() - t0;
+
+    std::printf("%7d faces: build %8.3fs  cached %8.3fs  nearest %7.2fus  ray %7.2fus  "
+                "mesh-mesh %8.3fms  (%g %d %d)\n", mesh.getNumFaces(), 
+                buildTime, cachedTime, 1e6*nearestTime/nQueries, 1e6*rayTime/nQueries,
+                1e3*contactTime/nContacts, sum, nHits, nFaces);
+}
+
+int main() {
+    try {
+        runOne(3,  100000, 200);
+        runOne(5,   20000, 50);
+        runOne(7,    5000, 10);
+    } catch (const std::exception& e) {
+        std::printf("EXCEPTION THROWN: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
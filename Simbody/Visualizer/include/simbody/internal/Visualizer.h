@@ -455,6 +455,28 @@ Real getActualBufferLengthInSec() const;
 /** Get the actual length of the real time frame buffer in number of frames. **/
 int getActualBufferLengthInFrames() const;
 
+/** Request that scenes be passed to the visualizer GUI through shared 
+memory rather than being written to the pipe that connects them. Only scenes
+go this way; everything else still uses the pipe. The GUI is given each 
+polygonal mesh only once, and when a scene has the same geometry as the one
+before it only the drawing commands that changed (typically just the 
+transforms of moving bodies) are sent. This reduces the copying and system 
+call overhead that limits the frame rate for large scenes. A scene is sent 
+through the pipe instead whenever the GUI is still busy with the shared 
+memory buffer, or the scene is too big for it. This is off by default, and is
+not available on Windows.
+@param[in]      useSharedMemory
+    Set true to use shared memory when possible, false to send everything
+    through the pipe.
+@return A reference to this Visualizer so that you can chain "set" calls.
+@see getUseSharedMemoryTransport() **/
+Visualizer& setUseSharedMemoryTransport(bool useSharedMemory);
+/** Return true if scenes are being passed to the GUI through shared memory.
+This will be false if it was never requested, or if it was requested but 
+couldn't be set up on this platform. 
+@see setUseSharedMemoryTransport() **/
+bool getUseSharedMemoryTransport() const;
+
 /** Add a new input listener to this Visualizer, methods of which will be
 called when the GUI detects user-driven events like key presses, menu picks, 
 and slider or mouse moves. See Visualizer::InputListener for more 
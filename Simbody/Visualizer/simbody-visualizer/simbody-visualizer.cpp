@@ -25,6 +25,7 @@
 #include "simbody/internal/Visualizer.h"
 #include "simbody/internal/Visualizer_InputListener.h"
 #include "../src/VisualizerProtocol.h"
+#include "../src/VisualizerSharedScene.h"
 #include "lodepng.h"
 
 #include <cstdlib>
@@ -63,6 +64,27 @@
     PFNGLBUFFERDATAPROC glBufferData;
     PFNGLACTIVETEXTUREPROC glActiveTexture;
 
+    // These are needed only for drawing predefined meshes as instances; we
+    // draw them one at a time if these aren't available.
+    PFNGLCREATESHADERPROC glCreateShader;
+    PFNGLSHADERSOURCEPROC glShaderSource;
+    PFNGLCOMPILESHADERPROC glCompileShader;
+    PFNGLGETSHADERIVPROC glGetShaderiv;
+    PFNGLCREATEPROGRAMPROC glCreateProgram;
+    PFNGLATTACHSHADERPROC glAttachShader;
+    PFNGLBINDATTRIBLOCATIONPROC glBindAttribLocation;
+    PFNGLLINKPROGRAMPROC glLinkProgram;
+    PFNGLGETPROGRAMIVPROC glGetProgramiv;
+    PFNGLUSEPROGRAMPROC glUseProgram;
+    PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
+    PFNGLUNIFORM1IPROC glUniform1i;
+    PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
+    PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
+    PFNGLVERTEXATTRIBDIVISORARBPROC glVertexAttribDivisorARB;
+    PFNGLDRAWELEMENTSINSTANCEDARBPROC glDrawElementsInstancedARB;
+    PFNGLDRAWARRAYSINSTANCEDARBPROC glDrawArraysInstancedARB;
+
     // These are needed only for saving images and movies.
     // Use old EXT names for these so we only require OpenGL 2.0.
     PFNGLGENFRAMEBUFFERSEXTPROC glGenFramebuffersEXT;
@@ -179,10 +201,7 @@ public:
         computeBoundingSphereForVertices(vertices, radius, center);
     }
     void draw(short representation) const {
-        glBindBuffer(GL_ARRAY_BUFFER, vertBuffer);
-        glVertexPointer(3, GL_FLOAT, 0, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, normBuffer);
-        glNormalPointer(GL_FLOAT, 0, 0);
+        bind();
         if (representation == DecorativeGeometry::DrawSurface)
             glDrawElements(GL_TRIANGLES, (GLsizei)faces.size(), GL_UNSIGNED_SHORT, &faces[0]);
         else if (representation == DecorativeGeometry::DrawPoints)
@@ -190,11 +209,29 @@ public:
         else if (representation == DecorativeGeometry::DrawWireframe)
             glDrawElements(GL_LINES, (GLsizei)edges.size(), GL_UNSIGNED_SHORT, &edges[0]);
     }
+    // Draw numInstances copies with one call; the caller must have set up
+    // the per-instance vertex attributes. See INSTANCED MESH RENDERING below.
+    void drawInstances(short representation, int numInstances) const {
+        bind();
+        if (representation == DecorativeGeometry::DrawSurface)
+            glDrawElementsInstancedARB(GL_TRIANGLES, (GLsizei)faces.size(), GL_UNSIGNED_SHORT, &faces[0], numInstances);
+        else if (representation == DecorativeGeometry::DrawPoints)
+            glDrawArraysInstancedARB(GL_POINTS, 0, numVertices, numInstances);
+        else if (representation == DecorativeGeometry::DrawWireframe)
+            glDrawElementsInstancedARB(GL_LINES, (GLsizei)edges.size(), GL_UNSIGNED_SHORT, &edges[0], numInstances);
+    }
     void getBoundingSphere(float& radius, fVec3& center) {
         radius = this->radius;
         center = this->center;
     }
 private:
+    void bind() const {
+        glBindBuffer(GL_ARRAY_BUFFER, vertBuffer);
+        glVertexPointer(3, GL_FLOAT, 0, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, normBuffer);
+        glNormalPointer(GL_FLOAT, 0, 0);
+    }
+
     int numVertices;
     GLuint vertBuffer, normBuffer;
     vector<GLushort> edges, faces;
@@ -231,6 +268,34 @@ public:
     const fTransform& getTransform() const {
         return transform;
     }
+    short getRepresentation() const {return representation;}
+    unsigned short getMeshIndex() const {return meshIndex;}
+    unsigned short getResolution() const {return resolution;}
+    // Instances of the same mesh, resolution, and representation can be
+    // drawn together with a single instanced draw call.
+    bool isSameMeshAs(const RenderedMesh& other) const {
+        return meshIndex == other.meshIndex && resolution == other.resolution
+            && representation == other.representation;
+    }
+    bool operator<(const RenderedMesh& other) const {
+        if (meshIndex != other.meshIndex) return meshIndex < other.meshIndex;
+        if (resolution != other.resolution) return resolution < other.resolution;
+        return representation < other.representation;
+    }
+    // Append the per-instance data used by the instancing shader: the three
+    // rotation columns each with one scale factor in the fourth slot, the
+    // translation, and the color.
+    void appendInstanceData(vector<GLfloat>& data) const {
+        const fRotation& R = transform.R();
+        for (int c = 0; c < 3; c++) {
+            data.push_back(R[0][c]); data.push_back(R[1][c]); data.push_back(R[2][c]);
+            data.push_back(scale[c]);
+        }
+        for (int i = 0; i < 3; i++)
+            data.push_back(transform.p()[i]);
+        for (int i = 0; i < 4; i++)
+            data.push_back(color[i]);
+    }
     void computeBoundingSphere(float& radius, fVec3& center) const {
         meshes[meshIndex][resolution]->getBoundingSphere(radius, center);
         center += transform.p();
@@ -345,7 +410,21 @@ is signaled by the renderer when it finishes drawing the front scene. */
 // This object holds a scene. There are at most two of these around.
 class Scene {
 public:
-    Scene() : simTime(0), sceneHasBeenDrawn(false) {}
+    Scene() : simTime(0), instanceDataLoaded(false), sceneHasBeenDrawn(false) {}
+
+    // Call this once the scene is complete. The opaque meshes are sorted so
+    // that identical meshes are adjacent and can be drawn as instances, and
+    // the per-instance data is gathered for drawnMeshes followed by
+    // solidMeshes. This doesn't use OpenGL so may be done by the listener.
+    void prepareInstances() {
+        sort(drawnMeshes.begin(), drawnMeshes.end());
+        sort(solidMeshes.begin(), solidMeshes.end());
+        instanceData.clear();
+        for (int i = 0; i < (int) drawnMeshes.size(); i++)
+            drawnMeshes[i].appendInstanceData(instanceData);
+        for (int i = 0; i < (int) solidMeshes.size(); i++)
+            solidMeshes[i].appendInstanceData(instanceData);
+    }
 
     float simTime; // simulated time associated with this frame
 
@@ -356,6 +435,9 @@ public:
     vector<RenderedText> sceneText;
     vector<ScreenText>   screenText;
 
+    vector<GLfloat> instanceData;
+    bool instanceDataLoaded; // into the instance buffer, by the renderer
+
     bool sceneHasBeenDrawn;
 };
 
@@ -1212,6 +1294,186 @@ static Slider* findSliderById(int id) {
 
 
 
+/*==============================================================================
+                          INSTANCED MESH RENDERING
+================================================================================
+Scenes such as granular media or marker clouds can contain thousands of copies
+of the same predefined mesh (box, ellipsoid, cylinder). Drawing those one at a
+time makes the GUI CPU-bound, so when OpenGL supports instanced arrays we draw
+each run of identical predefined meshes with a single call. A scene's
+per-instance data (see RenderedMesh::appendInstanceData()) is loaded into one
+buffer the first time the scene is drawn, and a small vertex shader applies
+each instance's rotation, translation, scale and color, and reproduces the
+fixed-function lighting used otherwise. If instancing isn't available or the
+shader can't be built, meshes are drawn one at a time as before. Transparent
+meshes are always drawn individually since they have to be depth sorted. */
+
+// Generic vertex attribute locations for the per-instance data. We avoid
+// location 0 since it is an alias for the vertex position.
+enum {
+    InstanceRot0 = 1, InstanceRot1, InstanceRot2, InstancePos, InstanceColor
+};
+static const int InstanceStride = 19; // floats per instance
+
+// How the instancing shader should color the instances.
+enum InstanceColorMode {
+    UseCurrentColor     = 0, // for shadows
+    UseInstanceColor    = 1, // unlit points and wireframes
+    UseLitInstanceColor = 2  // surfaces
+};
+
+static bool useInstancing = false;
+static GLuint instanceProgram, instanceBuffer;
+static GLint instanceColorModeLocation;
+
+// The normal is transformed by the inverse transpose of the scale matrix.
+// We use the adjugate instead, with the determinant's sign, so that a zero
+// scale factor (a flattened shape) still works.
+static const char* instanceVertexShader =
+    "#version 120\n"
+    "attribute vec4 instanceRot0, instanceRot1, instanceRot2;\n"
+    "attribute vec3 instancePos;\n"
+    "attribute vec4 instanceColor;\n"
+    "uniform int colorMode;\n"
+    "void main() {\n"
+    "    vec3 scale = vec3(instanceRot0.w, instanceRot1.w, instanceRot2.w);\n"
+    "    mat3 R = mat3(instanceRot0.xyz, instanceRot1.xyz, instanceRot2.xyz);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix\n"
+    "                * vec4(R*(scale*gl_Vertex.xyz) + instancePos, 1.0);\n"
+    "    if (colorMode == 0)\n"
+    "        gl_FrontColor = gl_Color;\n"
+    "    else if (colorMode == 1)\n"
+    "        gl_FrontColor = vec4(instanceColor.rgb, 1.0);\n"
+    "    else {\n"
+    "        vec3 n = gl_Normal*scale.yzx*scale.zxy;\n"
+    "        if (scale.x*scale.y*scale.z < 0.0) n = -n;\n"
+    "        n = normalize(gl_NormalMatrix*(R*n));\n"
+    "        vec3 toLight = normalize(gl_LightSource[0].position.xyz);\n"
+    "        vec4 light = gl_LightModel.ambient + gl_LightSource[0].ambient\n"
+    "                   + max(dot(n, toLight), 0.0)*gl_LightSource[0].diffuse;\n"
+    "        gl_FrontColor = vec4(light.rgb*instanceColor.rgb, instanceColor.a);\n"
+    "    }\n"
+    "}\n";
+
+static const char* instanceFragmentShader =
+    "#version 120\n"
+    "void main() {\n"
+    "    gl_FragColor = gl_Color;\n"
+    "}\n";
+
+// Returns 0 if the shader doesn't compile.
+static GLuint compileInstanceShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    return status == GL_TRUE ? shader : 0;
+}
+
+// Call this once the OpenGL context exists. If instanced drawing can't be
+// used, useInstancing is left false.
+static void initInstancing() {
+#ifdef _WIN32
+    if (!(glCreateShader && glShaderSource && glCompileShader && glGetShaderiv
+          && glCreateProgram && glAttachShader && glBindAttribLocation
+          && glLinkProgram && glGetProgramiv && glUseProgram
+          && glGetUniformLocation && glUniform1i && glVertexAttribPointer
+          && glEnableVertexAttribArray && glDisableVertexAttribArray
+          && glVertexAttribDivisorARB && glDrawElementsInstancedARB
+          && glDrawArraysInstancedARB))
+        return;
+#endif
+    const char* extensions = (const char*) glGetString(GL_EXTENSIONS);
+    if (extensions == NULL
+        || strstr(extensions, "GL_ARB_instanced_arrays") == NULL
+        || strstr(extensions, "GL_ARB_draw_instanced") == NULL)
+        return;
+
+    GLuint vertexShader = compileInstanceShader(GL_VERTEX_SHADER, instanceVertexShader);
+    GLuint fragmentShader = compileInstanceShader(GL_FRAGMENT_SHADER, instanceFragmentShader);
+    if (vertexShader == 0 || fragmentShader == 0)
+        return;
+    instanceProgram = glCreateProgram();
+    glAttachShader(instanceProgram, vertexShader);
+    glAttachShader(instanceProgram, fragmentShader);
+    glBindAttribLocation(instanceProgram, InstanceRot0, "instanceRot0");
+    glBindAttribLocation(instanceProgram, InstanceRot1, "instanceRot1");
+    glBindAttribLocation(instanceProgram, InstanceRot2, "instanceRot2");
+    glBindAttribLocation(instanceProgram, InstancePos, "instancePos");
+    glBindAttribLocation(instanceProgram, InstanceColor, "instanceColor");
+    glLinkProgram(instanceProgram);
+    GLint status;
+    glGetProgramiv(instanceProgram, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+        return;
+    instanceColorModeLocation = glGetUniformLocation(instanceProgram, "colorMode");
+
+    glGenBuffers(1, &instanceBuffer);
+    // These attributes advance once per instance rather than per vertex.
+    for (GLuint i = InstanceRot0; i <= InstanceColor; i++)
+        glVertexAttribDivisorARB(i, 1);
+    useInstancing = true;
+}
+
+// Load the scene's per-instance data into the instance buffer unless that
+// has already been done. Caution -- make sure the scene is locked.
+static void loadInstanceData(Scene* scene) {
+    if (!useInstancing || scene->instanceDataLoaded)
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    if (!scene->instanceData.empty())
+        glBufferData(GL_ARRAY_BUFFER, scene->instanceData.size()*sizeof(GLfloat),
+                     &scene->instanceData[0], GL_STREAM_DRAW);
+    scene->instanceDataLoaded = true;
+}
+
+// Point the per-instance attributes at the given instance in the buffer.
+static void setInstanceAttributes(int firstInstance) {
+    const GLsizei stride = InstanceStride*sizeof(GLfloat);
+    const size_t base = (size_t) firstInstance*stride;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glVertexAttribPointer(InstanceRot0, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base));
+    glVertexAttribPointer(InstanceRot1, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base+4*sizeof(GLfloat)));
+    glVertexAttribPointer(InstanceRot2, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base+8*sizeof(GLfloat)));
+    glVertexAttribPointer(InstancePos, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base+12*sizeof(GLfloat)));
+    glVertexAttribPointer(InstanceColor, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base+15*sizeof(GLfloat)));
+}
+
+// Draw a list of opaque meshes that was sorted by Scene::prepareInstances().
+// firstInstance is the location of the first mesh in the scene's instance
+// data. Caution -- make sure the scene is locked and its instance data has
+// been loaded.
+static void drawMeshList(vector<RenderedMesh>& list, int firstInstance,
+                         InstanceColorMode colorMode) {
+    int start = 0;
+    while (start < (int) list.size()) {
+        int end = start+1;
+        while (end < (int) list.size() && list[end].isSameMeshAs(list[start]))
+            end++;
+        const RenderedMesh& first = list[start];
+        if (useInstancing && first.getMeshIndex() < NumPredefinedMeshes) {
+            glUseProgram(instanceProgram);
+            glUniform1i(instanceColorModeLocation, colorMode);
+            setInstanceAttributes(firstInstance+start);
+            for (GLuint i = InstanceRot0; i <= InstanceColor; i++)
+                glEnableVertexAttribArray(i);
+            meshes[first.getMeshIndex()][first.getResolution()]
+                ->drawInstances(first.getRepresentation(), end-start);
+            for (GLuint i = InstanceRot0; i <= InstanceColor; i++)
+                glDisableVertexAttribArray(i);
+            glUseProgram(0);
+        }
+        else {
+            for (int i = start; i < end; i++)
+                list[i].draw(colorMode != UseCurrentColor);
+        }
+        start = end;
+    }
+}
+
+
+
 /*==============================================================================
                              GROUND AND SKY
 ==============================================================================*/
@@ -1335,8 +1597,8 @@ static void drawGroundAndSky(float farClipDistance) {
         // mix light and dark shadows is much harder and any simple attempts
         // (e.g. put light shadows on top of dark ones) look terrible.
         glColor3f(0.3f, 0.2f, 0.0f);
-        for (int i = 0; i < (int) scene->solidMeshes.size(); i++)
-            scene->solidMeshes[i].draw(false);
+        drawMeshList(scene->solidMeshes, (int) scene->drawnMeshes.size(),
+                     UseCurrentColor);
         for (int i = 0; i < (int) scene->transparentMeshes.size(); i++)
             scene->transparentMeshes[i].draw(false);
         for (int i = 0; i < (int) scene->lines.size(); i++)
@@ -1412,6 +1674,7 @@ static void renderScene(std::vector<std::string>* screenText = NULL) {
             delete pendingCommands[i];
         }
         pendingCommands.clear();
+        loadInstanceData(scene);
 
         // Set up the viewpoint.
 
@@ -1459,11 +1722,10 @@ static void renderScene(std::vector<std::string>* screenText = NULL) {
             scene->sceneText[i].draw();
         glLineWidth(1);
         glEnableClientState(GL_NORMAL_ARRAY);
-        for (int i = 0; i < (int) scene->drawnMeshes.size(); i++)
-            scene->drawnMeshes[i].draw();
+        drawMeshList(scene->drawnMeshes, 0, UseInstanceColor);
         glEnable(GL_LIGHTING);
-        for (int i = 0; i < (int) scene->solidMeshes.size(); i++)
-            scene->solidMeshes[i].draw();
+        drawMeshList(scene->solidMeshes, (int) scene->drawnMeshes.size(),
+                     UseLitInstanceColor);
         glEnable(GL_BLEND);
         glDepthMask(GL_FALSE);
         vector<pair<float, int> > order(scene->transparentMeshes.size());
@@ -1990,10 +2252,24 @@ static void readDataFromPipe(int srcPipe, unsigned char* buffer, int bytes) {
     while (totalRead < bytes)
         totalRead += READ(srcPipe, buffer+totalRead, bytes-totalRead);
 }
+
+// When a scene arrives through shared memory we reassemble it here, in the
+// form it would have had in the pipe, and read it from there instead.
+static vector<unsigned char> sharedScene;
+static const unsigned char*  sharedSceneNext = NULL;
+
 static void readData(unsigned char* buffer, int bytes) {
+    if (sharedSceneNext) {
+        memcpy(buffer, sharedSceneNext, bytes);
+        sharedSceneNext += bytes;
+        return;
+    }
     readDataFromPipe(inPipe, buffer, bytes);
 }
 
+// The shared memory region set up by the simulator, if any.
+static VisualizerSharedScene sharedMemory;
+
 // We have just processed a StartOfScene command. Read in all the scene
 // elements until we see an EndOfScene command. We allocate a new Scene
 // object to hold the scene and return a pointer to it. Don't forget to
@@ -2197,6 +2473,7 @@ static Scene* readNewScene() {
         }
     }
 
+    newScene->prepareInstances();
     return newScene;
 }
 
@@ -2403,8 +2680,28 @@ void* listenForInput(void* args) {
             pthread_mutex_unlock(&sceneLock);   //------- UNLOCK SCENE -------
             break;
         }
-        case StartOfScene: {
-            Scene* newScene = readNewScene();
+        case UseSharedMemory: {
+            unsigned nameLength, bytes;
+            readData((unsigned char*)&nameLength, sizeof(unsigned));
+            vector<char> name(nameLength);
+            readData((unsigned char*)&name[0], nameLength);
+            readData((unsigned char*)&bytes, sizeof(unsigned));
+            sharedMemory.attach(string(name.begin(), name.end()), bytes);
+            break;
+        }
+
+        case StartOfScene:
+        case SceneInSharedMemory: {
+            Scene* newScene;
+            if (buffer[0] == StartOfScene)
+                newScene = readNewScene();
+            else {
+                readData(buffer, 1); // slot number
+                sharedMemory.readScene(buffer[0], sharedScene);
+                sharedSceneNext = &sharedScene[0];
+                newScene = readNewScene();
+                sharedSceneNext = NULL;
+            }
             pthread_mutex_lock(&sceneLock);     //------- LOCK SCENE ---------
             if (scene != NULL) {
                 while (!scene->sceneHasBeenDrawn) {
@@ -2463,6 +2760,7 @@ static void dumpAboutMessageToConsole() {
     printf(  "GLSL version: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
     printf(  "GL renderer:  %s\n", glGetString(GL_RENDERER));
     printf(  "GL vendor:    %s\n", glGetString(GL_VENDOR));
+    printf(  "Instanced drawing: %s\n", useInstancing ? "yes" : "no");
     printf("\nVisualizer authors: Peter Eastman, Michael Sherman\n");
     printf(  "Support: Simbios, Stanford Bioengineering, NIH U54 GM072970\n");
     printf(  "https://simtk.org/home/simbody\n");
@@ -2693,6 +2991,40 @@ static void shutdown() {
     exit(0);
 }
 
+// Set up the OpenGL state and mesh tables that drawing relies on. Call this
+// once the OpenGL context exists.
+static void initGLState() {
+    // Set up lighting.
+
+    GLfloat light_diffuse[]  = {0.8f, 0.8f, 0.8f, 1.0f};
+    GLfloat light_position[] = {1.0f, 1.0f, 1.0f, 0.0f};
+    GLfloat light_ambient[]  = {0.2f, 0.2f, 0.2f, 1.0f};
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
+    glLightfv(GL_LIGHT0, GL_POSITION, light_position);
+    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, light_ambient);
+    glClearColor(1, 1, 1, 1);
+    glEnable(GL_LIGHT0);
+
+    // Initialize miscellaneous OpenGL state.
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_NORMALIZE);
+
+    initInstancing();
+
+    // Make room for the predefined meshes.
+    meshes.resize(NumPredefinedMeshes);
+    // Note the first mesh index available for unique meshes
+    // that are sent to the GUI for caching.
+    nextMeshIndex = NumPredefinedMeshes;
+}
+
+// TestVisualizerInstancing compiles this file with its own main(), which 
+// renders without a window.
+#ifndef SimTK_VISUALIZER_OFFSCREEN_TEST
 int main(int argc, char** argv) {
   try
   { bool talkingToSimulator = false;
@@ -2765,30 +3097,7 @@ int main(int argc, char** argv) {
 
     setVsync(true);
 
-    // Set up lighting.
-
-    GLfloat light_diffuse[]  = {0.8f, 0.8f, 0.8f, 1.0f};
-    GLfloat light_position[] = {1.0f, 1.0f, 1.0f, 0.0f};
-    GLfloat light_ambient[]  = {0.2f, 0.2f, 0.2f, 1.0f};
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
-    glLightfv(GL_LIGHT0, GL_POSITION, light_position);
-    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, light_ambient);
-    glClearColor(1, 1, 1, 1);
-    glEnable(GL_LIGHT0);
-
-    // Initialize miscellaneous OpenGL state.
-
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_NORMAL_ARRAY);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_NORMALIZE);
-
-    // Make room for the predefined meshes.
-    meshes.resize(NumPredefinedMeshes);
-    // Note the first mesh index available for unique meshes
-    // that are sent to the GUI for caching.
-    nextMeshIndex = NumPredefinedMeshes;
+    initGLState();
 
     scene = NULL;
     pendingCommands.push_back(new PendingCameraZoom());
@@ -2840,6 +3149,7 @@ int main(int argc, char** argv) {
 
     return 0;
 }
+#endif // SimTK_VISUALIZER_OFFSCREEN_TEST
 
 
 // Initialize function pointers for Windows GL extensions.
@@ -2857,6 +3167,26 @@ static bool initGlextFuncPointersIfNeeded(bool& glCanSaveImages) {
     if (!(glGenBuffers && glBindBuffer && glBufferData && glActiveTexture))
         return false; // fatal error
 
+    // These are checked in initInstancing(); we can do without them.
+    glCreateShader  = (PFNGLCREATESHADERPROC) glutGetProcAddress("glCreateShader");
+    glShaderSource  = (PFNGLSHADERSOURCEPROC) glutGetProcAddress("glShaderSource");
+    glCompileShader = (PFNGLCOMPILESHADERPROC) glutGetProcAddress("glCompileShader");
+    glGetShaderiv   = (PFNGLGETSHADERIVPROC) glutGetProcAddress("glGetShaderiv");
+    glCreateProgram = (PFNGLCREATEPROGRAMPROC) glutGetProcAddress("glCreateProgram");
+    glAttachShader  = (PFNGLATTACHSHADERPROC) glutGetProcAddress("glAttachShader");
+    glBindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC) glutGetProcAddress("glBindAttribLocation");
+    glLinkProgram   = (PFNGLLINKPROGRAMPROC) glutGetProcAddress("glLinkProgram");
+    glGetProgramiv  = (PFNGLGETPROGRAMIVPROC) glutGetProcAddress("glGetProgramiv");
+    glUseProgram    = (PFNGLUSEPROGRAMPROC) glutGetProcAddress("glUseProgram");
+    glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC) glutGetProcAddress("glGetUniformLocation");
+    glUniform1i     = (PFNGLUNIFORM1IPROC) glutGetProcAddress("glUniform1i");
+    glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC) glutGetProcAddress("glVertexAttribPointer");
+    glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC) glutGetProcAddress("glEnableVertexAttribArray");
+    glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC) glutGetProcAddress("glDisableVertexAttribArray");
+    glVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) glutGetProcAddress("glVertexAttribDivisorARB");
+    glDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC) glutGetProcAddress("glDrawElementsInstancedARB");
+    glDrawArraysInstancedARB = (PFNGLDRAWARRAYSINSTANCEDARBPROC) glutGetProcAddress("glDrawArraysInstancedARB");
+
     // These are needed only when saving images or movies so the Visualizer can 
     // function without them.
 
@@ -914,6 +914,11 @@ const Visualizer& Visualizer::setShowSimTime(bool showSimTime) const
 const Visualizer& Visualizer::setShowFrameNumber(bool showFrameNumber) const 
 {   getImpl().m_protocol.setShowFrameNumber(showFrameNumber); return *this; }
 
+Visualizer& Visualizer::setUseSharedMemoryTransport(bool useSharedMemory) 
+{   updImpl().m_protocol.setUseSharedMemory(useSharedMemory); return *this; }
+bool Visualizer::getUseSharedMemoryTransport() const
+{   return getImpl().m_protocol.getUseSharedMemory(); }
+
 const Visualizer& Visualizer::setWindowTitle(const String& title) const 
 {   getImpl().m_protocol.setWindowTitle(title); return *this; }
 
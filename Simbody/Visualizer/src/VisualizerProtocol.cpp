@@ -43,6 +43,8 @@ using namespace std;
     #define READ _read
 #else
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
     #define READ read
 #endif
 
@@ -57,6 +59,10 @@ using namespace std;
 
 static int inPipe;
 
+// Capacity of each of the two scene slots in shared memory. Bigger scenes
+// are sent through the pipe.
+static const unsigned SharedSceneSlotBytes = 4*1024*1024;
+
 // Create a pipe, using the right call for this platform.
 static int createPipe(int pipeHandles[2]) {
     const int status =
@@ -191,6 +197,8 @@ static void* listenForVisualizerEvents(void* arg) {
 
 VisualizerProtocol::VisualizerProtocol
    (Visualizer& visualizer, const Array_<String>& userSearchPath) 
+:   sceneTime(0), havePrevScene(false), useSharedMemory(false), shared(0),
+    sharedBytes(0), nextSlot(0)
 {
     // Launch the GUI application. We'll first look for one in the same directory
     // as the running executable; then if that doesn't work we'll look in the
@@ -262,6 +270,15 @@ VisualizerProtocol::VisualizerProtocol
     pthread_create(&thread, NULL, listenForVisualizerEvents, &visualizer);
 }
 
+VisualizerProtocol::~VisualizerProtocol() {
+#ifndef _WIN32
+    if (shared) {
+        munmap(shared, sharedBytes);
+        shm_unlink(sharedName.c_str()); // in case the GUI never got it
+    }
+#endif
+}
+
 // This is executed on the main thread at GUI startup and thus does not
 // require locking.
 void VisualizerProtocol::shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe) {
@@ -321,18 +338,180 @@ void VisualizerProtocol::shutdownGUI() {
 
 void VisualizerProtocol::beginScene(Real time) {
     pthread_mutex_lock(&sceneLock);
-    char command = StartOfScene;
-    WRITE(outPipe, &command, 1);
-    float fTime = (float)time;
-    WRITE(outPipe, &fTime, sizeof(float));
+    sceneTime = (float)time;
+    sceneDefs.clear();
+    sceneDraw.clear();
+    sceneCommands.clear();
 }
 
 void VisualizerProtocol::finishScene() {
-    char command = EndOfScene;
-    WRITE(outPipe, &command, 1);
+    if (!(useSharedMemory && sendSceneThroughSharedMemory()))
+        sendSceneThroughPipe();
     pthread_mutex_unlock(&sceneLock);
 }
 
+void VisualizerProtocol::beginSceneCommand(const void* data, int bytes) {
+    sceneCommands.push_back((unsigned)sceneDraw.size());
+    addToScene(data, bytes);
+}
+
+// Send the whole scene with a single write.
+void VisualizerProtocol::sendSceneThroughPipe() {
+    pipeBuffer.clear();
+    pipeBuffer.push_back(StartOfScene);
+    const unsigned char* time = (const unsigned char*)&sceneTime;
+    pipeBuffer.insert(pipeBuffer.end(), time, time+sizeof(float));
+    pipeBuffer.insert(pipeBuffer.end(), sceneDefs.begin(), sceneDefs.end());
+    pipeBuffer.insert(pipeBuffer.end(), sceneDraw.begin(), sceneDraw.end());
+    pipeBuffer.push_back(EndOfScene);
+    WRITE(outPipe, &pipeBuffer[0], (int)pipeBuffer.size());
+
+    // The GUI's last shared memory scene is no longer the previous one.
+    havePrevScene = false;
+}
+
+namespace {
+// Fills in a shared memory slot, noting whether it would overflow.
+class SlotWriter {
+public:
+    SlotWriter(unsigned char* data, unsigned capacity)
+    :   data(data), capacity(capacity), size(0), overflow(false) {}
+    void put(const void* p, unsigned n) {
+        if (overflow || size+n > capacity) {overflow = true; return;}
+        memcpy(data+size, p, n); size += n;
+    }
+    void putUnsigned(unsigned u) {put(&u, sizeof(unsigned));}
+    bool overflowed() const {return overflow;}
+private:
+    unsigned char*  data;
+    unsigned        capacity, size;
+    bool            overflow;
+};
+
+unsigned getCommandLength(const std::vector<unsigned char>& draw,
+                          const std::vector<unsigned>& commands, unsigned i) {
+    const unsigned end = i+1 < commands.size() ? commands[i+1] 
+                                               : (unsigned)draw.size();
+    return end - commands[i];
+}
+}
+
+// Put this scene in the next shared memory slot, as a delta from the 
+// previous one if that's smaller, and tell the GUI where it is. Returns false
+// if the scene must go through the pipe instead.
+bool VisualizerProtocol::sendSceneThroughSharedMemory() {
+#ifdef _WIN32
+    return false;
+#else
+    if (!shared->attached)
+        return false; // GUI hasn't mapped the region yet
+    const int slot = nextSlot;
+    if (shared->slotBusy[slot])
+        return false; // GUI is still reading it; don't wait
+    __sync_synchronize();
+
+    // We can send only the changed commands if every command is the same
+    // kind and length as it was in the previous scene.
+    const unsigned n = (unsigned)sceneCommands.size();
+    bool canUseDelta = havePrevScene && prevCommands.size() == n;
+    unsigned deltaBytes = 0, numChanged = 0;
+    for (unsigned i=0; i < n && canUseDelta; ++i) {
+        const unsigned len = getCommandLength(sceneDraw, sceneCommands, i);
+        const unsigned char* now  = &sceneDraw[sceneCommands[i]];
+        const unsigned char* prev = &prevDraw[prevCommands[i]];
+        if (len != getCommandLength(prevDraw, prevCommands, i) 
+            || now[0] != prev[0])
+            canUseDelta = false;
+        else if (memcmp(now, prev, len) != 0) 
+        {   deltaBytes += sizeof(unsigned) + len; ++numChanged; }
+    }
+    const unsigned fullBytes = 
+        (unsigned)((n+2)*sizeof(unsigned) + sceneDraw.size());
+    const bool isDelta = canUseDelta && deltaBytes < fullBytes;
+
+    unsigned char* slotData = (unsigned char*)shared 
+                              + SharedSceneSlotOffset + slot*shared->slotBytes;
+    SlotWriter out(slotData, shared->slotBytes);
+    out.putUnsigned(isDelta);
+    out.put(&sceneTime, sizeof(float));
+    out.putUnsigned((unsigned)sceneDefs.size());
+    if (!sceneDefs.empty())
+        out.put(&sceneDefs[0], (unsigned)sceneDefs.size());
+    if (isDelta) {
+        out.putUnsigned(numChanged);
+        for (unsigned i=0; i < n; ++i) {
+            const unsigned len = getCommandLength(sceneDraw, sceneCommands, i);
+            const unsigned char* now  = &sceneDraw[sceneCommands[i]];
+            if (memcmp(now, &prevDraw[prevCommands[i]], len) == 0)
+                continue;
+            out.putUnsigned(i);
+            out.put(now, len);
+        }
+    } else {
+        out.putUnsigned(n);
+        out.putUnsigned((unsigned)sceneDraw.size());
+        if (n) {
+            out.put(&sceneCommands[0], n*sizeof(unsigned));
+            out.put(&sceneDraw[0], (unsigned)sceneDraw.size());
+        }
+    }
+    if (out.overflowed())
+        return false;
+
+    // Make sure the slot contents are visible before the GUI hears about them.
+    __sync_synchronize();
+    shared->slotBusy[slot] = 1;
+    const unsigned char command[2] = {SceneInSharedMemory, (unsigned char)slot};
+    WRITE(outPipe, command, 2);
+
+    nextSlot = 1-slot;
+    prevDraw.swap(sceneDraw);
+    prevCommands.swap(sceneCommands);
+    havePrevScene = true;
+    return true;
+#endif
+}
+
+// Create the shared memory region the first time it is requested, and tell
+// the GUI its name. The GUI will set the "attached" flag once it has it.
+bool VisualizerProtocol::setUseSharedMemory(bool use) {
+    pthread_mutex_lock(&sceneLock);
+#ifndef _WIN32
+    if (use && !shared) {
+        static int numRegions = 0;
+        char name[64];
+        sprintf(name, "/simbody-visualizer-%d-%d", (int)getpid(), numRegions++);
+        const unsigned bytes = SharedSceneSlotOffset + 2*SharedSceneSlotBytes;
+        const int fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, 0600);
+        void* region = MAP_FAILED;
+        if (fd != -1) {
+            if (ftruncate(fd, bytes) == 0)
+                region = mmap(0, bytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (region == MAP_FAILED)
+                shm_unlink(name);
+        }
+        if (region != MAP_FAILED) {
+            // The new region is zero filled.
+            shared      = (SharedSceneHeader*)region;
+            sharedBytes = bytes;
+            sharedName  = name;
+            shared->magic     = SharedSceneMagic;
+            shared->slotBytes = SharedSceneSlotBytes;
+
+            WRITE(outPipe, &UseSharedMemory, 1);
+            const unsigned nameLength = (unsigned)sharedName.size();
+            WRITE(outPipe, &nameLength, sizeof(unsigned));
+            WRITE(outPipe, sharedName.c_str(), nameLength);
+            WRITE(outPipe, &sharedBytes, sizeof(unsigned));
+        }
+    }
+#endif
+    useSharedMemory = use && shared;
+    pthread_mutex_unlock(&sceneLock);
+    return useSharedMemory == use;
+}
+
 void VisualizerProtocol::drawBox(const Transform& X_GB, const Vec3& scale, const Vec4& color, int representation) {
     drawMesh(X_GB, scale, color, (short) representation, MeshBox, 0);
 }
@@ -424,13 +603,17 @@ void VisualizerProtocol::drawPolygonalMesh(const PolygonalMesh& mesh, const Tran
         "Too many unique DecorativeMesh objects; max is 65535.");
     
     meshes[impl] = (unsigned short)index;    // insert new mesh
-    WRITE(outPipe, &DefineMesh, 1);
     unsigned short numVertices = (unsigned)vertices.size()/3;
     unsigned short numFaces = (unsigned)faces.size()/3;
-    WRITE(outPipe, &numVertices, sizeof(short));
-    WRITE(outPipe, &numFaces, sizeof(short));
-    WRITE(outPipe, &vertices[0], (unsigned)(vertices.size()*sizeof(float)));
-    WRITE(outPipe, &faces[0], (unsigned)(faces.size()*sizeof(short)));
+    const unsigned char* v = (const unsigned char*)&vertices[0];
+    const unsigned char* f = (const unsigned char*)&faces[0];
+    const unsigned char* nv = (const unsigned char*)&numVertices;
+    const unsigned char* nf = (const unsigned char*)&numFaces;
+    sceneDefs.push_back(DefineMesh);
+    sceneDefs.insert(sceneDefs.end(), nv, nv+sizeof(short));
+    sceneDefs.insert(sceneDefs.end(), nf, nf+sizeof(short));
+    sceneDefs.insert(sceneDefs.end(), v, v+vertices.size()*sizeof(float));
+    sceneDefs.insert(sceneDefs.end(), f, f+faces.size()*sizeof(short));
 
     drawMesh(X_GM, scale, color, (short) representation, index, 0);
 }
@@ -443,7 +626,7 @@ drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color,
                     ? AddPointMesh 
                     : (representation == DecorativeGeometry::DrawWireframe 
                         ? AddWireframeMesh : AddSolidMesh));
-    WRITE(outPipe, &command, 1);
+    beginSceneCommand(&command, 1);
     float buffer[13];
     Vec3 rot = X_GM.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -459,17 +642,17 @@ drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color,
     buffer[10] = (float) color[1];
     buffer[11] = (float) color[2];
     buffer[12] = (float) color[3];
-    WRITE(outPipe, buffer, 13*sizeof(float));
+    addToScene(buffer, 13*sizeof(float));
     unsigned short buffer2[2];
     buffer2[0] = meshIndex;
     buffer2[1] = resolution;
-    WRITE(outPipe, buffer2, 2*sizeof(unsigned short));
+    addToScene(buffer2, 2*sizeof(unsigned short));
 }
 
 void VisualizerProtocol::
 drawLine(const Vec3& end1, const Vec3& end2, const Vec4& color, Real thickness)
 {
-    WRITE(outPipe, &AddLine, 1);
+    beginSceneCommand(&AddLine, 1);
     float buffer[10];
     buffer[0] = (float) color[0];
     buffer[1] = (float) color[1];
@@ -481,7 +664,7 @@ drawLine(const Vec3& end1, const Vec3& end2, const Vec4& color, Real thickness)
     buffer[7] = (float) end2[0];
     buffer[8] = (float) end2[1];
     buffer[9] = (float) end2[2];
-    WRITE(outPipe, buffer, 10*sizeof(float));
+    addToScene(buffer, 10*sizeof(float));
 }
 
 void VisualizerProtocol::
@@ -491,7 +674,7 @@ drawText(const Vec3& position, const Vec3& scale, const Vec4& color,
         "VisualizerProtocol::drawText()",
         "Can't display DecorativeText longer than 256 characters;"
         " received text of length %u.", (unsigned)string.size());
-    WRITE(outPipe, &AddText, 1);
+    beginSceneCommand(&AddText, 1);
     float buffer[9];
     buffer[0] = (float) position[0];
     buffer[1] = (float) position[1];
@@ -502,19 +685,19 @@ drawText(const Vec3& position, const Vec3& scale, const Vec4& color,
     buffer[6] = (float) color[0];
     buffer[7] = (float) color[1];
     buffer[8] = (float) color[2];
-    WRITE(outPipe, buffer, 9*sizeof(float));
+    addToScene(buffer, 9*sizeof(float));
     short face = (short)faceCamera;
-    WRITE(outPipe, &face, sizeof(short));
+    addToScene(&face, sizeof(short));
     short screen = (short)isScreenText;
-    WRITE(outPipe, &screen, sizeof(short));
+    addToScene(&screen, sizeof(short));
     short length = (short)string.size();
-    WRITE(outPipe, &length, sizeof(short));
-    WRITE(outPipe, &string[0], length);
+    addToScene(&length, sizeof(short));
+    addToScene(string.c_str(), length);
 }
 
 void VisualizerProtocol::
 drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
-    WRITE(outPipe, &AddCoords, 1);
+    beginSceneCommand(&AddCoords, 1);
     float buffer[12];
     Vec3 rot = X_GF.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -529,7 +712,7 @@ drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
     buffer[9] = (float) color[0];
     buffer[10]= (float) color[1];
     buffer[11]= (float) color[2];
-    WRITE(outPipe, buffer, 12*sizeof(float));
+    addToScene(buffer, 12*sizeof(float));
 }
 
 void VisualizerProtocol::
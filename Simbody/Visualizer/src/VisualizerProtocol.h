@@ -28,6 +28,7 @@
 #include "simbody/internal/Visualizer.h"
 #include <pthread.h>
 #include <utility>
+#include <vector>
 
 /** @file
  * This file defines commands that are used for communication between the 
@@ -36,7 +37,7 @@
 
 // Increment this every time you make *any* change to the protocol;
 // we insist on an exact match.
-static const unsigned ProtocolVersion   = 32;
+static const unsigned ProtocolVersion   = 33;
 
 // The visualizer has several predefined cached meshes for common
 // shapes so that we don't have to send them. These are the mesh 
@@ -85,6 +86,8 @@ static const unsigned char SetShowFrameRate      = 27;
 static const unsigned char SetShowSimTime        = 28;
 static const unsigned char SetShowFrameNumber    = 29;
 static const unsigned char Shutdown              = 30;
+static const unsigned char UseSharedMemory       = 31;
+static const unsigned char SceneInSharedMemory   = 32;
 
 
 // Events sent from the GUI back to the application.
@@ -97,11 +100,42 @@ static const unsigned char KeyPressed            = 2;
 static const unsigned char MenuSelected          = 3;
 static const unsigned char SliderMoved           = 4;
 
+// Scenes can optionally be passed to the GUI through a double-buffered POSIX
+// shared memory region rather than written down the pipe; then only a short
+// SceneInSharedMemory command naming the slot goes through the pipe. The
+// region begins with this header, followed by two slots of slotBytes each.
+// A slot holds:
+//      unsigned    isDelta
+//      float       simTime
+//      unsigned    number of bytes of DefineMesh commands, then those bytes
+// then if it is a full scene:
+//      unsigned    number of drawing commands n, number of bytes they take
+//      unsigned    offset of each drawing command [n]
+//      the drawing commands, exactly as they would be sent down the pipe
+// or if it is a delta from the previous scene sent through shared memory, 
+// which must have had the same drawing commands of the same lengths:
+//      unsigned    number of drawing commands that changed
+//      for each, unsigned command number followed by the new command bytes
+// The simulator won't reuse a slot until the GUI clears its busy flag, and
+// uses the pipe instead if it would have to wait, or if the GUI hasn't 
+// attached to the region yet.
+static const unsigned SharedSceneMagic = 0x5343454e; // "SCEN"
+struct SharedSceneHeader {
+    unsigned            magic;
+    unsigned            slotBytes;
+    volatile unsigned   attached;       // set by the GUI once it is mapped
+    volatile unsigned   slotBusy[2];    // set by simulator, cleared by GUI
+};
+// Slots begin at this offset from the start of the region, and slotBytes 
+// after that.
+static const unsigned SharedSceneSlotOffset = 64;
+
 namespace SimTK {
 class VisualizerProtocol {
 public:
     VisualizerProtocol(Visualizer& visualizer,
                        const Array_<String>& searchPath);
+    ~VisualizerProtocol();
     void shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe);
     void shutdownGUI();
     void beginScene(Real simTime);
@@ -148,12 +182,45 @@ public:
     void lookAt(const Vec3& point, const Vec3& upDirection) const;
     void setFieldOfView(Real fov) const;
     void setClippingPlanes(Real near, Real far) const;
+
+    // Returns false if shared memory isn't available on this platform or
+    // couldn't be set up, in which case the pipe is used for everything.
+    bool setUseSharedMemory(bool useSharedMemory);
+    bool getUseSharedMemory() const {return useSharedMemory;}
 private:
     void drawMesh(const Transform& transform, const Vec3& scale, 
                   const Vec4& color, short representation, 
                   unsigned short meshIndex, unsigned short resolution);
+    // Scene data is collected between beginScene() and finishScene() and
+    // then sent all at once.
+    void beginSceneCommand(const void* data, int bytes);
+    void addToScene(const void* data, int bytes)
+    {   const unsigned char* p = (const unsigned char*)data;
+        sceneDraw.insert(sceneDraw.end(), p, p+bytes); }
+    void sendSceneThroughPipe();
+    bool sendSceneThroughSharedMemory();
+
     int outPipe;
 
+    float                       sceneTime;
+    std::vector<unsigned char>  sceneDefs;      // DefineMesh commands
+    std::vector<unsigned char>  sceneDraw;      // drawing commands
+    std::vector<unsigned>       sceneCommands;  // start of each in sceneDraw
+
+    // The drawing commands of the last scene sent through shared memory, 
+    // for delta encoding. Invalid after a scene goes through the pipe.
+    std::vector<unsigned char>  prevDraw;
+    std::vector<unsigned>       prevCommands;
+    bool                        havePrevScene;
+
+    // Shared memory transport; shared is null until it is first requested.
+    bool                        useSharedMemory;
+    SharedSceneHeader*          shared;
+    unsigned                    sharedBytes;
+    std::string                 sharedName;
+    int                         nextSlot;
+    std::vector<unsigned char>  pipeBuffer;
+
     // For user-defined meshes, map their unique memory addresses to the 
     // assigned visualizer cache index.
     mutable std::map<const void*, unsigned short> meshes;
@@ -0,0 +1,151 @@
+#ifndef SimTK_SIMBODY_VISUALIZER_SHARED_SCENE_H_
+#define SimTK_SIMBODY_VISUALIZER_SHARED_SCENE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the GUI side of the shared memory scene transport described in
+ * VisualizerProtocol.h. It is used by simbody-visualizer, and by the test
+ * that checks the transport against a stand-in for it.
+ */
+
+#include "VisualizerProtocol.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+#endif
+
+namespace SimTK {
+
+class VisualizerSharedScene {
+public:
+    VisualizerSharedScene() : shared(0), sharedBytes(0) {}
+    ~VisualizerSharedScene() {
+    #ifndef _WIN32
+        if (shared) munmap((void*)shared, sharedBytes);
+    #endif
+    }
+
+    bool isAttached() const {return shared != 0;}
+
+    // Map the shared memory region the simulator has created and let it know
+    // we have it. If this fails the simulator will just keep using the pipe.
+    void attach(const std::string& name, unsigned bytes) {
+    #ifndef _WIN32
+        if (shared)
+            return; // we only support one region
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd == -1)
+            return;
+        void* region = mmap(0, bytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        shm_unlink(name.c_str()); // it will go away once both sides unmap it
+        if (region == MAP_FAILED)
+            return;
+        SharedSceneHeader* header = (SharedSceneHeader*)region;
+        if (header->magic != SharedSceneMagic
+            || SharedSceneSlotOffset + 2*header->slotBytes > bytes) {
+            munmap(region, bytes);
+            return;
+        }
+        shared      = header;
+        sharedBytes = bytes;
+        __sync_synchronize();
+        shared->attached = 1;
+    #endif
+    }
+
+    // Reassemble the scene in the given slot into "scene", in the form it
+    // would have had in the pipe following the StartOfScene command, and
+    // give the slot back to the simulator. Returns true if the slot held
+    // only the changes from the previous shared memory scene.
+    bool readScene(int slot, std::vector<unsigned char>& scene) {
+        SimTK_ERRCHK_ALWAYS(shared != 0, "VisualizerSharedScene::readScene()",
+            "Got a scene in shared memory but no shared memory was set up.");
+        __sync_synchronize();
+        const unsigned char* p = (const unsigned char*)shared
+                                 + SharedSceneSlotOffset
+                                 + slot*shared->slotBytes;
+        const bool isDelta = readUnsigned(p) != 0;
+        const unsigned char* time = p;
+        p += sizeof(float);
+        const unsigned defsBytes = readUnsigned(p);
+        const unsigned char* defs = p;
+        p += defsBytes;
+
+        if (isDelta) {
+            const unsigned numChanged = readUnsigned(p);
+            for (unsigned i=0; i < numChanged; ++i) {
+                const unsigned command = readUnsigned(p);
+                const unsigned begin = commands[command];
+                const unsigned len = commands[command+1] - begin;
+                std::memcpy(&draw[begin], p, len);
+                p += len;
+            }
+        } else {
+            const unsigned numCommands = readUnsigned(p);
+            const unsigned drawBytes = readUnsigned(p);
+            commands.resize(numCommands+1);
+            for (unsigned i=0; i < numCommands; ++i)
+                commands[i] = readUnsigned(p);
+            commands[numCommands] = drawBytes;
+            draw.assign(p, p+drawBytes);
+        }
+
+        scene.assign(time, time+sizeof(float));
+        scene.insert(scene.end(), defs, defs+defsBytes);
+        scene.insert(scene.end(), draw.begin(), draw.end());
+        scene.push_back(EndOfScene);
+
+        // The simulator can reuse this slot now.
+        __sync_synchronize();
+        shared->slotBusy[slot] = 0;
+        return isDelta;
+    }
+
+private:
+    static unsigned readUnsigned(const unsigned char*& p) {
+        unsigned u;
+        std::memcpy(&u, p, sizeof(unsigned));
+        p += sizeof(unsigned);
+        return u;
+    }
+
+    SharedSceneHeader*          shared;
+    unsigned                    sharedBytes;
+    // The drawing commands from the last scene that came through shared
+    // memory, since a later scene may be sent as changes to that one.
+    std::vector<unsigned char>  draw;
+    std::vector<unsigned>       commands; // start of each, plus end
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_VISUALIZER_SHARED_SCENE_H_
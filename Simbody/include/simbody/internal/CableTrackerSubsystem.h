@@ -80,6 +80,28 @@ const CablePath& getCablePath(CablePathIndex cableIx) const;
 /** Get writable access to a particular cable path. **/
 CablePath& updCablePath(CablePathIndex cableIx);
 
+/** Request that, while solving for a cable path, the geodesics over its 
+active surface obstacles be calculated concurrently. Each iteration of the
+path solution must shoot a geodesic over every active surface; those are 
+independent as long as no two of them use the same ContactGeometry object,
+so paths that share geometry among their obstacles are still solved 
+serially. Results are identical to serial evaluation. This is off by 
+default, is only worth using for paths that wrap several surfaces at once,
+and does not invalidate any stage. Calls made from a thread that is already
+a ParallelExecutor worker, and calls made while another thread is using the
+worker threads, are always evaluated serially.
+@param[in]  useParallel
+    Set true to enable parallel evaluation, false to restore the default 
+    serial behavior.
+@param[in]  numThreads
+    The number of worker threads to use; by default this is the number of
+    available processors. One thread means serial execution. **/
+void setUseParallelSurfaceObstacles
+   (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+/** Return true if parallel evaluation of surface obstacles has been enabled
+with more than one thread. @see setUseParallelSurfaceObstacles() **/
+bool getUseParallelSurfaceObstacles() const;
+
 /** @cond **/ // Hide from Doxygen.
 SimTK_PIMPL_DOWNCAST(CableTrackerSubsystem, Subsystem);
 class Impl;
@@ -85,6 +85,29 @@ has not been set.
 @see getDissipatedEnergy(),setDissipatedEnergy(),setTrackDissipatedEnergy() **/
 bool getTrackDissipatedEnergy() const;
 
+/** Request that the forces for the active Contacts be calculated 
+concurrently, and accumulated onto the bodies using a separate set of body
+forces per thread. Each contact force is identical to the one calculated 
+serially; the total body forces may differ from serial results in the last
+bits due to the different order of summation. This is only worth using when 
+there are many simultaneous contacts, and every registered 
+ContactForceGenerator must be safe to call from several threads at once (the
+built-in ones are). Calls made from a thread that is already a 
+ParallelExecutor worker, and calls made while another thread is using the
+worker threads, are always evaluated serially. This is off by default and 
+does not invalidate any stage.
+@param[in]  useParallel
+    Set true to enable parallel evaluation, false to restore the default 
+    serial behavior.
+@param[in]  numThreads
+    The number of worker threads to use; by default this is the number of
+    available processors. One thread means serial execution. **/
+void setUseParallelContactForces
+   (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+/** Return true if parallel contact force evaluation has been enabled with 
+more than one thread. @see setUseParallelContactForces() **/
+bool getUseParallelContactForces() const;
+
 /** Determine how many of the active Contacts are currently generating
 contact forces. You can call this at Velocity stage or later; the contact
 forces will be realized first if necessary before we report how many there 
@@ -192,6 +215,29 @@ turned on energy tracking via setTrackDissipatedEnergy().
 void setDissipatedEnergy(State& state, Real energy) const;
 
 
+/** @name                    Statistics
+The subsystem can time each call it makes to a ContactForceGenerator and 
+keep totals by type of Contact, which shows where contact force calculation
+time is being spent. Timing is off by default since it adds a clock read per
+contact. Totals accumulate over all States realized with this subsystem until
+resetStats() is called. **/
+/*@{*/
+/** Enable or disable timing of force generator calls. Turning it off leaves
+the totals collected so far alone. **/
+void setTrackForceGeneratorTiming(bool shouldTrack);
+/** Return true if force generator calls are currently being timed. **/
+bool getTrackForceGeneratorTiming() const;
+/** Return the number of timed calls made to the force generator for Contacts
+of the indicated type. **/
+int getNumForceGeneratorCalls(ContactTypeId contact) const;
+/** Return the total wall clock time in seconds spent in timed calls to the
+force generator for Contacts of the indicated type. When forces are 
+calculated in parallel this is the sum over all threads. **/
+Real getForceGeneratorTime(ContactTypeId contact) const;
+/** Reset all the force generator timing totals to zero. **/
+void resetStats() const;
+/*@}*/
+
 /** Attach a new generator to this subsystem as the responder to be used when
 we see the kind of Contact type for which this generator is defined,
 replacing the previous generator for this Contact type if there was one. The 
@@ -125,6 +125,27 @@ public:
      * Set the transition velocity (vt) of the friction model.
      */
     void setTransitionVelocity(Real v);
+    /**
+     * Enable or disable evaluating the springs of large contact patches on
+     * multiple threads. Each patch is divided into fixed-size chunks of springs
+     * whose forces and energy are added up in a fixed order, so the results
+     * are the same whether or not this is enabled and regardless of the number
+     * of threads. Small patches, calls made from a thread that is already
+     * a ParallelExecutor worker, and calls made while another thread is 
+     * using the threads are always evaluated serially. This is off by 
+     * default.
+     *
+     * @param useParallel    set true to enable parallel spring evaluation
+     * @param numThreads     the number of worker threads to use; by default
+     *                       this is the number of available processors
+     */
+    void setUseParallelSprings
+       (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+    /**
+     * Get whether parallel spring evaluation has been enabled with more than
+     * one thread.
+     */
+    bool getUseParallelSprings() const;
     SimTK_INSERT_DERIVED_HANDLE_DECLARATIONS(ElasticFoundationForce, ElasticFoundationForceImpl, Force);
 };
 
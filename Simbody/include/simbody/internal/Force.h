@@ -141,6 +141,20 @@ public:
     @return The potential energy contribution of this force element at this
     \a state value. **/
     Real calcPotentialEnergyContribution(const State& state) const;
+
+    /** Declare whether this force element's calcForce() method may be run
+    concurrently with those of other force elements, when parallel force 
+    evaluation has been enabled in the containing GeneralForceSubsystem. A 
+    thread-safe force element must only read from the State (other than its 
+    own cache entries) and must not modify any shared objects. Elements that 
+    aren't thread safe are always evaluated serially. Most built-in force 
+    elements are thread safe; Force::Custom elements and cable springs are not 
+    by default. This is a Topology-stage change.
+    @see GeneralForceSubsystem::setUseParallelForces() **/
+    void setIsThreadSafe(bool isThreadSafe);
+    /** Return true if this force element may be evaluated concurrently with
+    other force elements. @see setIsThreadSafe() **/
+    bool isThreadSafe() const;
     /*@}*/
 
     /**@name                   Bookkeeping
@@ -86,6 +86,30 @@ public:
     void setForceIsDisabled
        (State& state, ForceIndex index, bool shouldBeDisabled) const;
 
+    /** Enable or disable parallel evaluation of force elements. When enabled,
+    the calcForce() methods of enabled force elements that are marked 
+    thread safe (see Force::setIsThreadSafe()) are run concurrently, in a 
+    fixed number of chunks that each accumulate into their own private force 
+    arrays. Those arrays are then summed in a fixed order, so results are 
+    repeatable from run to run for a given number of threads, although they
+    may differ from serial results in the last bits due to the different 
+    order of summation. Elements that are not thread safe are evaluated 
+    serially first. This is off by default; it is only worth using when 
+    there are many force elements or some expensive ones. Calls made from a
+    thread that is already a ParallelExecutor worker are always evaluated 
+    serially. This does not invalidate any stage.
+    @param[in]  useParallel
+        Set true to enable parallel evaluation, false to restore the default 
+        serial behavior.
+    @param[in]  numThreads
+        The number of worker threads to use; by default this is the number of
+        available processors. One thread means serial execution. **/
+    void setUseParallelForces
+       (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+    /** Return true if parallel force evaluation has been enabled with more
+    than one thread. @see setUseParallelForces() **/
+    bool getUseParallelForces() const;
+
     /** Every Subsystem is owned by a System; a GeneralForceSubsystem expects
     to be owned by a MultibodySystem. This method returns a const reference
     to the containing MultibodySystem and will throw an exception if there is
@@ -203,6 +203,133 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Enable or disable level-parallel execution of the O(n) tree sweeps used 
+for kinematics, articulated body inertias, forward and inverse dynamics, and
+multiplyByMInv(). Bodies at the same distance from Ground are independent 
+during these sweeps so wide trees (many limbs, crowds of independent 
+mechanisms) can have each level processed by a pool of worker threads, with
+a barrier between levels. Results are bit-identical to the serial sweeps. This
+is off by default; narrow levels and calls made from a thread that is already
+a ParallelExecutor worker are always processed serially. The worker threads
+are shared by all States of this System; if several user threads realize
+different States at once, only one of them uses the workers at a time and
+the others sweep serially. Since a
+MultibodySystem has only one matter subsystem this setting applies to the
+whole System; it does not invalidate any stage.
+@param[in]  useParallel
+    Set true to enable parallel tree sweeps, false to restore the default 
+    serial behavior.
+@param[in]  numThreads
+    The number of worker threads to use; by default this is the number of
+    available processors. One thread means serial execution.
+@note Custom mobilizers and Motions invoked during a parallel sweep must be 
+safe to call concurrently for different bodies. **/
+void setUseParallelTreeSweeps
+   (bool useParallel, int numThreads=ParallelExecutor::getNumProcessors());
+/** Return true if parallel tree sweeps have been enabled with more than one 
+thread. @see setUseParallelTreeSweeps() **/
+bool getUseParallelTreeSweeps() const;
+
+/** (Advanced) Choose whether position and velocity kinematics are calculated 
+a mobilized body at a time (the default) or in blocks of up to eight bodies
+that are at the same distance from Ground and have the same kind of 
+mobilizer. In a block the mobilizer-specific calculations for all the
+bodies are done first, with calls that are bound at compile time, followed 
+by the calculations that are the same for every mobilizer. Pin, Slider, 
+Ball, Universal, and Free mobilizers have block implementations; other
+mobilizers are still processed one at a time. Whether this is faster 
+depends on the model and the compiler, so measure before enabling it.
+Results are bit-identical either way, and if parallel tree sweeps are 
+enabled the blocks are shared among the worker threads. This setting does 
+not invalidate any stage.
+@param[in]  useBlocks
+    Set true to calculate kinematics in blocks, false to restore the 
+    default body at a time calculation. **/
+void setUseBlockKinematics(bool useBlocks);
+/** Return true if block kinematics has been enabled.
+@see setUseBlockKinematics() **/
+bool getUseBlockKinematics() const;
+
+/** Choose how the constraint-space system (G M^-1 ~G) lambda = b is solved 
+when calculating Lagrange multipliers for forward dynamics and when solving
+for constraint impulses. By default the whole m X m matrix is factored, which
+costs O(m^3) for m constraint equations. With the block solver enabled, the
+constraint equations are first partitioned into groups that cannot interact
+through the mass matrix (constraints on bodies in different branches of the
+tree, where a branch is a base body and everything outboard of it), and each
+group is factored separately at a cost of O(mi^3) per group. That is a large
+savings for systems made of many independent or loosely connected
+mechanisms, and no savings when all the constraints act on one branch. Only
+the groups' blocks of the matrix are formed, and since the groups don't
+interact, one column of every block is formed at once, so forming them costs 
+O(n) times the size of the largest group rather than O(n) times m. For
+independent constraints both methods produce the same solution to within 
+roundoff. Redundant constraints are detected within each group, relative to
+the scale of that group's block, so a borderline redundancy may be treated
+differently than by the dense solver. This setting does not invalidate any
+stage.
+@param[in]  useBlocks
+    Set true to solve block by block, false to restore the default dense 
+    solve. **/
+void setUseBlockConstraintSolver(bool useBlocks);
+/** Return true if the block constraint solver has been enabled.
+@see setUseBlockConstraintSolver() **/
+bool getUseBlockConstraintSolver() const;
+
+/** (Advanced) Allow projection of position and velocity constraints to reuse 
+an already-factored constraint Jacobian rather than factoring a new one on
+every iteration. The saved factorization is reused across iterations and 
+across calls to projectQ() and projectU() (that is, across integration steps)
+as in a modified Newton iteration, until it has been reused  maxReuses times
+or until a step using it fails to reduce the constraint error quickly enough,
+in which case it is refactored at the current configuration. Reuse is never 
+done when the ProjectOptions::ForceFullNewton option is set. Integrators report
+how often factorizations were reused and recomputed; see 
+Integrator::getNumProjectionFactorizationReuses().
+
+The saved factorizations are kept in each State's cache rather than in the 
+subsystem, so projecting different States concurrently from different threads
+is safe. They are discarded whenever the State's Instance stage is invalidated,
+for example by enabling or disabling a Constraint. Copies of a State share the
+saved factorization until one of them refactors.
+@param[in]  maxReuses
+    The number of times a factorization may be reused before it is considered
+    stale. The default is zero, which means always refactor. **/
+void setProjectionFactorizationReuseLimit(int maxReuses);
+/** Return the current limit on projection factorization reuse; zero means
+reuse is disabled.
+@see setProjectionFactorizationReuseLimit() **/
+int getProjectionFactorizationReuseLimit() const;
+
+/** (Advanced) Allow realizePosition() to skip recalculating the position 
+kinematics of mobilized bodies whose generalized coordinates q have not 
+changed since the last time they were calculated in the same State. Only
+mobilizers whose q's differ, and all the bodies outboard of them, are 
+recalculated; the results are identical to a full recalculation. This is a 
+large savings when only a few q's change at a time, as in interactive 
+manipulation or when a solver perturbs one q at a time. Only tree kinematics
+is done incrementally; constraint errors and everything that depends on 
+position kinematics are still recalculated. A change at the Instance stage
+or earlier forces a full recalculation, but nothing else is checked: a 
+mobilizer is recalculated only if its own q's or its parent's kinematics 
+changed. So mobilizers whose kinematics also depend on time or on Time- or 
+Position-stage discrete variables (as a custom mobilizer may) must not be 
+used with this option. This setting does not invalidate any stage.
+@param[in]  useIncremental
+    Set true to enable incremental position kinematics, false to recalculate
+    all the bodies every time (the default).
+@see getNumPositionKinematicsRecalculations() **/
+void setUseIncrementalPositionKinematics(bool useIncremental);
+/** Return true if incremental position kinematics has been enabled.
+@see setUseIncrementalPositionKinematics() **/
+bool getUseIncrementalPositionKinematics() const;
+/** Return the number of mobilized bodies (not counting Ground) whose position
+kinematics was recalculated during the most recent realizePosition() of this 
+State. This is getNumBodies()-1 unless incremental position kinematics is
+enabled. The State must have been realized to Stage::Position.
+@see setUseIncrementalPositionKinematics() **/
+int getNumPositionKinematicsRecalculations(const State& state) const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the 0th mobilized body. (Note: if special particle handling were
 implmemented, the count here would \e not include particles.) Bodies and their
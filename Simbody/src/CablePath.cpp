@@ -726,7 +726,8 @@ ensureVelocityKinematicsCalculated(const State& state) const {
     cables->markDiscreteVarUpdateValueRealized(state, velEntryIx);
 }
 
-// Numerical Jacobian calculation.
+// Numerical Jacobian calculation. This is much too slow for routine use but
+// is handy for checking calcPathErrorJacobian().
 
 class PathError : public Differentiator::JacobianFunction {
 public:
@@ -811,16 +812,9 @@ solveForPathPoints(const State& state, const PathInstanceInfo& instInfo,
     const Real ftol = Real(1e-12)*1000; // TODO
     const Real xtol = Real(1e-12)*1000;
 
-    const Real estimatedPathErrorAccuracy = ftol;
-    PathError pathErrorFnc(ppe.x.size(), *this, state, instInfo, ppe, 
-                           estimatedPathErrorAccuracy);
-    Differentiator diff(pathErrorFnc);
-
     Vector dx, xold, xchg;
 
     Real f = ppe.err.norm();
-    cout << "\n***PATH solveForPathPoints@t=" << state.getTime() 
-         << " err=" << f << "\n"; 
 
     Real fold, lam = 1, nextlam = 1;
     Real dxnormPrev = Infinity;
@@ -829,23 +823,15 @@ solveForPathPoints(const State& state, const PathInstanceInfo& instInfo,
         // We always need a Jacobian even if the path is already good enough
         // because we use it to solve for xdot. So we might as well do one
         // iteration.
-        if (i > 0 && f <= ftol) {
-            std::cout << "\n***PATH converged in " 
-                << i << " iterations err=" << f << "\n\n";
+        if (i > 0 && f <= ftol)
             break;
-        }
         //cout << "obstacle err = " << f << ", x = " << ppe.x << endl;
 
-        //diff.calcJacobian(ppe.x, ppe.err, ppe.J, 
-        //                  Differentiator::ForwardDifference);
-       // Matrix Jnum = ppe.J;
+        // The Jacobian is assembled analytically from the obstacles' blocks.
+        // To check it, use a Differentiator on the PathError function above.
         calcPathErrorJacobian(state, instInfo, ppe);
 
-        //cout << "DIFF J=" << Jnum-ppe.J;
-        //cout << "DIFF NORM=" << (Jnum-ppe.J).norm() << "\n";
-
         ppe.JInv.factor(ppe.J);
-        //ppe.JInv.factor(Jnum);
 
         fold = f;
         xold = ppe.x;
@@ -853,12 +839,8 @@ solveForPathPoints(const State& state, const PathInstanceInfo& instInfo,
         ppe.JInv.solve(ppe.err, dx);
 
         const Real dxnorm = std::sqrt(dx.normSqr()/ppe.x.size()); // rms
-        cout << "|dx| = " << dxnorm << endl;
-        if (dxnorm > Real(.99)*dxnormPrev) {
-           std::cout << "\nPATH stalled in " 
-                << i << " iterations err=" << f << " |dx|=" << dxnorm << "\n\n";
+        if (dxnorm > Real(.99)*dxnormPrev)
             break;
-        }
 
         // backtracking
         lam = nextlam;
@@ -1012,6 +994,48 @@ findKinematicVelocityErrors
     }
 }
 
+namespace {
+
+// Calculates the path errors and geodesics for a list of active surface 
+// obstacles, one obstacle per work item. Exceptions are caught and recorded
+// per obstacle so the first one can be rethrown by the caller.
+class SurfaceObstacleErrorTask : public ParallelExecutor::Task {
+public:
+    SurfaceObstacleErrorTask(const CablePath::Impl&            path,
+                             const State&                      state,
+                             const PathInstanceInfo&           instInfo,
+                             const Array_<CableObstacleIndex>& surfaces,
+                             PathPosEntry&                     ppe,
+                             Array_<Real>&                     geoLengths)
+    :   path(path), state(state), instInfo(instInfo), surfaces(surfaces),
+        ppe(ppe), geoLengths(geoLengths), errors(surfaces.size()) {}
+
+    void execute(int i) OVERRIDE_11 {
+        try {
+            geoLengths[i] = path.calcSurfaceObstaclePathError
+                                            (state, instInfo, surfaces[i], ppe);
+        }
+        catch (const std::exception& e) {errors[i] = e.what();}
+        catch (...) {errors[i] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned i=0; i < errors.size(); ++i)
+            if (!errors[i].empty())
+                SimTK_THROW1(Exception::Cant, errors[i]);
+    }
+private:
+    const CablePath::Impl&              path;
+    const State&                        state;
+    const PathInstanceInfo&             instInfo;
+    const Array_<CableObstacleIndex>&   surfaces;
+    PathPosEntry&                       ppe;
+    Array_<Real>&                       geoLengths;
+    Array_<std::string>                 errors;
+};
+
+}
+
 //------------------------------------------------------------------------------
 //                            CALC PATH ERROR
 //------------------------------------------------------------------------------
@@ -1022,8 +1046,6 @@ void CablePath::Impl::
 calcPathError(const State& state, const PathInstanceInfo& instInfo, 
               PathPosEntry& ppe) const
 {
-    const PathPosEntry& prevPPE = getPrevPosEntry(state);
-
     ppe.length = 0;
 
     // First pass: run through all the enabled obstacles. Update the distance
@@ -1080,56 +1102,102 @@ calcPathError(const State& state, const PathInstanceInfo& instInfo,
     }
 
     // Pass 2 : use above info to calculate errors from active surfaces.
-
-
+    // Each of these requires shooting a geodesic, which is expensive but 
+    // independent of the other surfaces. A geodesic calculation uses its
+    // ContactGeometry object for workspace though, so we can only do 
+    // surfaces concurrently if they don't share geometry.
+    Array_<CableObstacleIndex> activeSurfaces;
+    bool geometryIsShared = false;
     // Skip origin and termination "obstacles" at beginning and end.
     for (CableObstacleIndex ox(1); ox < obstacles.size()-1; ++ox) {
-        const ActiveSurfaceIndex asx = ppe.mapToActiveSurface[ox];
-        if (!asx.isValid())
+        if (!ppe.mapToActiveSurface[ox].isValid())
             continue; // skip via points and inactive surfaces
+        const ContactGeometryImpl& geom = SimTK_DYNAMIC_CAST_DEBUG
+            <const CableObstacle::Surface::Impl&>(getObstacleImpl(ox))
+                .getContactGeometry().getImpl();
+        for (unsigned i=0; i < activeSurfaces.size(); ++i)
+            if (&SimTK_DYNAMIC_CAST_DEBUG
+                    <const CableObstacle::Surface::Impl&>
+                        (getObstacleImpl(activeSurfaces[i]))
+                    .getContactGeometry().getImpl() == &geom)
+                geometryIsShared = true;
+        activeSurfaces.push_back(ox);
+    }
 
-        const int xSlot = ppe.mapToCoords[ox];
-        assert(xSlot >= 0); // Should have had coordinates assigned
-
-        const CableObstacle::Surface::Impl& obs = 
-            SimTK_DYNAMIC_CAST_DEBUG<const CableObstacle::Surface::Impl&>
-                                                        (getObstacleImpl(ox));
-
-        const Rotation& R_BS = obs.getObstaclePoseOnBody(state, instInfo).R();
-        const Rotation& R_GB = obs.getBodyTransform(state).R();
-        const Rotation  R_GS = R_GB*R_BS;
+    Array_<Real> geoLengths(activeSurfaces.size());
+    const CableTrackerSubsystem::Impl& tracker = cables->getImpl();
+    ParallelExecutor* executor = tracker.getSurfaceObstacleExecutor();
+    if (   !executor || activeSurfaces.size() < 2 || geometryIsShared
+        || ParallelExecutor::isWorkerThread()
+        || !tracker.tryLockSurfaceObstacleExecutor()) {
+        for (unsigned i=0; i < activeSurfaces.size(); ++i)
+            geoLengths[i] = calcSurfaceObstaclePathError
+                                (state, instInfo, activeSurfaces[i], ppe);
+    } else {
+        SurfaceObstacleErrorTask task(*this, state, instInfo, activeSurfaces,
+                                      ppe, geoLengths);
+        executor->execute(task, (int)activeSurfaces.size()); // barrier
+        tracker.unlockSurfaceObstacleExecutor();
+        task.rethrowFirstError();
+    }
 
-        const ActiveObstacleIndex ax = ppe.mapToActive[ox];
-        const ActiveSurfaceIndex prevASX = prevPPE.mapToActiveSurface[ox];
-        const UnitVec3 eIn_S  = ~R_GS * ppe.eIn_G[ax];
-        const UnitVec3 eOut_S = ~R_GS * ppe.eIn_G[ax.next()];
-        Vec6::updAs(&ppe.err[xSlot]) =
-            obs.calcSurfacePathError(   
-                prevASX.isValid() ? prevPPE.geodesics[prevASX] : Geodesic(),
-                eIn_S,
-                Vec3::getAs(&ppe.x[xSlot]),  // xP
-                Vec3::getAs(&ppe.x[xSlot+3]),// xQ
-                eOut_S,
-                ppe.geodesics[asx] );
-
-        const Geodesic& geod = ppe.geodesics[asx];
-        const Real signP = (Real)sign(dot(eIn_S,geod.getTangentP()));
-        const Real signQ = (Real)sign(dot(eOut_S,geod.getTangentQ()));
-        const bool isFlipped = (signP<0 && signQ<0);
-        const Real geoLength = isFlipped ? -geod.getLength() : geod.getLength();
-
-        ppe.length += geoLength;
+    // Accumulate lengths in obstacle order so the result doesn't depend on
+    // how the work was scheduled.
+    for (unsigned i=0; i < activeSurfaces.size(); ++i) {
+        ppe.length += geoLengths[i];
 
-        const SurfaceObstacleIndex sox = instInfo.mapObstacleToSurface[ox];
+        const SurfaceObstacleIndex sox = 
+            instInfo.mapObstacleToSurface[activeSurfaces[i]];
         assert(sox.isValid());
 
-        ppe.witnesses[sox] = geoLength;
+        ppe.witnesses[sox] = geoLengths[i];
 
         //std::cout << "WITNESS=" << ppe.witnesses[sox] << std::endl;
     }
 
 }
 
+Real CablePath::Impl::
+calcSurfaceObstaclePathError(const State& state, 
+                             const PathInstanceInfo& instInfo,
+                             CableObstacleIndex ox, PathPosEntry& ppe) const
+{
+    const PathPosEntry& prevPPE = getPrevPosEntry(state);
+
+    const ActiveSurfaceIndex asx = ppe.mapToActiveSurface[ox];
+    assert(asx.isValid());
+
+    const int xSlot = ppe.mapToCoords[ox];
+    assert(xSlot >= 0); // Should have had coordinates assigned
+
+    const CableObstacle::Surface::Impl& obs = 
+        SimTK_DYNAMIC_CAST_DEBUG<const CableObstacle::Surface::Impl&>
+                                                    (getObstacleImpl(ox));
+
+    const Rotation& R_BS = obs.getObstaclePoseOnBody(state, instInfo).R();
+    const Rotation& R_GB = obs.getBodyTransform(state).R();
+    const Rotation  R_GS = R_GB*R_BS;
+
+    const ActiveObstacleIndex ax = ppe.mapToActive[ox];
+    const ActiveSurfaceIndex prevASX = prevPPE.mapToActiveSurface[ox];
+    const UnitVec3 eIn_S  = ~R_GS * ppe.eIn_G[ax];
+    const UnitVec3 eOut_S = ~R_GS * ppe.eIn_G[ax.next()];
+    Vec6::updAs(&ppe.err[xSlot]) =
+        obs.calcSurfacePathError(   
+            prevASX.isValid() ? prevPPE.geodesics[prevASX] : Geodesic(),
+            eIn_S,
+            Vec3::getAs(&ppe.x[xSlot]),  // xP
+            Vec3::getAs(&ppe.x[xSlot+3]),// xQ
+            eOut_S,
+            ppe.geodesics[asx] );
+
+    const Geodesic& geod = ppe.geodesics[asx];
+    const Real signP = (Real)sign(dot(eIn_S,geod.getTangentP()));
+    const Real signQ = (Real)sign(dot(eOut_S,geod.getTangentQ()));
+    const bool isFlipped = (signP<0 && signQ<0);
+    return isFlipped ? -geod.getLength() : geod.getLength();
+}
+
 //------------------------------------------------------------------------------
 //                          CALC PATH ERROR JACOBIAN
 //------------------------------------------------------------------------------
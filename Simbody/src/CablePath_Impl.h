@@ -525,6 +525,15 @@ public:
     void calcPathError
        (const State&, const PathInstanceInfo&, PathPosEntry&) const;
 
+    // Calculate the path error for active surface obstacle ox, given the 
+    // entry and exit directions already in PathPosEntry, and shoot the 
+    // geodesic that goes with it. Only that obstacle's entries are written
+    // so different obstacles may be done concurrently. Returns the signed 
+    // geodesic length (negative if the geodesic is flipped).
+    Real calcSurfaceObstaclePathError
+       (const State&, const PathInstanceInfo&, CableObstacleIndex ox,
+        PathPosEntry&) const;
+
     // Given kinematics K and a set of contact point coordinates x (already in
     // PathPosEntry), calculate the Jacobian D patherr(K;x)/Dx, with the
     // result going back into PathPosEntry. This is a banded matrix assembled
@@ -85,3 +85,9 @@ CablePath& CableTrackerSubsystem::
 updCablePath(CablePathIndex cableIx)
 {   return updImpl().updCablePath(cableIx); }
 
+void CableTrackerSubsystem::
+setUseParallelSurfaceObstacles(bool useParallel, int numThreads)
+{   updImpl().setUseParallelSurfaceObstacles(useParallel, numThreads); }
+
+bool CableTrackerSubsystem::getUseParallelSurfaceObstacles() const
+{   return getImpl().getUseParallelSurfaceObstacles(); }
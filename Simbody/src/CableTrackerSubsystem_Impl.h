@@ -35,6 +35,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <pthread.h>
 using std::cout; using std::endl;
 
 namespace SimTK {
@@ -48,9 +49,19 @@ class CableTrackerSubsystem::Impl : public Subsystem::Guts {
 public:
 // Constructor registers a default set of Trackers to use with geometry
 // we know about. These can be overridden later.
-Impl() {}
+Impl() : obstacleExecutor(0), obstacleThreads(1) 
+{   pthread_mutex_init(&obstacleExecutorLock, NULL); }
 
-~Impl() {}
+// The copy gets its own thread pool if the source had one.
+Impl(const Impl& src) 
+:   Subsystem::Guts(src), cablePaths(src.cablePaths),
+    obstacleExecutor(0), obstacleThreads(1)
+{   pthread_mutex_init(&obstacleExecutorLock, NULL);
+    setUseParallelSurfaceObstacles(src.obstacleExecutor != 0, 
+                                   src.obstacleThreads); }
+
+~Impl() 
+{   delete obstacleExecutor; pthread_mutex_destroy(&obstacleExecutorLock); }
 
 Impl* cloneImpl() const OVERRIDE_11 
 {   return new Impl(*this); }
@@ -69,6 +80,34 @@ CablePathIndex adoptCablePath(CablePath& path) {
     return CablePathIndex(cablePaths.size()-1);
 }
 
+void setUseParallelSurfaceObstacles(bool useParallel, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "CableTrackerSubsystem", "setUseParallelSurfaceObstacles",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete obstacleExecutor;
+    obstacleExecutor = 0;
+    obstacleThreads  = 1;
+
+    if (useParallel && numThreads > 1) {
+        obstacleExecutor = new ParallelExecutor(numThreads);
+        obstacleThreads  = numThreads;
+    }
+}
+bool getUseParallelSurfaceObstacles() const {return obstacleExecutor != 0;}
+
+// Cable paths use this to shoot geodesics over their surface obstacles
+// concurrently; null means do it serially. The executor isn't reentrant, so
+// a path must get tryLockSurfaceObstacleExecutor() to return true before 
+// using it, and unlock it afterwards; if the lock is held by another thread 
+// the path does its surfaces serially.
+ParallelExecutor* getSurfaceObstacleExecutor() const 
+{   return obstacleExecutor; }
+bool tryLockSurfaceObstacleExecutor() const 
+{   return pthread_mutex_trylock(&obstacleExecutorLock) == 0; }
+void unlockSurfaceObstacleExecutor() const 
+{   pthread_mutex_unlock(&obstacleExecutorLock); }
+
 // Return the MultibodySystem which owns this ContactTrackerSubsystem.
 const MultibodySystem& getMultibodySystem() const 
 {   return MultibodySystem::downcast(getSystem()); }
@@ -260,6 +299,12 @@ SimTK_DOWNCAST(Impl, Subsystem::Guts);
 private:
 // TOPOLOGY STATE
 Array_<CablePath, CablePathIndex> cablePaths;
+
+// If non-null, geodesics over a path's independent active surface obstacles
+// are calculated by this executor's worker threads. Owned by this object.
+ParallelExecutor*       obstacleExecutor;
+int                     obstacleThreads;
+mutable pthread_mutex_t obstacleExecutorLock;
 };
 
 } // namespace SimTK
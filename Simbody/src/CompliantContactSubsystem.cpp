@@ -36,8 +36,28 @@ patch analysis methods.
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/MultibodySystem.h"
 
+#include <algorithm>
+#include <string>
+#include <pthread.h>
+
 namespace SimTK {
 
+// If there are fewer active contacts than this we don't bother handing them
+// off to worker threads. When we do, each work item is a run of this many
+// consecutive contacts.
+static const int MinContactsForParallel = 64;
+static const int ContactsPerChunk       = 32;
+
+namespace {
+// Number of calls made to the force generator for one type of contact, and 
+// the wall clock time they took.
+struct GeneratorStats {
+    GeneratorStats() : numCalls(0), realTime(0) {}
+    int     numCalls;
+    double  realTime; // seconds
+};
+}
+
 //==============================================================================
 //                    COMPLIANT CONTACT SUBSYSTEM IMPL
 //==============================================================================
@@ -50,9 +70,29 @@ CompliantContactSubsystemImpl(const ContactTrackerSubsystem& tracker)
 :   ForceSubsystemRep("CompliantContactSubsystem", "0.0.1"),
     m_tracker(tracker), m_transitionVelocity(Real(0.01)), 
     m_ooTransitionVelocity(1/m_transitionVelocity), 
-    m_trackDissipatedEnergy(false), m_defaultGenerator(0) 
-{   
-}
+    m_trackDissipatedEnergy(false), m_defaultGenerator(0),
+    m_executor(0), m_numThreads(1), m_trackGeneratorTiming(false)
+{   pthread_mutex_init(&m_executorLock, NULL);
+    pthread_mutex_init(&m_statsLock, NULL); }
+
+// The copy gets its own thread pool if the source had one, and its own
+// locks; the statistics collected so far are copied.
+CompliantContactSubsystemImpl(const CompliantContactSubsystemImpl& src)
+:   ForceSubsystemRep(src), m_tracker(src.m_tracker),
+    m_transitionVelocity(src.m_transitionVelocity),
+    m_ooTransitionVelocity(src.m_ooTransitionVelocity),
+    m_trackDissipatedEnergy(src.m_trackDissipatedEnergy),
+    m_generators(src.m_generators), m_defaultGenerator(src.m_defaultGenerator),
+    m_executor(0), m_numThreads(1),
+    m_trackGeneratorTiming(src.m_trackGeneratorTiming),
+    m_generatorStats(src.m_generatorStats),
+    m_dissipatedEnergyIx(src.m_dissipatedEnergyIx),
+    m_potEnergyCacheIx(src.m_potEnergyCacheIx),
+    m_forceCacheIx(src.m_forceCacheIx),
+    m_bodyForceChunksIx(src.m_bodyForceChunksIx)
+{   pthread_mutex_init(&m_executorLock, NULL);
+    pthread_mutex_init(&m_statsLock, NULL);
+    setUseParallelContactForces(src.m_executor != 0, src.m_numThreads); }
 
 Real getTransitionVelocity() const  {return m_transitionVelocity;}
 Real getOOTransitionVelocity() const  {return m_ooTransitionVelocity;}
@@ -67,6 +107,149 @@ void setTrackDissipatedEnergy(bool shouldTrack) {
 }
 bool getTrackDissipatedEnergy() const {return m_trackDissipatedEnergy;}
 
+void setUseParallelContactForces(bool useParallel, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "CompliantContactSubsystem", "setUseParallelContactForces",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete m_executor;
+    m_executor   = 0;
+    m_numThreads = 1;
+
+    if (useParallel && numThreads > 1) {
+        m_executor   = new ParallelExecutor(numThreads);
+        m_numThreads = numThreads;
+    }
+}
+bool getUseParallelContactForces() const {return m_executor != 0;}
+
+void setTrackForceGeneratorTiming(bool shouldTrack) 
+{   m_trackGeneratorTiming = shouldTrack; }
+bool getTrackForceGeneratorTiming() const {return m_trackGeneratorTiming;}
+
+int getNumForceGeneratorCalls(ContactTypeId type) const {
+    pthread_mutex_lock(&m_statsLock);
+    const int numCalls = type.isValid() && type < (int)m_generatorStats.size()
+                         ? m_generatorStats[type].numCalls : 0;
+    pthread_mutex_unlock(&m_statsLock);
+    return numCalls;
+}
+
+Real getForceGeneratorTime(ContactTypeId type) const {
+    pthread_mutex_lock(&m_statsLock);
+    const double t = type.isValid() && type < (int)m_generatorStats.size()
+                     ? m_generatorStats[type].realTime : 0;
+    pthread_mutex_unlock(&m_statsLock);
+    return Real(t);
+}
+
+void resetStats() const {
+    pthread_mutex_lock(&m_statsLock);
+    m_generatorStats.clear();
+    pthread_mutex_unlock(&m_statsLock);
+}
+
+// Add some newly collected timing information to the totals. Several States
+// may be realized at once so this must be serialized.
+void recordGeneratorStats(const Array_<GeneratorStats>& stats) const {
+    pthread_mutex_lock(&m_statsLock);
+    if (m_generatorStats.size() < stats.size())
+        m_generatorStats.resize(stats.size());
+    for (unsigned i=0; i < stats.size(); ++i) {
+        m_generatorStats[i].numCalls += stats[i].numCalls;
+        m_generatorStats[i].realTime += stats[i].realTime;
+    }
+    pthread_mutex_unlock(&m_statsLock);
+}
+
+// Calculate the force produced by each active contact n in [begin,end) and
+// put it in forces[n], measured and expressed in Ground; forces[n] is left
+// invalid if contact n isn't producing a force. If atZeroVelocity is set the
+// State may be at Position stage only; forces are calculated as though all
+// velocities were zero and are left in the S1 frame since only their 
+// potential energy is of interest. If stats is supplied, the calls made to
+// each type of generator and the time they took are added to it. This is
+// called concurrently for disjoint ranges so must not modify anything else.
+void calcContactForces(const State& state, const ContactSnapshot& active,
+                       bool atZeroVelocity, int begin, int end,
+                       Array_<ContactForce>&    forces,
+                       Array_<GeneratorStats>*  stats) const
+{
+    for (int i=begin; i<end; ++i) {
+        const Contact& contact = active.getContact(i);
+        ContactForce& force = forces[i];
+        const ContactForceGenerator& generator = 
+            getForceGenerator(contact.getTypeId());
+        const double startTime = stats ? realTime() : 0;
+
+        if (atZeroVelocity)
+            generator.calcContactForce(state,contact,SpatialVec(Vec3(0)),force);
+        else if (contact.getCondition() == Contact::Broken) {
+            // No need to generate forces; this will be gone next time.
+            force.clear();
+            continue;
+        } else {
+            const ContactSurfaceIndex surf1(contact.getSurface1());
+            const ContactSurfaceIndex surf2(contact.getSurface2());
+            const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
+            const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
+
+            // TODO: These two are expensive (63 flops each) and shouldn't 
+            // have to be recalculated here since we must have used them in 
+            // creating the Contact and X_S1S2.
+            const Transform X_GS1 = mobod1.findFrameTransformInGround
+                (state, m_tracker.getContactSurfaceTransform(surf1));
+            const Transform X_GS2 = mobod2.findFrameTransformInGround
+                (state, m_tracker.getContactSurfaceTransform(surf2));
+
+            const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
+                (state, m_tracker.getContactSurfaceTransform(surf1));
+            const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
+                (state, m_tracker.getContactSurfaceTransform(surf2));
+
+            // Calculate the relative velocity of S2 in S1, expressed in S1.
+            const SpatialVec V_S1S2 =
+                findRelativeVelocity(X_GS1, V_GS1, X_GS2, V_GS2); // 51 flops
+
+            // Calculate the contact force measured and expressed in S1.
+            generator.calcContactForce(state, contact, V_S1S2, force);
+            // Re-express the contact force in Ground for later use.
+            if (force.isValid())
+                force.changeFrameInPlace(X_GS1); // switch to Ground
+        }
+
+        if (stats) {
+            const int type = contact.getTypeId();
+            if ((int)stats->size() <= type)
+                stats->resize(type+1);
+            GeneratorStats& typeStats = (*stats)[type];
+            ++typeStats.numCalls;
+            typeStats.realTime += realTime() - startTime;
+        }
+    }
+}
+
+// Add the given contact force into the appropriate rigid body force slots,
+// shifted from the contact point to the two body origins.
+void applyContactForce(const State& s, const ContactSnapshot& contacts,
+                       const ContactForce& force,
+                       Vector_<SpatialVec>& rigidBodyForces) const
+{
+    const Contact& contact = contacts.getContactById(force.getContactId());
+    const MobilizedBody& mobod1 = m_tracker.getMobilizedBody
+                                            (contact.getSurface1());
+    const MobilizedBody& mobod2 = m_tracker.getMobilizedBody
+                                            (contact.getSurface2());
+    const Vec3 r1 = force.getContactPoint() - mobod1.getBodyOriginLocation(s);
+    const Vec3 r2 = force.getContactPoint() - mobod2.getBodyOriginLocation(s);
+    const SpatialVec& F2cpt = force.getForceOnSurface2(); // at contact pt
+    // Shift applied force to body origins.
+    const SpatialVec F2( F2cpt[0] + r2 %  F2cpt[1],  F2cpt[1]);
+    const SpatialVec F1(-F2cpt[0] + r1 % -F2cpt[1], -F2cpt[1]);
+    mobod1.applyBodyForce(s, F1, rigidBodyForces);
+    mobod2.applyBodyForce(s, F2, rigidBodyForces);
+}
+
 int getNumContactForces(const State& s) const {
     ensureForceCacheValid(s);
     const Array_<ContactForce>& forces = getForceCache(s);
@@ -153,6 +336,9 @@ const ContactTrackerSubsystem& getContactTrackerSubsystem() const
 {   return m_tracker; }
 
 ~CompliantContactSubsystemImpl() {
+    delete m_executor;
+    pthread_mutex_destroy(&m_executorLock);
+    pthread_mutex_destroy(&m_statsLock);
     delete m_defaultGenerator;
     for (GeneratorMap::iterator p  = m_generators.begin(); 
                                 p != m_generators.end(); ++p)
@@ -231,6 +417,10 @@ int realizeSubsystemTopologyImpl(State& s) const {
     wThis->m_potEnergyCacheIx = allocateLazyCacheEntry(s, 
         Stage::Position, new Value<Real>(NaN));
 
+    // Per-thread rigid body force arrays used for parallel accumulation.
+    wThis->m_bodyForceChunksIx = allocateCacheEntry(s, Stage::Dynamics,
+        new Value<Array_<Vector_<SpatialVec> > >());
+
     // This state variable is used to integrate power to get dissipated
     // energy. Allocate only if requested.
     if (m_trackDissipatedEnergy) {
@@ -271,26 +461,30 @@ int realizeSubsystemDynamicsImpl(const State& s) const {
     Vector_<SpatialVec>& rigidBodyForces =
         mbs.updRigidBodyForces(s, Stage::Dynamics);
 
-    // Accumulate the values from the cache into the global arrays.
+    // Accumulate the values from the cache into the global arrays. In 
+    // parallel, each thread has its own array and those are summed in a
+    // fixed order afterwards. If another thread is using the executor we
+    // accumulate serially here.
     const ContactSnapshot& contacts = m_tracker.getActiveContacts(s);
     const Array_<ContactForce>& forces = getForceCache(s);
-    for (unsigned i=0; i < forces.size(); ++i) {
-        const ContactForce& force = forces[i];
-        const Contact& contact = contacts.getContactById(force.getContactId());
-        const MobilizedBody& mobod1 = m_tracker.getMobilizedBody
-                                                (contact.getSurface1());
-        const MobilizedBody& mobod2 = m_tracker.getMobilizedBody
-                                                (contact.getSurface2());
-        const Vec3 r1 = force.getContactPoint() - mobod1.getBodyOriginLocation(s);
-        const Vec3 r2 = force.getContactPoint() - mobod2.getBodyOriginLocation(s);
-        const SpatialVec& F2cpt = force.getForceOnSurface2(); // at contact pt
-        // Shift applied force to body origins.
-        const SpatialVec F2( F2cpt[0] + r2 %  F2cpt[1],  F2cpt[1]);
-        const SpatialVec F1(-F2cpt[0] + r1 % -F2cpt[1], -F2cpt[1]);
-        mobod1.applyBodyForce(s, F1, rigidBodyForces);
-        mobod2.applyBodyForce(s, F2, rigidBodyForces);
+    if (   !m_executor || (int)forces.size() < MinContactsForParallel
+        || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&m_executorLock) != 0) {
+        for (unsigned i=0; i < forces.size(); ++i)
+            applyContactForce(s, contacts, forces[i], rigidBodyForces);
+        return 0;
     }
 
+    Array_<Vector_<SpatialVec> >& chunkForces = updBodyForceChunks(s);
+    chunkForces.resize(m_numThreads);
+    for (int c=0; c < m_numThreads; ++c) {
+        chunkForces[c].resize(rigidBodyForces.size());
+        chunkForces[c] = SpatialVec(Vec3(0), Vec3(0));
+    }
+    applyContactForcesInParallel(s, contacts, forces, chunkForces); // unlocks
+    for (int c=0; c < m_numThreads; ++c)
+        rigidBodyForces += chunkForces[c];
+
     return 0;
 }
 
@@ -354,9 +548,20 @@ void markPotentialEnergyCacheValid(const State& s) const
 void markForceCacheValid(const State& s) const
 {   markCacheValueRealized(s,m_forceCacheIx); }
 
+Array_<Vector_<SpatialVec> >& updBodyForceChunks(const State& s) const
+{   return Value<Array_<Vector_<SpatialVec> > >::updDowncast
+                                    (updCacheEntry(s,m_bodyForceChunksIx)); }
+
 void ensurePotentialEnergyCacheValid(const State&) const;
 void ensureForceCacheValid(const State&) const;
 
+void calcAllContactForces(const State&, const ContactSnapshot&, 
+                          bool atZeroVelocity, Array_<ContactForce>&) const;
+// The caller must hold m_executorLock; this releases it.
+void applyContactForcesInParallel(const State&, const ContactSnapshot&,
+                                  const Array_<ContactForce>&,
+                                  Array_<Vector_<SpatialVec> >&) const;
+
 
 
     // TOPOLOGY "STATE"
@@ -383,6 +588,22 @@ GeneratorMap                        m_generators;
 // this will either do nothing silently or throw an error.
 ContactForceGenerator*              m_defaultGenerator;
 
+// If non-null, contact forces are calculated by this executor's worker 
+// threads. Owned by this object; null means serial. The executor isn't
+// reentrant, so it is used only while holding m_executorLock, which is taken
+// with trylock; if another thread (realizing a different State) holds it, the
+// work is done serially instead.
+ParallelExecutor*                   m_executor;
+int                                 m_numThreads;
+mutable pthread_mutex_t             m_executorLock;
+
+// When set we time every force generator call and keep the totals here,
+// indexed by ContactTypeId. These are updated during const realizations,
+// possibly of several States at once, so are guarded by a lock.
+bool                                m_trackGeneratorTiming;
+mutable Array_<GeneratorStats>      m_generatorStats;
+mutable pthread_mutex_t             m_statsLock;
+
     // TOPOLOGY "CACHE"
 
 // These must be set during realizeTopology and treated as const thereafter.
@@ -391,6 +612,7 @@ ContactForceGenerator*              m_defaultGenerator;
 ZIndex                              m_dissipatedEnergyIx;
 CacheEntryIndex                     m_potEnergyCacheIx;
 CacheEntryIndex                     m_forceCacheIx;
+CacheEntryIndex                     m_bodyForceChunksIx;
 };
 
 void CompliantContactSubsystemImpl::
@@ -418,15 +640,10 @@ ensurePotentialEnergyCacheValid(const State& state) const {
     // to calculate forces at zero velocity and then throw away all the 
     // results except for the PE.
     const ContactSnapshot& active = m_tracker.getActiveContacts(state);
-    const int nContacts = active.getNumContacts();
-    for (int i=0; i<nContacts; ++i) {
-        const Contact& contact = active.getContact(i);
-        const ContactForceGenerator& generator = 
-            getForceGenerator(contact.getTypeId());
-        ContactForce force;
-        generator.calcContactForce(state,contact,SpatialVec(Vec3(0)), force);
-        pe += force.getPotentialEnergy();
-    }
+    Array_<ContactForce> forces(active.getNumContacts());
+    calcAllContactForces(state, active, true, forces);
+    for (unsigned i=0; i < forces.size(); ++i)
+        pe += forces[i].getPotentialEnergy();
 
     markPotentialEnergyCacheValid(state);
 }
@@ -440,53 +657,163 @@ ensureForceCacheValid(const State& state) const {
         "CompliantContactSubystemImpl::ensureForceCacheValid()");
 
     Array_<ContactForce>& forces = updForceCache(state);
-    forces.clear();
+    const ContactSnapshot& active = m_tracker.getActiveContacts(state);
+    forces.resize(active.getNumContacts());
+    // Slots kept from the last evaluation must not look valid if their 
+    // generator doesn't write them this time.
+    for (unsigned i=0; i < forces.size(); ++i)
+        forces[i].clear();
+    calcAllContactForces(state, active, false, forces);
 
+    // Squeeze out the contacts that aren't producing forces, keeping the
+    // rest in contact order.
+    unsigned nForces = 0;
+    for (unsigned i=0; i < forces.size(); ++i)
+        if (forces[i].isValid()) {
+            if (nForces != i) forces[nForces] = forces[i];
+            ++nForces;
+        }
+    forces.resize(nForces);
 
-    const ContactSnapshot& active = m_tracker.getActiveContacts(state);
-    const int nContacts = active.getNumContacts();
-    for (int i=0; i<nContacts; ++i) {
-        const Contact& contact = active.getContact(i);
-        if (contact.getCondition() == Contact::Broken) {
-            // No need to generate forces; this will be gone next time.
-            continue;
+    markForceCacheValid(state);
+}
+
+
+namespace {
+
+// Calculates the forces for runs of ContactsPerChunk consecutive contacts.
+// Each contact's force goes in its own slot so the result doesn't depend on
+// how the work was scheduled. Exceptions are caught and recorded per chunk 
+// so the first one can be rethrown by the caller.
+class CalcContactForcesTask : public ParallelExecutor::Task {
+public:
+    CalcContactForcesTask(const CompliantContactSubsystemImpl& subsys,
+                          const State&                         state,
+                          const ContactSnapshot&               active,
+                          bool                                 atZeroVelocity,
+                          bool                                 trackTiming,
+                          Array_<ContactForce>&                forces)
+    :   subsys(subsys), state(state), active(active), 
+        atZeroVelocity(atZeroVelocity), forces(forces),
+        errors(getNumChunks()), stats(trackTiming ? getNumChunks() : 0) {}
+
+    int getNumChunks() const 
+    {   return ((int)forces.size() + ContactsPerChunk-1) / ContactsPerChunk; }
+
+    void execute(int chunk) OVERRIDE_11 {
+        const int begin = chunk*ContactsPerChunk;
+        const int end   = std::min(begin+ContactsPerChunk, (int)forces.size());
+        try {
+            subsys.calcContactForces(state, active, atZeroVelocity, begin, end,
+                forces, stats.empty() ? 0 : &stats[chunk]);
         }
-        const Transform& X_S1S2 = contact.getTransform();
-        const ContactSurfaceIndex surf1(contact.getSurface1());
-        const ContactSurfaceIndex surf2(contact.getSurface2());
-        const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
-        const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
-
-        // TODO: These two are expensive (63 flops each) and shouldn't have 
-        // to be recalculated here since we must have used them in creating
-        // the Contact and X_S1S2.
-        const Transform X_GS1 = mobod1.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const Transform X_GS2 = mobod2.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        // Calculate the relative velocity of S2 in S1, expressed in S1.
-        const SpatialVec V_S1S2 =
-            findRelativeVelocity(X_GS1, V_GS1, X_GS2, V_GS2);   // 51 flops
+        catch (const std::exception& e) {errors[chunk] = e.what();}
+        catch (...) {errors[chunk] = "unknown exception";}
+    }
 
-        const ContactForceGenerator& generator = 
-            getForceGenerator(contact.getTypeId());
-        forces.push_back(); // allocate a new garbage ContactForce
-        // Calculate the contact force measured and expressed in S1.
-        generator.calcContactForce(state, contact, V_S1S2, forces.back());
-        // Re-express the contact force in Ground for later use.
-        if (forces.back().isValid())
-            forces.back().changeFrameInPlace(X_GS1); // switch to Ground
-        else
-            forces.pop_back(); // never mind ...
+    void rethrowFirstError() const {
+        for (unsigned c=0; c < errors.size(); ++c)
+            if (!errors[c].empty())
+                SimTK_THROW1(Exception::Cant, errors[c]);
     }
 
-    markForceCacheValid(state);
+    void recordStats() const {
+        for (unsigned c=0; c < stats.size(); ++c)
+            subsys.recordGeneratorStats(stats[c]);
+    }
+private:
+    const CompliantContactSubsystemImpl&    subsys;
+    const State&                            state;
+    const ContactSnapshot&                  active;
+    const bool                              atZeroVelocity;
+    Array_<ContactForce>&                   forces;
+    Array_<std::string>                     errors;
+    Array_<Array_<GeneratorStats> >         stats;
+};
+
+// Applies a fixed, contiguous chunk of the contact forces to each of the
+// supplied rigid body force arrays. The chunking depends only on the number
+// of arrays so summing them in order gives the same result every time.
+class ApplyContactForcesTask : public ParallelExecutor::Task {
+public:
+    ApplyContactForcesTask(const CompliantContactSubsystemImpl& subsys,
+                           const State&                         state,
+                           const ContactSnapshot&               contacts,
+                           const Array_<ContactForce>&          forces,
+                           Array_<Vector_<SpatialVec> >&        chunkForces)
+    :   subsys(subsys), state(state), contacts(contacts), forces(forces),
+        chunkForces(chunkForces), errors(chunkForces.size()) {}
+
+    void execute(int chunk) OVERRIDE_11 {
+        const int n = (int)forces.size(), nChunks = (int)chunkForces.size();
+        const int begin = (int)((long long)chunk*n/nChunks);
+        const int end   = (int)((long long)(chunk+1)*n/nChunks);
+        try {
+            for (int i=begin; i < end; ++i)
+                subsys.applyContactForce(state, contacts, forces[i], 
+                                         chunkForces[chunk]);
+        }
+        catch (const std::exception& e) {errors[chunk] = e.what();}
+        catch (...) {errors[chunk] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned c=0; c < errors.size(); ++c)
+            if (!errors[c].empty())
+                SimTK_THROW1(Exception::Cant, errors[c]);
+    }
+private:
+    const CompliantContactSubsystemImpl&    subsys;
+    const State&                            state;
+    const ContactSnapshot&                  contacts;
+    const Array_<ContactForce>&             forces;
+    Array_<Vector_<SpatialVec> >&           chunkForces;
+    Array_<std::string>                     errors;
+};
+
+}
+
+
+// Fill in a force for every active contact, using worker threads if parallel
+// evaluation is on and there are enough contacts to make it worthwhile. We 
+// never fan out from a thread that is already a ParallelExecutor worker, or
+// while another thread is using the executor.
+void CompliantContactSubsystemImpl::
+calcAllContactForces(const State& state, const ContactSnapshot& active,
+                     bool atZeroVelocity, Array_<ContactForce>& forces) const {
+    const int nContacts = (int)forces.size();
+    if (   !m_executor || nContacts < MinContactsForParallel
+        || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&m_executorLock) != 0) {
+        if (!m_trackGeneratorTiming) {
+            calcContactForces(state, active, atZeroVelocity, 0, nContacts,
+                              forces, 0);
+            return;
+        }
+        Array_<GeneratorStats> stats;
+        calcContactForces(state, active, atZeroVelocity, 0, nContacts,
+                          forces, &stats);
+        recordGeneratorStats(stats);
+        return;
+    }
+
+    CalcContactForcesTask task(*this, state, active, atZeroVelocity,
+                               m_trackGeneratorTiming, forces);
+    m_executor->execute(task, task.getNumChunks()); // barrier on return
+    pthread_mutex_unlock(&m_executorLock);
+    task.rethrowFirstError();
+    task.recordStats();
+}
+
+
+void CompliantContactSubsystemImpl::
+applyContactForcesInParallel(const State& state, const ContactSnapshot& active,
+                             const Array_<ContactForce>& forces,
+                             Array_<Vector_<SpatialVec> >& chunkForces) const {
+    ApplyContactForcesTask task(*this, state, active, forces, chunkForces);
+    m_executor->execute(task, (int)chunkForces.size()); // barrier on return
+    pthread_mutex_unlock(&m_executorLock);
+    task.rethrowFirstError();
 }
 
 
@@ -544,6 +871,24 @@ void CompliantContactSubsystem::setTrackDissipatedEnergy(bool shouldTrack)
 bool CompliantContactSubsystem::getTrackDissipatedEnergy() const
 {   return getImpl().getTrackDissipatedEnergy(); }
 
+void CompliantContactSubsystem::setUseParallelContactForces
+   (bool useParallel, int numThreads)
+{   updImpl().setUseParallelContactForces(useParallel, numThreads); }
+bool CompliantContactSubsystem::getUseParallelContactForces() const
+{   return getImpl().getUseParallelContactForces(); }
+
+void CompliantContactSubsystem::setTrackForceGeneratorTiming(bool shouldTrack)
+{   updImpl().setTrackForceGeneratorTiming(shouldTrack); }
+bool CompliantContactSubsystem::getTrackForceGeneratorTiming() const
+{   return getImpl().getTrackForceGeneratorTiming(); }
+int CompliantContactSubsystem::
+getNumForceGeneratorCalls(ContactTypeId type) const
+{   return getImpl().getNumForceGeneratorCalls(type); }
+Real CompliantContactSubsystem::getForceGeneratorTime(ContactTypeId type) const
+{   return getImpl().getForceGeneratorTime(type); }
+void CompliantContactSubsystem::resetStats() const
+{   getImpl().resetStats(); }
+
 int CompliantContactSubsystem::getNumContactForces(const State& s) const
 {   return getImpl().getNumContactForces(s); }
 
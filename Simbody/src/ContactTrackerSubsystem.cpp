@@ -43,6 +43,10 @@ namespace SimTK {
 
 SimTK_DEFINE_UNIQUE_INDEX_TYPE(BubbleIndex);
 
+// Leaf boxes in the broad phase tree are enlarged by this fraction of the
+// bubble radius on each side.
+static const Real BubbleTreeMargin = Real(0.1);
+
 //TODO: should these be organized by body rather than surface?
 //      surfaces on ground certainly should!
 
@@ -66,21 +70,239 @@ static std::ostream& operator<<(std::ostream& o, const Bubble& bb) {
     return o;
 }
 
-// For spatial sorting of bubbles.
-class BubbleExtent {
+// This is a dynamic axis-aligned bounding box tree over the bubbles, used
+// for broad phase pair finding. Each bounded bubble is a leaf whose box has
+// been "fattened" by a margin so that small motions don't require any change
+// to the tree; when a bubble's box escapes its fattened box the leaf is 
+// removed and reinserted. Insertion picks a sibling by a surface area 
+// heuristic and the tree is kept height-balanced with AVL-style rotations,
+// so updating is O(log n) per moved bubble and pair finding is O(n log n + k)
+// for k overlapping pairs regardless of how the bubbles are arranged. 
+// Bubbles with infinite radius (e.g. half spaces) can't go in the tree; they
+// are kept in a separate list and paired with everything.
+//
+// The tree is kept in a cache entry so that each State carries the tree
+// that matches its most recent contact update.
+class BubbleTree {
 public:
-    BubbleExtent(Real start, Real end, BubbleIndex index) 
-    :   start(start), end(end), index(index) {}
-    BubbleExtent() {}
-    bool operator<(const BubbleExtent& e) const 
-    {   return start < e.start; }
-    Real        start, end; // span along chosen sort axis
-    BubbleIndex index;
+    BubbleTree() {clear();}
+
+    void clear() {
+        m_nodes.clear(); m_leafOfBubble.clear(); m_unbounded.clear();
+        m_root = m_free = NoNode;
+    }
+
+    int getNumBubbles() const {return m_leafOfBubble.size();}
+    const Array_<BubbleIndex>& getUnboundedBubbles() const 
+    {   return m_unbounded; }
+
+    // Start over with a tree for numBubbles bubbles, none inserted yet.
+    void resize(int numBubbles) {
+        clear();
+        m_leafOfBubble.resize(numBubbles, NoNode);
+        m_nodes.reserve(2*numBubbles);
+    }
+
+    // Make sure the given bubble's current tight box [lo,hi] is contained in
+    // its leaf's fattened box, reinserting it if necessary. Call this once
+    // for each bubble (in order) when the tree is first built.
+    void updateBubble(BubbleIndex bbx, const Vec3& lo, const Vec3& hi, 
+                      Real margin) {
+        int leaf = m_leafOfBubble[bbx];
+        if (leaf != NoNode) {
+            const Node& node = m_nodes[leaf];
+            if (contains(node.lo, node.hi, lo, hi)) return;
+            removeLeaf(leaf);
+        } else {
+            leaf = allocateNode();
+            m_leafOfBubble[bbx] = leaf;
+            m_nodes[leaf].bubble = bbx;
+        }
+        Node& node = m_nodes[leaf];
+        node.lo = lo - margin; node.hi = hi + margin;
+        insertLeaf(leaf);
+    }
+
+    // An unbounded bubble is never inserted; call once when building.
+    void addUnboundedBubble(BubbleIndex bbx) {m_unbounded.push_back(bbx);}
+
+    // Append to "found" all bubbles whose fattened box overlaps [lo,hi].
+    void findOverlaps(const Vec3& lo, const Vec3& hi, 
+                      Array_<BubbleIndex>& found) const {
+        if (m_root == NoNode) return;
+        m_stack.clear();
+        m_stack.push_back(m_root);
+        while (!m_stack.empty()) {
+            const Node& node = m_nodes[m_stack.back()];
+            m_stack.pop_back();
+            if (!overlaps(node.lo, node.hi, lo, hi)) continue;
+            if (node.isLeaf()) found.push_back(node.bubble);
+            else {m_stack.push_back(node.child1); 
+                  m_stack.push_back(node.child2);}
+        }
+    }
+
+private:
+    enum {NoNode = -1};
+    struct Node {
+        bool isLeaf() const {return child1 == NoNode;}
+        Vec3 lo, hi;        // box in Ground (fattened for leaves)
+        int  parent;        // or next free node when on the free list
+        int  child1, child2;
+        int  height;        // leaves are 0
+        BubbleIndex bubble; // leaves only
+    };
+
+    static bool contains(const Vec3& outerLo, const Vec3& outerHi,
+                         const Vec3& lo, const Vec3& hi) {
+        for (int i=0; i<3; ++i)
+            if (lo[i] < outerLo[i] || hi[i] > outerHi[i]) return false;
+        return true;
+    }
+    static bool overlaps(const Vec3& lo1, const Vec3& hi1,
+                         const Vec3& lo2, const Vec3& hi2) {
+        for (int i=0; i<3; ++i)
+            if (lo1[i] > hi2[i] || lo2[i] > hi1[i]) return false;
+        return true;
+    }
+    static Real area(const Vec3& lo, const Vec3& hi) {
+        const Vec3 d = hi - lo;
+        return 2*(d[0]*d[1] + d[1]*d[2] + d[2]*d[0]);
+    }
+    static Real unionArea(const Node& a, const Node& b) {
+        return area(Vec3(std::min(a.lo[0],b.lo[0]), std::min(a.lo[1],b.lo[1]),
+                         std::min(a.lo[2],b.lo[2])),
+                    Vec3(std::max(a.hi[0],b.hi[0]), std::max(a.hi[1],b.hi[1]),
+                         std::max(a.hi[2],b.hi[2])));
+    }
+    // Set an internal node's box and height from its children.
+    void refit(int n) {
+        Node& node = m_nodes[n];
+        const Node& c1 = m_nodes[node.child1];
+        const Node& c2 = m_nodes[node.child2];
+        for (int i=0; i<3; ++i) {
+            node.lo[i] = std::min(c1.lo[i], c2.lo[i]);
+            node.hi[i] = std::max(c1.hi[i], c2.hi[i]);
+        }
+        node.height = 1 + std::max(c1.height, c2.height);
+    }
+    // Replace oldChild by newChild in oldChild's parent, or at the root.
+    void replaceChild(int parent, int oldChild, int newChild) {
+        if (parent == NoNode) {m_root = newChild; return;}
+        Node& p = m_nodes[parent];
+        if (p.child1 == oldChild) p.child1 = newChild;
+        else                      p.child2 = newChild;
+    }
+
+    int allocateNode() {
+        int n = m_free;
+        if (n != NoNode) m_free = m_nodes[n].parent;
+        else {n = m_nodes.size(); m_nodes.push_back();}
+        Node& node = m_nodes[n];
+        node.parent = node.child1 = node.child2 = NoNode;
+        node.height = 0;
+        return n;
+    }
+    void freeNode(int n) {
+        m_nodes[n].parent = m_free; m_nodes[n].height = -1;
+        m_free = n;
+    }
+
+    void insertLeaf(int leaf) {
+        if (m_root == NoNode) {
+            m_root = leaf; m_nodes[leaf].parent = NoNode;
+            return;
+        }
+        // Descend to the cheapest sibling for the new leaf.
+        int sibling = m_root;
+        while (!m_nodes[sibling].isLeaf()) {
+            const Node& node = m_nodes[sibling];
+            const Real combined = unionArea(node, m_nodes[leaf]);
+            const Real cost = 2*combined; // new parent here
+            const Real inheritance = 2*(combined - area(node.lo, node.hi));
+            Real childCost[2];
+            const int children[2] = {node.child1, node.child2};
+            for (int c=0; c<2; ++c) {
+                const Node& child = m_nodes[children[c]];
+                childCost[c] = unionArea(child, m_nodes[leaf]) + inheritance;
+                if (!child.isLeaf()) childCost[c] -= area(child.lo, child.hi);
+            }
+            if (cost < childCost[0] && cost < childCost[1]) break;
+            sibling = childCost[0] < childCost[1] ? children[0] : children[1];
+        }
+
+        const int oldParent = m_nodes[sibling].parent;
+        const int newParent = allocateNode();
+        m_nodes[newParent].parent = oldParent;
+        m_nodes[newParent].child1 = sibling;
+        m_nodes[newParent].child2 = leaf;
+        replaceChild(oldParent, sibling, newParent);
+        m_nodes[sibling].parent = m_nodes[leaf].parent = newParent;
+
+        refitUpward(newParent);
+    }
+
+    void removeLeaf(int leaf) {
+        if (leaf == m_root) {m_root = NoNode; return;}
+        const int parent = m_nodes[leaf].parent;
+        const int grandParent = m_nodes[parent].parent;
+        const int sibling = m_nodes[parent].child1 == leaf 
+                            ? m_nodes[parent].child2 : m_nodes[parent].child1;
+        replaceChild(grandParent, parent, sibling);
+        m_nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitUpward(grandParent);
+    }
+
+    // Rebalance and refit every node from n to the root.
+    void refitUpward(int n) {
+        while (n != NoNode) {
+            n = balance(n);
+            refit(n);
+            n = m_nodes[n].parent;
+        }
+    }
+
+    // If node a's subtrees differ in height by more than one, rotate the 
+    // taller child up to take a's place. Returns the index of the node now
+    // at a's former position.
+    int balance(int a) {
+        if (m_nodes[a].isLeaf() || m_nodes[a].height < 2) return a;
+        const int b = m_nodes[a].child1, c = m_nodes[a].child2;
+        const int diff = m_nodes[c].height - m_nodes[b].height;
+        if (diff > 1)  return rotateUp(a, c, false);
+        if (diff < -1) return rotateUp(a, b, true);
+        return a;
+    }
+
+    // Promote a's child "up" to replace a; a keeps its other child and takes
+    // the shorter of up's children. The taller one stays with up.
+    int rotateUp(int a, int up, bool upWasChild1) {
+        const int f = m_nodes[up].child1, g = m_nodes[up].child2;
+        m_nodes[up].child1 = a;
+        m_nodes[up].parent = m_nodes[a].parent;
+        m_nodes[a].parent  = up;
+        replaceChild(m_nodes[up].parent, a, up);
+
+        const bool fTaller = m_nodes[f].height > m_nodes[g].height;
+        const int keep = fTaller ? f : g, give = fTaller ? g : f;
+        m_nodes[up].child2 = keep;
+        if (upWasChild1) m_nodes[a].child1 = give;
+        else             m_nodes[a].child2 = give;
+        m_nodes[give].parent = a;
+
+        refit(a);
+        refit(up);
+        return up;
+    }
+
+    Array_<Node,int>            m_nodes;
+    Array_<int,BubbleIndex>     m_leafOfBubble;
+    Array_<BubbleIndex>         m_unbounded;
+    int                         m_root;
+    int                         m_free;     // head of free node list
+    mutable Array_<int>         m_stack;    // temp for findOverlaps()
 };
-static std::ostream& operator<<(std::ostream& o, const BubbleExtent& bx) {
-    o << bx.index << ":(" << bx.start << "," << bx.end << ")";
-    return o;
-}
 
 typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
                   pair<ContactTracker*,bool> > TrackerMap;
@@ -132,11 +354,12 @@ ContactTrackerSubsystemImpl() : m_defaultTracker(0) {
     adoptContactTracker(new ContactTracker::TriangleMeshTriangleMesh());
 
     // Handle sphere-ellipsoid and ellipsoid-ellipsoid by treating them as
-    // convex objects represented by their implicit functions.
-    adoptContactTracker(new ContactTracker::ConvexImplicitPair
+    // convex objects represented by their support functions. These fall 
+    // back to the implicit function method if necessary.
+    adoptContactTracker(new ContactTracker::ConvexSupportPair
                                 (ContactGeometry::Sphere::classTypeId(),
                                  ContactGeometry::Ellipsoid::classTypeId()));
-    adoptContactTracker(new ContactTracker::ConvexImplicitPair
+    adoptContactTracker(new ContactTracker::ConvexSupportPair
                                 (ContactGeometry::Ellipsoid::classTypeId(),
                                  ContactGeometry::Ellipsoid::classTypeId()));
 }
@@ -220,6 +443,10 @@ int realizeSubsystemTopologyImpl(State& state) const {
     wThis->m_predictedContactsIx = allocateAutoUpdateDiscreteVariable
         (state, Stage::Dynamics, new Value<ContactSnapshot>(), 
          Stage::Acceleration);  // update depends on accelerations
+    // The broad phase tree is never marked valid; it persists and is 
+    // updated in place whenever contacts are updated.
+    wThis->m_bubbleTreeIx = allocateLazyCacheEntry
+        (state, Stage::Topology, new Value<BubbleTree>());
 
     const SimbodyMatterSubsystem& matter = getMatterSubsystem();
 
@@ -259,85 +486,80 @@ int realizeSubsystemVelocityImpl(const State& state) const {
     return 0;
 }
 
-// Adds new pairs to the existing set, if not already present.
+// Adds new pairs to the existing set, if not already present. Candidates
+// come from the State's persistent bubble tree, which is brought up to date
+// with the current bubble positions first.
 void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
     const int numBubbles = getNumBubbles();
-    
-    // Perform a sweep-and-prune on a single axis to identify potential 
-    // contacts. First, find which axis has the most variation in body 
-    // locations. That is the axis we will use.
-    // TODO: this one-axis method is not good enough in general
-    
+    BubbleTree& tree = Value<BubbleTree>::updDowncast
+                            (updCacheEntry(state, m_bubbleTreeIx));
+    const bool mustBuild = (tree.getNumBubbles() != numBubbles);
+    if (mustBuild) tree.resize(numBubbles);
+
     Vector_<Vec3> centers(numBubbles);
     for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
         const Bubble&  bubb = m_bubbles[bbx];
         const Surface& surf = m_surfaces[bubb.surface];
         centers[bbx] = surf.mobod->getBodyTransform(state) 
                         * bubb.getCenter();
+        const Real radius = bubb.getRadius();
+        if (radius == Infinity) {
+            if (mustBuild) tree.addUnboundedBubble(bbx);
+            continue;
+        }
+        tree.updateBubble(bbx, centers[bbx]-radius, centers[bbx]+radius,
+                          BubbleTreeMargin*radius);
     }
-    Vec3 average = mean(centers);
-    Vec3 var(0);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx)
-        var += abs(centers[bbx]-average);
-    int axis = (var[0] > var[1] ? 0 : 1);
-    if (var[2] > var[axis])
-        axis = 2;
-    
-    // Find the extent of each bubble along the axis and sort them by 
-    // starting location.
-    Array_<BubbleExtent,int> extents(numBubbles);
+
+    // Every pair of overlapping bubbles is found when looking for the 
+    // lower-numbered one's overlaps, since its tight box must overlap the 
+    // other's fattened box.
+    Array_<BubbleIndex> found;
     for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
         const Real radius = m_bubbles[bbx].getRadius();
-        const Real center = centers[bbx][axis];
-        extents[bbx] = BubbleExtent(center-radius, center+radius, bbx);
-    }
-    //cout << "Bubble extents:" << extents << "\n";
-
-    // Expensive: O(n log n)
-    std::sort(extents.begin(), extents.end());
-    
-    // Now sweep along the axis, finding potential contacts.
-    
-    for (int ex1=0; ex1 < numBubbles; ++ex1) {
-        const BubbleExtent& extent1 = extents[ex1];
-        const Bubble&       bubb1   = m_bubbles[extent1.index];
-        const Real          radius1 = bubb1.getRadius();
-        const Vec3&         center1 = centers[extent1.index];
-
-        // Loop over just the overlapping bubbles.
-        for (int ex2(ex1+1); ex2 < numBubbles; ++ex2) {
-            const BubbleExtent& extent2 = extents[ex2];
-            if (extent2.start > extent1.end)
-                break;  // no more bubbles can overlap with extent1
-
-            // These bubbles do overlap along this axis. See if they are
-            // actually touching.
-            const Bubble& bubb2   = m_bubbles[extent2.index];
-            const Real    radius2 = bubb2.getRadius();
-            const Vec3&   center2 = centers[extent2.index];
-            if ((center1-center2).normSqr() > square(radius1+radius2))
-                continue; // nope
-
-            // The bubbles are touching. We'll add the corresponding surfaces
-            // to the narrow-phase list unless there are relevant exclusions.
-            const Surface& surf1 = m_surfaces[bubb1.surface];
-            const Surface& surf2 = m_surfaces[bubb2.surface];
-            // Ignore if on the same body.
-            if (surf1.mobod == surf2.mobod) continue;
-            assert(bubb1.surface != bubb2.surface); // duh!
-            // Ignore if surfaces are in a common clique.
-            if (surf1.surface->isInSameClique(*surf2.surface)) continue;
-            // We'll need to do a narrow phase investigation of these two
-            // surfaces; use the lower-numbered one as the index to avoid
-            // duplicates.
-            ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
-            if (low > high) std::swap(low,high);
-            ContactSurfaceSet& surfSet = pairs[low];
-            // Insert this pair with null Contact if the pair isn't already
-            // in the PairMap.
-            surfSet.insert(make_pair(high,(Contact*)0));
-        }
+        if (radius == Infinity) continue;
+        found.clear();
+        tree.findOverlaps(centers[bbx]-radius, centers[bbx]+radius, found);
+        for (unsigned i=0; i < found.size(); ++i)
+            if (found[i] > bbx)
+                addPairIfTouching(bbx, found[i], centers, pairs);
     }
+
+    // Bubbles of infinite extent might touch anything.
+    const Array_<BubbleIndex>& unbounded = tree.getUnboundedBubbles();
+    for (unsigned i=0; i < unbounded.size(); ++i)
+        for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx)
+            if (bbx != unbounded[i] && (m_bubbles[bbx].getRadius() != Infinity
+                                        || bbx > unbounded[i]))
+                addPairIfTouching(unbounded[i], bbx, centers, pairs);
+}
+
+// If two bubbles are touching, add the corresponding surfaces to the 
+// narrow-phase list unless there are relevant exclusions.
+void addPairIfTouching(BubbleIndex bbx1, BubbleIndex bbx2, 
+                       const Vector_<Vec3>& centers, PairMap& pairs) const {
+    const Bubble& bubb1 = m_bubbles[bbx1];
+    const Bubble& bubb2 = m_bubbles[bbx2];
+    if ((centers[bbx1]-centers[bbx2]).normSqr() 
+        > square(bubb1.getRadius()+bubb2.getRadius()))
+        return; // nope
+
+    const Surface& surf1 = m_surfaces[bubb1.surface];
+    const Surface& surf2 = m_surfaces[bubb2.surface];
+    // Ignore if on the same body.
+    if (surf1.mobod == surf2.mobod) return;
+    assert(bubb1.surface != bubb2.surface); // duh!
+    // Ignore if surfaces are in a common clique.
+    if (surf1.surface->isInSameClique(*surf2.surface)) return;
+    // We'll need to do a narrow phase investigation of these two
+    // surfaces; use the lower-numbered one as the index to avoid
+    // duplicates.
+    ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
+    if (low > high) std::swap(low,high);
+    ContactSurfaceSet& surfSet = pairs[low];
+    // Insert this pair with null Contact if the pair isn't already
+    // in the PairMap.
+    surfSet.insert(make_pair(high,(Contact*)0));
 }
 
 // Call this any time after positions are known, to ensure that the active
@@ -553,6 +775,7 @@ Array_<Surface,ContactSurfaceIndex> m_surfaces;
 Array_<Bubble,BubbleIndex>          m_bubbles;
 DiscreteVariableIndex               m_activeContactsIx;
 DiscreteVariableIndex               m_predictedContactsIx;
+CacheEntryIndex                     m_bubbleTreeIx;
 };
 
 
@@ -27,7 +27,8 @@
 #include "simbody/internal/GeneralContactSubsystem.h"
 #include "simbody/internal/MobilizedBody.h"
 #include "ElasticFoundationForceImpl.h"
-#include <map>
+#include <algorithm>
+#include <string>
 #include <set>
 
 namespace SimTK {
@@ -53,9 +54,47 @@ void ElasticFoundationForce::setTransitionVelocity(Real v) {
     updImpl().transitionVelocity = v;
 }
 
+void ElasticFoundationForce::setUseParallelSprings
+   (bool useParallel, int numThreads) {
+    updImpl().setUseParallelSprings(useParallel, numThreads);
+}
+
+bool ElasticFoundationForce::getUseParallelSprings() const {
+    return getImpl().getUseParallelSprings();
+}
+
 ElasticFoundationForceImpl::ElasticFoundationForceImpl
    (GeneralContactSubsystem& subsystem, ContactSetIndex set) : 
-        subsystem(subsystem), set(set), transitionVelocity(Real(0.01)) {
+        subsystem(subsystem), set(set), transitionVelocity(Real(0.01)),
+        springExecutor(0), springThreads(1) {
+    pthread_mutex_init(&springExecutorLock, NULL);
+}
+
+ElasticFoundationForceImpl::ElasticFoundationForceImpl
+   (const ElasticFoundationForceImpl& src) : 
+        ForceImpl(src), subsystem(src.subsystem), set(src.set), 
+        parameters(src.parameters), 
+        transitionVelocity(src.transitionVelocity),
+        energyCacheIndex(src.energyCacheIndex),
+        springExecutor(0), springThreads(1) {
+    pthread_mutex_init(&springExecutorLock, NULL);
+    setUseParallelSprings(src.springExecutor != 0, src.springThreads);
+}
+
+void ElasticFoundationForceImpl::setUseParallelSprings
+   (bool useParallel, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "ElasticFoundationForce", "setUseParallelSprings",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete springExecutor;
+    springExecutor = 0;
+    springThreads  = 1;
+
+    if (useParallel && numThreads > 1) {
+        springExecutor = new ParallelExecutor(numThreads);
+        springThreads  = numThreads;
+    }
 }
 
 void ElasticFoundationForceImpl::setBodyParameters
@@ -67,6 +106,8 @@ void ElasticFoundationForceImpl::setBodyParameters
                         == ContactGeometry::TriangleMesh::classTypeId(), 
         "ElasticFoundationForceImpl", "setBodyParameters",
         "Body %d is not a triangle mesh", (int)bodyIndex);
+    if ((int)bodyIndex >= (int)parameters.size())
+        parameters.resize(bodyIndex+1);
     parameters[bodyIndex] = 
         Parameters(stiffness, dissipation, staticFriction, dynamicFriction, 
                    viscousFriction);
@@ -98,88 +139,108 @@ void ElasticFoundationForceImpl::calcForce
                 (subsystem.updCacheEntry(state, energyCacheIndex));
     pe = 0.0;
     for (int i = 0; i < (int) contacts.size(); i++) {
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter1 = 
-            parameters.find(contacts[i].getSurface1());
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter2 = 
-            parameters.find(contacts[i].getSurface2());
+        const Parameters* param1 = findParameters(contacts[i].getSurface1());
+        const Parameters* param2 = findParameters(contacts[i].getSurface2());
 
         // If there are two meshes, scale each one's contributions by 50%.
-        Real areaScale = (iter1==parameters.end() || iter2==parameters.end())
-                         ? Real(1) : Real(0.5);
+        Real areaScale = (!param1 || !param2) ? Real(1) : Real(0.5);
 
-        if (iter1 != parameters.end()) {
+        if (param1) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface1(), 
-                contact.getSurface2(), iter1->second, 
+                contact.getSurface2(), *param1, 
                 contact.getSurface1Faces(), areaScale, bodyForces, pe);
         }
 
-        if (iter2 != parameters.end()) {
+        if (param2) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface2(), 
-                contact.getSurface1(), iter2->second, 
+                contact.getSurface1(), *param2, 
                 contact.getSurface2Faces(), areaScale, bodyForces, pe);
         }
     }
 }
 
-void ElasticFoundationForceImpl::processContact
-   (const State& state, 
-    ContactSurfaceIndex meshIndex, ContactSurfaceIndex otherBodyIndex, 
-    const Parameters& param, const std::set<int>& insideFaces,
-    Real areaScale, Vector_<SpatialVec>& bodyForces, Real& pe) const 
-{
-    const ContactGeometry& otherObject = subsystem.getBodyGeometry(set, otherBodyIndex);
-    const MobilizedBody& body1 = subsystem.getBody(set, meshIndex);
-    const MobilizedBody& body2 = subsystem.getBody(set, otherBodyIndex);
-    const Transform t1g = body1.getBodyTransform(state)*subsystem.getBodyTransform(set, meshIndex); // mesh to ground
-    const Transform t2g = body2.getBodyTransform(state)*subsystem.getBodyTransform(set, otherBodyIndex); // other object to ground
-    const Transform t12 = ~t2g*t1g; // mesh to other object
+namespace {
+
+// The springs of a contact patch are evaluated in fixed-size chunks and the
+// chunk results are summed in chunk order. The result is thus the same 
+// whether the chunks are run serially or on any number of threads.
+const int SpringsPerChunk = 256;
+
+// Smaller patches aren't worth sending to the thread pool.
+const int MinSpringsForParallel = 4*SpringsPerChunk;
 
-    // Loop over all the springs, and evaluate the force from each one.
+// Everything the spring loop needs to know about one mesh's side of a 
+// contact. Body 1 carries the mesh M; body 2 carries the other object O.
+// Spring positions are in M; everything else is in Ground.
+struct SpringPatch {
+    const ElasticFoundationForceImpl::Parameters*   param;
+    const ContactGeometry*                          otherObject;
+    Array_<int> faces;          // springs that may be compressed
+    Real        areaScale;
+    Real        transitionVelocity;
+    Transform   X_GM, X_GO, X_OM;
+    Vec3        p_GB1, p_GB2;   // body origins
+    SpatialVec  V_GB1, V_GB2;   // body spatial velocities
+};
 
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) {
-        int face = *iter;
+// Resultant of a range of springs as spatial forces on body 1 and body 2, 
+// about their body origins and expressed in Ground, plus the spring energy.
+struct SpringSum {
+    SpringSum() : F1(Vec3(0),Vec3(0)), F2(Vec3(0),Vec3(0)), pe(0) {}
+    SpatialVec F1, F2;
+    Real       pe;
+};
+
+void evaluateSprings(const SpringPatch& patch, int begin, int end,
+                     SpringSum& sum) 
+{
+    const ElasticFoundationForceImpl::Parameters& param = *patch.param;
+    const Vec3& w1 = patch.V_GB1[0]; const Vec3& v1 = patch.V_GB1[1];
+    const Vec3& w2 = patch.V_GB2[0]; const Vec3& v2 = patch.V_GB2[1];
+
+    for (int i = begin; i < end; ++i) {
+        const int face = patch.faces[i];
+        const Vec3& springPos = param.springPosition[face];
         UnitVec3 normal;
         bool inside;
-        Vec3 nearestPoint = otherObject.findNearestPoint(t12*param.springPosition[face], inside, normal);
+        const Vec3 nearestPoint_O = patch.otherObject->findNearestPoint
+                                        (patch.X_OM*springPos, inside, normal);
         if (!inside)
             continue;
-        
+
         // Find how much the spring is displaced.
-        
-        nearestPoint = t2g*nearestPoint;
-        const Vec3 springPosInGround = t1g*param.springPosition[face];
-        const Vec3 displacement = nearestPoint-springPosInGround;
+
+        const Vec3 nearestPoint = patch.X_GO*nearestPoint_O;
+        const Vec3 displacement = nearestPoint - patch.X_GM*springPos;
         const Real distance = displacement.norm();
         if (distance == 0.0)
             continue;
         const Vec3 forceDir = displacement/distance;
-        
-        // Calculate the relative velocity of the two bodies at the contact point.
-        
-        const Vec3 station1 = body1.findStationAtGroundPoint(state, nearestPoint);
-        const Vec3 station2 = body2.findStationAtGroundPoint(state, nearestPoint);
-        const Vec3 v1 = body1.findStationVelocityInGround(state, station1);
-        const Vec3 v2 = body2.findStationVelocityInGround(state, station2);
-        const Vec3 v = v2-v1;
+
+        // Calculate the relative velocity of the two bodies at the contact
+        // point, using the station of each body that is coincident with it.
+
+        const Vec3 r1 = nearestPoint - patch.p_GB1;
+        const Vec3 r2 = nearestPoint - patch.p_GB2;
+        const Vec3 v = (v2 + w2 % r2) - (v1 + w1 % r1);
         const Real vnormal = dot(v, forceDir);
         const Vec3 vtangent = v-vnormal*forceDir;
-        
+
         // Calculate the damping force.
-        
-        const Real area = areaScale * param.springArea[face];
+
+        const Real area = patch.areaScale * param.springArea[face];
         const Real f = param.stiffness*area*distance*(1+param.dissipation*vnormal);
         Vec3 force = (f > 0 ? f*forceDir : Vec3(0));
-        
+
         // Calculate the friction force.
-        
+
         const Real vslip = vtangent.norm();
         if (f > 0 && vslip != 0) {
-            const Real vrel = vslip/transitionVelocity;
+            const Real vrel = vslip/patch.transitionVelocity;
             const Real ffriction = 
                 f*(std::min(vrel, Real(1))
                  *(param.dynamicFriction+2*(param.staticFriction-param.dynamicFriction)
@@ -187,10 +248,96 @@ void ElasticFoundationForceImpl::processContact
             force += ffriction*vtangent/vslip;
         }
 
-        body1.applyForceToBodyPoint(state, station1, force, bodyForces);
-        body2.applyForceToBodyPoint(state, station2, -force, bodyForces);
-        pe += param.stiffness*area*displacement.normSqr()/2;
+        sum.F1[0] += r1 % force; sum.F1[1] += force;
+        sum.F2[0] -= r2 % force; sum.F2[1] -= force;
+        sum.pe += param.stiffness*area*displacement.normSqr()/2;
+    }
+}
+
+// Each task index is one chunk of springs, written to its own SpringSum.
+// Exceptions are caught per chunk so the first can be rethrown by the caller.
+class EvaluateSpringsTask : public ParallelExecutor::Task {
+public:
+    EvaluateSpringsTask(const SpringPatch& patch, Array_<SpringSum>& sums)
+    :   patch(patch), sums(sums), errors(sums.size()) {}
+
+    void execute(int chunk) OVERRIDE_11 {
+        const int begin = chunk*SpringsPerChunk;
+        const int end = std::min(begin+SpringsPerChunk, 
+                                 (int)patch.faces.size());
+        try {evaluateSprings(patch, begin, end, sums[chunk]);}
+        catch (const std::exception& e) {errors[chunk] = e.what();}
+        catch (...) {errors[chunk] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned c=0; c < errors.size(); ++c)
+            if (!errors[c].empty())
+                SimTK_THROW1(Exception::Cant, errors[c]);
+    }
+private:
+    const SpringPatch&  patch;
+    Array_<SpringSum>&  sums;
+    Array_<std::string> errors;
+};
+
+}
+
+void ElasticFoundationForceImpl::processContact
+   (const State& state, 
+    ContactSurfaceIndex meshIndex, ContactSurfaceIndex otherBodyIndex, 
+    const Parameters& param, const std::set<int>& insideFaces,
+    Real areaScale, Vector_<SpatialVec>& bodyForces, Real& pe) const 
+{
+    const MobilizedBody& body1 = subsystem.getBody(set, meshIndex);
+    const MobilizedBody& body2 = subsystem.getBody(set, otherBodyIndex);
+    const Transform& X_GB1 = body1.getBodyTransform(state);
+    const Transform& X_GB2 = body2.getBodyTransform(state);
+
+    SpringPatch patch;
+    patch.param = &param;
+    patch.otherObject = &subsystem.getBodyGeometry(set, otherBodyIndex);
+    patch.faces.assign(insideFaces.begin(), insideFaces.end());
+    patch.areaScale = areaScale;
+    patch.transitionVelocity = transitionVelocity;
+    patch.X_GM = X_GB1*subsystem.getBodyTransform(set, meshIndex);
+    patch.X_GO = X_GB2*subsystem.getBodyTransform(set, otherBodyIndex);
+    patch.X_OM = ~patch.X_GO*patch.X_GM; // mesh to other object
+    patch.p_GB1 = X_GB1.p();
+    patch.p_GB2 = X_GB2.p();
+    patch.V_GB1 = body1.getBodyVelocity(state);
+    patch.V_GB2 = body2.getBodyVelocity(state);
+
+    // Evaluate the springs chunk by chunk, then add up the chunks in order.
+    // The executor isn't reentrant, so if another thread is using it (to
+    // realize a different State) the chunks are evaluated serially here.
+
+    const int nSprings = (int)patch.faces.size();
+    const int nChunks  = (nSprings + SpringsPerChunk-1) / SpringsPerChunk;
+    Array_<SpringSum> sums(nChunks);
+
+    if (   springExecutor && nSprings >= MinSpringsForParallel 
+        && !ParallelExecutor::isWorkerThread()
+        && pthread_mutex_trylock(&springExecutorLock) == 0) {
+        EvaluateSpringsTask task(patch, sums);
+        springExecutor->execute(task, nChunks); // barrier on return
+        pthread_mutex_unlock(&springExecutorLock);
+        task.rethrowFirstError();
+    } else {
+        for (int c=0; c < nChunks; ++c)
+            evaluateSprings(patch, c*SpringsPerChunk, 
+                            std::min((c+1)*SpringsPerChunk, nSprings), 
+                            sums[c]);
+    }
+
+    SpatialVec F1(Vec3(0),Vec3(0)), F2(Vec3(0),Vec3(0));
+    for (int c=0; c < nChunks; ++c) {
+        F1 += sums[c].F1;
+        F2 += sums[c].F2;
+        pe += sums[c].pe;
     }
+    bodyForces[body1.getMobilizedBodyIndex()] += F1;
+    bodyForces[body2.getMobilizedBodyIndex()] += F2;
 }
 
 Real ElasticFoundationForceImpl::calcPotentialEnergy(const State& state) const {
@@ -29,6 +29,8 @@
 #include "simbody/internal/ElasticFoundationForce.h"
 #include "ForceImpl.h"
 
+#include <pthread.h>
+
 namespace SimTK {
 
 class ElasticFoundationForceImpl : public ForceImpl {
@@ -36,12 +38,18 @@ public:
     class Parameters;
     ElasticFoundationForceImpl(GeneralContactSubsystem& subystem, 
                                ContactSetIndex set);
+    // The copy gets its own thread pool if the source had one.
+    ElasticFoundationForceImpl(const ElasticFoundationForceImpl& src);
+    ~ElasticFoundationForceImpl() 
+    {   delete springExecutor; pthread_mutex_destroy(&springExecutorLock); }
     ElasticFoundationForceImpl* clone() const {
         return new ElasticFoundationForceImpl(*this);
     }
     void setBodyParameters
        (ContactSurfaceIndex bodyIndex, Real stiffness, Real dissipation, 
         Real staticFriction, Real dynamicFriction, Real viscousFriction);
+    void setUseParallelSprings(bool useParallel, int numThreads);
+    bool getUseParallelSprings() const {return springExecutor != 0;}
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const;
     Real calcPotentialEnergy(const State& state) const;
@@ -54,11 +62,19 @@ public:
                         Vector_<SpatialVec>& bodyForces, Real& pe) const;
 private:
     friend class ElasticFoundationForce;
+    // Return null if this surface has no springs.
+    const Parameters* findParameters(ContactSurfaceIndex surf) const;
     const GeneralContactSubsystem& subsystem;
     const ContactSetIndex set;
-    std::map<ContactSurfaceIndex, Parameters> parameters;
+    // Indexed by ContactSurfaceIndex; surfaces that aren't spring-covered
+    // meshes have empty spring arrays.
+    Array_<Parameters, ContactSurfaceIndex> parameters;
     Real transitionVelocity;
     mutable CacheEntryIndex energyCacheIndex;
+    ParallelExecutor* springExecutor; // null unless parallel springs enabled
+    int springThreads;
+    // Held while processContact() is using springExecutor.
+    mutable pthread_mutex_t springExecutorLock;
 };
 
 class ElasticFoundationForceImpl::Parameters {
@@ -69,11 +85,20 @@ public:
             stiffness(stiffness), dissipation(dissipation), staticFriction(staticFriction), dynamicFriction(dynamicFriction), viscousFriction(viscousFriction) {
     }
     Real stiffness, dissipation, staticFriction, dynamicFriction, viscousFriction;
+    // Per-face spring data, one array per field so that the spring loop
+    // streams through just the fields it uses.
     Array_<Vec3> springPosition;
     Array_<UnitVec3> springNormal;
     Array_<Real> springArea;
 };
 
+inline const ElasticFoundationForceImpl::Parameters* 
+ElasticFoundationForceImpl::findParameters(ContactSurfaceIndex surf) const {
+    return (int)surf < (int)parameters.size() 
+           && !parameters[surf].springArea.empty() 
+           ? &parameters[surf] : 0;
+}
+
 } // namespace SimTK
 
 #endif // SimTK_SIMBODY_HUNT_CROSSLEY_FORCE_IMPL_H_
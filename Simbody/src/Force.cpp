@@ -43,6 +43,11 @@ void Force::setDisabledByDefault(bool shouldBeDisabled)
 bool Force::isDisabledByDefault() const
 {   return getImpl().isDisabledByDefault(); }
 
+void Force::setIsThreadSafe(bool isThreadSafe)
+{   updImpl().setIsThreadSafe(isThreadSafe); }
+bool Force::isThreadSafe() const
+{   return getImpl().isThreadSafe(); }
+
 void Force::disable(State& state) const 
 {   getForceSubsystem().setForceIsDisabled(state, getForceIndex(), true); }
 void Force::enable(State& state) const 
@@ -98,6 +103,7 @@ Force::TwoPointLinearSpringImpl::TwoPointLinearSpringImpl(const MobilizedBody& b
         const MobilizedBody& body2, const Vec3& station2, Real k, Real x0) : matter(body1.getMatterSubsystem()),
         body1(body1.getMobilizedBodyIndex()), station1(station1),
         body2(body2.getMobilizedBodyIndex()), station2(station2), k(k), x0(x0) {
+    setIsThreadSafe(true);
 }
 
 void Force::TwoPointLinearSpringImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -154,6 +160,7 @@ Force::TwoPointLinearDamperImpl::TwoPointLinearDamperImpl(const MobilizedBody& b
         const MobilizedBody& body2, const Vec3& station2, Real damping) : matter(body1.getMatterSubsystem()),
         body1(body1.getMobilizedBodyIndex()), station1(station1),
         body2(body2.getMobilizedBodyIndex()), station2(station2), damping(damping) {
+    setIsThreadSafe(true);
 }
 
 void Force::TwoPointLinearDamperImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -198,6 +205,7 @@ Force::TwoPointConstantForceImpl::TwoPointConstantForceImpl(const MobilizedBody&
         const MobilizedBody& body2, const Vec3& station2, Real force) : matter(body1.getMatterSubsystem()),
         body1(body1.getMobilizedBodyIndex()), station1(station1),
         body2(body2.getMobilizedBodyIndex()), station2(station2), force(force) {
+    setIsThreadSafe(true);
 }
 
 void Force::TwoPointConstantForceImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -314,6 +322,7 @@ MobilityLinearSpringImpl(const MobilizedBody&    mobod,
     m_mobodIx(mobod.getMobilizedBodyIndex()), m_whichQ(whichQ), 
     m_defaultStiffness(defaultStiffness), m_defaultQZero(defaultQZero)
 {
+    setIsThreadSafe(true);
 }
 
 void Force::MobilityLinearSpringImpl::
@@ -409,6 +418,7 @@ MobilityLinearDamperImpl(const MobilizedBody&   mobod,
     m_mobodIx(mobod.getMobilizedBodyIndex()), m_whichU(whichU), 
     m_defaultDamping(defaultDamping) 
 {
+    setIsThreadSafe(true);
 }
 
 void Force::MobilityLinearDamperImpl::
@@ -476,6 +486,7 @@ Force::MobilityConstantForceImpl::MobilityConstantForceImpl
     m_mobodIx(mobod.getMobilizedBodyIndex()), m_whichU(whichU), 
     m_defaultForce(defaultForce) 
 {
+    setIsThreadSafe(true);
 }
 
 void Force::MobilityConstantForceImpl::
@@ -611,6 +622,7 @@ Force::MobilityLinearStopImpl::MobilityLinearStopImpl
     m_defStiffness(defaultStiffness), m_defDissipation(defaultDissipation),
     m_defQLow(defaultQLow), m_defQHigh(defaultQHigh)
 {
+    setIsThreadSafe(true);
 }
 
 
@@ -699,6 +711,7 @@ Force::MobilityDiscreteForceImpl::MobilityDiscreteForceImpl
 :   m_matter(mobod.getMatterSubsystem()), 
     m_mobodIx(mobod.getMobilizedBodyIndex()), 
     m_whichU(whichU), m_defaultVal(defaultForce) {
+    setIsThreadSafe(true);
 }
 
 void Force::MobilityDiscreteForceImpl::
@@ -852,7 +865,9 @@ addForceToBodyPoint(State& state, const MobilizedBody& mobod,
 }
 
 Force::DiscreteForcesImpl::DiscreteForcesImpl
-   (const SimbodyMatterSubsystem& matter) : m_matter(matter) {}
+   (const SimbodyMatterSubsystem& matter) : m_matter(matter) {
+    setIsThreadSafe(true);
+}
 
 const Vector& Force::DiscreteForcesImpl::
 getAllMobilityForces(const State& state) const {
@@ -923,6 +938,7 @@ Force::ConstantForce::ConstantForce(GeneralForceSubsystem& forces, const Mobiliz
 
 Force::ConstantForceImpl::ConstantForceImpl(const MobilizedBody& body, const Vec3& station, const Vec3& force) :
         matter(body.getMatterSubsystem()), body(body.getMobilizedBodyIndex()), station(station), force(force) {
+    setIsThreadSafe(true);
 }
 
 void Force::ConstantForceImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -948,6 +964,7 @@ Force::ConstantTorque::ConstantTorque(GeneralForceSubsystem& forces, const Mobil
 
 Force::ConstantTorqueImpl::ConstantTorqueImpl(const MobilizedBody& body, const Vec3& torque) :
         matter(body.getMatterSubsystem()), body(body.getMobilizedBodyIndex()), torque(torque) {
+    setIsThreadSafe(true);
 }
 
 void Force::ConstantTorqueImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -971,6 +988,7 @@ Force::GlobalDamper::GlobalDamper(GeneralForceSubsystem& forces, const SimbodyMa
 }
 
 Force::GlobalDamperImpl::GlobalDamperImpl(const SimbodyMatterSubsystem& matter, Real damping) : matter(matter), damping(damping) {
+    setIsThreadSafe(true);
 }
 
 void Force::GlobalDamperImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
@@ -1009,6 +1027,7 @@ void Force::UniformGravity::setZeroHeight(Real height) {
 }
 
 Force::UniformGravityImpl::UniformGravityImpl(const SimbodyMatterSubsystem& matter, const Vec3& g, Real zeroHeight) : matter(matter), g(g), zeroHeight(zeroHeight) {
+    setIsThreadSafe(true);
 }
 
 void Force::UniformGravityImpl::calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
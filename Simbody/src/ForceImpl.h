@@ -34,7 +34,7 @@ namespace SimTK {
 // This is what a Force handle points to.
 class ForceImpl : public PIMPLImplementation<Force, ForceImpl> {
 public:
-    ForceImpl() : forces(0), defaultDisabled(false) {}
+    ForceImpl() : forces(0), defaultDisabled(false), threadSafe(false) {}
     ForceImpl(const ForceImpl& clone) {*this = clone;}
 
     void setDisabledByDefault(bool shouldBeDisabled) 
@@ -44,6 +44,13 @@ public:
     bool isDisabledByDefault() const 
     {   return defaultDisabled; }
 
+    void setIsThreadSafe(bool isThreadSafe) 
+    {   invalidateTopologyCache();
+        threadSafe = isThreadSafe; }
+
+    bool isThreadSafe() const 
+    {   return threadSafe; }
+
     virtual ~ForceImpl() {}
     virtual ForceImpl* clone() const = 0;
     virtual bool dependsOnlyOnPositions() const {
@@ -95,6 +102,11 @@ private:
     // by default.
     bool                   defaultDisabled;
 
+    // This says whether calcForce() may be called concurrently with the 
+    // calcForce() methods of other force elements. Built-in elements that
+    // only read from the State set this in their constructors.
+    bool                   threadSafe;
+
         // TOPOLOGY "CACHE"
     // Nothing in the base Impl class.
 };
@@ -408,6 +408,7 @@ Force::LinearBushingImpl::LinearBushingImpl
     defX_B1F(frameOnB1),    defX_B2M(frameOnB2), 
     defK(stiffness),        defC(damping) 
 {
+    setIsThreadSafe(true);
 }
 
 void Force::LinearBushingImpl::
@@ -37,9 +37,76 @@
 
 #include "ForceImpl.h"
 
+#include <string>
+#include <pthread.h>
+
 
 namespace SimTK {
 
+//==============================================================================
+//                         PARALLEL FORCE EVALUATION
+//==============================================================================
+// If there are fewer thread-safe force elements than this to evaluate, we 
+// don't bother handing them off to worker threads.
+static const int MinForcesForParallel = 8;
+
+namespace {
+
+// Private force arrays for one chunk of force elements, so that each worker 
+// can accumulate without synchronization. These live in a State cache entry.
+struct ForceAccumulator {
+    Vector_<SpatialVec> rigidBodyForces;
+    Vector_<Vec3>       particleForces;
+    Vector              mobilityForces;
+};
+
+// Evaluates a list of force elements in a fixed number of contiguous chunks,
+// each into its own accumulator. The chunking depends only on the number of
+// chunks and not on thread scheduling, so summing the accumulators in chunk
+// order afterwards gives the same result every time. Exceptions are caught
+// and recorded per chunk so the first one can be rethrown by the caller.
+class CalcForcesTask : public ParallelExecutor::Task {
+public:
+    CalcForcesTask(const State&                 state, 
+                   const Array_<Force*>&        forces,
+                   const Array_<ForceIndex>&    which,
+                   Array_<ForceAccumulator>&    accumulators)
+    :   state(state), forces(forces), which(which), 
+        accumulators(accumulators), errors(accumulators.size()) {}
+
+    void execute(int chunk) OVERRIDE_11 {
+        const int n = (int)which.size(), nChunks = (int)accumulators.size();
+        const int begin = (int)((long long)chunk*n/nChunks);
+        const int end   = (int)((long long)(chunk+1)*n/nChunks);
+        ForceAccumulator& acc = accumulators[chunk];
+        try {
+            for (int i=begin; i < end; ++i)
+                forces[which[i]]->getImpl().calcForce(state, 
+                    acc.rigidBodyForces, acc.particleForces, 
+                    acc.mobilityForces);
+        }
+        catch (const std::exception& e) {errors[chunk] = e.what();}
+        catch (...) {errors[chunk] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned c=0; c < errors.size(); ++c)
+            if (!errors[c].empty())
+                SimTK_THROW1(Exception::Cant, errors[c]);
+    }
+private:
+    const State&                state;
+    const Array_<Force*>&       forces;
+    const Array_<ForceIndex>&   which;
+    Array_<ForceAccumulator>&   accumulators;
+    Array_<std::string>         errors;
+};
+
+} // anonymous namespace
+//......................... PARALLEL FORCE EVALUATION ..........................
+
+
+
 // There is some tricky caching being done here for forces that have overridden
 // dependsOnlyOnPositions() (and returned "true"). This is probably only worth
 // doing for very expensive position-only forces like atomic force fields. We
@@ -49,15 +116,48 @@ namespace SimTK {
 class GeneralForceSubsystemRep : public ForceSubsystem::Guts {
 public:
     GeneralForceSubsystemRep()
-     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1")
+     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1"),
+       forceExecutor(0), forceThreads(1)
+    {   pthread_mutex_init(&forceExecutorLock, NULL); }
+
+    // The copy gets its own thread pool if the source had one.
+    GeneralForceSubsystemRep(const GeneralForceSubsystemRep& src)
+     : ForceSubsystemRep(src), forces(src.forces),
+       forceEnabledIndex(src.forceEnabledIndex),
+       cachedForcesAreValidCacheIndex(src.cachedForcesAreValidCacheIndex),
+       rigidBodyForceCacheIndex(src.rigidBodyForceCacheIndex),
+       mobilityForceCacheIndex(src.mobilityForceCacheIndex),
+       particleForceCacheIndex(src.particleForceCacheIndex),
+       accumulatorCacheIndex(src.accumulatorCacheIndex),
+       forceExecutor(0), forceThreads(1)
     {
+        pthread_mutex_init(&forceExecutorLock, NULL);
+        setUseParallelForces(src.forceExecutor != 0, src.forceThreads);
     }
     
     ~GeneralForceSubsystemRep() {
+        delete forceExecutor;
+        pthread_mutex_destroy(&forceExecutorLock);
         // Delete in reverse order to be nice to heap system.
         for (int i = (int)forces.size()-1; i >= 0; --i)
             delete forces[i]; 
     }
+
+    void setUseParallelForces(bool useParallel, int numThreads) {
+        SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+            "GeneralForceSubsystem", "setUseParallelForces",
+            "Number of threads must be positive but was %d.", numThreads);
+
+        delete forceExecutor;
+        forceExecutor = 0;
+        forceThreads  = 1;
+
+        if (useParallel && numThreads > 1) {
+            forceExecutor = new ParallelExecutor(numThreads);
+            forceThreads  = numThreads;
+        }
+    }
+    bool getUseParallelForces() const {return forceExecutor != 0;}
     
     ForceIndex adoptForce(Force& force) {
         invalidateSubsystemTopologyCache();
@@ -120,6 +220,7 @@ public:
         rigidBodyForceCacheIndex.invalidate();
         mobilityForceCacheIndex.invalidate();
         particleForceCacheIndex.invalidate();
+        accumulatorCacheIndex.invalidate();
 
         // Some forces are disabled by default; initialize the enabled flags
         // accordingly. Also, see if we're going to need to do any caching
@@ -150,6 +251,11 @@ public:
                 new Value<Vector_<Vec3> >());
         }
 
+        // Per-chunk force arrays for parallel evaluation; these stay empty
+        // unless parallel evaluation is used with this State.
+        accumulatorCacheIndex = allocateCacheEntry(s, Stage::Dynamics,
+            new Value<Array_<ForceAccumulator> >());
+
         // We must realizeTopology() even if the force is disabled by default.
         for (int i = 0; i < (int) forces.size(); ++i)
             forces[i]->getImpl().realizeTopology(s);
@@ -224,11 +330,8 @@ public:
         // checking whether the *index* is valid (i.e. does the cache entry
         // exist?), not the contents.
         if (!cachedForcesAreValidCacheIndex.isValid()) {
-            for (int i = 0; i < (int)forces.size(); ++i) {
-                if (forceEnabled[i]) 
-                    forces[i]->getImpl().calcForce
-                       (s, rigidBodyForces, particleForces, mobilityForces);
-            }
+            calcSelectedForces(s, forceEnabled, AllForces,
+                               rigidBodyForces, particleForces, mobilityForces);
 
             // Allow forces to do their own realization, but wait until all
             // forces have executed calcForce(). TODO: not sure if that is
@@ -267,26 +370,16 @@ public:
 
             // Run through all the forces, accumulating directly into the
             // force arrays or indirectly into the cache as appropriate.
-            for (int i = 0; i < (int) forces.size(); ++i) {
-                if (!forceEnabled[i]) continue;
-                const ForceImpl& impl = forces[i]->getImpl();
-                if (impl.dependsOnlyOnPositions())
-                    impl.calcForce(s, rigidBodyForceCache, particleForceCache, 
-                                      mobilityForceCache);
-                else // ordinary velocity dependent force
-                    impl.calcForce(s, rigidBodyForces, particleForces, 
-                                      mobilityForces);
-            }
+            calcSelectedForces(s, forceEnabled, PositionOnlyForces,
+                               rigidBodyForceCache, particleForceCache, 
+                               mobilityForceCache);
+            calcSelectedForces(s, forceEnabled, VelocityDependentForces,
+                               rigidBodyForces, particleForces, mobilityForces);
             cachedForcesAreValid = true;
         } else {
             // Cache already valid; just need to do the non-cached ones.
-            for (int i = 0; i < (int) forces.size(); ++i) {
-                if (!forceEnabled[i]) continue;
-                const ForceImpl& impl = forces[i]->getImpl();
-                if (!impl.dependsOnlyOnPositions())
-                    impl.calcForce(s, rigidBodyForces, particleForces, 
-                                      mobilityForces);
-            }
+            calcSelectedForces(s, forceEnabled, VelocityDependentForces,
+                               rigidBodyForces, particleForces, mobilityForces);
         }
 
         // Accumulate the values from the cache into the global arrays.
@@ -343,6 +436,83 @@ public:
     }
 
 private:
+    enum ForceSelection {AllForces, PositionOnlyForces, VelocityDependentForces};
+
+    static bool isSelected(const ForceImpl& impl, ForceSelection which) {
+        return which == AllForces 
+            || impl.dependsOnlyOnPositions() == (which == PositionOnlyForces);
+    }
+
+    // Call calcForce() for each enabled force element in the selected 
+    // category, adding into the given arrays. If parallel evaluation is on, 
+    // elements that aren't thread safe are evaluated first, serially and in 
+    // index order; then the thread-safe ones are evaluated concurrently in
+    // chunks and the chunks' results are summed in a fixed order. We never 
+    // fan out from a thread that is already a ParallelExecutor worker, and 
+    // since the executor isn't reentrant, if another thread is using it to 
+    // evaluate forces for a different State we evaluate them serially.
+    void calcSelectedForces(const State& s, const Array_<bool>& forceEnabled,
+                            ForceSelection              which,
+                            Vector_<SpatialVec>&        rigidBodyForces,
+                            Vector_<Vec3>&              particleForces,
+                            Vector&                     mobilityForces) const
+    {
+        if (!forceExecutor || ParallelExecutor::isWorkerThread()) {
+            for (int i = 0; i < (int)forces.size(); ++i) {
+                if (!forceEnabled[i]) continue;
+                const ForceImpl& impl = forces[i]->getImpl();
+                if (isSelected(impl, which))
+                    impl.calcForce(s, rigidBodyForces, particleForces, 
+                                      mobilityForces);
+            }
+            return;
+        }
+
+        Array_<ForceIndex> parallelForces;
+        for (ForceIndex i(0); i < (int)forces.size(); ++i) {
+            if (!forceEnabled[i]) continue;
+            const ForceImpl& impl = forces[i]->getImpl();
+            if (!isSelected(impl, which)) continue;
+            if (impl.isThreadSafe()) parallelForces.push_back(i);
+            else impl.calcForce(s, rigidBodyForces, particleForces, 
+                                   mobilityForces);
+        }
+
+        if (   (int)parallelForces.size() < MinForcesForParallel
+            || pthread_mutex_trylock(&forceExecutorLock) != 0) {
+            for (unsigned i=0; i < parallelForces.size(); ++i)
+                forces[parallelForces[i]]->getImpl().calcForce
+                   (s, rigidBodyForces, particleForces, mobilityForces);
+            return;
+        }
+
+        Array_<ForceAccumulator>& accumulators = 
+            Value<Array_<ForceAccumulator> >::updDowncast
+                (updCacheEntry(s, accumulatorCacheIndex));
+        accumulators.resize(forceThreads);
+        for (int c=0; c < forceThreads; ++c) {
+            ForceAccumulator& acc = accumulators[c];
+            acc.rigidBodyForces.resize(rigidBodyForces.size());
+            acc.rigidBodyForces = SpatialVec(Vec3(0), Vec3(0));
+            acc.particleForces.resize(particleForces.size());
+            acc.particleForces = Vec3(0);
+            acc.mobilityForces.resize(mobilityForces.size());
+            acc.mobilityForces = 0;
+        }
+
+        CalcForcesTask task(s, forces, parallelForces, accumulators);
+        forceExecutor->execute(task, forceThreads); // barrier on return
+        pthread_mutex_unlock(&forceExecutorLock);
+        task.rethrowFirstError();
+
+        for (int c=0; c < forceThreads; ++c) {
+            const ForceAccumulator& acc = accumulators[c];
+            rigidBodyForces += acc.rigidBodyForces;
+            particleForces  += acc.particleForces;
+            mobilityForces  += acc.mobilityForces;
+        }
+    }
+
     Array_<Force*>                  forces;
     
         // TOPOLOGY "CACHE"
@@ -358,6 +528,16 @@ private:
     mutable CacheEntryIndex         rigidBodyForceCacheIndex;
     mutable CacheEntryIndex         mobilityForceCacheIndex;
     mutable CacheEntryIndex         particleForceCacheIndex;
+
+    // Per-chunk force arrays used for parallel evaluation.
+    mutable CacheEntryIndex         accumulatorCacheIndex;
+
+    // If non-null, thread-safe force elements are evaluated by this 
+    // executor's worker threads. Owned by this Rep; null means serial.
+    // forceExecutorLock is held while the executor is in use.
+    ParallelExecutor*               forceExecutor;
+    int                             forceThreads;
+    mutable pthread_mutex_t         forceExecutorLock;
 };
 
     ///////////////////////////
@@ -420,6 +600,13 @@ void GeneralForceSubsystem::setForceIsDisabled
    (State& state, ForceIndex index, bool disabled) const 
 {   getRep().setForceIsDisabled(state, index, disabled); }
 
+void GeneralForceSubsystem::setUseParallelForces
+   (bool useParallel, int numThreads)
+{   updRep().setUseParallelForces(useParallel, numThreads); }
+
+bool GeneralForceSubsystem::getUseParallelForces() const
+{   return getRep().getUseParallelForces(); }
+
 const MultibodySystem& GeneralForceSubsystem::getMultibodySystem() const
 {   return MultibodySystem::downcast(getSystem()); }
 
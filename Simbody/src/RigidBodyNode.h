@@ -463,6 +463,24 @@ virtual void realizePosition(
 virtual void realizeVelocity(
     const SBStateDigest&         sbs) const=0;
 
+// Realize position or velocity kinematics for a block of nodes that are all
+// at the same level of the tree and all of exactly the same concrete type as
+// this node (normally this is nodes[0]). The results must be identical to 
+// calling realizePosition() or realizeVelocity() on each node in turn. The 
+// default does exactly that; mobilizers that are common in large models
+// override these with loops that avoid per-node virtual calls.
+virtual void realizePositionBlock(
+    const SBStateDigest&            sbs,
+    const RigidBodyNode* const*     nodes,
+    int                             nNodes) const
+{   for (int j=0; j < nNodes; ++j) nodes[j]->realizePosition(sbs); }
+
+virtual void realizeVelocityBlock(
+    const SBStateDigest&            sbs,
+    const RigidBodyNode* const*     nodes,
+    int                             nNodes) const
+{   for (int j=0; j < nNodes; ++j) nodes[j]->realizeVelocity(sbs); }
+
 // Calculate base-to-tip velocity-dependent terms which will be used
 // in Dynamics stage operators. Assumes realizeVelocity()
 // has already been called on all nodes, as well as any Dynamics 
@@ -320,6 +320,106 @@ void realizeVelocity(const SBStateDigest& sbs) const
     calcJointIndependentKinematicsVel(pc,vc);
 }
 
+// These are the block forms of realizePosition() and realizeVelocity() for
+// use by concrete mobilizers that override realizePositionBlock() and 
+// realizeVelocityBlock(). Every node in the block must have dynamic type
+// Concrete. The mobilizer-specific methods are invoked with qualified names
+// so they are bound at compile time and can be inlined, and each node's work
+// is split into a mobilizer-specific phase and a mobilizer-independent phase
+// which are run as separate passes over the block. Nodes at the same level
+// don't depend on one another so the results are identical to the one-node-
+// at-a-time methods above.
+template <class Concrete> static void
+realizePositionBlockOf(const SBStateDigest&         sbs,
+                       const RigidBodyNode* const*  nodes,
+                       int                          nNodes)
+{
+    const SBModelVars&      mv   = sbs.getModelVars();
+    const SBModelCache&     mc   = sbs.getModelCache();
+    const SBInstanceCache&  ic   = sbs.getInstanceCache();
+    const Vector&           allQ = sbs.getQ();
+    SBTreePositionCache&    pc   = sbs.updTreePositionCache();
+    Vector&                 allQErr = sbs.updQErr();
+
+    // Mobilizer specific: q precalculations, X_FM, and H_FM. H_FM may depend
+    // only on X_FM so it doesn't need the body transforms yet.
+    for (int j=0; j < nNodes; ++j) {
+        const Concrete& node = static_cast<const Concrete&>(*nodes[j]);
+        const SBModelPerMobodInfo& mbInfo = node.getModelInfo(mc);
+
+        const int nq=mbInfo.nQInUse, nqpool=mbInfo.nQPoolInUse,
+                  nqerr=(mbInfo.hasQuaternionInUse ? 1 : 0);
+        const Real* q0    = nq     ? &allQ[mbInfo.firstQIndex]            : 0;
+        Real*       qpool0= nqpool ? &pc.mobilizerQCache[mbInfo.startInQPool]
+                                   : 0;
+        Real*       qerr0 = nqerr  ? &allQErr[ic.firstQuaternionQErrSlot
+                                              + mbInfo.quaternionPoolIndex]     
+                                   : 0;
+        node.Concrete::performQPrecalculations(sbs, q0, nq, qpool0, nqpool, 
+                                               qerr0, nqerr);
+
+        if (node.isReversed()) {
+            Transform X_MF;
+            node.Concrete::calcX_FM(sbs, q0, nq, qpool0, nqpool, X_MF);
+            node.updX_FM(pc) = ~X_MF;
+            node.Concrete::calcReverseMobilizerH_FM(sbs, node.updH_FM(pc));
+        } else {
+            node.Concrete::calcX_FM(sbs, q0, nq, qpool0, nqpool, 
+                                    node.updX_FM(pc));
+            node.Concrete::calcAcrossJointVelocityJacobian
+                                                   (sbs, node.updH_FM(pc));
+        }
+    }
+
+    // Mobilizer independent.
+    for (int j=0; j < nNodes; ++j) {
+        const Concrete& node = static_cast<const Concrete&>(*nodes[j]);
+        node.calcBodyTransforms(pc, node.updX_PB(pc), node.updX_GB(pc));
+        node.calcParentToChildVelocityJacobianInGround(mv,pc, node.updH(pc));
+        node.calcJointIndependentKinematicsPos(pc);
+    }
+}
+
+template <class Concrete> static void
+realizeVelocityBlockOf(const SBStateDigest&         sbs,
+                       const RigidBodyNode* const*  nodes,
+                       int                          nNodes)
+{
+    const SBModelVars&          mv = sbs.getModelVars();
+    const SBTreePositionCache&  pc = sbs.getTreePositionCache();
+    SBTreeVelocityCache&        vc = sbs.updTreeVelocityCache();
+    const Vector&               allU = sbs.getU();
+    Vector&                     allQDot = sbs.updQDot();
+
+    // Mobilizer specific: qdot, V_FM, V_PB_G, and HDot_FM.
+    for (int j=0; j < nNodes; ++j) {
+        const Concrete& node = static_cast<const Concrete&>(*nodes[j]);
+        const Vec<dof>& u = node.fromU(allU);
+
+        node.Concrete::calcQDot(sbs, &allU[node.getUIndex()], 
+                                &allQDot[node.getQIndex()]);
+
+        node.updV_FM(vc)    = node.getH_FM(pc) * u;   // 6*dof flops
+        node.updV_PB_G(vc)  = node.getH(pc)    * u;   // 6*dof flops
+
+        if (node.isReversed()) 
+            node.Concrete::calcReverseMobilizerHDot_FM
+                                                (sbs, node.updHDot_FM(vc));
+        else
+            node.Concrete::calcAcrossJointVelocityJacobianDot
+                                                (sbs, node.updHDot_FM(vc));
+    }
+
+    // Mobilizer independent.
+    for (int j=0; j < nNodes; ++j) {
+        const Concrete& node = static_cast<const Concrete&>(*nodes[j]);
+        node.calcParentToChildVelocityJacobianInGroundDot(mv,pc,vc, 
+                                                          node.updHDot(vc));
+        node.updVD_PB_G(vc) = node.getHDot(vc) * node.fromU(allU);
+        node.calcJointIndependentKinematicsVel(pc,vc);
+    }
+}
+
 // Articulated body inertias have been calculated; here we're 
 void realizeDynamics(const SBArticulatedBodyInertiaCache&   abc,
                      const SBStateDigest&                   sbs) const 
@@ -444,6 +444,17 @@ void convertToQuaternions(const Vector& inputQ, Vector& outputQ) const {
     this->toQuat(outputQ) = rot.convertRotationToQuaternion().asVec4();
 }
 
+// Use the devirtualized block kinematics; ball joints are common in
+// biomechanical models (shoulders, hips, spine).
+void realizePositionBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizePositionBlockOf<RBNodeBall>(sbs, nodes, nNodes); }
+
+void realizeVelocityBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizeVelocityBlockOf<RBNodeBall>(sbs, nodes, nNodes); }
 
 };
 
@@ -501,6 +501,17 @@ void convertToQuaternions(const Vector& inputQ, Vector& outputQ) const {
     this->toQuat(outputQ) = rot.convertRotationToQuaternion().asVec4();
 }
 
+// Use the devirtualized block kinematics; crowd models have many free
+// bodies at level 1.
+void realizePositionBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizePositionBlockOf<RBNodeFree>(sbs, nodes, nNodes); }
+
+void realizeVelocityBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizeVelocityBlockOf<RBNodeFree>(sbs, nodes, nNodes); }
 
 };
 
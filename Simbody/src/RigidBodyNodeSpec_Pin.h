@@ -156,6 +156,17 @@ void calcReverseMobilizerHDot_FM(
     HDot_FM(0) = SpatialVec( Vec3(0), Vec3(0) ); 
 }
 
+// Use the devirtualized block kinematics; pin joints dominate most models.
+void realizePositionBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizePositionBlockOf<RBNodeTorsion>(sbs, nodes, nNodes); }
+
+void realizeVelocityBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizeVelocityBlockOf<RBNodeTorsion>(sbs, nodes, nNodes); }
+
 };
 
 
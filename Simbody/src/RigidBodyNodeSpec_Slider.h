@@ -142,6 +142,17 @@ void calcReverseMobilizerHDot_FM(
     HDot_FM(0) = SpatialVec( Vec3(0), Vec3(0) );
 }
 
+// Use the devirtualized block kinematics for runs of sliders.
+void realizePositionBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizePositionBlockOf<RBNodeSlider>(sbs, nodes, nNodes); }
+
+void realizeVelocityBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizeVelocityBlockOf<RBNodeSlider>(sbs, nodes, nNodes); }
+
 };
 
 
@@ -188,6 +188,17 @@ void calcAcrossJointVelocityJacobianDot(
     HDot_FM(1) = SpatialVec( w_FM % R_FM.y() , Vec3(0) );
 }
 
+// Use the devirtualized block kinematics for runs of universal joints.
+void realizePositionBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizePositionBlockOf<RBNodeUJoint>(sbs, nodes, nNodes); }
+
+void realizeVelocityBlock(const SBStateDigest&          sbs,
+                          const RigidBodyNode* const*   nodes,
+                          int                           nNodes) const
+{   this->template realizeVelocityBlockOf<RBNodeUJoint>(sbs, nodes, nNodes); }
+
 };
 
 
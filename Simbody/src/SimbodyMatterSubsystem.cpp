@@ -107,6 +107,52 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+void SimbodyMatterSubsystem::
+setUseParallelTreeSweeps(bool useParallel, int numThreads) {
+    updRep().setUseParallelTreeSweeps(useParallel, numThreads);
+}
+
+bool SimbodyMatterSubsystem::getUseParallelTreeSweeps() const {
+    return getRep().getUseParallelTreeSweeps();
+}
+
+void SimbodyMatterSubsystem::setUseBlockKinematics(bool useBlocks) {
+    updRep().setUseBlockKinematics(useBlocks);
+}
+bool SimbodyMatterSubsystem::getUseBlockKinematics() const {
+    return getRep().getUseBlockKinematics();
+}
+
+void SimbodyMatterSubsystem::setUseBlockConstraintSolver(bool useBlocks) {
+    updRep().setUseBlockConstraintSolver(useBlocks);
+}
+bool SimbodyMatterSubsystem::getUseBlockConstraintSolver() const {
+    return getRep().getUseBlockConstraintSolver();
+}
+
+void SimbodyMatterSubsystem::setProjectionFactorizationReuseLimit
+   (int maxReuses) {
+    SimTK_APIARGCHECK1_ALWAYS(maxReuses >= 0, "SimbodyMatterSubsystem",
+        "setProjectionFactorizationReuseLimit",
+        "Reuse limit must be nonnegative but was %d.", maxReuses);
+    updRep().setProjectionReuseLimit(maxReuses);
+}
+int SimbodyMatterSubsystem::getProjectionFactorizationReuseLimit() const {
+    return getRep().getProjectionReuseLimit();
+}
+
+void SimbodyMatterSubsystem::
+setUseIncrementalPositionKinematics(bool useIncremental) {
+    updRep().setUseIncrementalPositionKinematics(useIncremental);
+}
+bool SimbodyMatterSubsystem::getUseIncrementalPositionKinematics() const {
+    return getRep().getUseIncrementalPositionKinematics();
+}
+int SimbodyMatterSubsystem::
+getNumPositionKinematicsRecalculations(const State& state) const {
+    return getRep().getTreePositionCache(state).nKinematicsRecalculated;
+}
+
 
 ConstraintIndex SimbodyMatterSubsystem::adoptConstraint(Constraint& child) {
     return updRep().adoptConstraint(child);
@@ -39,6 +39,7 @@
 
 #include <string>
 #include <iostream>
+#include <typeinfo>
 using std::cout; using std::endl;
 
 SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep(const SimbodyMatterSubsystemRep& src)
@@ -48,6 +49,387 @@ SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep(const SimbodyMatterSubsyste
 }
 
 
+//==============================================================================
+//                          LEVEL-PARALLEL TREE SWEEPS
+//==============================================================================
+// Levels narrower than this are swept serially even when parallel sweeps are
+// enabled; the thread wakeup costs more than the work saved.
+static const int MinNodesForParallelLevel = 4;
+
+// Same-type runs of nodes within a level are cut into blocks no larger than
+// this so that wide levels still have enough blocks to share among threads.
+static const int MaxNodeBlockSize = 8;
+
+namespace {
+
+// Executes a per-node operator over the nodes of a single tree level. Any
+// exception thrown by a node is caught and its message recorded by node
+// offset so that the first failure (in serial order) can be rethrown on the
+// calling thread.
+template <class NodeOp>
+class TreeLevelTask : public ParallelExecutor::Task {
+public:
+    TreeLevelTask(const RBNodePtrList& nodes, const NodeOp& op)
+    :   nodes(nodes), op(op), errors(nodes.size()) {}
+
+    void execute(int j) {
+        try {op(*nodes[j]);}
+        catch (const std::exception& e) {errors[j] = e.what();}
+        catch (...) {errors[j] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned j=0; j < errors.size(); ++j)
+            if (!errors[j].empty())
+                SimTK_THROW1(Exception::Cant, errors[j]);
+    }
+private:
+    const RBNodePtrList&    nodes;
+    const NodeOp&           op;
+    Array_<std::string>     errors;
+};
+
+// Same as above but executes a block operator over the same-type node
+// blocks of a single level.
+template <class BlockOp>
+class TreeLevelBlockTask : public ParallelExecutor::Task {
+public:
+    TreeLevelBlockTask(const RBNodePtrList&         nodes,
+                       const Array_<RBNodeBlock>&   blocks, 
+                       const BlockOp&               op)
+    :   nodes(nodes), blocks(blocks), op(op), errors(blocks.size()) {}
+
+    void execute(int b) {
+        try {op(&nodes[blocks[b].first], blocks[b].nNodes);}
+        catch (const std::exception& e) {errors[b] = e.what();}
+        catch (...) {errors[b] = "unknown exception";}
+    }
+
+    void rethrowFirstError() const {
+        for (unsigned b=0; b < errors.size(); ++b)
+            if (!errors[b].empty())
+                SimTK_THROW1(Exception::Cant, errors[b]);
+    }
+private:
+    const RBNodePtrList&        nodes;
+    const Array_<RBNodeBlock>&  blocks;
+    const BlockOp&              op;
+    Array_<std::string>         errors;
+};
+
+// Orders nodes by their concrete type so that same-type nodes are adjacent.
+class NodeTypeLess {
+public:
+    bool operator()(const RigidBodyNode* a, const RigidBodyNode* b) const
+    {   return typeid(*a).before(typeid(*b)) != 0; }
+};
+
+// These are the per-block and per-node operations for each of the sweeps 
+// that may be run in parallel. Each must touch only its own nodes' entries 
+// in the output arrays and read only entries computed at an earlier level.
+
+class RealizePositionOp {
+public:
+    explicit RealizePositionOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.realizePosition(sbs); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizeVelocityOp {
+public:
+    explicit RealizeVelocityOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.realizeVelocity(sbs); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizePositionBlockOp {
+public:
+    explicit RealizePositionBlockOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void operator()(const RigidBodyNode* const* nodes, int nNodes) const 
+    {   nodes[0]->realizePositionBlock(sbs, nodes, nNodes); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizeVelocityBlockOp {
+public:
+    explicit RealizeVelocityBlockOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void operator()(const RigidBodyNode* const* nodes, int nNodes) const 
+    {   nodes[0]->realizeVelocityBlock(sbs, nodes, nNodes); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizeDynamicsOp {
+public:
+    RealizeDynamicsOp(const SBArticulatedBodyInertiaCache& abc,
+                      const SBStateDigest&                 sbs) 
+    :   abc(abc), sbs(sbs) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.realizeDynamics(abc, sbs); }
+private:
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBStateDigest&                    sbs;
+};
+
+class ArticulatedBodyInertiasInwardOp {
+public:
+    ArticulatedBodyInertiasInwardOp(const SBInstanceCache&          ic,
+                                    const SBTreePositionCache&      tpc,
+                                    SBArticulatedBodyInertiaCache&  abc)
+    :   ic(ic), tpc(tpc), abc(abc) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); }
+private:
+    const SBInstanceCache&          ic;
+    const SBTreePositionCache&      tpc;
+    SBArticulatedBodyInertiaCache&  abc;
+};
+
+class UDotPass1InwardOp {
+public:
+    UDotPass1InwardOp(const SBInstanceCache&                ic,
+                      const SBTreePositionCache&            tpc,
+                      const SBArticulatedBodyInertiaCache&  abc,
+                      const SBDynamicsCache&                dc,
+                      const Real*                           mobilityForcePtr,
+                      const SpatialVec*                     bodyForcePtr,
+                      const Real*                           udotPtr,
+                      SpatialVec*                           zPtr,
+                      SpatialVec*                           zPlusPtr,
+                      Real*                                 epsPtr)
+    :   ic(ic), tpc(tpc), abc(abc), dc(dc), mobilityForcePtr(mobilityForcePtr),
+        bodyForcePtr(bodyForcePtr), udotPtr(udotPtr), zPtr(zPtr), 
+        zPlusPtr(zPlusPtr), epsPtr(epsPtr) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.calcUDotPass1Inward(ic,tpc,abc,dc,
+            mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr, epsPtr); }
+private:
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBDynamicsCache&                  dc;
+    const Real*                             mobilityForcePtr;
+    const SpatialVec*                       bodyForcePtr;
+    const Real*                             udotPtr;
+    SpatialVec*                             zPtr;
+    SpatialVec*                             zPlusPtr;
+    Real*                                   epsPtr;
+};
+
+class UDotPass2OutwardOp {
+public:
+    UDotPass2OutwardOp(const SBStateDigest&                  sbs,
+                       const SBInstanceCache&                ic,
+                       const SBTreePositionCache&            tpc,
+                       const SBArticulatedBodyInertiaCache&  abc,
+                       const SBTreeVelocityCache&            tvc,
+                       const SBDynamicsCache&                dc,
+                       const Real*                           epsPtr,
+                       SpatialVec*                           aPtr,
+                       Real*                                 udotPtr,
+                       Real*                                 tauPtr,
+                       Real*                                 qdotdotPtr)
+    :   sbs(sbs), ic(ic), tpc(tpc), abc(abc), tvc(tvc), dc(dc), 
+        epsPtr(epsPtr), aPtr(aPtr), udotPtr(udotPtr), tauPtr(tauPtr),
+        qdotdotPtr(qdotdotPtr) {}
+    void operator()(const RigidBodyNode& node) const {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            epsPtr, aPtr, udotPtr, tauPtr);
+        node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
+                         &qdotdotPtr[node.getQIndex()]);
+    }
+private:
+    const SBStateDigest&                    sbs;
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBTreeVelocityCache&              tvc;
+    const SBDynamicsCache&                  dc;
+    const Real*                             epsPtr;
+    SpatialVec*                             aPtr;
+    Real*                                   udotPtr;
+    Real*                                   tauPtr;
+    Real*                                   qdotdotPtr;
+};
+
+class MInvPass1InwardOp {
+public:
+    MInvPass1InwardOp(const SBInstanceCache&                ic,
+                      const SBTreePositionCache&            tpc,
+                      const SBArticulatedBodyInertiaCache&  abc,
+                      const Real*                           fPtr,
+                      SpatialVec*                           zPtr,
+                      SpatialVec*                           zPlusPtr,
+                      Real*                                 epsPtr)
+    :   ic(ic), tpc(tpc), abc(abc), fPtr(fPtr), zPtr(zPtr), 
+        zPlusPtr(zPlusPtr), epsPtr(epsPtr) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.multiplyByMInvPass1Inward(ic,tpc,abc,fPtr,zPtr,zPlusPtr,epsPtr); }
+private:
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const Real*                             fPtr;
+    SpatialVec*                             zPtr;
+    SpatialVec*                             zPlusPtr;
+    Real*                                   epsPtr;
+};
+
+class MInvPass2OutwardOp {
+public:
+    MInvPass2OutwardOp(const SBInstanceCache&                ic,
+                       const SBTreePositionCache&            tpc,
+                       const SBArticulatedBodyInertiaCache&  abc,
+                       const Real*                           epsPtr,
+                       SpatialVec*                           aPtr,
+                       Real*                                 MInvfPtr)
+    :   ic(ic), tpc(tpc), abc(abc), epsPtr(epsPtr), aPtr(aPtr), 
+        MInvfPtr(MInvfPtr) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.multiplyByMInvPass2Outward(ic,tpc,abc,epsPtr,aPtr,MInvfPtr); }
+private:
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const Real*                             epsPtr;
+    SpatialVec*                             aPtr;
+    Real*                                   MInvfPtr;
+};
+
+class BodyAccelerationsOutwardOp {
+public:
+    BodyAccelerationsOutwardOp(const SBTreePositionCache&   tpc,
+                               const SBTreeVelocityCache&   tvc,
+                               const Real*                  knownUdotPtr,
+                               SpatialVec*                  aPtr)
+    :   tpc(tpc), tvc(tvc), knownUdotPtr(knownUdotPtr), aPtr(aPtr) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.calcBodyAccelerationsFromUdotOutward(tpc,tvc,knownUdotPtr,aPtr); }
+private:
+    const SBTreePositionCache&  tpc;
+    const SBTreeVelocityCache&  tvc;
+    const Real*                 knownUdotPtr;
+    SpatialVec*                 aPtr;
+};
+
+class InverseDynamicsPass2InwardOp {
+public:
+    InverseDynamicsPass2InwardOp(const SBTreePositionCache& tpc,
+                                 const SBTreeVelocityCache& tvc,
+                                 const SpatialVec*          aPtr,
+                                 const Real*                mobilityForcePtr,
+                                 const SpatialVec*          bodyForcePtr,
+                                 SpatialVec*                tempPtr,
+                                 Real*                      residualPtr)
+    :   tpc(tpc), tvc(tvc), aPtr(aPtr), mobilityForcePtr(mobilityForcePtr),
+        bodyForcePtr(bodyForcePtr), tempPtr(tempPtr), 
+        residualPtr(residualPtr) {}
+    void operator()(const RigidBodyNode& node) const 
+    {   node.calcInverseDynamicsPass2Inward(tpc,tvc,aPtr,
+            mobilityForcePtr,bodyForcePtr,tempPtr,residualPtr); }
+private:
+    const SBTreePositionCache&  tpc;
+    const SBTreeVelocityCache&  tvc;
+    const SpatialVec*           aPtr;
+    const Real*                 mobilityForcePtr;
+    const SpatialVec*           bodyForcePtr;
+    SpatialVec*                 tempPtr;
+    Real*                       residualPtr;
+};
+
+} // anonymous namespace
+
+// Process all the nodes at one level, in parallel if that's enabled and the
+// level is wide enough to make it worthwhile. We never fan out from a thread
+// that is already a ParallelExecutor worker (for example, when many States
+// are being realized concurrently); that would oversubscribe the machine and
+// the executor is not reentrant. For the same reason, if another thread is
+// using the executor to sweep a different State, this level is processed
+// serially rather than waiting for it.
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+sweepLevel(int level, const NodeOp& op) const {
+    const RBNodePtrList& nodes = rbNodeLevels[level];
+    const int nNodes = (int)nodes.size();
+
+    if (!treeSweepExecutor || nNodes < MinNodesForParallelLevel 
+        || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&treeSweepLock) != 0) 
+    {
+        for (int j=0 ; j < nNodes ; ++j)
+            op(*nodes[j]);
+        return;
+    }
+
+    TreeLevelTask<NodeOp> task(nodes, op);
+    treeSweepExecutor->execute(task, nNodes); // barrier on return
+    pthread_mutex_unlock(&treeSweepLock);
+    task.rethrowFirstError();
+}
+
+template <class BlockOp> void SimbodyMatterSubsystemRep::
+sweepLevelBlocks(int level, const BlockOp& op) const {
+    const RBNodePtrList&        nodes  = rbNodeLevelsByType[level];
+    const Array_<RBNodeBlock>&  blocks = rbNodeBlocks[level];
+    const int nBlocks = (int)blocks.size();
+
+    if (!treeSweepExecutor || nBlocks < 2
+        || (int)nodes.size() < MinNodesForParallelLevel 
+        || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&treeSweepLock) != 0) 
+    {
+        for (int b=0 ; b < nBlocks ; ++b)
+            op(&nodes[blocks[b].first], blocks[b].nNodes);
+        return;
+    }
+
+    TreeLevelBlockTask<BlockOp> task(nodes, blocks, op);
+    treeSweepExecutor->execute(task, nBlocks); // barrier on return
+    pthread_mutex_unlock(&treeSweepLock);
+    task.rethrowFirstError();
+}
+
+template <class BlockOp> void SimbodyMatterSubsystemRep::
+sweepBlocksOutward(const BlockOp& op) const {
+    for (int i=0 ; i < (int)rbNodeBlocks.size() ; ++i)
+        sweepLevelBlocks(i, op);
+}
+
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+sweepOutward(const NodeOp& op, int firstLevel) const {
+    for (int i=firstLevel ; i < (int)rbNodeLevels.size() ; ++i)
+        sweepLevel(i, op);
+}
+
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+sweepInward(const NodeOp& op, int firstLevel) const {
+    for (int i=(int)rbNodeLevels.size()-1 ; i >= firstLevel ; --i)
+        sweepLevel(i, op);
+}
+
+void SimbodyMatterSubsystemRep::
+setUseParallelTreeSweeps(bool useParallel, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(!useParallel || numThreads > 0, 
+        "SimbodyMatterSubsystem", "setUseParallelTreeSweeps",
+        "Number of threads must be positive but was %d.", numThreads);
+
+    delete treeSweepExecutor;
+    treeSweepExecutor = 0;
+    treeSweepThreads  = 1;
+
+    if (useParallel && numThreads > 1) {
+        treeSweepExecutor = new ParallelExecutor(numThreads);
+        treeSweepThreads  = numThreads;
+    }
+}
+//........................ LEVEL-PARALLEL TREE SWEEPS ..........................
+
+
+
 void SimbodyMatterSubsystemRep::clearTopologyState() {
     // Constraints are independent from one another, so any deletion order
     // is fine. However, they depend on bodies and not vice versa so we'll
@@ -91,6 +473,8 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     // be deleted when the MobilizedBodyImpl objects are.
     rbNodeLevels.clear();
     nodeNum2NodeMap.clear();
+    rbNodeLevelsByType.clear();
+    rbNodeBlocks.clear();
 
     showDefaultGeometry = true;
 }
@@ -251,6 +635,25 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
         DOFTotal += ndof; SqDOFTotal += ndof*ndof;
         maxNQTotal += n.getMaxNQ();
     }
+
+    // Group the nodes at each level by concrete type and cut the same-type
+    // runs into blocks for the block-at-a-time kinematics sweeps. Order 
+    // within a level is irrelevant to the results.
+    rbNodeLevelsByType = rbNodeLevels;
+    rbNodeBlocks.clear();
+    rbNodeBlocks.resize(rbNodeLevelsByType.size());
+    for (int i=0 ; i<(int)rbNodeLevelsByType.size() ; ++i) {
+        RBNodePtrList& level = rbNodeLevelsByType[i];
+        std::stable_sort(level.begin(), level.end(), NodeTypeLess());
+        for (int j=0 ; j<(int)level.size() ; ) {
+            int n = 1;
+            while (j+n < (int)level.size() && n < MaxNodeBlockSize
+                   && typeid(*level[j+n]) == typeid(*level[j]))
+                ++n;
+            rbNodeBlocks[i].push_back(RBNodeBlock(j, n));
+            j += n;
+        }
+    }
     
     // Order doesn't matter for constraints as long as the bodies are already 
     // there. Quaternion normalization constraints exist only at the 
@@ -591,6 +994,16 @@ int SimbodyMatterSubsystemRep::realizeSubsystemModelImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // Factorizations saved by projectQ() and projectU() for reuse. These 
+    // belong to this State; they are forgotten whenever Instance stage is
+    // invalidated since that may change which constraints are enabled.
+    mc.qProjectionCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<ProjectionFactorization>());
+    mc.uProjectionCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<ProjectionFactorization>());
+
     return 0;
 }
 
@@ -911,6 +1324,10 @@ realizeSubsystemInstanceImpl(const State& s) const {
                                          + ic.totalNNonholonomicConstraintEquationsInUse
                                          + ic.totalNAccelerationOnlyConstraintEquationsInUse);
 
+    // Constraint coupling changes only when constraints are enabled or
+    // disabled, so the block solver's partition is computed here once.
+    findUncoupledConstraintGroups(s, ic, ic.uncoupledConstraintGroups);
+
     // ALLOCATE REMAINING CACHE ENTRIES
     // Now that we know all the Instance-stage info, we can allocate (or 
     // reallocate) the rest of the cache entries.
@@ -1005,10 +1422,54 @@ int SimbodyMatterSubsystemRep::realizeSubsystemPositionImpl(const State& s) cons
 
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
-    // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    const Vector& q = stateDigest.getQ();
+    Vector& qErr = stateDigest.updQErr();
+    const int nQuats = mc.totalNQuaternionsInUse;
+    if (useIncrementalPositionKinematics && tpc.kinematicsQValid
+        && tpc.kinematicsQ.size() == q.size()) {
+        // Only mobilizers whose q's changed, and their descendents, need to
+        // be recalculated; everything else in the cache is still good. 
+        // Quaternion errors are restored because qErr isn't ours to keep.
+        // The saved q's are marked stale until the sweep completes so that 
+        // a node that throws can't leave a half-updated cache looking valid.
+        tpc.kinematicsQValid = false;
+        if (nQuats)
+            qErr(ic.firstQuaternionQErrSlot, nQuats) = tpc.quaternionErrs;
+        tpc.kinematicsRecalculated[GroundIndex] = false;
+        tpc.nKinematicsRecalculated = 0;
+        for (int i=1 ; i<(int)rbNodeLevels.size() ; ++i) 
+            for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j) {
+                const RigidBodyNode& node = *rbNodeLevels[i][j];
+                const MobilizedBodyIndex mbx = node.getNodeNum();
+                const SBModelPerMobodInfo& mbInfo = mc.getMobodModelInfo(mbx);
+                bool mustRecalc = 
+                    tpc.kinematicsRecalculated[node.getParent()->getNodeNum()];
+                for (int k=0; !mustRecalc && k < mbInfo.nQInUse; ++k) {
+                    const QIndex qx(mbInfo.firstQIndex + k);
+                    mustRecalc = (q[qx] != tpc.kinematicsQ[qx]);
+                }
+                tpc.kinematicsRecalculated[mbx] = mustRecalc;
+                if (mustRecalc) {
+                    node.realizePosition(stateDigest);
+                    ++tpc.nKinematicsRecalculated;
+                }
+            }
+    } else {
+        // Set generalized coordinates: sweep from base to tips.
+        tpc.kinematicsQValid = false;
+        if (useBlockKinematics)
+            sweepBlocksOutward(RealizePositionBlockOp(stateDigest));
+        else
+            sweepOutward(RealizePositionOp(stateDigest));
+        tpc.nKinematicsRecalculated = getNumBodies()-1;
+    }
+
+    if (useIncrementalPositionKinematics) {
+        tpc.kinematicsQ = q;
+        if (nQuats)
+            tpc.quaternionErrs = qErr(ic.firstQuaternionQErrSlot, nQuats);
+        tpc.kinematicsQValid = true;
+    }
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1027,7 +1488,6 @@ int SimbodyMatterSubsystemRep::realizeSubsystemPositionImpl(const State& s) cons
 
 
     // Put position constraint equation errors in qErr
-    Vector& qErr = stateDigest.updQErr();
     for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
         if (isConstraintDisabled(s,cx))
             continue;
@@ -1099,9 +1559,7 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    sweepInward(ArticulatedBodyInertiasInwardOp(ic,tpc,abc));
 
     markCacheValueRealized(state, abx);
 }
@@ -1118,6 +1576,29 @@ invalidateArticulatedBodyInertias(const State& state) const {
 
 
 
+//==============================================================================
+//                      UPD PROJECTION FACTORIZATION
+//==============================================================================
+// The saved factorization is a lazy cache entry that depends only on Instance
+// stage. If Instance stage has been invalidated since it was last touched we
+// discard whatever it holds, then mark it valid so that it stays with this
+// State until the next Instance-stage change.
+ProjectionFactorization& SimbodyMatterSubsystemRep::
+updProjectionFactorization(const State& state, bool forQ) const {
+    const SBModelCache& mc = getModelCache(state);
+    const CacheEntryIndex px = forQ ? mc.qProjectionCacheIndex
+                                    : mc.uProjectionCacheIndex;
+    ProjectionFactorization& pf = 
+        Value<ProjectionFactorization>::updDowncast(updCacheEntry(state, px));
+    if (!isCacheValueRealized(state, px)) {
+        pf.invalidate();
+        markCacheValueRealized(state, px);
+    }
+    return pf;
+}
+
+
+
 //==============================================================================
 //                               REALIZE VELOCITY
 //==============================================================================
@@ -1154,9 +1635,10 @@ int SimbodyMatterSubsystemRep::realizeSubsystemVelocityImpl(const State& s) cons
     // and all global velocities relative to Ground (G).
 
     // Set generalized speeds: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeVelocity(stateDigest); 
+    if (useBlockKinematics)
+        sweepBlocksOutward(RealizeVelocityBlockOp(stateDigest));
+    else
+        sweepOutward(RealizeVelocityOp(stateDigest));
 
     // Ask the constraints to calculate ancestor-relative velocity kinematics 
     // (still goes in TreePositionCache).
@@ -1230,9 +1712,7 @@ int SimbodyMatterSubsystemRep::realizeSubsystemDynamicsImpl(const State& s)  con
 
     // Realize velocity-dependent articulated body quantities needed for 
     // dynamics: base-to-tip.
-    for (int i=0; i < (int)rbNodeLevels.size(); ++i)
-        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j)
-            rbNodeLevels[i][j]->realizeDynamics(abc, stateDigest);
+    sweepOutward(RealizeDynamicsOp(abc, stateDigest));
 
     // MobilizedBodies
     // This will include writing the prescribed accelerations into
@@ -3290,24 +3770,253 @@ calcGMInvGt(const State&   s,
 
 
 
+// =============================================================================
+//                          CALC G M^-1 ~G BLOCKS
+// =============================================================================
+// This calculates only the diagonal blocks of G M^-1 ~G, one per group of 
+// uncoupled constraint equations, in the order of the Instance cache's
+// uncoupledConstraintGroups. Element (i,j) of block g is GMInvGt(eqs[i],eqs[j])
+// where eqs is the g'th group.
+//
+// As in calcGMInvGt() we form a column at a time using O(n) operators, but
+// because the groups are uncoupled we can form one column of every group with
+// the same operator calls. The columns of ~G plucked out for different groups
+// apply forces only to different branches of the tree (or to nothing, for
+// constraints on Ground), M^-1 doesn't couple branches, and each constraint 
+// equation sees only the velocities of its own branches. So the rows of each
+// group in the resulting product hold exactly the values they would have if 
+// that group's column had been formed alone.
+//
+// Complexity is O(m + n*max(mi)) for group sizes mi, rather than O(m*n), and
+// only sum(mi^2) elements are stored rather than m^2.
+void SimbodyMatterSubsystemRep::
+calcGMInvGtBlocks(const State&      s,
+                  Array_<Matrix>&   blocks) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const Array_< Array_<int> >& groups = ic.uncoupledConstraintGroups;
+
+    // Global problem dimensions.
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
+    const int m        = mHolo+mNonholo+mAccOnly;  
+    const int nu       = getNU(s);
+
+    blocks.resize(groups.size());
+    int maxBlockSize = 0;
+    for (unsigned g=0; g < groups.size(); ++g) {
+        const int mb = (int)groups[g].size();
+        blocks[g].resize(mb,mb);
+        maxBlockSize = std::max(maxBlockSize, mb);
+    }
+    if (maxBlockSize==0) return;
+
+    Vector Gtcol(nu), MInvGtcol(nu), GMInvGtcol(m);
+    Vector bias(m);
+    calcBiasForMultiplyByPVA(s,true,true,true,bias);
+
+    // Lambda has a 1 for the j'th equation of every group that has one.
+    Vector lambda(m, Real(0));
+
+    for (int j=0; j < maxBlockSize; ++j) {
+        for (unsigned g=0; g < groups.size(); ++g)
+            if (j < (int)groups[g].size()) lambda[groups[g][j]] = 1;
+        multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
+        for (unsigned g=0; g < groups.size(); ++g)
+            if (j < (int)groups[g].size()) lambda[groups[g][j]] = 0;
+        multiplyByMInv(s, Gtcol, MInvGtcol);
+        multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGtcol);
+
+        for (unsigned g=0; g < groups.size(); ++g) {
+            const Array_<int>& eqs = groups[g];
+            if (j >= (int)eqs.size()) continue;
+            Matrix& block = blocks[g];
+            for (int i=0; i < (int)eqs.size(); ++i)
+                block(i,j) = GMInvGtcol[eqs[i]];
+        }
+    }
+}
+
+
+
 // =============================================================================
 //                     SOLVE FOR CONSTRAINT IMPULSES
 // =============================================================================
-// Current implementation computes G*M^-1*~G, factors it, and does a single
-// solve all at great expense.
+// Current implementation computes G*M^-1*~G (or its blocks), factors it, and
+// does a single solve all at great expense.
 // TODO: should realize factored matrix if needed and reuse if possible.
 void SimbodyMatterSubsystemRep::
 solveForConstraintImpulses(const State&     state,
                            const Vector&    deltaV,
                            Vector&          impulse) const
 {
-    Matrix GMInvGt;
-    calcGMInvGt(state, GMInvGt);
-    // MUST DUPLICATE SIMBODY'S METHOD HERE:
-    const Real conditioningTol = GMInvGt.nrow() 
-                                    * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    // This uses the same method as forward dynamics.
+    solveGMInvGt(state, deltaV, impulse);
+}
+
+
+
+// =============================================================================
+//                     FIND UNCOUPLED CONSTRAINT GROUPS
+// =============================================================================
+// Union-find over base bodies: every enabled Constraint merges the branches
+// of all its constrained bodies and mobilizers. Constraints that touch no 
+// branch (i.e., only Ground) form groups of their own. Cost is O(nb + m)
+// plus the cost of visiting each Constraint's bodies.
+namespace {
+int findRoot(Array_<int>& parent, int i) {
+    while (parent[i] != i) 
+        i = parent[i] = parent[parent[i]]; // path halving
+    return i;
+}
+class FirstEquationLess {
+public:
+    bool operator()(const Array_<int>& a, const Array_<int>& b) const
+    {   return a.front() < b.front(); }
+};
+}
+
+void SimbodyMatterSubsystemRep::
+findUncoupledConstraintGroups(const State&           s,
+                              const SBInstanceCache& ic,
+                              Array_< Array_<int> >& groups) const
+{
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int nb       = getNumBodies();
+
+    groups.clear();
+
+    // Branch (base body) of each constrained body or mobilizer, or -1 for 
+    // Ground. We join all the branches touched by a Constraint.
+    Array_<int> parent(nb);
+    for (int i=0; i < nb; ++i) parent[i] = i;
+
+    Array_<int> firstBranch(constraints.size(), -1);
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
+        if (isConstraintDisabled(s,cx))
+            continue;
+        const ConstraintImpl& crep = constraints[cx]->getImpl();
+
+        Array_<MobilizedBodyIndex> mbxs;
+        for (ConstrainedBodyIndex cbx(0); 
+             cbx < crep.getNumConstrainedBodies(); ++cbx)
+            mbxs.push_back(crep.getMobilizedBodyIndexOfConstrainedBody(cbx));
+        for (ConstrainedMobilizerIndex cmx(0); 
+             cmx < crep.getNumConstrainedMobilizers(); ++cmx)
+            mbxs.push_back(
+                crep.getMobilizedBodyIndexOfConstrainedMobilizer(cmx));
+
+        for (unsigned i=0; i < mbxs.size(); ++i) {
+            if (mbxs[i] == GroundIndex) continue;
+            const int branch = getMobilizedBody(mbxs[i]).getImpl()
+                                    .getMyBaseBodyMobilizedBodyIndex();
+            if (firstBranch[cx] < 0) firstBranch[cx] = branch;
+            else parent[findRoot(parent, branch)] 
+                                    = findRoot(parent, firstBranch[cx]);
+        }
+    }
+
+    // Now deal each Constraint's equations into the group for its branch
+    // set. Group keys are root branches, or nb+cx for Ground-only ones.
+    std::map<int,int> key2group;
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
+        if (isConstraintDisabled(s,cx))
+            continue;
+        const SBInstancePerConstraintInfo& 
+                              cInfo = ic.getConstraintInstanceInfo(cx);
+        const Segment& holoSeg    = cInfo.holoErrSegment;
+        const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+        const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+        if (holoSeg.length + nonholoSeg.length + accOnlySeg.length == 0)
+            continue;
+
+        const int key = firstBranch[cx] < 0 
+                        ? nb + (int)cx : findRoot(parent, firstBranch[cx]);
+        std::map<int,int>::const_iterator p = key2group.find(key);
+        int g;
+        if (p == key2group.end()) {
+            g = (int)groups.size();
+            key2group[key] = g;
+            groups.push_back();
+        } else g = p->second;
+
+        Array_<int>& eqs = groups[g];
+        for (int i=0; i<holoSeg.length; ++i) 
+            eqs.push_back(                 holoSeg.offset    + i);
+        for (int i=0; i<nonholoSeg.length; ++i) 
+            eqs.push_back(mHolo          + nonholoSeg.offset + i);
+        for (int i=0; i<accOnlySeg.length; ++i) 
+            eqs.push_back(mHolo+mNonholo + accOnlySeg.offset + i);
+    }
+
+    for (unsigned g=0; g < groups.size(); ++g)
+        std::sort(groups[g].begin(), groups[g].end());
+    std::sort(groups.begin(), groups.end(), FirstEquationLess());
+}
+
+
+
+// =============================================================================
+//                             SOLVE G M^-1 ~G
+// =============================================================================
+// Conditioning tolerance for factoring an mXm G M^-1 ~G, or a block of it. 
+// This determines when we'll drop a constraint. 
+// TODO: this is probably too tight; should depend on constraint tolerance
+// and should be consistent with position and velocity projection ranks.
+// Tricky here because conditioning depends on mass matrix as well as
+// constraints.
+static Real calcGMInvGtConditioningTol(int m) {
+    return m 
+        //* SignificantReal;
+        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
+}
+
+// G M^-1 ~G is block diagonal (up to a permutation) with one block per group
+// of coupled constraints. If the block solver is enabled we form only those
+// blocks and factor each separately, costing sum(mi^3) rather than m^3. Each
+// block gets a conditioning tolerance scaled by its own size, as the whole 
+// matrix does otherwise. A block diagonal system's minimum-norm solution is 
+// the concatenation of the blocks', so the solution is the same as the dense
+// one provided the blocks are found to have the same ranks; but redundancy is
+// judged within each block, relative to that block's own scale.
+void SimbodyMatterSubsystemRep::
+solveGMInvGt(const State&   s,
+             const Vector&  b,
+             Vector&        x) const
+{
+    const Array_< Array_<int> >& groups = 
+        getInstanceCache(s).uncoupledConstraintGroups;
+
+    if (!useBlockConstraintSolver || groups.size() <= 1) {
+        // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
+        // I know how to do, O(m*n) with O(n) temporary memory, using a series
+        // of O(n) operators. Then we'll factor it here in O(m^3) time. 
+        Matrix GMInvGt;
+        calcGMInvGt(s, GMInvGt);
+        FactorQTZ qtz(GMInvGt, calcGMInvGtConditioningTol(GMInvGt.nrow())); 
+        qtz.solve(b, x);
+        return;
+    }
+
+    Array_<Matrix> blocks;
+    calcGMInvGtBlocks(s, blocks);
+
+    x.resize(b.size());
+    x.setToZero();
+    Vector bb, xb;
+    for (unsigned g=0; g < groups.size(); ++g) {
+        const Array_<int>& eqs = groups[g];
+        const int mb = (int)eqs.size();
+        bb.resize(mb);
+        for (int j=0; j < mb; ++j)
+            bb[j] = b[eqs[j]];
+        FactorQTZ qtz(blocks[g], calcGMInvGtConditioningTol(mb));
+        qtz.solve(bb, xb);
+        for (int j=0; j < mb; ++j)
+            x[eqs[j]] = xb[j];
+    }
 }
 
 
@@ -3824,6 +4533,32 @@ void SimbodyMatterSubsystemRep::enforcePositionConstraints
 //   multiplying these matrices by columns, but not for producing Wq so we 
 //   just create it operationally as we go.
 
+// When projectQ() or projectU() solve with an out-of-date factorization of the
+// constraint Jacobian, each step must reduce the constraint error norm by at
+// least this factor or the factorization is discarded and recomputed.
+static const Real MaxReuseConvergenceRate = Real(0.5);
+
+// Return the RMS or infinity norm of the n entries of v starting at v[start],
+// each multiplied by the corresponding entry of w if weights are given, and 
+// set worst to the index (counting from start) of the largest of them, or -1
+// if n is zero. This is the same as asking a weighted copy of those entries 
+// for its norm, but doesn't touch the heap; it is used for the check on 
+// entry to projectQ() and projectU(), which usually finds nothing to do.
+static Real calcWeightedNorm(const Vector& v, int start, int n, 
+                             const Vector* w, bool useNormInf, int& worst) {
+    worst = -1;
+    if (n == 0) return 0;
+    worst = 0;
+    Real sumsq = 0, maxsq = 0;
+    for (int i=0; i < n; ++i) {
+        const Real vi = w ? (*w)[start+i]*v[start+i] : v[start+i];
+        const Real v2 = square(vi);
+        if (v2 > maxsq) maxsq=v2, worst=i;
+        sumsq += v2;
+    }
+    return useNormInf ? std::sqrt(maxsq) : std::sqrt(sumsq/n);
+}
+
 int SimbodyMatterSubsystemRep::projectQ
    (State&                  s, 
     Vector&                 qErrest, // q error estimate or empty 
@@ -3846,21 +4581,15 @@ int SimbodyMatterSubsystemRep::projectQ
     const int mHolo  = getNumHolonomicConstraintEquationsInUse(s);
     const int mQuats = getNumQuaternionsInUse(s);
 
-    // This is a const view into the State; the contents it refers to will 
-    // change though.
-    const VectorView pErrs = getQErr(s)(0,mHolo); // just leave off quaternions
-    const VectorView quatErrs = getQErr(s)(mHolo,mQuats); // quaternions
-
-    // We don't weight the quaternion errors.
-    const VectorView perrWeights = getQErrWeights(s)(0,mHolo); // 1/unit error (Tp)
-
-    // Determine norms on entry.
+    // Determine norms on entry. We don't weight the quaternion errors. This
+    // is done without making views or temporaries since we usually return
+    // right after.
+    const Vector& qErr = getQErr(s);
     int worstPerr, worstQuatErr;
-    Vector scaledPerrs = pErrs.rowScale(perrWeights);
-    const Real perrNormOnEntry = useNormInf ? scaledPerrs.normInf(&worstPerr)
-                                            : scaledPerrs.normRMS(&worstPerr);
-    const Real quatNormOnEntry = useNormInf ? quatErrs.normInf(&worstQuatErr)
-                                            : quatErrs.normRMS(&worstQuatErr);
+    const Real perrNormOnEntry = calcWeightedNorm(qErr, 0, mHolo, 
+        &getQErrWeights(s), useNormInf, worstPerr);
+    const Real quatNormOnEntry = calcWeightedNorm(qErr, mHolo, mQuats, 
+        0, useNormInf, worstQuatErr);
     
     Real normOnEntry;
     if (perrNormOnEntry >= quatNormOnEntry) {
@@ -3891,8 +4620,8 @@ int SimbodyMatterSubsystemRep::projectQ
         if (quatNormOnEntry > consAccuracy || forceOneIter) {
             const bool anyQuatChange = normalizeQuaternions(s,qErrest);
             results.setAnyChangeMade(anyQuatChange);
-            const Real quatNorm = useNormInf ? quatErrs.normInf(&worstQuatErr)
-                                             : quatErrs.normRMS(&worstQuatErr);
+            const Real quatNorm = calcWeightedNorm(getQErr(s), mHolo, mQuats,
+                0, useNormInf, worstQuatErr);
             results.setNormOnExit(quatNorm);
             if (quatNorm > consAccuracy) {
                 results.setExitStatus(ProjectResults::FailedToAchieveAccuracy);
@@ -3915,6 +4644,15 @@ int SimbodyMatterSubsystemRep::projectQ
     }
 
 
+    // This is a const view into the State; the contents it refers to will 
+    // change though.
+    const VectorView pErrs = getQErr(s)(0,mHolo); // just leave off quaternions
+    const VectorView quatErrs = getQErr(s)(mHolo,mQuats); // quaternions
+
+    // We don't weight the quaternion errors.
+    const VectorView perrWeights = getQErrWeights(s)(0,mHolo); // 1/unit error (Tp)
+    Vector scaledPerrs = pErrs.rowScale(perrWeights);
+
     // We're going to have to project constraints. Get the remaining options.
 
 
@@ -3932,9 +4670,10 @@ int SimbodyMatterSubsystemRep::projectQ
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using full Newton at the moment.
+    // this is set. We'll only do so if reuse has been enabled, though.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool mayReuse = !forceFullNewton && projectionReuseLimit > 0;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -3960,11 +4699,15 @@ int SimbodyMatterSubsystemRep::projectQ
     // (diagonal weights are symmetric). We only retain rows that 
     // correspond to free (non prescribed) q's.
     //
-    // This is a nonlinear least squares problem. Below is a full Newton 
-    // iteration since we recalculate the iteration matrix each time around the
-    // loop. TODO: a solution could be found using the same iteration matrix, 
-    // since we are projecting from (presumably) not too far away. Q1: will it
-    // be the same solution? Q2: if not, does it matter?
+    // This is a nonlinear least squares problem. By default below is a full 
+    // Newton iteration since we recalculate the iteration matrix each time 
+    // around the loop. If factorization reuse is enabled we instead keep 
+    // using the last-factored iteration matrix (even one from a previous 
+    // call) as long as each step reduces the error by at least 
+    // MaxReuseConvergenceRate; otherwise we take back the step and refactor.
+    // That converges to a nearby point on the constraint manifold rather than
+    // exactly the weighted least squares solution, which is fine since we are
+    // projecting from (presumably) not too far away.
 
     // These will be updated as we go.
     Real perrNormAchieved = perrNormOnEntry;
@@ -3996,15 +4739,34 @@ int SimbodyMatterSubsystemRep::projectQ
     Vector dfq_WLS(nfq), du(nu), dq(nq); // = Wq^+ dq_WLS
     Vector udfq_WLS(hasPrescribedMotion ? nq : 0); // unpacked if needed
     udfq_WLS.setToZero(); // must initialize unwritten elements
-    FactorQTZ Pqwr_qtz;
+    // Use the State's saved factorization only if we're allowed to reuse it;
+    // otherwise factor into a local one and leave the State's cache alone.
+    ProjectionFactorization* saved = 
+        mayReuse ? &updProjectionFactorization(s, true) : 0;
+    FactorQTZ localQtz;
+    FactorQTZ& Pqwr_qtz = mayReuse ? saved->qtz : localQtz;
+    int nFactorizations = 0, nReuses = 0;
+    bool needRefactor = false; // set if the saved matrix converges too slowly
+
     Real prevPerrNormAchieved = perrNormAchieved; // watch for divergence
     bool diverged = false;
     const int MaxIterations  = 20;
     do {
-        calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
+        const bool reuse = mayReuse && !needRefactor
+            && saved->isReusableFor(s, perrWeights, uWeights, 
+                                    projectionReuseLimit);
+        if (reuse) {
+            ++saved->nUses; ++nReuses;
+        } else {
+            calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
 
-        // This factorization acts like a pseudoinverse.
-        Pqwr_qtz.factor<Real>(~Pqwrt, conditioningTol); 
+            // This factorization acts like a pseudoinverse.
+            Pqwr_qtz.factor<Real>(~Pqwrt, conditioningTol); 
+            if (mayReuse) 
+                saved->noteFactored(s, perrWeights, uWeights, uAbsScale);
+            ++nFactorizations;
+            needRefactor = false;
+        }
 
         //printf("projectQ %d: m=%d condTol=%g rank=%d rcond=%g\n",
         //    nItsUsed, Pqwrt.ncol(), conditioningTol, Pqwr_qtz.getRank(),
@@ -4039,6 +4801,23 @@ int SimbodyMatterSubsystemRep::projectQ
                                       : scaledPerrs.normRMS();
         ++nItsUsed;
 
+        if (reuse 
+            && perrNormAchieved > MaxReuseConvergenceRate*prevPerrNormAchieved)
+        {   // The out-of-date iteration matrix isn't good enough here. Take 
+            // back the step if it made things worse, then refactor.
+            if (perrNormAchieved > prevPerrNormAchieved) {
+                updQ(s) += dq;
+                realizeSubsystemPosition(s); // pErrs changes here
+                scaledPerrs = pErrs.rowScale(perrWeights);
+                perrNormAchieved = useNormInf ? scaledPerrs.normInf()
+                                              : scaledPerrs.normRMS();
+            }
+            saved->invalidate();
+            needRefactor = true;
+            prevPerrNormAchieved = perrNormAchieved;
+            continue;
+        }
+
         if (localOnly && nItsUsed >= 2 
             && perrNormAchieved > prevPerrNormAchieved) {
             // perr norm got worse; restore to end of previous iteration
@@ -4057,6 +4836,8 @@ int SimbodyMatterSubsystemRep::projectQ
                 && nItsUsed < MaxIterations);
 
     results.setNumIterations(nItsUsed);
+    results.setNumFactorizations(nFactorizations);
+    results.setNumFactorizationReuses(nReuses);
 
     //printf("        perrNormAchieved=%g in %d its\n",perrNormAchieved, nItsUsed);
 
@@ -4425,11 +5206,11 @@ int SimbodyMatterSubsystemRep::projectU
     const Vector& pvErrs = getUErr(s); // mHolo+mNonholo of these
     const Vector& pverrWeights = getUErrWeights(s); // 1/unit err (Tpv)
 
-    // Determine norm on entry.
+    // Determine norm on entry, without a temporary since we usually return
+    // right after.
     int worstPVerr;
-    Vector scaledPVerrs = pvErrs.rowScale(pverrWeights);
-    const Real pverrNormOnEntry = useNormInf ? scaledPVerrs.normInf(&worstPVerr)
-                                             : scaledPVerrs.normRMS(&worstPVerr);
+    const Real pverrNormOnEntry = calcWeightedNorm(pvErrs, 0, pvErrs.size(),
+        &pverrWeights, useNormInf, worstPVerr);
     
     results.setNormOnEntrance(pverrNormOnEntry, worstPVerr);
 
@@ -4459,6 +5240,8 @@ int SimbodyMatterSubsystemRep::projectU
         return 0;
     }
 
+    Vector scaledPVerrs = pvErrs.rowScale(pverrWeights);
+
     // We're going to have to project constraints. Get the remaining options.
 
     // This is the factor by which we try to achieve a tighter accuracy
@@ -4475,9 +5258,11 @@ int SimbodyMatterSubsystemRep::projectU
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using modified Newton at the moment.
+    // this is set. We always use modified Newton within a call, but will 
+    // only reuse a factorization from an earlier call if reuse is enabled.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool mayReuse = !forceFullNewton && projectionReuseLimit > 0;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -4535,12 +5320,30 @@ int SimbodyMatterSubsystemRep::projectU
     if (hasPrescribedMotion)
         du.setToZero(); // must initialize unwritten elements
 
-    calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
-    // PVwrt is now Eu^-1 (Pt Vt) Tpv
+    // Use the State's saved factorization only if we're allowed to reuse it;
+    // otherwise factor into a local one and leave the State's cache alone. A
+    // reused factorization must be applied with the scaling it was built with.
+    ProjectionFactorization* saved = 
+        mayReuse ? &updProjectionFactorization(s, false) : 0;
+    FactorQTZ localQtz;
+    FactorQTZ& PVwr_qtz = mayReuse ? saved->qtz : localQtz;
+    int nFactorizations = 0, nReuses = 0;
+    bool isStale = mayReuse 
+        && saved->isReusableFor(s, pverrWeights, uWeights, projectionReuseLimit);
+
+    if (isStale) {
+        uRelScale = saved->colScale;
+        ++saved->nUses; ++nReuses;
+    } else {
+        calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
+        // PVwrt is now Eu^-1 (Pt Vt) Tpv
 
-    // Calculate pseudoinverse (just once)
-    FactorQTZ PVwr_qtz;
-    PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
+        // Calculate pseudoinverse (just once)
+        PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
+        if (mayReuse) 
+            saved->noteFactored(s, pverrWeights, uWeights, uRelScale);
+        ++nFactorizations;
+    }
 
     //printf("projectU m=%d condTol=%g rank=%d rcond=%g\n",
     //    PVwrt.ncol(), conditioningTol, PVwr_qtz.getRank(),
@@ -4570,6 +5373,32 @@ int SimbodyMatterSubsystemRep::projectU
                                        : scaledPVerrs.normRMS();
         ++nItsUsed;
 
+        if (isStale && pverrNormAchieved 
+                        > MaxReuseConvergenceRate*prevPVerrNormAchieved)
+        {   // The factorization from an earlier call isn't good enough here.
+            // Take back the step if it made things worse, then refactor with
+            // scaling based on the current u.
+            if (pverrNormAchieved > prevPVerrNormAchieved) {
+                updU(s) += du;
+                realizeSubsystemVelocity(s); // pvErrs changes here
+                scaledPVerrs = pvErrs.rowScale(pverrWeights);
+                pverrNormAchieved = useNormInf ? scaledPVerrs.normInf()
+                                               : scaledPVerrs.normRMS();
+            }
+            for (int i=0; i<nu; ++i) {
+                const Real ui = std::abs(u[i]);
+                const Real wi = uWeights[i];
+                uRelScale[i] = ui*wi > 1 ? ui : 1/wi;
+            }
+            calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
+            PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
+            saved->noteFactored(s, pverrWeights, uWeights, uRelScale);
+            ++nFactorizations;
+            isStale = false;
+            prevPVerrNormAchieved = pverrNormAchieved;
+            continue;
+        }
+
         if (localOnly && nItsUsed >= 2 
             && pverrNormAchieved > prevPVerrNormAchieved) {
             // Velocity norm worse -- restore to end of previous iteration.
@@ -4588,6 +5417,8 @@ int SimbodyMatterSubsystemRep::projectU
                 && nItsUsed < MaxIterations);
 
     results.setNumIterations(nItsUsed);
+    results.setNumFactorizations(nFactorizations);
+    results.setNumFactorizationReuses(nReuses);
 
     // Make sure we achieved at least the required constraint accuracy. If not 
     // we'll return with an error. If we see that the norm has been made worse
@@ -4712,30 +5543,26 @@ void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsOperator(
     const SBTreeVelocityCache&  tvc = sbs.getTreeVelocityCache();
     const SBDynamicsCache&      dc  = sbs.getDynamicsCache();
 
+    // If there are extra forces, subtract them (note sign) from the input 
+    // forces in temporaries and use those as the inputs instead. The 
+    // temporaries are made only here so that the usual case doesn't touch
+    // the heap.
+    if (extraMobilityForces || extraBodyForces) {
+        const Vector totalMobilityForces = extraMobilityForces
+            ? mobilityForces - *extraMobilityForces : mobilityForces;
+        const Vector_<SpatialVec> totalBodyForces = extraBodyForces
+            ? bodyForces - *extraBodyForces : bodyForces;
+        calcTreeForwardDynamicsOperator
+           (s, totalMobilityForces, particleForces, totalBodyForces,
+            0, 0, tac, udot, qdotdot, udotErr);
+        return;
+    }
+
     // Ensure that output arguments have been allocated properly.
     tac.allocate(topologyCache, mc, ic);
     udot.resize(topologyCache.nDOFs);
     qdotdot.resize(topologyCache.maxNQs);
 
-    Vector              totalMobilityForces;
-    Vector_<SpatialVec> totalBodyForces;
-
-    // inputs
-
-    // First assume we'll use the input forces as-is.
-    const Vector*              mobilityForcesToUse  = &mobilityForces;
-    const Vector_<SpatialVec>* bodyForcesToUse      = &bodyForces;
-
-    if (extraMobilityForces) {
-        totalMobilityForces = mobilityForces - *extraMobilityForces; // note sign
-        mobilityForcesToUse = &totalMobilityForces;
-    }
-
-    if (extraBodyForces) {
-        totalBodyForces = bodyForces - *extraBodyForces;    // note sign
-        bodyForcesToUse = &totalBodyForces;
-    }
-
     // outputs
     Vector&              netHingeForces = tac.epsilon;
     Array_<SpatialVec,MobilizedBodyIndex>&
@@ -4749,7 +5576,7 @@ void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsOperator(
     // body accelerations A_GB, u-space generalized accelerations udot,
     // and q-space generalized accelerations qdotdot.
     calcTreeAccelerations
-       (s, *mobilityForcesToUse, *bodyForcesToUse, dc.presUDotPool,
+       (s, mobilityForces, bodyForces, dc.presUDotPool,
         netHingeForces, abForcesZ, abForcesZPlus,
         A_GB, udot, qdotdot, tau);
 
@@ -4840,32 +5667,10 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     if (m==0) return;
     if (nu==0) {multipliers.setToZero(); return;}
 
-    // Conditioning tolerance. This determines when we'll drop a 
-    // constraint. 
-    // TODO: this is probably too tight; should depend on constraint tolerance
-    // and should be consistent with position and velocity projection ranks.
-    // Tricky here because conditioning depends on mass matrix as well as
-    // constraints.
-    const Real conditioningTol = m 
-        //* SignificantReal;
-        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-
     // Calculate multipliers lambda as
     //     (G M^-1 ~G) lambda = aerr
-    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
-    // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    // This will be solved block by block if that's enabled.
+    solveGMInvGt(s, udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
@@ -5049,22 +5854,12 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,dc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    sweepInward(UDotPass1InwardOp(ic,tpc,abc,dc,
+        mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+        hingeForcePtr));
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    sweepOutward(UDotPass2OutwardOp(sbs,ic,tpc,abc,tvc,dc,
+        hingeForcePtr, aPtr, udotPtr, tauPtr, qdotdotPtr));
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5108,19 +5903,11 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     const Real* fPtr     = &f[0];       
     Real*       MInvfPtr = &MInvf[0];
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass1Inward(ic,tpc,abc,
-                fPtr, z.begin(), zPlus.begin(), eps.begin());
-        }
+    sweepInward(MInvPass1InwardOp(ic,tpc,abc,
+        fPtr, z.begin(), zPlus.begin(), eps.begin()));
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass2Outward(ic,tpc,abc, 
-                eps.cbegin(), A_GB.begin(), MInvfPtr);
-        }
+    sweepOutward(MInvPass2OutwardOp(ic,tpc,abc, 
+        eps.cbegin(), A_GB.begin(), MInvfPtr));
 }
 //............................. CALC M INVERSE F ...............................
 
@@ -5322,21 +6109,10 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
                         ? &residualMobilityForces[0] : NULL;
     SpatialVec* tempPtr = allFTmp.size() ? &allFTmp[0] : NULL;
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcBodyAccelerationsFromUdotOutward
-               (tpc,tvc,knownUdotPtr,aPtr);
-        }
+    sweepOutward(BodyAccelerationsOutwardOp(tpc,tvc,knownUdotPtr,aPtr));
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcInverseDynamicsPass2Inward(
-                tpc,tvc,aPtr,
-                mobilityForcePtr,bodyForcePtr,
-                tempPtr,residualPtr);
-        }
+    sweepInward(InverseDynamicsPass2InwardOp(tpc,tvc,aPtr,
+        mobilityForcePtr,bodyForcePtr,tempPtr,residualPtr));
 }
 //........................ CALC TREE RESIDUAL FORCES ...........................
 
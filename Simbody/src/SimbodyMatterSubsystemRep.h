@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKcommon.h"
+#include "simmath/LinearAlgebra.h"
 
 #include "simbody/internal/common.h"
 #include "simbody/internal/MultibodySystem.h"
@@ -49,6 +50,8 @@ using std::pair;
 #include <set>
 #include <algorithm>
 
+#include <pthread.h>
+
 class RigidBodyNode;
 class RBDistanceConstraint;
 class RBStation;
@@ -57,6 +60,15 @@ class RBDirection;
 using namespace SimTK;
 
 typedef Array_<const RigidBodyNode*>   RBNodePtrList;
+
+// A run of consecutive nodes within one tree level that all have exactly the
+// same concrete RigidBodyNode type, so can be processed as a block.
+struct RBNodeBlock {
+    RBNodeBlock() : first(-1), nNodes(0) {}
+    RBNodeBlock(int first, int nNodes) : first(first), nNodes(nNodes) {}
+    int first;  // offset within the level
+    int nNodes;
+};
 typedef Vector_<SpatialVec>            SpatialVecList;
 
 /*
@@ -117,6 +129,56 @@ private:
     SimbodyMatterSubtree coupledSubtree; // with the new ancestor
 };
 
+/*
+ * A ProjectionFactorization holds a factored, weighted constraint Jacobian
+ * that was used for a projectQ() or projectU() iteration, along with enough
+ * information to decide whether it may be used again in later iterations or
+ * later calls (a modified Newton iteration). The Jacobian depends on q (and 
+ * rarely u) so a reused factorization is out of date; the projection methods
+ * check the convergence rate and refactor when it is unacceptable. Here we
+ * only check that the factorization has the right shape and weighting for
+ * the given State and hasn't already been used too many times. Each State
+ * holds its own pair of these in a lazy cache entry that depends on Instance
+ * stage (see updProjectionFactorization()).
+ */
+class ProjectionFactorization {
+public:
+    ProjectionFactorization() {invalidate();}
+
+    void invalidate() {valid=false; nUses=0;}
+
+    // Record that qtz was just factored for this State using the given 
+    // constraint error weights, u weights, and column scaling.
+    void noteFactored(const State& s, const Vector& errWeights, 
+                      const Vector& uWeights, const Vector& scale) {
+        topologyVersion = s.getSystemTopologyStageVersion();
+        savedErrWeights = errWeights; savedUWeights = uWeights;
+        colScale = scale;
+        valid = true; nUses = 1;
+    }
+
+    bool isReusableFor(const State& s, const Vector& errWeights, 
+                       const Vector& uWeights, int maxUses) const {
+        if (!valid || nUses > maxUses) return false;
+        if (topologyVersion != s.getSystemTopologyStageVersion()) return false;
+        if (savedErrWeights.size() != errWeights.size()
+            || savedUWeights.size() != uWeights.size()) return false;
+        for (int i=0; i < errWeights.size(); ++i)
+            if (savedErrWeights[i] != errWeights[i]) return false;
+        for (int i=0; i < uWeights.size(); ++i)
+            if (savedUWeights[i] != uWeights[i]) return false;
+        return true;
+    }
+
+    FactorQTZ       qtz;
+    Vector          colScale;   // u scaling the factored matrix was built with
+    int             nUses;      // solves performed since factoring
+private:
+    bool            valid;
+    StageVersion    topologyVersion;
+    Vector          savedErrWeights, savedUWeights;
+};
+
     //////////////////////////////////
     // SIMBODY MATTER SUBSYSTEM REP //
     //////////////////////////////////
@@ -141,8 +203,12 @@ private:
 class SimbodyMatterSubsystemRep : public SimTK::Subsystem::Guts {
 public:
     SimbodyMatterSubsystemRep() 
-      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
+      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1"),
+        treeSweepExecutor(0), treeSweepThreads(1),
+        useBlockKinematics(false), useBlockConstraintSolver(false),
+        useIncrementalPositionKinematics(false), projectionReuseLimit(0)
     { 
+        pthread_mutex_init(&treeSweepLock, NULL);
         clearTopologyCache();
     }
 
@@ -157,6 +223,8 @@ public:
         invalidateSubsystemTopologyCache();
         clearTopologyCache(); // should do cache before state
         clearTopologyState();
+        delete treeSweepExecutor;
+        pthread_mutex_destroy(&treeSweepLock);
     }
 
     SimbodyMatterSubsystemRep* cloneImpl() const {
@@ -851,6 +919,36 @@ public:
                                     const Vector&    deltaV,
                                     Vector&          impulse) const;
 
+    // Calculate the diagonal blocks of G M^-1 ~G, one for each group of
+    // mutually-coupled constraint equations found by 
+    // findUncoupledConstraintGroups(), without forming the rest.
+    void calcGMInvGtBlocks(const State&     state,
+                           Array_<Matrix>&  blocks) const;
+
+    // Solve G M^-1 ~G x = b for x. Rank deficiency is handled by a
+    // rank-revealing QTZ factorization whose conditioning tolerance is
+    // scaled by the size of the matrix factored. If the block constraint
+    // solver is enabled, only the blocks of G M^-1 ~G are formed and each is
+    // factored and solved separately; otherwise it is formed and factored 
+    // whole.
+    void solveGMInvGt(const State&      state,
+                      const Vector&     b,
+                      Vector&           x) const;
+
+    // Partition the constraint equations currently in use into groups whose
+    // equations are uncoupled in G M^-1 ~G. Mass matrix coupling doesn't 
+    // cross between base bodies (children of Ground), so two constraints are
+    // coupled only if they have constrained bodies or mobilizers in the 
+    // same branch, directly or through a chain of other constraints. The
+    // returned groups hold indices into the multiplier vector in increasing
+    // order; groups are ordered by their lowest multiplier index. This 
+    // depends only on Instance-stage information and is called once from
+    // realizeInstance() to fill in the Instance cache; the supplied cache
+    // must already have its constraint equation segments assigned.
+    void findUncoupledConstraintGroups(const State&             state,
+                                       const SBInstanceCache&   ic,
+                                       Array_< Array_<int> >&   groups) const;
+
     // Given an array of nu udots, return nb body accelerations in G (including
     // Ground as the 0th body with A_GB[0]=0). The returned accelerations are
     // A = J*udot + Jdot*u, with the Jdot*u (coriolis acceleration) term
@@ -1095,7 +1193,72 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    // Level-parallel tree sweeps. Nodes at the same level of the tree are
+    // independent during base-to-tip and tip-to-base sweeps, so they can
+    // be processed concurrently with a barrier between levels. Results are
+    // bit-identical to the serial sweep since each node performs exactly
+    // the same computation in either case.
+    void setUseParallelTreeSweeps(bool useParallel, int numThreads);
+    bool getUseParallelTreeSweeps() const {return treeSweepExecutor != 0;}
+    int  getNumTreeSweepThreads() const {return treeSweepThreads;}
+
+    // Block kinematics. When enabled, position and velocity kinematics are
+    // realized a block of same-type nodes at a time through 
+    // RigidBodyNode::realizePositionBlock() and realizeVelocityBlock() 
+    // rather than a node at a time. The results are the same.
+    void setUseBlockKinematics(bool useBlocks) 
+    {   useBlockKinematics = useBlocks; }
+    bool getUseBlockKinematics() const {return useBlockKinematics;}
+
+    // Block constraint solver. When enabled, solving with G M^-1 ~G for 
+    // multipliers or impulses factors each group of coupled constraints 
+    // separately, costing the sum of the cubes of the group sizes rather than
+    // the cube of the total number of constraint equations.
+    void setUseBlockConstraintSolver(bool useBlocks) 
+    {   useBlockConstraintSolver = useBlocks; }
+    bool getUseBlockConstraintSolver() const 
+    {   return useBlockConstraintSolver; }
+
+    // Incremental position kinematics. When enabled, realizePosition()
+    // recalculates tree kinematics only for mobilizers whose q's differ from
+    // those used the last time, and for everything outboard of them.
+    void setUseIncrementalPositionKinematics(bool useIncremental)
+    {   useIncrementalPositionKinematics = useIncremental; }
+    bool getUseIncrementalPositionKinematics() const
+    {   return useIncrementalPositionKinematics; }
+
+    // Projection factorization reuse. When the limit is positive, projectQ()
+    // and projectU() may solve with a previously factored constraint Jacobian
+    // up to this many additional times, across iterations and across calls,
+    // before refactoring. Zero means always refactor (full Newton).
+    void setProjectionReuseLimit(int maxReuses) 
+    {   projectionReuseLimit = maxReuses; }
+    int getProjectionReuseLimit() const {return projectionReuseLimit;}
+
+    // Return the factorization saved in this State's cache by projectQ() 
+    // (forQ==true) or projectU(). It is empty after any Instance-stage 
+    // change.
+    ProjectionFactorization& 
+    updProjectionFactorization(const State& state, bool forQ) const;
+
 private:
+    // Apply a per-node operator to every node of the tree, one level at a 
+    // time; outward is base to tip, inward is tip to base. Ground (level 0)
+    // is included unless firstLevel is > 0. If parallel tree sweeps are
+    // enabled, sufficiently wide levels are spread across worker threads.
+    template <class NodeOp> void sweepOutward(const NodeOp& op, 
+                                              int firstLevel=0) const;
+    template <class NodeOp> void sweepInward(const NodeOp& op,
+                                             int firstLevel=0) const;
+    template <class NodeOp> void sweepLevel(int level, const NodeOp& op) const;
+
+    // Apply a block operator base to tip to the same-type node blocks in 
+    // rbNodeBlocks. Blocks within a level may be spread across worker
+    // threads just as single nodes are above.
+    template <class BlockOp> void sweepBlocksOutward(const BlockOp& op) const;
+    template <class BlockOp> void sweepLevelBlocks(int level, 
+                                                   const BlockOp& op) const;
+
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1248,6 +1411,13 @@ private:
     // Map nodeNum (a.k.a. MobilizedBodyIndex) to (level,offset).
     Array_<RigidBodyNodeIndex,MobilizedBodyIndex> nodeNum2NodeMap;
 
+    // The same nodes as rbNodeLevels but with each level stably grouped by
+    // concrete node type, and the blocks of at most MaxNodeBlockSize same-
+    // type nodes that each level is cut into. Position and velocity 
+    // kinematics are realized a block at a time.
+    Array_<RBNodePtrList>           rbNodeLevelsByType;
+    Array_< Array_<RBNodeBlock> >   rbNodeBlocks;
+
         // Constraints
 
     // Here we sort the above constraints by branch (ancestor's base body), then by
@@ -1320,6 +1490,28 @@ private:
     
     // Specifies whether default decorative geometry should be shown.
     bool showDefaultGeometry;
+
+    // If non-null, wide tree levels are processed by this executor's worker
+    // threads during sweeps. Owned by this Rep; null means serial sweeps.
+    // The executor runs one level at a time, so a sweep holds treeSweepLock
+    // while using it; a sweep that finds it busy (another thread is realizing
+    // a different State) runs serially instead.
+    ParallelExecutor*           treeSweepExecutor;
+    int                         treeSweepThreads;
+    mutable pthread_mutex_t     treeSweepLock;
+
+    // If true, position and velocity kinematics sweep rbNodeBlocks.
+    bool                useBlockKinematics;
+
+    // If true, solveGMInvGt() works block by block.
+    bool                useBlockConstraintSolver;
+
+    // If true, realizePosition() skips mobilizers whose q's haven't changed.
+    bool                useIncrementalPositionKinematics;
+
+    // Factorizations used by projectQ() and projectU() are saved in each
+    // State's cache, and only reused if projectionReuseLimit > 0.
+    int                 projectionReuseLimit;
 };
 
 std::ostream& operator<<(std::ostream&, const SimbodyMatterSubsystemRep&);
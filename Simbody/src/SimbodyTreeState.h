@@ -259,7 +259,8 @@ public:
                           compositeBodyInertiaCacheIndex, articulatedBodyInertiaCacheIndex,
                           treeVelocityCacheIndex, constrainedVelocityCacheIndex,
                           dynamicsCacheIndex, 
-                          treeAccelerationCacheIndex, constrainedAccelerationCacheIndex;
+                          treeAccelerationCacheIndex, constrainedAccelerationCacheIndex,
+                          qProjectionCacheIndex, uProjectionCacheIndex;
 
 private:
     // MobilizedBody 0 is Ground.
@@ -568,6 +569,11 @@ public:
     int totalNConstrainedMobilizersInUse;
     int totalNConstrainedQInUse; // q,u from the constrained mobilizers
     int totalNConstrainedUInUse; 
+
+    // Partition of the multipliers of the enabled constraints into groups 
+    // whose equations are uncoupled in G M^-1 ~G; see 
+    // findUncoupledConstraintGroups(). Used by the block constraint solver.
+    Array_< Array_<int> > uncoupledConstraintGroups;
 public:
     void allocate(const SBTopologyCache& topo,
                   const SBModelCache&    model) 
@@ -591,6 +597,8 @@ public:
         totalNConstrainedMobilizersInUse = 0;
         totalNConstrainedQInUse          = 0;
         totalNConstrainedUInUse          = 0; 
+
+        uncoupledConstraintGroups.clear();
     }
 
 };
@@ -696,6 +704,20 @@ public:
     // the Ancestor frame rather than Ground.
     Array_<Transform> constrainedBodyConfigInAncestor;   // nacb (X_AB)
 
+        // Incremental kinematics
+
+    // When incremental position kinematics is enabled, we remember the q's
+    // that were used to calculate the above tree kinematics, along with the
+    // quaternion normalization errors that were written into qErr at the
+    // same time. If kinematicsQValid is true, only mobilizers whose q's
+    // differ from these (and their descendents) need to be recalculated.
+    // Any reallocation here invalidates the saved q's.
+    Vector                          kinematicsQ;        // nq
+    Vector                          quaternionErrs;     // nquat
+    bool                            kinematicsQValid;
+    Array_<bool,MobilizedBodyIndex> kinematicsRecalculated; // nb (temp)
+    int                             nKinematicsRecalculated;
+
 public:
     void allocate(const SBTopologyCache& tree,
                   const SBModelCache&    model,
@@ -736,6 +758,12 @@ public:
         bodyCOMInGround[GroundIndex] = Vec3(0);
 
         constrainedBodyConfigInAncestor.resize(nacb);
+
+        kinematicsQ.clear();
+        quaternionErrs.clear();
+        kinematicsQValid = false;
+        kinematicsRecalculated.resize(nBodies);
+        nKinematicsRecalculated = 0;
     }
 };
 //.......................... TREE POSITION CACHE ...............................
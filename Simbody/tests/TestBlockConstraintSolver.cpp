@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that the block-diagonal constraint solver produces the same
+ * constrained accelerations, multipliers, and impulses as the dense solver.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// Build a loop: a chain of ball-jointed links hanging from Ground whose tip
+// is tied back to Ground with a ball constraint. Returns the tip body.
+static MobilizedBody buildLoop(SimbodyMatterSubsystem& matter,
+                               const Vec3& attach, int nLinks)
+{
+    const Body::Rigid link(MassProperties(1, Vec3(0,-.25,0),
+                                          UnitInertia::brick(.1,.25,.1)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < nLinks; ++i)
+        parent = MobilizedBody::Ball(parent, i==0 ? attach : Vec3(0,-.5,0),
+                                     link, Vec3(0));
+    Constraint::Ball(matter.Ground(), attach + Vec3(.3,-.6,0),
+                     parent, Vec3(0,-.5,0));
+    return parent;
+}
+
+static Constraint buildModel(SimbodyMatterSubsystem& matter) {
+    // Independent loops, each its own block.
+    for (int i=0; i < 5; ++i)
+        buildLoop(matter, Vec3(i,0,0), 3);
+
+    // Two loops on different branches tied together; these must end up
+    // in the same block.
+    MobilizedBody tip1 = buildLoop(matter, Vec3(0,0,2), 2);
+    MobilizedBody tip2 = buildLoop(matter, Vec3(1,0,2), 2);
+    Constraint::Rod rod(tip1, Vec3(0,-.25,0), tip2, Vec3(0,-.25,0), 1.1);
+
+    // A redundant constraint on a branch of its own.
+    MobilizedBody::Pin pend(matter.Ground(), Vec3(0,0,-2),
+        Body::Rigid(MassProperties(1,Vec3(0),UnitInertia(1))), Vec3(0,1,0));
+    Constraint::ConstantAngle(matter.Ground(), XAxis, pend, YAxis);
+    Constraint::ConstantAngle(matter.Ground(), XAxis, pend, YAxis);
+    return rod;
+}
+
+static bool isClose(const Vector& a, const Vector& b, Real tol) {
+    if (a.size() != b.size()) return false;
+    const Real scale = std::max(Real(1), max(abs(a)));
+    return a.size()==0 || max(abs(a-b)) <= tol*scale;
+}
+
+// Compare dense and block results for the given State, which must have its
+// q's assembled. The matter subsystem is left using the dense solver.
+static void compareBlockWithDense(const MultibodySystem&   system,
+                                  SimbodyMatterSubsystem&  matter,
+                                  const State&             state) 
+{
+    matter.setUseBlockConstraintSolver(false);
+    Random::Uniform random(-1,1); random.setSeed(23);
+
+    State dense = state;
+    system.realize(dense, Stage::Acceleration);
+    Vector deltaV(dense.getNMultipliers());
+    for (int i=0; i < deltaV.size(); ++i) deltaV[i] = random.getValue();
+    Vector denseImpulse;
+    matter.solveForConstraintImpulses(dense, deltaV, denseImpulse);
+
+    matter.setUseBlockConstraintSolver(true);
+    SimTK_TEST(matter.getUseBlockConstraintSolver());
+
+    State block = state;
+    system.realize(block, Stage::Acceleration);
+    Vector blockImpulse;
+    matter.solveForConstraintImpulses(block, deltaV, blockImpulse);
+
+    SimTK_TEST(isClose(dense.getUDot(), block.getUDot(), 1e-10));
+    SimTK_TEST(isClose(dense.getMultipliers(), block.getMultipliers(), 1e-10));
+    SimTK_TEST(isClose(denseImpulse, blockImpulse, 1e-10));
+    SimTK_TEST(block.getUDotErr().normInf() < 1e-10);
+
+    matter.setUseBlockConstraintSolver(false);
+}
+
+void testBlockMatchesDense() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+    buildModel(matter);
+
+    SimTK_TEST(!matter.getUseBlockConstraintSolver());
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(17);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = .3*random.getValue();
+    Assembler(system).setAccuracy(1e-10).assemble(state);
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+
+    compareBlockWithDense(system, matter, state);
+}
+
+// Disabling the constraint that couples two branches splits their group.
+void testDisabledConstraints() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+    Constraint rod = buildModel(matter);
+
+    State state = system.realizeTopology();
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = .2*std::cos(Real(i));
+    rod.disable(state);
+    Assembler(system).setAccuracy(1e-10).assemble(state);
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = std::sin(Real(i));
+    compareBlockWithDense(system, matter, state);
+}
+
+int main() {
+    SimTK_START_TEST("TestBlockConstraintSolver");
+        SimTK_SUBTEST(testBlockMatchesDense);
+        SimTK_SUBTEST(testDisabledConstraints);
+    SimTK_END_TEST();
+}
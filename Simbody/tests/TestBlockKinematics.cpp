@@ -0,0 +1,154 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that calculating position and velocity kinematics in blocks of
+ * same-type mobilizers gives exactly the same results as calculating them a
+ * mobilized body at a time, on a model that mixes mobilizers that have
+ * block implementations with ones that don't.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// Vectors must match bit for bit, not just to a tolerance.
+static bool exactlyEqual(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (!(a[i] == b[i])) return false;
+    return true;
+}
+
+// Add a child of the given kind to parent. Kinds 0-4 have block
+// implementations; the rest don't.
+static MobilizedBody addChild(MobilizedBody& parent, int kind,
+                              const Body& body) {
+    const Transform X_PF(Rotation(.3*kind, UnitVec3(1,1,kind)),
+                         Vec3(.1*kind,-.5,0));
+    const Transform X_BM(Vec3(0,.5,0));
+    switch (kind) {
+    case 0: return MobilizedBody::Pin      (parent, X_PF, body, X_BM);
+    case 1: return MobilizedBody::Slider   (parent, X_PF, body, X_BM);
+    case 2: return MobilizedBody::Ball     (parent, X_PF, body, X_BM);
+    case 3: return MobilizedBody::Universal(parent, X_PF, body, X_BM);
+    case 4: return MobilizedBody::Free     (parent, X_PF, body, X_BM);
+    case 5: return MobilizedBody::Gimbal   (parent, X_PF, body, X_BM);
+    case 6: return MobilizedBody::Cylinder (parent, X_PF, body, X_BM);
+    case 7: return MobilizedBody::Planar   (parent, X_PF, body, X_BM);
+    default: return MobilizedBody::Weld    (parent, X_PF, body, X_BM);
+    }
+}
+static const int NumKinds = 9;
+
+// Many branches off Ground, each a short chain, with the mobilizer kinds
+// interleaved so that every level has long same-type runs (more than a block
+// long) as well as short ones once the nodes are sorted by type.
+static void buildModel(SimbodyMatterSubsystem& matter) {
+    const Body::Rigid body(MassProperties(1.5, Vec3(.1,-.2,.05),
+                                          UnitInertia(1,1.2,1.4,.1,.05,.02)));
+    for (int b=0; b < 40; ++b) {
+        MobilizedBody parent = matter.Ground();
+        for (int level=0; level < 4; ++level) {
+            const int kind = (b < 20 ? b/4 + level : b + 3*level) % NumKinds;
+            parent = addChild(parent, kind, body);
+        }
+    }
+}
+
+// Realize the State to Acceleration stage from Position, and return
+// everything the position and velocity kinematics affect.
+static void realizeAll(const MultibodySystem& system, State& state,
+                       Array_<Transform>& X_GB, Array_<SpatialVec>& V_GB,
+                       Vector& qdot, Vector& qerr, Vector& udot) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    state.invalidateAllCacheAtOrAbove(Stage::Position);
+    system.realize(state, Stage::Acceleration);
+    X_GB.clear(); V_GB.clear();
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+        X_GB.push_back(mobod.getBodyTransform(state));
+        V_GB.push_back(mobod.getBodyVelocity(state));
+    }
+    qdot = state.getQDot();
+    qerr = state.getQErr();
+    udot = state.getUDot();
+}
+
+static void compareBlockWithSerial(MultibodySystem& system,
+                                   bool useEulerAngles, bool useParallel) {
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    matter.setUseParallelTreeSweeps(useParallel, 4);
+    State state = system.realizeTopology();
+    matter.setUseEulerAngles(state, useEulerAngles);
+    system.realizeModel(state);
+
+    Random::Uniform random(-1, 1);
+    random.setSeed(7);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+
+    Array_<Transform> X_GB, blockX_GB;
+    Array_<SpatialVec> V_GB, blockV_GB;
+    Vector qdot, qerr, udot, blockQdot, blockQerr, blockUdot;
+
+    matter.setUseBlockKinematics(false);
+    realizeAll(system, state, X_GB, V_GB, qdot, qerr, udot);
+    matter.setUseBlockKinematics(true);
+    realizeAll(system, state, blockX_GB, blockV_GB,
+               blockQdot, blockQerr, blockUdot);
+    matter.setUseBlockKinematics(false);
+
+    for (unsigned b=0; b < X_GB.size(); ++b) {
+        SimTK_TEST(blockX_GB[b].R().asMat33() == X_GB[b].R().asMat33());
+        SimTK_TEST(blockX_GB[b].p() == X_GB[b].p());
+        SimTK_TEST(blockV_GB[b] == V_GB[b]);
+    }
+    SimTK_TEST(exactlyEqual(blockQdot, qdot));
+    SimTK_TEST(exactlyEqual(blockQerr, qerr));
+    SimTK_TEST(exactlyEqual(blockUdot, udot));
+    matter.setUseParallelTreeSweeps(false);
+}
+
+void testBlockMatchesSerial() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.81);
+    buildModel(matter);
+
+    SimTK_TEST(!matter.getUseBlockKinematics());
+    for (int euler=0; euler < 2; ++euler)
+        for (int parallel=0; parallel < 2; ++parallel)
+            compareBlockWithSerial(system, euler != 0, parallel != 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestBlockKinematics");
+        SimTK_SUBTEST(testBlockMatchesSerial);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,119 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+using namespace std;
+
+// Check that CPodesIntegrator's matrix-free Krylov linear solver option
+// produces the same trajectory as the default dense direct solver, while
+// avoiding the ny realizations per Jacobian that the dense solver requires.
+
+// A damped chain of pin-jointed links hanging from ground. The subsystem
+// handles must outlive the forces that refer to them, so keep them together.
+class Chain {
+public:
+    explicit Chain(int nLinks) : matter(system), forces(system) {
+        Force::Gravity(forces, matter, -YAxis, 9.8);
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(0.1)));
+        MobilizedBody parent = matter.Ground();
+        for (int i=0; i < nLinks; ++i) {
+            MobilizedBody::Pin link(parent, Vec3(0, -0.5, 0), 
+                                    body, Vec3(0, 0.5, 0));
+            Force::MobilityLinearDamper(forces, link, MobilizerUIndex(0), 0.5);
+            parent = link;
+        }
+        state = system.realizeTopology();
+        for (int i=0; i < nLinks; ++i)
+            state.updQ()[i] = 0.3*std::sin(Real(i));
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    State                   state;
+};
+
+static void simulate(const MultibodySystem& system, const State& state,
+                     bool useKrylov, CPodes::KrylovMethod method,
+                     Real tFinal, Vector& yFinal, int& nRealize, int& nSteps)
+{
+    CPodesIntegrator integ(system, CPodes::BDF, CPodes::Newton);
+    integ.setAccuracy(1e-6);
+    if (useKrylov)
+        integ.setUseKrylovLinearSolver(method);
+    TimeStepper ts(system, integ);
+    ts.initialize(state);
+    for (int i=1; i <= 10; ++i)
+        ts.stepTo(i*tFinal/10);
+    yFinal   = ts.getState().getY();
+    nRealize = integ.getNumRealizations();
+    nSteps   = integ.getNumStepsTaken();
+    if (useKrylov) {
+        SimTK_TEST(integ.getNumLinearSolverIterations() > 0);
+    } else {
+        SimTK_TEST(integ.getNumLinearSolverIterations() == 0);
+    }
+}
+
+void testKrylovMatchesDense() {
+    const Real tFinal = 2;
+    Chain chain(150); // ny = 300
+    const MultibodySystem& system = chain.system;
+    const State& state = chain.state;
+
+    Vector yDense;
+    int denseRealize, denseSteps;
+    simulate(system, state, false, CPodes::GMRES, tFinal, 
+             yDense, denseRealize, denseSteps);
+
+    const CPodes::KrylovMethod methods[] = 
+        {CPodes::GMRES, CPodes::BiCGStab, CPodes::TFQMR};
+    for (int m=0; m < 3; ++m) {
+        Vector yKrylov;
+        int krylovRealize, krylovSteps;
+        simulate(system, state, true, methods[m], tFinal, 
+                 yKrylov, krylovRealize, krylovSteps);
+        cout << "  method " << methods[m] << ": Krylov " << krylovSteps 
+             << " steps, " << krylovRealize << " realizations; dense " 
+             << denseSteps << " steps, " << denseRealize 
+             << " realizations\n";
+        SimTK_TEST_EQ_TOL(yKrylov, yDense, 1e-3);
+        SimTK_TEST(krylovRealize < denseRealize);
+    }
+}
+
+void testMustSetBeforeInitialize() {
+    Chain chain(2);
+    CPodesIntegrator integ(chain.system, CPodes::BDF, CPodes::Newton);
+    integ.initialize(chain.state);
+    SimTK_TEST_MUST_THROW(integ.setUseKrylovLinearSolver());
+}
+
+int main() {
+    SimTK_START_TEST("TestCPodesKrylov");
+        SimTK_SUBTEST(testKrylovMatchesDense);
+        SimTK_SUBTEST(testMustSetBeforeInitialize);
+    SimTK_END_TEST();
+}
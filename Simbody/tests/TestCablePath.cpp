@@ -0,0 +1,109 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that a cable path wrapping several surface obstacles is solved the
+ * same way whether or not the obstacles are done in parallel.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+static const Real Rad = .5;
+
+// A cable between two ground points that is pushed down by three spheres
+// mounted on pendulums. If shareGeometry is set, all the obstacles use the
+// same ContactGeometry object.
+static void buildModel(SimbodyMatterSubsystem& matter,
+                       CableTrackerSubsystem& cables, bool shareGeometry)
+{
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    const ContactGeometry::Sphere shared(Rad);
+
+    CablePath path(cables, matter.Ground(), Vec3(-4,0,0),  // origin
+                           matter.Ground(), Vec3( 4,0,0)); // termination
+    for (int i=0; i < 3; ++i) {
+        MobilizedBody::Pin pendulum(matter.Ground(),
+                                    Transform(Vec3(2.5*(i-1), 2, 0)),
+                                    body, Transform(Vec3(0, 1.7, 0)));
+        CableObstacle::Surface obs(path, pendulum, Transform(),
+            shareGeometry ? ContactGeometry(shared)
+                          : ContactGeometry(ContactGeometry::Sphere(Rad)));
+        obs.setContactPointHints(Rad*UnitVec3(-.5,-1,0.01),
+                                 Rad*UnitVec3( .5,-1,0.01));
+    }
+}
+
+void testParallelFlags() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    CableTrackerSubsystem   cables(system);
+
+    SimTK_TEST(!cables.getUseParallelSurfaceObstacles());
+    cables.setUseParallelSurfaceObstacles(true, 3);
+    SimTK_TEST(cables.getUseParallelSurfaceObstacles());
+    cables.setUseParallelSurfaceObstacles(true, 1); // one thread means serial
+    SimTK_TEST(!cables.getUseParallelSurfaceObstacles());
+    SimTK_TEST_MUST_THROW(cables.setUseParallelSurfaceObstacles(true, 0));
+}
+
+void testParallelMatchesSerial(bool shareGeometry) {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    CableTrackerSubsystem   cables(system);
+    buildModel(matter, cables, shareGeometry);
+    const CablePath& path = cables.getCablePath(CablePathIndex(0));
+
+    const State state = system.realizeTopology();
+
+    State serial = state;
+    system.realize(serial, Stage::Position);
+    const Real serialLength = path.getCableLength(serial);
+    // The straight line would be 8 long; wrapping must make it longer.
+    SimTK_TEST(serialLength > 8);
+
+    // Use more threads than this machine might have so that work really is
+    // handed off to workers.
+    cables.setUseParallelSurfaceObstacles(true, 4);
+    State parallel = state;
+    system.realize(parallel, Stage::Position);
+    SimTK_TEST(path.getCableLength(parallel) == serialLength);
+}
+
+void testParallelMatchesSerialDistinctGeometry()
+{   testParallelMatchesSerial(false); }
+void testParallelMatchesSerialSharedGeometry()
+{   testParallelMatchesSerial(true); }
+
+int main() {
+    SimTK_START_TEST("TestCablePath");
+        SimTK_SUBTEST(testParallelFlags);
+        SimTK_SUBTEST(testParallelMatchesSerialDistinctGeometry);
+        SimTK_SUBTEST(testParallelMatchesSerialSharedGeometry);
+    SimTK_END_TEST();
+}
@@ -24,6 +24,7 @@
 #include "SimTKsimbody.h"
 
 #include <set>
+#include <pthread.h>
 
 using namespace SimTK;
 using namespace std;
@@ -532,6 +533,192 @@ void testTriangleMeshTriangleMesh() {
     }
 }
 
+// Two overlapping sphere meshes, dense enough that the narrow phase tests 
+// many batches of leaf pairs. The intersecting faces are checked against 
+// testing every pair of triangles, and the buried ones against the spheres.
+void testDenseTriangleMeshes() {
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 4);
+    ContactGeometry::TriangleMesh mesh1(sphere), mesh2(sphere);
+    const Transform X_GM1(Rotation(0.3, XAxis), Vec3(0.1, 0.2, 0.3));
+    const Transform X_GM2(Rotation(1.1, YAxis), Vec3(1.3, 0.5, 0.2));
+    const Transform X_M1M2 = ~X_GM1*X_GM2;
+
+    Array_<Contact> contacts;
+    CollisionDetectionAlgorithm::TriangleMeshTriangleMesh algorithm;
+    algorithm.processObjects(ContactSurfaceIndex(0), mesh1, X_GM1,
+                             ContactSurfaceIndex(1), mesh2, X_GM2, contacts);
+    ASSERT(contacts.size() == 1);
+    const TriangleMeshContact& c = TriangleMeshContact::getAs(contacts[0]);
+
+    // The tracker must find the same faces.
+    ContactTracker::TriangleMeshTriangleMesh tracker;
+    Contact tracked;
+    tracker.trackContact(UntrackedContact(ContactSurfaceIndex(0), 
+                                          ContactSurfaceIndex(1)),
+                         X_GM1, mesh1, X_GM2, mesh2, 0, tracked);
+    ASSERT(TriangleMeshContact::isInstance(tracked));
+    ASSERT(TriangleMeshContact::getAs(tracked).getSurface1Faces() 
+           == c.getSurface1Faces());
+    ASSERT(TriangleMeshContact::getAs(tracked).getSurface2Faces() 
+           == c.getSurface2Faces());
+
+    set<int> crossing1, crossing2;
+    for (int f2 = 0; f2 < mesh2.getNumFaces(); f2++) {
+        const Geo::Triangle A
+           (X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 0)),
+            X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 1)),
+            X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 2)));
+        for (int f1 = 0; f1 < mesh1.getNumFaces(); f1++) {
+            const Geo::Triangle B
+               (mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 0)),
+                mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 1)),
+                mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 2)));
+            if (A.overlapsTriangle(B)) {
+                crossing1.insert(f1);
+                crossing2.insert(f2);
+            }
+        }
+    }
+    ASSERT(!crossing1.empty());
+
+    // Every crossing face must be found. Any other face that was found must 
+    // be inside the other sphere, and all faces well inside must be found.
+    const set<int>& found1 = c.getSurface1Faces();
+    const Vec3 center2_M1 = X_M1M2.p();
+    for (int f1 = 0; f1 < mesh1.getNumFaces(); f1++) {
+        const Real dist = (mesh1.findCentroid(f1) - center2_M1).norm();
+        const bool isFound = found1.count(f1) != 0;
+        if (crossing1.count(f1)) 
+            ASSERT(isFound)
+        else if (isFound)
+            ASSERT(dist < 1)
+        else
+            ASSERT(dist > 0.95)
+    }
+    const set<int>& found2 = c.getSurface2Faces();
+    const Vec3 center1_M2 = (~X_M1M2).p();
+    for (int f2 = 0; f2 < mesh2.getNumFaces(); f2++) {
+        const Real dist = (mesh2.findCentroid(f2) - center1_M2).norm();
+        const bool isFound = found2.count(f2) != 0;
+        if (crossing2.count(f2)) 
+            ASSERT(isFound)
+        else if (isFound)
+            ASSERT(dist < 1)
+        else
+            ASSERT(dist > 0.95)
+    }
+}
+
+// Meshes big enough that the narrow phase uses the worker threads, when 
+// enabled, for every stage. The faces found must not depend on that.
+void testParallelTriangleMeshes() {
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 5);
+    ContactGeometry::TriangleMesh mesh1(sphere), mesh2(sphere);
+    const Transform X_GM1(Rotation(0.3, XAxis), Vec3(0.1, 0.2, 0.3));
+    const Transform X_GM2(Rotation(1.1, YAxis), Vec3(1.3, 0.5, 0.2));
+
+    CollisionDetectionAlgorithm::TriangleMeshTriangleMesh serial, parallel;
+    ASSERT(!parallel.getUseParallel());
+    parallel.setUseParallel(true, 4);
+    ASSERT(parallel.getUseParallel());
+    Array_<Contact> serialContacts, parallelContacts;
+    serial.processObjects(ContactSurfaceIndex(0), mesh1, X_GM1,
+                          ContactSurfaceIndex(1), mesh2, X_GM2, 
+                          serialContacts);
+    ASSERT(serialContacts.size() == 1);
+    const TriangleMeshContact& c = 
+        TriangleMeshContact::getAs(serialContacts[0]);
+
+    // Use the same executor more than once.
+    for (int i=0; i < 2; ++i) {
+        parallelContacts.clear();
+        parallel.processObjects(ContactSurfaceIndex(0), mesh1, X_GM1,
+                                ContactSurfaceIndex(1), mesh2, X_GM2, 
+                                parallelContacts);
+        ASSERT(parallelContacts.size() == 1);
+        const TriangleMeshContact& p = 
+            TriangleMeshContact::getAs(parallelContacts[0]);
+        ASSERT(p.getSurface1Faces() == c.getSurface1Faces());
+        ASSERT(p.getSurface2Faces() == c.getSurface2Faces());
+    }
+
+    ContactTracker::TriangleMeshTriangleMesh tracker;
+    tracker.setUseParallel(true, 4);
+    for (int i=0; i < 2; ++i) {
+        Contact tracked;
+        tracker.trackContact(UntrackedContact(ContactSurfaceIndex(0), 
+                                              ContactSurfaceIndex(1)),
+                             X_GM1, mesh1, X_GM2, mesh2, 0, tracked);
+        ASSERT(TriangleMeshContact::isInstance(tracked));
+        ASSERT(TriangleMeshContact::getAs(tracked).getSurface1Faces() 
+               == c.getSurface1Faces());
+        ASSERT(TriangleMeshContact::getAs(tracked).getSurface2Faces() 
+               == c.getSurface2Faces());
+    }
+    tracker.setUseParallel(false);
+    ASSERT(!tracker.getUseParallel());
+}
+
+// Processes the same pair of meshes over and over from its own user thread.
+struct ProcessRepeatedly {
+    const CollisionDetectionAlgorithm::TriangleMeshTriangleMesh*  algorithm;
+    const ContactGeometry::TriangleMesh*    mesh1;
+    const ContactGeometry::TriangleMesh*    mesh2;
+    Transform                               X_GM1, X_GM2;
+    int                                     numTimes;
+    Array_<Contact>                         contacts;
+};
+
+static void* processRepeatedly(void* arg) {
+    ProcessRepeatedly& job = *(ProcessRepeatedly*)arg;
+    for (int i=0; i < job.numTimes; ++i) {
+        job.contacts.clear();
+        job.algorithm->processObjects(ContactSurfaceIndex(0), *job.mesh1, 
+                                      job.X_GM1, ContactSurfaceIndex(1), 
+                                      *job.mesh2, job.X_GM2, job.contacts);
+    }
+    return 0;
+}
+
+// Two user threads using the same algorithm object at once share its 
+// executor; whichever finds it busy must work serially.
+void testConcurrentTriangleMeshes() {
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 5);
+    ContactGeometry::TriangleMesh mesh1(sphere), mesh2(sphere);
+    const Transform X_GM1(Rotation(0.3, XAxis), Vec3(0.1, 0.2, 0.3));
+    const Transform X_GM2(Rotation(1.1, YAxis), Vec3(1.3, 0.5, 0.2));
+
+    CollisionDetectionAlgorithm::TriangleMeshTriangleMesh serial, parallel;
+    Array_<Contact> serialContacts;
+    serial.processObjects(ContactSurfaceIndex(0), mesh1, X_GM1,
+                          ContactSurfaceIndex(1), mesh2, X_GM2, 
+                          serialContacts);
+    const TriangleMeshContact& c = 
+        TriangleMeshContact::getAs(serialContacts[0]);
+
+    parallel.setUseParallel(true, 4);
+    ProcessRepeatedly jobs[2];
+    pthread_t threads[2];
+    for (int k=0; k < 2; ++k) {
+        jobs[k].algorithm = &parallel;
+        jobs[k].mesh1 = &mesh1; jobs[k].mesh2 = &mesh2;
+        jobs[k].X_GM1 = X_GM1;  jobs[k].X_GM2 = X_GM2;
+        jobs[k].numTimes = 20;
+        ASSERT(pthread_create(&threads[k], NULL, processRepeatedly, 
+                              &jobs[k]) == 0);
+    }
+    for (int k=0; k < 2; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k=0; k < 2; ++k) {
+        ASSERT(jobs[k].contacts.size() == 1);
+        const TriangleMeshContact& p = 
+            TriangleMeshContact::getAs(jobs[k].contacts[0]);
+        ASSERT(p.getSurface1Faces() == c.getSurface1Faces());
+        ASSERT(p.getSurface2Faces() == c.getSurface2Faces());
+    }
+}
+
 int main() {
     try {
         testHalfSpaceSphere();
@@ -541,6 +728,9 @@ int main() {
         testHalfSpaceTriangleMesh();
         testSphereTriangleMesh();
         testTriangleMeshTriangleMesh();
+        testDenseTriangleMeshes();
+        testParallelTriangleMeshes();
+        testConcurrentTriangleMeshes();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -0,0 +1,280 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that parallel contact force evaluation in a CompliantContactSubsystem
+ * matches serial evaluation, and that force generator timing is counted.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <pthread.h>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+static const int NumSpheres    = 60;
+static const int NumEllipsoids = 20;
+static const int NumBricks     = 2;
+
+static const ContactMaterial material(1e6,  // stiffness
+                                      .5,   // dissipation
+                                      .9,   // mu_static
+                                      .8,   // mu_dynamic
+                                      .1);  // mu_viscous
+
+// A grid of free bodies resting slightly into a ground half space; there is
+// one contact per body: spheres (Hertz circular), ellipsoids (Hertz
+// elliptical) and meshed bricks (elastic foundation).
+static void buildModel(SimbodyMatterSubsystem& matter) {
+    const Real r = .1;
+    matter.Ground().updBody().addContactSurface(
+        Transform(Rotation(-Pi/2, ZAxis)), // half space normal is +y
+        ContactSurface(ContactGeometry::HalfSpace(), material));
+
+    const int nBodies = NumSpheres + NumEllipsoids + NumBricks;
+    for (int i=0; i < nBodies; ++i) {
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.01)));
+        if (i < NumSpheres)
+            body.addContactSurface(Transform(),
+                ContactSurface(ContactGeometry::Sphere(r), material));
+        else if (i < NumSpheres + NumEllipsoids)
+            body.addContactSurface(Transform(),
+                ContactSurface(ContactGeometry::Ellipsoid(Vec3(.7*r,r,.5*r)),
+                               material));
+        else
+            body.addContactSurface(Transform(),
+                ContactSurface(ContactGeometry::TriangleMesh
+                    (PolygonalMesh::createBrickMesh(Vec3(r), 3)),
+                    material, .01));
+        MobilizedBody::Free(matter.Ground(),
+                            Vec3(3*r*(i%10), 0, 3*r*(i/10)), body, Vec3(0));
+    }
+}
+
+// Put each body slightly into the ground and give everything some velocity.
+static State makeState(const MultibodySystem& system) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(42);
+    for (MobilizedBodyIndex bx(1); bx < matter.getNumBodies(); ++bx) {
+        const MobilizedBody& body = matter.getMobilizedBody(bx);
+        const Real height = .1 - .005*(1 + random.getValue()); // r=.1
+        body.setQToFitTranslation(state, Vec3(0, height, 0));
+        body.setUToFitVelocity(state,
+            SpatialVec(Vec3(random.getValue(), random.getValue(),
+                            random.getValue()),
+                       Vec3(random.getValue(), .1*random.getValue(),
+                            random.getValue())));
+    }
+    return state;
+}
+
+// ContactIds are handed out as contacts are first seen so they differ between
+// States that were realized separately; compare everything else.
+static bool exactlyEqual(const ContactForce& a, const ContactForce& b) {
+    return a.getContactPoint() == b.getContactPoint()
+        && a.getForceOnSurface2() == b.getForceOnSurface2()
+        && a.getPotentialEnergy() == b.getPotentialEnergy()
+        && a.getPowerDissipation() == b.getPowerDissipation();
+}
+
+void testParallelFlags() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contact(system, tracker);
+
+    SimTK_TEST(!contact.getUseParallelContactForces());
+    contact.setUseParallelContactForces(true, 3);
+    SimTK_TEST(contact.getUseParallelContactForces());
+    contact.setUseParallelContactForces(true, 1); // one thread means serial
+    SimTK_TEST(!contact.getUseParallelContactForces());
+    SimTK_TEST_MUST_THROW(contact.setUseParallelContactForces(true, 0));
+
+    SimTK_TEST(!contact.getTrackForceGeneratorTiming());
+    contact.setTrackForceGeneratorTiming(true);
+    SimTK_TEST(contact.getTrackForceGeneratorTiming());
+    SimTK_TEST(contact.getNumForceGeneratorCalls
+                            (CircularPointContact::classTypeId()) == 0);
+    SimTK_TEST(contact.getForceGeneratorTime
+                            (CircularPointContact::classTypeId()) == 0);
+}
+
+void testParallelMatchesSerial() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contact(system, tracker);
+    buildModel(matter);
+    const State state = makeState(system);
+
+    State serial = state;
+    system.realize(serial, Stage::Acceleration);
+    const int nForces = contact.getNumContactForces(serial);
+    SimTK_TEST(nForces == NumSpheres + NumEllipsoids + NumBricks);
+
+    // Use more threads than this machine might have so that work really is
+    // handed off to workers.
+    contact.setUseParallelContactForces(true, 4);
+    State parallel = state;
+    system.realize(parallel, Stage::Acceleration);
+
+    // Each contact force is calculated exactly as it would be serially.
+    SimTK_TEST(contact.getNumContactForces(parallel) == nForces);
+    for (int i=0; i < nForces; ++i)
+        SimTK_TEST(exactlyEqual(contact.getContactForce(serial, i),
+                                contact.getContactForce(parallel, i)));
+
+    const Vector_<SpatialVec>& serialF =
+        system.getRigidBodyForces(serial, Stage::Dynamics);
+    const Vector_<SpatialVec>& parallelF =
+        system.getRigidBodyForces(parallel, Stage::Dynamics);
+    SimTK_TEST_EQ_TOL(serialF, parallelF, 1e-12);
+    SimTK_TEST_EQ_TOL(serial.getUDot(), parallel.getUDot(), 1e-10);
+
+    // Parallel evaluation must be repeatable.
+    State again = state;
+    system.realize(again, Stage::Acceleration);
+    const Vector_<SpatialVec>& againF =
+        system.getRigidBodyForces(again, Stage::Dynamics);
+    for (int i=0; i < againF.size(); ++i)
+        SimTK_TEST(againF[i] == parallelF[i]);
+
+    // At Position stage the energy is calculated separately at zero
+    // velocity; it is summed in contact order either way.
+    State serialPos = state, parallelPos = state;
+    system.realize(parallelPos, Stage::Position);
+    const Real parallelPE = system.calcPotentialEnergy(parallelPos);
+    contact.setUseParallelContactForces(false);
+    system.realize(serialPos, Stage::Position);
+    SimTK_TEST(system.calcPotentialEnergy(serialPos) == parallelPE);
+    SimTK_TEST(parallelPE > 0);
+}
+
+// Realizes one State over and over from its own user thread, invalidating
+// Dynamics stage each time so that the contact forces are calculated again.
+struct RealizeRepeatedly {
+    const MultibodySystem*  system;
+    State*                  state;
+    int                     numTimes;
+};
+
+static void* realizeRepeatedly(void* arg) {
+    const RealizeRepeatedly& job = *(const RealizeRepeatedly*)arg;
+    for (int i=0; i < job.numTimes; ++i) {
+        job.state->invalidateAll(Stage::Dynamics);
+        job.system->realize(*job.state, Stage::Acceleration);
+    }
+    return 0;
+}
+
+// Two user threads realizing different States at once share the one 
+// executor; whichever finds it busy must calculate its forces serially.
+void testConcurrentRealizations() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contact(system, tracker);
+    buildModel(matter);
+
+    State states[2] = {makeState(system), makeState(system)};
+    states[1].updU() *= -1;
+    Vector serialUDot[2];
+    for (int k=0; k < 2; ++k) {
+        system.realize(states[k], Stage::Acceleration);
+        serialUDot[k] = states[k].getUDot();
+    }
+
+    contact.setUseParallelContactForces(true, 4);
+    RealizeRepeatedly jobs[2];
+    pthread_t threads[2];
+    for (int k=0; k < 2; ++k) {
+        jobs[k].system = &system; jobs[k].state = &states[k]; 
+        jobs[k].numTimes = 100;
+        SimTK_TEST(pthread_create(&threads[k], NULL, realizeRepeatedly, 
+                                  &jobs[k]) == 0);
+    }
+    for (int k=0; k < 2; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k=0; k < 2; ++k)
+        SimTK_TEST_EQ_TOL(serialUDot[k], states[k].getUDot(), 1e-10);
+}
+
+void testGeneratorTiming() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contact(system, tracker);
+    buildModel(matter);
+    const State state = makeState(system);
+
+    const ContactTypeId circular   = CircularPointContact::classTypeId();
+    const ContactTypeId elliptical = EllipticalPointContact::classTypeId();
+    const ContactTypeId mesh       = TriangleMeshContact::classTypeId();
+
+    // Nothing is counted unless timing is on.
+    State s = state;
+    system.realize(s, Stage::Dynamics);
+    SimTK_TEST(contact.getNumForceGeneratorCalls(circular) == 0);
+
+    contact.setTrackForceGeneratorTiming(true);
+    for (int pass=0; pass < 2; ++pass) {
+        if (pass == 1) contact.setUseParallelContactForces(true, 4);
+        contact.resetStats();
+        s = state;
+        system.realize(s, Stage::Dynamics);
+        SimTK_TEST(contact.getNumForceGeneratorCalls(circular) == NumSpheres);
+        SimTK_TEST(contact.getNumForceGeneratorCalls(elliptical)
+                   == NumEllipsoids);
+        SimTK_TEST(contact.getNumForceGeneratorCalls(mesh) == NumBricks);
+        SimTK_TEST(contact.getForceGeneratorTime(circular) > 0);
+        SimTK_TEST(contact.getForceGeneratorTime(mesh) > 0);
+        cout << "pass " << pass << ": circular "
+             << contact.getForceGeneratorTime(circular) << "s elliptical "
+             << contact.getForceGeneratorTime(elliptical) << "s mesh "
+             << contact.getForceGeneratorTime(mesh) << "s\n";
+
+        // Totals accumulate until reset.
+        s = state;
+        system.realize(s, Stage::Dynamics);
+        SimTK_TEST(contact.getNumForceGeneratorCalls(circular)
+                   == 2*NumSpheres);
+    }
+
+    contact.resetStats();
+    SimTK_TEST(contact.getNumForceGeneratorCalls(circular) == 0);
+    SimTK_TEST(contact.getForceGeneratorTime(mesh) == 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestCompliantContactSubsystem");
+        SimTK_SUBTEST(testParallelFlags);
+        SimTK_SUBTEST(testParallelMatchesSerial);
+        SimTK_SUBTEST(testConcurrentRealizations);
+        SimTK_SUBTEST(testGeneratorTiming);
+    SimTK_END_TEST();
+}
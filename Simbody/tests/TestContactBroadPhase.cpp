@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+/**@file
+ * Test that the ContactTrackerSubsystem broad phase finds exactly the 
+ * touching surface pairs, including for arrangements that defeat a 
+ * single-axis sweep and as the surfaces move around.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <set>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+typedef std::set< std::pair<int,int> > PairSet;
+
+static const ContactMaterial material(1e6, 0, 0, 0, 0);
+
+// Ground has a half space whose surface is the y=0 plane; there is one free
+// sphere per body. Returns the sphere radii by surface index.
+static Array_<Real> buildSpheres(SimbodyMatterSubsystem& matter, int n) {
+    Array_<Real> radii;
+    matter.Ground().updBody().addContactSurface
+       (Transform(Rotation(-Pi/2, ZAxis)),
+        ContactSurface(ContactGeometry::HalfSpace(), material));
+    radii.push_back(Infinity);
+    for (int i=0; i < n; ++i) {
+        const Real r = .05 + .05*(i%3);
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        body.addContactSurface(Transform(), 
+            ContactSurface(ContactGeometry::Sphere(r), material));
+        MobilizedBody::Free(matter.Ground(), Transform(), body, Transform());
+        radii.push_back(r);
+    }
+    return radii;
+}
+
+static PairSet findActivePairs(const ContactTrackerSubsystem& tracker,
+                               const State& state) {
+    PairSet pairs;
+    const ContactSnapshot& active = tracker.getActiveContacts(state);
+    for (int i=0; i < active.getNumContacts(); ++i) {
+        int s1 = active.getContact(i).getSurface1(),
+            s2 = active.getContact(i).getSurface2();
+        if (s1 > s2) std::swap(s1,s2);
+        pairs.insert(std::make_pair(s1,s2));
+    }
+    return pairs;
+}
+
+// Check every pair of surfaces; surface i+1 is on body i+1.
+static PairSet findTouchingPairs(const SimbodyMatterSubsystem& matter,
+                                 const Array_<Real>& radii,
+                                 const State& state) {
+    PairSet pairs;
+    for (int i=1; i < (int)radii.size(); ++i) {
+        const Vec3 pi = matter.getMobilizedBody(MobilizedBodyIndex(i))
+                              .getBodyOriginLocation(state);
+        if (pi[1] < radii[i]) pairs.insert(std::make_pair(0,i));
+        for (int j=i+1; j < (int)radii.size(); ++j) {
+            const Vec3 pj = matter.getMobilizedBody(MobilizedBodyIndex(j))
+                                  .getBodyOriginLocation(state);
+            if ((pi-pj).norm() < radii[i]+radii[j])
+                pairs.insert(std::make_pair(i,j));
+        }
+    }
+    return pairs;
+}
+
+void testBroadPhase() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    ContactTrackerSubsystem tracker(system);
+    const int n = 300;
+    const Array_<Real> radii = buildSpheres(matter, n);
+
+    State state = system.realizeTopology();
+    SimTK_TEST(tracker.getNumSurfaces() == n+1);
+    Random::Uniform random(0,1); random.setSeed(99);
+
+    // Spheres strung out along x, all overlapping in y and z.
+    for (int i=1; i <= n; ++i)
+        matter.getMobilizedBody(MobilizedBodyIndex(i)).setQToFitTranslation
+           (state, Vec3(.08*i, .2*random.getValue(), .01*random.getValue()));
+    system.realize(state, Stage::Dynamics);
+    PairSet expected = findTouchingPairs(matter, radii, state);
+    SimTK_TEST(expected.size() > (unsigned)n);
+    SimTK_TEST(findActivePairs(tracker, state) == expected);
+
+    // Now scatter them in a box and let them drift, so that some leave 
+    // their place in the tree and others don't.
+    for (int i=1; i <= n; ++i)
+        matter.getMobilizedBody(MobilizedBodyIndex(i)).setQToFitTranslation
+           (state, 3*Vec3(random.getValue(), .2*random.getValue(), 
+                          random.getValue()));
+    for (int pass=0; pass < 5; ++pass) {
+        system.realize(state, Stage::Dynamics);
+        expected = findTouchingPairs(matter, radii, state);
+        SimTK_TEST(!expected.empty());
+        SimTK_TEST(findActivePairs(tracker, state) == expected);
+
+        // A copy of the State has its own tree.
+        State copy = state;
+        for (int i=1; i <= n; i += 7) {
+            const MobilizedBody& mobod = 
+                matter.getMobilizedBody(MobilizedBodyIndex(i));
+            mobod.setQToFitTranslation(copy, Vec3(.5, .12, .01*i));
+        }
+        system.realize(copy, Stage::Dynamics);
+        SimTK_TEST(findActivePairs(tracker, copy) 
+                   == findTouchingPairs(matter, radii, copy));
+
+        for (int i=1; i <= n; ++i) {
+            const MobilizedBody& mobod = 
+                matter.getMobilizedBody(MobilizedBodyIndex(i));
+            const Real step = i%2 ? .002 : .2;
+            mobod.setQToFitTranslation(state, mobod.getBodyOriginLocation(state)
+                + step*Vec3(random.getValue()-.5, random.getValue()-.5,
+                            random.getValue()-.5));
+        }
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestContactBroadPhase");
+        SimTK_SUBTEST(testBroadPhase);
+    SimTK_END_TEST();
+}
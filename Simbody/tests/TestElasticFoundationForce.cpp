@@ -23,6 +23,8 @@
 
 #include "SimTKsimbody.h"
 
+#include <pthread.h>
+
 using namespace SimTK;
 using namespace std;
 
@@ -130,9 +132,112 @@ void testForces() {
     }
 }
 
+// Evaluating the springs of a large contact patch on multiple threads must
+// give exactly the same forces and energy as doing it serially.
+void testParallelSprings() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem forces(system);
+
+    // A sphere mesh with 8192 faces, about a quarter of which are below 
+    // the ground plane.
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    MobilizedBody::Free mesh(matter.updGround(), Transform(), body, Transform());
+    contacts.addBody(setIndex, mesh, ContactGeometry::TriangleMesh(PolygonalMesh::createSphereMesh(1, 5)), Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(), Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    ef.setBodyParameters(ContactSurfaceIndex(0), 1e6, 0.01, 0.1, 0.05, 0.01);
+    ASSERT(!ef.getUseParallelSprings());
+    State state = system.realizeTopology();
+    mesh.setQToFitTransform(state, Transform(Rotation(0.3, UnitVec3(1,1,1)), Vec3(0.1, 0.5, 0)));
+    mesh.setUToFitVelocity(state, SpatialVec(Vec3(0.1, 0.2, 0.3), Vec3(0.5, -0.2, 0.1)));
+
+    system.realize(state, Stage::Dynamics);
+    const Vector_<SpatialVec> serialForces = system.getRigidBodyForces(state, Stage::Dynamics);
+    const Real serialEnergy = system.calcPotentialEnergy(state);
+    ASSERT(serialForces[mesh.getMobilizedBodyIndex()][1][1] > 0);
+
+    ef.setUseParallelSprings(true, 3);
+    ASSERT(ef.getUseParallelSprings());
+    state.invalidateAllCacheAtOrAbove(Stage::Dynamics);
+    system.realize(state, Stage::Dynamics);
+    const Vector_<SpatialVec>& parallelForces = system.getRigidBodyForces(state, Stage::Dynamics);
+    for (int i = 0; i < matter.getNumBodies(); ++i)
+        ASSERT(parallelForces[i] == serialForces[i]);
+    ASSERT(system.calcPotentialEnergy(state) == serialEnergy);
+
+    ef.setUseParallelSprings(false);
+    ASSERT(!ef.getUseParallelSprings());
+}
+
+// Realizes one State over and over from its own user thread.
+struct RealizeRepeatedly {
+    const MultibodySystem*  system;
+    State*                  state;
+    int                     numTimes;
+};
+
+static void* realizeRepeatedly(void* arg) {
+    const RealizeRepeatedly& job = *(const RealizeRepeatedly*)arg;
+    for (int i = 0; i < job.numTimes; ++i) {
+        job.state->invalidateAllCacheAtOrAbove(Stage::Dynamics);
+        job.system->realize(*job.state, Stage::Dynamics);
+    }
+    return 0;
+}
+
+// Two user threads realizing different States at once share the one 
+// executor; whichever finds it busy must evaluate its springs serially, which
+// gives the same results.
+void testConcurrentSprings() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem forces(system);
+
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    MobilizedBody::Free mesh(matter.updGround(), Transform(), body, Transform());
+    contacts.addBody(setIndex, mesh, ContactGeometry::TriangleMesh(PolygonalMesh::createSphereMesh(1, 5)), Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(), Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    ef.setBodyParameters(ContactSurfaceIndex(0), 1e6, 0.01, 0.1, 0.05, 0.01);
+    State state = system.realizeTopology();
+
+    State states[2] = {state, state};
+    Vector_<SpatialVec> serialForces[2];
+    for (int k = 0; k < 2; ++k) {
+        mesh.setQToFitTransform(states[k], Transform(Rotation(0.3*(k+1), UnitVec3(1,1,1)), Vec3(0.1, 0.5, 0)));
+        mesh.setUToFitVelocity(states[k], SpatialVec(Vec3(0.1, 0.2, 0.3), Vec3(0.5, -0.2, 0.1)));
+        system.realize(states[k], Stage::Dynamics);
+        serialForces[k] = system.getRigidBodyForces(states[k], Stage::Dynamics);
+    }
+
+    ef.setUseParallelSprings(true, 4);
+    RealizeRepeatedly jobs[2];
+    pthread_t threads[2];
+    for (int k = 0; k < 2; ++k) {
+        jobs[k].system = &system; jobs[k].state = &states[k];
+        jobs[k].numTimes = 20;
+        ASSERT(pthread_create(&threads[k], NULL, realizeRepeatedly, &jobs[k]) == 0);
+    }
+    for (int k = 0; k < 2; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k = 0; k < 2; ++k) {
+        const Vector_<SpatialVec>& parallelForces = system.getRigidBodyForces(states[k], Stage::Dynamics);
+        for (int i = 0; i < matter.getNumBodies(); ++i)
+            ASSERT(parallelForces[i] == serialForces[k][i]);
+    }
+}
+
 int main() {
     try {
         testForces();
+        testParallelSprings();
+        testConcurrentSprings();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -0,0 +1,129 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+using namespace std;
+
+// Check that event localization in the explicit integrators finds the same
+// event times whether a witness function is evaluated at Position or at 
+// Acceleration stage, but that a Position-stage witness function is 
+// root-found on the interpolant without realizing the interpolated states 
+// through Acceleration stage.
+
+// Record the times at which a mobility coordinate crosses a given value.
+class CrossingRecorder : public TriggeredEventHandler {
+public:
+    CrossingRecorder(const MobilizedBody& mobod, Real value, Stage stage)
+    :   TriggeredEventHandler(stage), mobod(mobod), value(value) {}
+
+    Real getValue(const State& state) const {
+        return mobod.getOneQ(state, 0) - value;
+    }
+
+    void handleEvent(State& state, Real accuracy, 
+                     bool& shouldTerminate) const {
+        times.push_back(state.getTime());
+    }
+
+    const Array_<Real>& getTimes() const {return times;}
+private:
+    const MobilizedBody mobod;
+    const Real          value;
+    mutable Array_<Real> times;
+};
+
+// An undamped harmonic oscillator x = x0 cos(w t) on a slider.
+class Oscillator {
+public:
+    Oscillator(Real k, Real x0, Stage witnessStage) 
+    :   matter(system), forces(system) {
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        MobilizedBody::Slider block(matter.Ground(), body);
+        Force::MobilityLinearSpring(forces, block, MobilizerQIndex(0), k, 0);
+        recorder = new CrossingRecorder(block, x0/2, witnessStage);
+        system.addEventHandler(recorder); // takes ownership
+        state = system.realizeTopology();
+        block.setOneQ(state, 0, x0);
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    CrossingRecorder*       recorder;
+    State                   state;
+};
+
+static void simulate(Integrator& integ, const Oscillator& osc, Real tFinal) {
+    integ.setAccuracy(1e-6);
+    TimeStepper ts(osc.system, integ);
+    ts.initialize(osc.state);
+    ts.stepTo(tFinal);
+}
+
+template <class IntegratorType>
+void testWitnessStage(const char* name) {
+    const Real k = 100, w = std::sqrt(k), x0 = 0.1, tFinal = 3;
+
+    Oscillator atPosition(k, x0, Stage::Position);
+    IntegratorType posInteg(atPosition.system);
+    simulate(posInteg, atPosition, tFinal);
+
+    Oscillator atAcceleration(k, x0, Stage::Acceleration);
+    IntegratorType accInteg(atAcceleration.system);
+    simulate(accInteg, atAcceleration, tFinal);
+
+    // x = x0/2 when w t = +/- pi/3 + 2 pi n.
+    const Array_<Real>& posTimes = atPosition.recorder->getTimes();
+    const Array_<Real>& accTimes = atAcceleration.recorder->getTimes();
+    SimTK_TEST(posTimes.size() == 9);
+    SimTK_TEST(accTimes.size() == posTimes.size());
+    for (unsigned i=0; i < posTimes.size(); ++i) {
+        const int n = (i+1)/2;
+        const Real tExact = ((i%2 ? -1 : 1)*Pi/3 + 2*Pi*n)/w;
+        SimTK_TEST_EQ_TOL(posTimes[i], tExact, 1e-4);
+        SimTK_TEST_EQ_TOL(posTimes[i], accTimes[i], 1e-8);
+    }
+
+    cout << "  " << name << ": " << posInteg.getNumRealizations() 
+         << " realizations with Position-stage witness, " 
+         << accInteg.getNumRealizations() << " with Acceleration-stage\n";
+    SimTK_TEST(posInteg.getNumStepsTaken() == accInteg.getNumStepsTaken());
+    SimTK_TEST(posInteg.getNumRealizations() < accInteg.getNumRealizations());
+}
+
+void testRungeKutta3()      
+{   testWitnessStage<RungeKutta3Integrator>("RungeKutta3"); }
+void testRungeKuttaMerson() 
+{   testWitnessStage<RungeKuttaMersonIntegrator>("RungeKuttaMerson"); }
+void testRungeKuttaFeldberg() 
+{   testWitnessStage<RungeKuttaFeldbergIntegrator>("RungeKuttaFeldberg"); }
+
+int main() {
+    SimTK_START_TEST("TestEventLocalization");
+        SimTK_SUBTEST(testRungeKutta3);
+        SimTK_SUBTEST(testRungeKuttaMerson);
+        SimTK_SUBTEST(testRungeKuttaFeldberg);
+    SimTK_END_TEST();
+}
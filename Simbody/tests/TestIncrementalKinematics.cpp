@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that incremental position kinematics recalculates only the bodies
+ * whose q's changed (and their descendants), with exactly the same results
+ * as a full recalculation.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// A free-floating palm with a few fingers made of ball and pin joints.
+// Returns the last segment of the first finger.
+static MobilizedBody buildHand(SimbodyMatterSubsystem& matter, const Vec3& loc,
+                               int nFingers, int nSegments)
+{
+    const Body::Rigid palm(MassProperties(1, Vec3(0),
+                                          UnitInertia::brick(.5,.1,.3)));
+    const Body::Rigid segment(MassProperties(.1, Vec3(0,-.05,0),
+                                             UnitInertia::cylinderAlongY(.01,.05)));
+    MobilizedBody::Free hand(matter.Ground(), loc, palm, Vec3(0));
+    MobilizedBody tip;
+    for (int f=0; f < nFingers; ++f) {
+        MobilizedBody parent = hand;
+        for (int s=0; s < nSegments; ++s) {
+            const Vec3 inb = s==0 ? Vec3(-.25+.5*f/nFingers, -.1, 0)
+                                  : Vec3(0,-.1,0);
+            if ((f+s) % 2) parent = MobilizedBody::Ball(parent, inb,
+                                                        segment, Vec3(0));
+            else           parent = MobilizedBody::Pin(parent, inb,
+                                                       segment, Vec3(0));
+        }
+        if (f == 0) tip = parent;
+    }
+    return tip;
+}
+
+// Incremental results must match a full recalculation bit for bit.
+static void compareWithFull(const MultibodySystem&   system,
+                            SimbodyMatterSubsystem&  matter,
+                            const State&             incremental)
+{
+    matter.setUseIncrementalPositionKinematics(false);
+    State full = incremental;
+    full.invalidateAll(Stage::Position);
+    system.realize(full, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(full)
+               == matter.getNumBodies()-1);
+
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+        SimTK_TEST(mobod.getBodyTransform(incremental).p()
+                   == mobod.getBodyTransform(full).p());
+        SimTK_TEST(mobod.getBodyTransform(incremental).R()
+                   == mobod.getBodyTransform(full).R());
+    }
+    SimTK_TEST(matter.calcSystemMassCenterLocationInGround(incremental)
+               == matter.calcSystemMassCenterLocationInGround(full));
+    for (int i=0; i < full.getNQErr(); ++i)
+        SimTK_TEST(incremental.getQErr()[i] == full.getQErr()[i]);
+    matter.setUseIncrementalPositionKinematics(true);
+}
+
+void testIncrementalMatchesFull() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    const int nFingers=4, nSegments=3;
+    const MobilizedBody tip = buildHand(matter, Vec3(0), nFingers, nSegments);
+    const MobilizedBody otherTip = buildHand(matter, Vec3(2,0,0),
+                                             nFingers, nSegments);
+    const MobilizedBody firstFinger = tip.getParentMobilizedBody()
+                                         .getParentMobilizedBody();
+    const MobilizedBody palm = firstFinger.getParentMobilizedBody();
+    const MobilizedBody otherPalm = otherTip.getParentMobilizedBody()
+        .getParentMobilizedBody().getParentMobilizedBody();
+    const int nBodiesPerHand = 1 + nFingers*nSegments;
+
+    SimTK_TEST(!matter.getUseIncrementalPositionKinematics());
+    matter.setUseIncrementalPositionKinematics(true);
+    SimTK_TEST(matter.getUseIncrementalPositionKinematics());
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(11);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+
+    // First time everything must be calculated.
+    system.realize(state, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(state)
+               == matter.getNumBodies()-1);
+    compareWithFull(system, matter, state);
+
+    // Nothing changed.
+    state.invalidateAll(Stage::Position);
+    system.realize(state, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(state) == 0);
+
+    // Change only the tip of one finger.
+    tip.setOneQ(state, 0, tip.getOneQ(state, 0) + .1);
+    system.realize(state, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(state) == 1);
+    compareWithFull(system, matter, state);
+
+    // Change the base of a finger; the whole finger moves.
+    firstFinger.setOneQ(state, 0, firstFinger.getOneQ(state, 0) - .2);
+    system.realize(state, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(state)
+               == nSegments);
+    compareWithFull(system, matter, state);
+
+    // Changes made to a copy of the State affect only the copy, and the copy
+    // can still be updated incrementally.
+    State copy = state;
+    palm.setQToFitTranslation(copy, Vec3(.3,.2,.1));
+    otherPalm.setQToFitRotation(copy, Rotation(.5, YAxis));
+    system.realize(copy, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(copy)
+               == 2*nBodiesPerHand);
+    compareWithFull(system, matter, copy);
+    SimTK_TEST(palm.getBodyOriginLocation(state)
+               != palm.getBodyOriginLocation(copy));
+
+    // Change a Model-stage variable; everything is recalculated.
+    matter.setUseEulerAngles(state, true);
+    system.realizeModel(state);
+    system.realize(state, Stage::Position);
+    SimTK_TEST(matter.getNumPositionKinematicsRecalculations(state)
+               == matter.getNumBodies()-1);
+    compareWithFull(system, matter, state);
+}
+
+int main() {
+    SimTK_START_TEST("TestIncrementalKinematics");
+        SimTK_SUBTEST(testIncrementalMatchesFull);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,126 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the explicit integrators don't touch the heap once they are
+// running a multibody system. This is TestIntegratorAllocations from
+// SimTKmath applied to a chain of bodies with gravity, a spring and a
+// damper, so that the per-step work done by Simbody is checked too. Systems
+// with constraints are not covered; assembling and factoring the constraint
+// matrices still allocates.
+
+#include "SimTKsimbody.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace SimTK;
+
+static long long numAllocations = 0;
+
+void* operator new(std::size_t sz) {
+    ++numAllocations;
+    void* p = std::malloc(sz ? sz : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t sz) {return operator new(sz);}
+void operator delete(void* p) throw() {std::free(p);}
+void operator delete[](void* p) throw() {std::free(p);}
+void operator delete(void* p, std::size_t) throw() {std::free(p);}
+void operator delete[](void* p, std::size_t) throw() {std::free(p);}
+
+// Return true if an allocation made in SimTKcommon is counted.
+static bool libraryAllocationsAreCounted() {
+    const long long before = numAllocations;
+    Vector v(10);
+    return numAllocations > before;
+}
+
+// Take numSteps internal steps and return the number of heap allocations
+// that occurred while doing so.
+static long long countAllocationsPerSteps(Integrator& integ, int numSteps) {
+    const long long before = numAllocations;
+    for (int i=0; i < numSteps; ++i)
+        integ.stepTo(100);
+    return numAllocations - before;
+}
+
+template <class INTEG>
+void testNoAllocations() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < 5; ++i)
+        parent = MobilizedBody::Pin(parent, Transform(Vec3(0,-1,0)),
+                                    body, Transform());
+    MobilizedBody::Ball ball(parent, Transform(Vec3(0,-1,0)),
+                             body, Transform());
+    Force::MobilityLinearSpring(forces, ball, 0, 10, 0);
+    Force::MobilityLinearDamper(forces,
+        matter.getMobilizedBody(MobilizedBodyIndex(1)), 0, 1);
+
+    State state = system.realizeTopology();
+    matter.getMobilizedBody(MobilizedBodyIndex(1)).setOneQ(state, 0, .5);
+    ball.setQToFitRotation(state, Rotation(.3, XAxis));
+
+    INTEG integ(system);
+    integ.setAccuracy(1e-6);
+    integ.setReturnEveryInternalStep(true);
+    integ.initialize(state);
+
+    countAllocationsPerSteps(integ, 50); // warm up; workspace gets sized here
+    SimTK_TEST(countAllocationsPerSteps(integ, 100) == 0);
+    SimTK_TEST(integ.getTime() > 0);
+}
+
+void testRungeKutta2()        {testNoAllocations<RungeKutta2Integrator>();}
+void testRungeKutta3()        {testNoAllocations<RungeKutta3Integrator>();}
+void testRungeKuttaMerson()   {testNoAllocations<RungeKuttaMersonIntegrator>();}
+void testRungeKuttaFeldberg() {testNoAllocations<RungeKuttaFeldbergIntegrator>();}
+void testVerlet()             {testNoAllocations<VerletIntegrator>();}
+
+int main() {
+    if (!libraryAllocationsAreCounted()) {
+    #ifdef _WIN32
+        std::cout << "TestMultibodyIntegratorAllocations: library allocations "
+                     "can't be counted here; skipped." << std::endl;
+        return 0;
+    #else
+        std::cout << "TestMultibodyIntegratorAllocations: allocating a Vector "
+                     "was not counted." << std::endl;
+        return 1;
+    #endif
+    }
+
+    SimTK_START_TEST("TestMultibodyIntegratorAllocations");
+        SimTK_SUBTEST(testRungeKutta2);
+        SimTK_SUBTEST(testRungeKutta3);
+        SimTK_SUBTEST(testRungeKuttaMerson);
+        SimTK_SUBTEST(testRungeKuttaFeldberg);
+        SimTK_SUBTEST(testVerlet);
+    SimTK_END_TEST();
+}
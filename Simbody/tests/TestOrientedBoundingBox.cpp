@@ -152,6 +152,22 @@ void testIntersectsBox() {
     Rotation r;
     r.setRotationToBodyFixedXYZ(Vec3(Pi/2, 0, -1.1));;
     verifyBoxIntersection(true, OrientedBoundingBox(Transform(r, Vec3(-0.95, 1.1, 2.5)), Vec3(2e-10, 1.118, 1)), OrientedBoundingBox(Vec3(0, -50, -50), Vec3(100, 100, 100)));
+
+    // These overlapping boxes come from the OBB trees of two sphere meshes.
+    // They have parallel edges, and roundoff in the resulting zero cross 
+    // product axis used to make them appear separated.
+
+    const Rotation r1(Mat33(0.21900668709304177, -0.97572335782665998, -5.4163526876186417e-17, 
+                            0, -5.5511151231257839e-17, 1, 
+                            -0.97572335782665998, -0.21900668709304177, -1.2157313327878597e-17), true);
+    const Rotation r2(Mat33(0.21900668709304177, -0.97572335782665998, -3.7914468813330466e-16, 
+                            0, -3.8857805861880469e-16, 1, 
+                            -0.97572335782665998, -0.21900668709304177, -8.5101193295150172e-17), true);
+    verifyBoxIntersection(true, 
+        OrientedBoundingBox(Transform(r1, Vec3(0.75650568770924453, -1.0000100000000001, 1.1943969377371377)), 
+                            Vec3(1.9994423724690269, 1.9994423724690269, 1.0000199999999999)),
+        OrientedBoundingBox(Transform(r2, Vec3(2.5565056877092447, -0.48963734968684597, 1.1943969377371377)), 
+                            Vec3(1.9994423724690269, 1.9994423724690269, 0.4896422460113804)));
 }
 
 void verifyRayIntersection(const OrientedBoundingBox& box, const Vec3& origin, const UnitVec3& direction, bool shouldIntersect, Real expectedDistance) {
@@ -0,0 +1,215 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that parallel evaluation of force elements in a GeneralForceSubsystem
+ * matches serial evaluation and is repeatable.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <pthread.h>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// A force element that isn't marked thread safe; it counts its calls.
+class CountingTorque : public Force::Custom::Implementation {
+public:
+    CountingTorque(const MobilizedBody& body) : nCalls(0), body(body) {}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
+                   Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+    {   ++nCalls; body.applyBodyTorque(state, Vec3(0,0,.1), bodyForces); }
+    Real calcPotentialEnergy(const State& state) const {return 0;}
+    mutable int nCalls;
+private:
+    MobilizedBody body;
+};
+
+template <class T>
+static bool exactlyEqual(const Vector_<T>& a, const Vector_<T>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (!(a[i] == b[i])) return false;
+    return true;
+}
+
+// A row of free bodies connected to Ground and to each other by a variety of
+// thread-safe force elements.
+static void buildModel(SimbodyMatterSubsystem& matter, 
+                       GeneralForceSubsystem& forces, int nBodies) 
+{
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1)));
+    MobilizedBody prev = matter.Ground();
+    for (int i=0; i < nBodies; ++i) {
+        MobilizedBody::Free b(matter.Ground(), Vec3(i,0,0), body, Vec3(0));
+        Force::TwoPointLinearSpring(forces, prev, Vec3(.1,0,0), 
+                                    b, Vec3(-.1,0,0), 10, .5);
+        Force::TwoPointLinearDamper(forces, prev, Vec3(0), b, Vec3(0), 2);
+        Force::LinearBushing(forces, matter.Ground(), Transform(Vec3(i,0,0)),
+                             b, Transform(),
+                             Vec6(1,2,3,10,20,30), Vec6(.1,.2,.3,1,2,3));
+        Force::MobilityLinearSpring(forces, b, MobilizerQIndex(0), 5, 0);
+        prev = b;
+    }
+    Force::GlobalDamper(forces, matter, .05);
+}
+
+void testThreadSafeFlags() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    MobilizedBody::Pin pin(matter.Ground(), Vec3(0), 
+        Body::Rigid(MassProperties(1,Vec3(0),UnitInertia(1))), Vec3(0));
+
+    Force::MobilityLinearSpring spring(forces, pin, MobilizerQIndex(0), 1, 0);
+    Force::Custom custom(forces, new CountingTorque(pin));
+    SimTK_TEST(spring.isThreadSafe());
+    SimTK_TEST(!custom.isThreadSafe());
+    custom.setIsThreadSafe(true);
+    SimTK_TEST(custom.isThreadSafe());
+
+    SimTK_TEST(!forces.getUseParallelForces());
+    forces.setUseParallelForces(true, 3);
+    SimTK_TEST(forces.getUseParallelForces());
+    forces.setUseParallelForces(true, 1); // one thread means serial
+    SimTK_TEST(!forces.getUseParallelForces());
+    SimTK_TEST_MUST_THROW(forces.setUseParallelForces(true, 0));
+}
+
+void testParallelMatchesSerial() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    buildModel(matter, forces, 20);
+    CountingTorque* counter = new CountingTorque(matter.getMobilizedBody
+                                                 (MobilizedBodyIndex(3)));
+    Force::Custom custom(forces, counter); // serial only
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(99);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] += .1*random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+
+    State serial = state;
+    system.realize(serial, Stage::Acceleration);
+    SimTK_TEST(counter->nCalls == 1);
+
+    // Use more threads than this machine might have so that work really is
+    // handed off to workers.
+    forces.setUseParallelForces(true, 4);
+    State parallel = state;
+    system.realize(parallel, Stage::Acceleration);
+    SimTK_TEST(counter->nCalls == 2);
+
+    const Vector_<SpatialVec>& serialF = 
+        system.getRigidBodyForces(serial, Stage::Dynamics);
+    const Vector_<SpatialVec>& parallelF = 
+        system.getRigidBodyForces(parallel, Stage::Dynamics);
+    SimTK_TEST_EQ_TOL(serialF, parallelF, 1e-12);
+    SimTK_TEST_EQ_TOL(system.getMobilityForces(serial, Stage::Dynamics),
+                      system.getMobilityForces(parallel, Stage::Dynamics), 
+                      1e-12);
+    SimTK_TEST_EQ_TOL(serial.getUDot(), parallel.getUDot(), 1e-10);
+
+    // Parallel evaluation must be repeatable.
+    State again = state;
+    system.realize(again, Stage::Acceleration);
+    SimTK_TEST(exactlyEqual(parallelF, 
+                            system.getRigidBodyForces(again, Stage::Dynamics)));
+    SimTK_TEST(exactlyEqual(parallel.getUDot(), again.getUDot()));
+
+    // Only velocities changed; cached position-only forces must be reused
+    // and the result still match serial evaluation.
+    again.updU() *= 2;
+    serial.updU() *= 2;
+    forces.setUseParallelForces(false);
+    system.realize(serial, Stage::Acceleration);
+    forces.setUseParallelForces(true, 4);
+    system.realize(again, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(serial.getUDot(), again.getUDot(), 1e-10);
+}
+
+// Realizes one State over and over from its own user thread, invalidating
+// Dynamics stage each time so that the forces are evaluated again.
+struct RealizeRepeatedly {
+    const MultibodySystem*  system;
+    State*                  state;
+    int                     numTimes;
+};
+
+static void* realizeRepeatedly(void* arg) {
+    const RealizeRepeatedly& job = *(const RealizeRepeatedly*)arg;
+    for (int i=0; i < job.numTimes; ++i) {
+        job.state->invalidateAll(Stage::Dynamics);
+        job.system->realize(*job.state, Stage::Acceleration);
+    }
+    return 0;
+}
+
+// Two user threads realizing different States at once share the one 
+// executor; whichever finds it busy must evaluate its forces serially.
+void testConcurrentRealizations() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    buildModel(matter, forces, 20);
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(5);
+    State states[2] = {state, state};
+    Vector serialUDot[2];
+    for (int k=0; k < 2; ++k) {
+        for (int i=0; i < state.getNQ(); ++i) 
+            states[k].updQ()[i] += .1*random.getValue();
+        for (int i=0; i < state.getNU(); ++i) 
+            states[k].updU()[i] = random.getValue();
+        system.realize(states[k], Stage::Acceleration);
+        serialUDot[k] = states[k].getUDot();
+    }
+
+    forces.setUseParallelForces(true, 4);
+    RealizeRepeatedly jobs[2];
+    pthread_t threads[2];
+    for (int k=0; k < 2; ++k) {
+        jobs[k].system = &system; jobs[k].state = &states[k]; 
+        jobs[k].numTimes = 200;
+        SimTK_TEST(pthread_create(&threads[k], NULL, realizeRepeatedly, 
+                                  &jobs[k]) == 0);
+    }
+    for (int k=0; k < 2; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k=0; k < 2; ++k)
+        SimTK_TEST_EQ_TOL(serialUDot[k], states[k].getUDot(), 1e-10);
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelForces");
+        SimTK_SUBTEST(testThreadSafeFlags);
+        SimTK_SUBTEST(testParallelMatchesSerial);
+        SimTK_SUBTEST(testConcurrentRealizations);
+    SimTK_END_TEST();
+}
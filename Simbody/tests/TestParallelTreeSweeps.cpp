@@ -0,0 +1,234 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that level-parallel tree sweeps in the matter subsystem produce
+ * exactly the same results as the serial sweeps.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <pthread.h>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// Vectors must match bit for bit, not just to a tolerance.
+template <class T>
+static bool exactlyEqual(const Vector_<T>& a, const Vector_<T>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (!(a[i] == b[i])) return false;
+    return true;
+}
+
+// Build a wide tree: several "hands", each a free-floating palm with a
+// number of fingers made of pin, ball, and universal joints. Each level past
+// the palms has (#hands * #fingers) bodies in it.
+static void buildHands(SimbodyMatterSubsystem& matter, int nHands,
+                       int nFingers, int nSegments)
+{
+    const Body::Rigid palm(MassProperties(1, Vec3(0),
+                                          UnitInertia::brick(.5,.1,.3)));
+    const Body::Rigid segment(MassProperties(.1, Vec3(0,-.05,0),
+                                             UnitInertia::cylinderAlongY(.01,.05)));
+    for (int h=0; h < nHands; ++h) {
+        MobilizedBody::Free hand(matter.Ground(), Vec3(h,0,0),
+                                 palm, Vec3(0));
+        for (int f=0; f < nFingers; ++f) {
+            MobilizedBody parent = hand;
+            for (int s=0; s < nSegments; ++s) {
+                const Vec3 inb = s==0 ? Vec3(-.25+.5*f/nFingers, -.1, 0)
+                                      : Vec3(0,-.1,0);
+                switch ((f+s) % 3) {
+                case 0: parent = MobilizedBody::Pin(parent, inb,
+                                                    segment, Vec3(0)); break;
+                case 1: parent = MobilizedBody::Ball(parent, inb,
+                                                     segment, Vec3(0)); break;
+                case 2: parent = MobilizedBody::Universal(parent, inb,
+                                                          segment, Vec3(0));
+                        break;
+                }
+            }
+        }
+    }
+}
+
+void testParallelMatchesSerial() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+    Force::GlobalDamper     damper(forces, matter, .1);
+
+    buildHands(matter, 6, 5, 3);
+    SimTK_TEST(!matter.getUseParallelTreeSweeps());
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(42);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+
+    Vector f(state.getNU());
+    for (int i=0; i < f.size(); ++i) f[i] = random.getValue();
+
+    // Serial reference results.
+    State serial = state;
+    system.realize(serial, Stage::Acceleration);
+    Vector serialMInvf, serialResid;
+    matter.multiplyByMInv(serial, f, serialMInvf);
+    matter.calcResidualForceIgnoringConstraints(serial, f,
+        Vector_<SpatialVec>(), serial.getUDot(), serialResid);
+
+    // Use more threads than this machine might have so that work really is
+    // handed off to workers.
+    matter.setUseParallelTreeSweeps(true, 4);
+    SimTK_TEST(matter.getUseParallelTreeSweeps());
+
+    State parallel = state;
+    system.realize(parallel, Stage::Acceleration);
+    Vector parallelMInvf, parallelResid;
+    matter.multiplyByMInv(parallel, f, parallelMInvf);
+    matter.calcResidualForceIgnoringConstraints(parallel, f,
+        Vector_<SpatialVec>(), parallel.getUDot(), parallelResid);
+
+    SimTK_TEST(exactlyEqual(serial.getQErr(), parallel.getQErr()));
+    SimTK_TEST(exactlyEqual(serial.getQDot(), parallel.getQDot()));
+    SimTK_TEST(exactlyEqual(serial.getUDot(), parallel.getUDot()));
+    SimTK_TEST(exactlyEqual(serial.getQDotDot(), parallel.getQDotDot()));
+    SimTK_TEST(exactlyEqual(serialMInvf, parallelMInvf));
+    SimTK_TEST(exactlyEqual(serialResid, parallelResid));
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+        SimTK_TEST(mobod.getBodyTransform(serial).p()
+                   == mobod.getBodyTransform(parallel).p());
+        SimTK_TEST(mobod.getBodyVelocity(serial)
+                   == mobod.getBodyVelocity(parallel));
+        SimTK_TEST(mobod.getBodyAcceleration(serial)
+                   == mobod.getBodyAcceleration(parallel));
+    }
+
+    // Switching back must restore serial behavior.
+    matter.setUseParallelTreeSweeps(false);
+    SimTK_TEST(!matter.getUseParallelTreeSweeps());
+    State again = state;
+    system.realize(again, Stage::Acceleration);
+    SimTK_TEST(exactlyEqual(serial.getUDot(), again.getUDot()));
+}
+
+// A parallel simulation should follow the serial trajectory exactly.
+void testParallelSimulation() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+
+    buildHands(matter, 4, 4, 2);
+    State state = system.realizeTopology();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = std::sin(Real(i));
+
+    State serial = state;
+    RungeKuttaMersonIntegrator serialInteg(system);
+    TimeStepper serialTs(system, serialInteg);
+    serialTs.initialize(serial);
+    serialTs.stepTo(0.1);
+
+    matter.setUseParallelTreeSweeps(true, 3);
+    State parallel = state;
+    RungeKuttaMersonIntegrator parallelInteg(system);
+    TimeStepper parallelTs(system, parallelInteg);
+    parallelTs.initialize(parallel);
+    parallelTs.stepTo(0.1);
+
+    SimTK_TEST(serialInteg.getNumStepsTaken()
+               == parallelInteg.getNumStepsTaken());
+    SimTK_TEST(exactlyEqual(serialTs.getState().getY(),
+                            parallelTs.getState().getY()));
+}
+
+// Realizes one State over and over from its own user thread, invalidating
+// Position stage each time so that every sweep is done again.
+struct RealizeRepeatedly {
+    const MultibodySystem*  system;
+    State*                  state;
+    int                     numTimes;
+};
+
+static void* realizeRepeatedly(void* arg) {
+    const RealizeRepeatedly& job = *(const RealizeRepeatedly*)arg;
+    for (int i=0; i < job.numTimes; ++i) {
+        job.state->invalidateAll(Stage::Position);
+        job.system->realize(*job.state, Stage::Acceleration);
+    }
+    return 0;
+}
+
+// Two user threads realizing different States of the same System at once
+// share the one executor; whichever finds it busy must sweep serially, and
+// both must get the serial results.
+void testConcurrentRealizations() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+
+    buildHands(matter, 6, 5, 3);
+    State state = system.realizeTopology();
+    Random::Uniform random(-1,1); random.setSeed(7);
+
+    State states[2] = {state, state};
+    Vector serialUDot[2];
+    for (int k=0; k < 2; ++k) {
+        for (int i=0; i < state.getNQ(); ++i) 
+            states[k].updQ()[i] = random.getValue();
+        for (int i=0; i < state.getNU(); ++i) 
+            states[k].updU()[i] = random.getValue();
+        system.realize(states[k], Stage::Acceleration);
+        serialUDot[k] = states[k].getUDot();
+    }
+
+    matter.setUseParallelTreeSweeps(true, 4);
+    RealizeRepeatedly jobs[2];
+    pthread_t threads[2];
+    for (int k=0; k < 2; ++k) {
+        jobs[k].system = &system; jobs[k].state = &states[k]; 
+        jobs[k].numTimes = 200;
+        SimTK_TEST(pthread_create(&threads[k], NULL, realizeRepeatedly, 
+                                  &jobs[k]) == 0);
+    }
+    for (int k=0; k < 2; ++k)
+        pthread_join(threads[k], NULL);
+
+    for (int k=0; k < 2; ++k)
+        SimTK_TEST(exactlyEqual(serialUDot[k], states[k].getUDot()));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelTreeSweeps");
+        SimTK_SUBTEST(testParallelMatchesSerial);
+        SimTK_SUBTEST(testParallelSimulation);
+        SimTK_SUBTEST(testConcurrentRealizations);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,202 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test reuse of constraint Jacobian factorizations during position and 
+ * velocity projection, and the integrator statistics that report it.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+// A few parallelogram linkages made of two pendulums whose tips are joined
+// by a rod, plus a free body hanging from Ground by a rod.
+static void buildModel(SimbodyMatterSubsystem& matter) {
+    const Body::Rigid link(MassProperties(1, Vec3(0,-.5,0),
+                                          UnitInertia::cylinderAlongY(.05,.5)));
+    for (int i=0; i < 3; ++i) {
+        const Vec3 base(2*i,0,0);
+        MobilizedBody::Pin crank(matter.Ground(), base, link, Vec3(0));
+        MobilizedBody::Pin rocker(matter.Ground(), base+Vec3(1,0,0), 
+                                  link, Vec3(0));
+        Constraint::Rod(crank, Vec3(0,-1,0), rocker, Vec3(0,-1,0), 1);
+    }
+    MobilizedBody::Free ball(matter.Ground(), Vec3(0,0,2),
+        Body::Rigid(MassProperties(1,Vec3(0),UnitInertia(.1))), Vec3(0,1,0));
+    Constraint::Rod(matter.Ground(), Vec3(0,0,2), ball, Vec3(0), 1);
+}
+
+static State assembledState(const MultibodySystem& system) {
+    State state = system.realizeTopology();
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = .1*std::sin(Real(i));
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = std::cos(Real(i));
+    Assembler(system).setAccuracy(1e-10).assemble(state);
+    system.realize(state, Stage::Velocity);
+    system.projectU(state, 1e-10);
+    return state;
+}
+
+// Direct calls: a second projection from nearby should hit the cache, and
+// ForceFullNewton must bypass it.
+void testProjectionReuse() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+    buildModel(matter);
+
+    SimTK_TEST(matter.getProjectionFactorizationReuseLimit() == 0);
+    matter.setProjectionFactorizationReuseLimit(10);
+    SimTK_TEST(matter.getProjectionFactorizationReuseLimit() == 10);
+    SimTK_TEST_MUST_THROW(matter.setProjectionFactorizationReuseLimit(-1));
+
+    const State start = assembledState(system);
+    ProjectOptions options(1e-8);
+    options.setOption(ProjectOptions::ForceProjection);
+    ProjectResults results;
+    Vector noErrEst;
+
+    // The saved factorizations live in the State, so keep projecting the
+    // same one.
+    State state = start;
+    for (int pass=0; pass < 3; ++pass) {
+        state.updQ() += 1e-4;
+        system.realize(state, Stage::Position);
+        system.projectQ(state, noErrEst, options, results);
+        SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+        SimTK_TEST(results.getNormOnExit() <= 1e-8);
+        if (pass == 0) {
+            SimTK_TEST(results.getNumFactorizations() >= 1);
+        } else {
+            SimTK_TEST(results.getNumFactorizationReuses() >= 1);
+        }
+
+        state.updU() += 1e-4;
+        system.realize(state, Stage::Velocity);
+        system.projectU(state, noErrEst, options, results);
+        SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+        SimTK_TEST(results.getNormOnExit() <= 1e-8);
+        if (pass > 0) {
+            SimTK_TEST(results.getNumFactorizationReuses() == 1);
+        }
+    }
+
+    // A copy of the State made earlier has no saved factorization.
+    State other = start;
+    other.updQ() += 1e-4;
+    system.realize(other, Stage::Position);
+    system.projectQ(other, noErrEst, options, results);
+    SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(results.getNumFactorizations() >= 1);
+
+    // A copy made now shares it.
+    other = state;
+    other.updQ() += 1e-4;
+    system.realize(other, Stage::Position);
+    system.projectQ(other, noErrEst, options, results);
+    SimTK_TEST(results.getNumFactorizationReuses() >= 1);
+
+    // Swapping which Constraint is disabled leaves the problem the same size
+    // and weighting, but invalidates Instance stage which must discard the 
+    // saved factorization.
+    const Constraint& c0 = matter.getConstraint(ConstraintIndex(0));
+    const Constraint& c1 = matter.getConstraint(ConstraintIndex(1));
+    ProjectOptions loose(1e-5);
+    loose.setOption(ProjectOptions::ForceProjection);
+    c0.disable(state);
+    for (int pass=0; pass < 2; ++pass) {
+        if (pass == 1) {c0.enable(state); c1.disable(state);}
+        state.updQ() += 1e-4;
+        system.realize(state, Stage::Position);
+        system.projectQ(state, noErrEst, loose, results);
+        SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+        SimTK_TEST(results.getNumFactorizationReuses() == 0);
+    }
+    c1.enable(state);
+
+    options.setOption(ProjectOptions::ForceFullNewton);
+    state = start;
+    state.updQ() += 1e-4;
+    system.realize(state, Stage::Position);
+    system.projectQ(state, noErrEst, options, results);
+    SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+    SimTK_TEST(results.getNumFactorizationReuses() == 0);
+    SimTK_TEST(results.getNumFactorizations() == results.getNumIterations());
+}
+
+// Simulations with and without reuse should agree to within the 
+// integration accuracy, and the integrator should report the reuse.
+void testSimulationWithReuse() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity          gravity(forces, matter, -YAxis, 9.81);
+    buildModel(matter);
+    const State start = assembledState(system);
+
+    RungeKuttaMersonIntegrator fullInteg(system);
+    fullInteg.setAccuracy(1e-6);
+    TimeStepper fullTs(system, fullInteg);
+    fullTs.initialize(start);
+    fullTs.stepTo(1);
+    SimTK_TEST(fullInteg.getNumProjectionFactorizations() > 0);
+    SimTK_TEST(fullInteg.getNumProjectionFactorizationReuses() == 0);
+
+    matter.setProjectionFactorizationReuseLimit(20);
+    RungeKuttaMersonIntegrator reuseInteg(system);
+    reuseInteg.setAccuracy(1e-6);
+    TimeStepper reuseTs(system, reuseInteg);
+    reuseTs.initialize(start);
+    reuseTs.stepTo(1);
+    SimTK_TEST(reuseInteg.getNumProjectionFactorizationReuses() > 0);
+    SimTK_TEST(reuseInteg.getNumProjectionFactorizations() 
+               < fullInteg.getNumProjectionFactorizations());
+
+    cout << "factorizations full=" << fullInteg.getNumProjectionFactorizations()
+         << " reuse=" << reuseInteg.getNumProjectionFactorizations() 
+         << " (reused " << reuseInteg.getNumProjectionFactorizationReuses() 
+         << ")\n";
+
+    const State& fullState = fullTs.getState();
+    const State& reuseState = reuseTs.getState();
+    system.realize(reuseState, Stage::Velocity);
+    SimTK_TEST(reuseState.getQErr().normInf() <= 1e-5);
+    SimTK_TEST(reuseState.getUErr().normInf() <= 1e-5);
+    SimTK_TEST((fullState.getQ()-reuseState.getQ()).normInf() < 1e-3);
+
+    reuseInteg.resetAllStatistics();
+    SimTK_TEST(reuseInteg.getNumProjectionFactorizations() == 0);
+    SimTK_TEST(reuseInteg.getNumProjectionFactorizationReuses() == 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestProjectionFactorizationReuse");
+        SimTK_SUBTEST(testProjectionReuse);
+        SimTK_SUBTEST(testSimulationWithReuse);
+    SimTK_END_TEST();
+}
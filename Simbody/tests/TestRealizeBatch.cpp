@@ -0,0 +1,202 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test System::realizeBatch(), which must give exactly the same results as
+ * realizing each State individually.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+static bool exactlyEqual(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (!(a[i] == b[i])) return false;
+    return true;
+}
+
+// A few chains of pendulums with springs and gravity.
+class Chains : public MultibodySystem {
+public:
+    Chains(int nChains, int nLinks) 
+    :   matter(*this), forces(*this), gravity(forces, matter, -YAxis, 9.81) {
+        const Body::Rigid link(MassProperties(1, Vec3(0,-.5,0), 
+                                              UnitInertia::cylinderAlongY(.1,.5)));
+        for (int c=0; c < nChains; ++c) {
+            MobilizedBody parent = matter.Ground();
+            for (int i=0; i < nLinks; ++i) {
+                MobilizedBody::Ball next(parent, i==0 ? Vec3(c,0,0) : Vec3(0,-1,0),
+                                         link, Vec3(0));
+                Force::MobilityLinearSpring(forces, next, 0, 10, 0);
+                parent = next;
+            }
+        }
+    }
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    Force::Gravity          gravity;
+};
+
+// An exception type that nothing but ThrowLate below throws.
+class LateStateError : public std::exception {
+public:
+    const char* what() const throw() {return "State is too late";}
+};
+
+// A force that can't be calculated for States later than a given time.
+class ThrowLate : public Force::Custom::Implementation {
+public:
+    explicit ThrowLate(Real tLatest) : tLatest(tLatest) {}
+    void calcForce(const State& s, Vector_<SpatialVec>&, Vector_<Vec3>&,
+                   Vector&) const 
+    {   if (s.getTime() > tLatest) throw LateStateError(); }
+    Real calcPotentialEnergy(const State&) const {return 0;}
+private:
+    Real tLatest;
+};
+
+static void makeStates(const Chains& system, int n, Array_<State>& states) {
+    Random::Uniform random(-1,1); random.setSeed(1234);
+    states.resize(n, system.getDefaultState());
+    for (int k=0; k < n; ++k) {
+        State& s = states[k];
+        s.updTime() = k*.01;
+        for (int i=0; i < s.getNQ(); ++i) s.updQ()[i] = random.getValue();
+        for (int i=0; i < s.getNU(); ++i) s.updU()[i] = random.getValue();
+    }
+}
+
+static void testBatch(ParallelExecutor* executor) {
+    Chains system(3, 4);
+    system.realizeTopology();
+
+    Array_<State> reference, batch;
+    makeStates(system, 50, reference);
+    makeStates(system, 50, batch);
+
+    for (int k=0; k < (int)reference.size(); ++k)
+        system.realize(reference[k], Stage::Acceleration);
+
+    // Leave some States partially realized already.
+    for (int k=0; k < (int)batch.size(); k += 3)
+        system.realize(batch[k], Stage::Position);
+
+    Array_<State*> ptrs;
+    for (int k=0; k < (int)batch.size(); ++k)
+        ptrs.push_back(&batch[k]);
+
+    const int nAccBefore = system.getNumRealizationsOfThisStage(Stage::Acceleration);
+    const int nPosBefore = system.getNumRealizationsOfThisStage(Stage::Position);
+    system.realizeBatch(ptrs, Stage::Acceleration, executor);
+    SimTK_TEST(system.getNumRealizationsOfThisStage(Stage::Acceleration)
+               == nAccBefore + (int)batch.size());
+    // Every third State was already at Position stage.
+    SimTK_TEST(system.getNumRealizationsOfThisStage(Stage::Position)
+               == nPosBefore + (int)batch.size() - ((int)batch.size()+2)/3);
+
+    for (int k=0; k < (int)batch.size(); ++k) {
+        SimTK_TEST(batch[k].getSystemStage() == Stage::Acceleration);
+        SimTK_TEST(exactlyEqual(batch[k].getQDot(), reference[k].getQDot()));
+        SimTK_TEST(exactlyEqual(batch[k].getUDot(), reference[k].getUDot()));
+        SimTK_TEST(system.calcPotentialEnergy(batch[k]) 
+                   == system.calcPotentialEnergy(reference[k]));
+    }
+
+    // Realizing again to the same or a lower stage does nothing.
+    system.realizeBatch(ptrs, Stage::Velocity, executor);
+    SimTK_TEST(system.getNumRealizationsOfThisStage(Stage::Acceleration)
+               == nAccBefore + (int)batch.size());
+}
+
+void testSerialBatch() {
+    testBatch(0);
+}
+
+void testParallelBatch() {
+    ParallelExecutor executor(3);
+    testBatch(&executor);
+}
+
+void testBatchRequiresModelStage() {
+    Chains system(1, 2);
+    system.realizeTopology();
+    State s = system.getDefaultState();
+    s.invalidateAll(Stage::Model);
+    Array_<State*> ptrs(1, &s);
+    SimTK_TEST_MUST_THROW(system.realizeBatch(ptrs, Stage::Position));
+}
+
+// The exception thrown while realizing a State on a worker thread must reach
+// the caller with its own type, after the other chunks have been realized.
+void testParallelBatchRethrowsOriginalException() {
+    Chains system(2, 3);
+    Force::Custom(system.forces, new ThrowLate(.3));
+    system.realizeTopology();
+
+    Array_<State> batch;
+    makeStates(system, 50, batch);
+    Array_<State*> ptrs;
+    for (int k=0; k < (int)batch.size(); ++k)
+        ptrs.push_back(&batch[k]);
+
+    ParallelExecutor executor(3);
+    SimTK_TEST_MUST_THROW_EXC(
+        system.realizeBatch(ptrs, Stage::Acceleration, &executor),
+        LateStateError);
+    // A chunk stops at its first late State, so only the late States' stages
+    // are certain; but the first chunk (of 8) has no late States.
+    for (int k=0; k < (int)batch.size(); ++k) {
+        if (batch[k].getTime() > .3)
+            SimTK_TEST(batch[k].getSystemStage() <= Stage::Velocity);
+    }
+    for (int k=0; k < 8; ++k)
+        SimTK_TEST(batch[k].getSystemStage() == Stage::Acceleration);
+}
+
+void testBatchRejectsDuplicateStates() {
+    Chains system(1, 2);
+    system.realizeTopology();
+    Array_<State> batch;
+    makeStates(system, 10, batch);
+    Array_<State*> ptrs;
+    for (int k=0; k < (int)batch.size(); ++k)
+        ptrs.push_back(&batch[k]);
+    ptrs.push_back(&batch[4]);
+    SimTK_TEST_MUST_THROW_DEBUG(system.realizeBatch(ptrs, Stage::Position));
+}
+
+int main() {
+    SimTK_START_TEST("TestRealizeBatch");
+        SimTK_SUBTEST(testSerialBatch);
+        SimTK_SUBTEST(testParallelBatch);
+        SimTK_SUBTEST(testBatchRequiresModelStage);
+        SimTK_SUBTEST(testParallelBatchRethrowsOriginalException);
+        SimTK_SUBTEST(testBatchRejectsDuplicateStates);
+    SimTK_END_TEST();
+}
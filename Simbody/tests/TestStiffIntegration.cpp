@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+using namespace std;
+
+// Check that the SDIRK3 implicit integrator takes steps limited by accuracy
+// rather than stability on stiff models, while still producing accurate
+// answers.
+
+// A block on a slider attached to ground by a very stiff, heavily damped
+// spring. The eigenvalues are roughly -101 and -9899, so an explicit 
+// integrator is stability limited to h ~ 1e-4 long after the fast mode has 
+// died out.
+void testStiffSpringDamper() {
+    const Real m = 1, k = 1e6, c = 1e4, x0 = 0.1, tFinal = 0.5;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Body::Rigid body(MassProperties(m, Vec3(0), Inertia(1)));
+    MobilizedBody::Slider block(matter.Ground(), body);
+    Force::MobilityLinearSpring(forces, block, MobilizerQIndex(0), k, 0);
+    Force::MobilityLinearDamper(forces, block, MobilizerUIndex(0), c);
+    State state = system.realizeTopology();
+    block.setOneQ(state, 0, x0);
+
+    // Analytic solution x(t) = a1 exp(s1 t) + a2 exp(s2 t) with x'(0)=0.
+    const Real disc = std::sqrt(c*c - 4*m*k);
+    const Real s1 = (-c + disc)/(2*m), s2 = (-c - disc)/(2*m);
+    const Real a1 = x0*s2/(s2-s1), a2 = -x0*s1/(s2-s1);
+
+    SDIRK3Integrator sdirk(system);
+    sdirk.setAccuracy(1e-4);
+    TimeStepper ts(system, sdirk);
+    ts.initialize(state);
+    for (Real t = 0.01; t <= tFinal + 1e-12; t += 0.01) {
+        ts.stepTo(t);
+        const Real x = block.getOneQ(ts.getState(), 0);
+        const Real xExact = a1*std::exp(s1*t) + a2*std::exp(s2*t);
+        SimTK_TEST_EQ_TOL(x, xExact, 1e-4*x0);
+    }
+    const int sdirkSteps = sdirk.getNumStepsTaken();
+    SimTK_TEST(sdirk.getNumJacobianEvaluations() < sdirkSteps);
+    SimTK_TEST(sdirk.getNumIterationMatrixFactorizations() < sdirkSteps);
+
+    RungeKuttaMersonIntegrator merson(system);
+    merson.setAccuracy(1e-4);
+    TimeStepper tsm(system, merson);
+    tsm.initialize(state);
+    tsm.stepTo(tFinal);
+    const int mersonSteps = merson.getNumStepsTaken();
+
+    cout << "  stiff spring: SDIRK3 " << sdirkSteps << " steps, "
+         << sdirk.getNumJacobianEvaluations() << " Jacobians, "
+         << sdirk.getNumIterationMatrixFactorizations() << " factorizations, "
+         << sdirk.getNumRealizations() << " realizations; Merson " 
+         << mersonSteps << " steps, " << merson.getNumRealizations() 
+         << " realizations\n";
+
+    SimTK_TEST(5*sdirkSteps < mersonSteps);
+    SimTK_TEST(5*sdirk.getNumRealizations() < merson.getNumRealizations());
+}
+
+// A ball dropped onto a stiff, dissipative Hunt-Crossley contact surface
+// comes to rest on it. Compare against a tightly converged explicit 
+// solution. Once the ball is resting in contact, the explicit integrator is
+// stuck at a small step size while the implicit one is not.
+void testHuntCrossleyContact() {
+    const Real tFinal = 3;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    GeneralContactSubsystem contacts(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(0.01)));
+    MobilizedBody::Translation ball(matter.Ground(), body);
+    const ContactSetIndex setIndex = contacts.createContactSet();
+    contacts.addBody(setIndex, ball, ContactGeometry::Sphere(0.1), 
+                     Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(),
+                     Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    HuntCrossleyForce hc(forces, contacts, setIndex);
+    hc.setBodyParameters(ContactSurfaceIndex(0), 1e9, 10, 0, 0, 0);
+    hc.setBodyParameters(ContactSurfaceIndex(1), 1e9, 10, 0, 0, 0);
+    State state = system.realizeTopology();
+    ball.setQToFitTranslation(state, Vec3(0, 0.15, 0));
+
+    RungeKuttaMersonIntegrator reference(system);
+    reference.setAccuracy(1e-8);
+    TimeStepper tsr(system, reference);
+    tsr.initialize(state);
+    tsr.stepTo(tFinal);
+    const Vec3 pRef = ball.getBodyOriginLocation(tsr.getState());
+
+    SDIRK3Integrator sdirk(system);
+    sdirk.setAccuracy(1e-4);
+    TimeStepper ts(system, sdirk);
+    ts.initialize(state);
+    ts.stepTo(tFinal);
+    const Vec3 p = ball.getBodyOriginLocation(ts.getState());
+
+    RungeKuttaMersonIntegrator merson(system);
+    merson.setAccuracy(1e-4);
+    TimeStepper tsm(system, merson);
+    tsm.initialize(state);
+    tsm.stepTo(tFinal);
+
+    cout << "  contact: SDIRK3 " << sdirk.getNumStepsTaken() << " steps, "
+         << sdirk.getNumJacobianEvaluations() << " Jacobians, "
+         << sdirk.getNumIterationMatrixFactorizations() << " factorizations, "
+         << sdirk.getNumRealizations() << " realizations; Merson " 
+         << merson.getNumStepsTaken() << " steps, " 
+         << merson.getNumRealizations() << " realizations\n";
+
+    SimTK_TEST_EQ_TOL(p, pRef, 1e-4);
+    SimTK_TEST(3*sdirk.getNumStepsTaken() < merson.getNumStepsTaken());
+}
+
+int main() {
+    SimTK_START_TEST("TestStiffIntegration");
+        SimTK_SUBTEST(testStiffSpringDamper);
+        SimTK_SUBTEST(testHuntCrossleyContact);
+    SimTK_END_TEST();
+}
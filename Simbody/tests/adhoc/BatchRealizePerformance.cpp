@@ -0,0 +1,108 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measure the throughput, in States/second, of realizing many States of the
+same System to Acceleration stage: one at a time with System::realize(), in a
+serial System::realizeBatch(), and in a parallel System::realizeBatch(). This
+is the pattern used by Monte Carlo and parameter sweep studies. */
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+
+using namespace SimTK;
+
+static void createSystem(MultibodySystem& system, int nLinks) {
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.81);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-.5,0), 
+                                          UnitInertia::cylinderAlongY(.1,.5)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < nLinks; ++i) {
+        MobilizedBody::Pin next(parent, i==0 ? Vec3(0) : Vec3(0,-1,0),
+                                link, Vec3(0));
+        Force::MobilityLinearSpring(forces, next, 0, 10, 0);
+        parent = next;
+    }
+}
+
+// Reset all the States to a new configuration so they have to be realized
+// from Time stage again.
+static void perturb(Array_<State>& states, Real t) {
+    for (int k=0; k < (int)states.size(); ++k) {
+        states[k].updTime() = t;
+        states[k].updQ() = std::sin(t + k);
+        states[k].updU() = std::cos(t + k);
+    }
+}
+
+static void runOne(int nLinks, int nStates, int nReps) {
+    MultibodySystem system;
+    createSystem(system, nLinks);
+    system.realizeTopology();
+
+    Array_<State> states(nStates, system.getDefaultState());
+    Array_<State*> ptrs;
+    for (int k=0; k < nStates; ++k) ptrs.push_back(&states[k]);
+
+    ParallelExecutor executor;
+
+    double loopTime=0, batchTime=0, parallelTime=0;
+    for (int rep=0; rep < nReps; ++rep) {
+        perturb(states, rep); 
+        double t0 = realTime();
+        for (int k=0; k < nStates; ++k)
+            system.realize(states[k], Stage::Acceleration);
+        loopTime += realTime() - t0;
+
+        perturb(states, rep); 
+        t0 = realTime();
+        system.realizeBatch(ptrs, Stage::Acceleration);
+        batchTime += realTime() - t0;
+
+        perturb(states, rep); 
+        t0 = realTime();
+        system.realizeBatch(ptrs, Stage::Acceleration, &executor);
+        parallelTime += realTime() - t0;
+    }
+
+    const double n = double(nStates)*nReps;
+    std::printf("%4d links %6d states: loop %10.0f/s  batch %10.0f/s  "
+                "parallel(%d) %10.0f/s\n", nLinks, nStates, 
+                n/loopTime, n/batchTime, ParallelExecutor::getNumProcessors(),
+                n/parallelTime);
+}
+
+int main() {
+    try {
+        runOne(  2, 10000, 5);
+        runOne( 10, 10000, 5);
+        runOne( 50,  2000, 5);
+        runOne(200,   500, 5);
+    } catch (const std::exception& e) {
+        std::printf("EXCEPTION THROWN: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Compare the time taken to realize position and velocity kinematics a
+mobilized body at a time with the time taken in blocks of same-type
+mobilizers (SimbodyMatterSubsystem::setUseBlockKinematics()), for a few
+models of different widths and mobilizer mixes. */
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+
+using namespace SimTK;
+
+// nBranches chains of nLinks links off Ground. If mixed, the mobilizers
+// cycle through Pin, Ball, Universal, and Free; otherwise they are all Pins.
+static void createSystem(MultibodySystem& system, int nBranches, int nLinks,
+                         bool mixed) {
+    SimbodyMatterSubsystem  matter(system);
+    const Body::Rigid link(MassProperties(1, Vec3(0,-.5,0),
+                                          UnitInertia::cylinderAlongY(.1,.5)));
+    for (int b=0; b < nBranches; ++b) {
+        MobilizedBody parent = matter.Ground();
+        for (int i=0; i < nLinks; ++i) {
+            const Vec3 attach = i==0 ? Vec3(b,0,0) : Vec3(0,-1,0);
+            switch (mixed ? (b+i) % 4 : 0) {
+            case 0: parent = MobilizedBody::Pin(parent, attach, link, Vec3(0));
+                    break;
+            case 1: parent = MobilizedBody::Ball(parent, attach, link, Vec3(0));
+                    break;
+            case 2: parent = MobilizedBody::Universal(parent, attach,
+                                                      link, Vec3(0));
+                    break;
+            default: parent = MobilizedBody::Free(parent, attach,
+                                                  link, Vec3(0));
+            }
+        }
+    }
+}
+
+static double timeKinematics(const MultibodySystem& system, State& state,
+                             int nReps) {
+    const double t0 = realTime();
+    for (int rep=0; rep < nReps; ++rep) {
+        state.updQ()[0] = 1e-3*rep; // invalidates Position stage
+        system.realize(state, Stage::Velocity);
+    }
+    return realTime() - t0;
+}
+
+static void runOne(int nBranches, int nLinks, bool mixed, int nReps) {
+    MultibodySystem system;
+    createSystem(system, nBranches, nLinks, mixed);
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    State state = system.realizeTopology();
+    state.updQ() = .1; state.updU() = .2;
+
+    // Alternate to spread any drift in machine speed evenly.
+    double nodeTime=0, blockTime=0;
+    for (int trial=0; trial < 6; ++trial) {
+        matter.setUseBlockKinematics(trial % 2 != 0);
+        (trial % 2 ? blockTime : nodeTime) +=
+            timeKinematics(system, state, nReps);
+    }
+    matter.setUseBlockKinematics(false);
+
+    std::printf("%4d x %3d %s: body at a time %8.2f us, blocks %8.2f us"
+                "  (%.2fx)\n", nBranches, nLinks, mixed ? "mixed" : "pins ",
+                1e6*nodeTime/(3*nReps), 1e6*blockTime/(3*nReps),
+                nodeTime/blockTime);
+}
+
+int main() {
+    try {
+        runOne(  1, 100, false, 20000);
+        runOne(100,   1, false, 20000);
+        runOne( 32,   8, false,  5000);
+        runOne( 32,   8, true,   5000);
+        runOne(200,   5, true,   1000);
+    } catch (const std::exception& e) {
+        std::printf("EXCEPTION THROWN: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
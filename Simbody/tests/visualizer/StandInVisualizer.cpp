@@ -0,0 +1,207 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * A stand-in for simbody-visualizer that has no window. It is built under
+ * that name next to TestVisualizerTransport so that the Visualizer launches
+ * it instead of the real one. It speaks the simulator side of the protocol
+ * just well enough to receive scenes, which it reads through the same
+ * shared memory code as the real GUI, and logs each scene as it would have
+ * come down the pipe to the file named by SimTK_TEST_VISUALIZER_LOG.
+ *
+ * Each log record is: unsigned char transport (0 for the pipe, 1 for shared
+ * memory, EndOfLog after Shutdown), unsigned char slot, unsigned char
+ * isDelta, then unsigned n and n bytes of scene.
+ */
+
+#include "SimTKcommon.h"
+#include "../../Visualizer/src/VisualizerProtocol.h"
+#include "../../Visualizer/src/VisualizerSharedScene.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace SimTK;
+
+static const unsigned char EndOfLog = 0xff;
+
+static int inPipe, outPipe;
+
+// Scenes that came through shared memory are read from here instead.
+static std::vector<unsigned char>   sharedScene;
+static const unsigned char*         sharedSceneNext = NULL;
+
+static void readData(unsigned char* buffer, unsigned bytes) {
+    if (sharedSceneNext) {
+        std::memcpy(buffer, sharedSceneNext, bytes);
+        sharedSceneNext += bytes;
+        return;
+    }
+    unsigned totalRead = 0;
+    while (totalRead < bytes) {
+        const ssize_t n = read(inPipe, buffer+totalRead, bytes-totalRead);
+        if (n <= 0)
+            std::exit(1); // simulator went away without saying goodbye
+        totalRead += (unsigned)n;
+    }
+}
+
+static unsigned readUnsigned() {
+    unsigned u;
+    readData((unsigned char*)&u, sizeof(unsigned));
+    return u;
+}
+
+// Append the next "bytes" bytes of the scene to "scene".
+static void readInto(std::vector<unsigned char>& scene, unsigned bytes) {
+    const size_t start = scene.size();
+    scene.resize(start + bytes);
+    if (bytes) readData(&scene[start], bytes);
+}
+
+// Read one scene following StartOfScene, through EndOfScene. The element
+// sizes are the same ones simbody-visualizer's readNewScene() uses.
+static void readScene(std::vector<unsigned char>& scene) {
+    scene.clear();
+    readInto(scene, sizeof(float)); // time
+    while (true) {
+        readInto(scene, 1);
+        const unsigned char command = scene.back();
+        if (command == EndOfScene)
+            return;
+        switch (command) {
+        case AddSolidMesh:
+        case AddPointMesh:
+        case AddWireframeMesh:
+            readInto(scene, 13*sizeof(float)+2*sizeof(short));
+            break;
+        case AddLine:
+            readInto(scene, 10*sizeof(float));
+            break;
+        case AddText: {
+            readInto(scene, 9*sizeof(float)+3*sizeof(short));
+            short length;
+            std::memcpy(&length, &scene[scene.size()-sizeof(short)],
+                        sizeof(short));
+            readInto(scene, length);
+            break;
+        }
+        case AddCoords:
+            readInto(scene, 12*sizeof(float));
+            break;
+        case DefineMesh: {
+            readInto(scene, 2*sizeof(short));
+            unsigned short counts[2];
+            std::memcpy(counts, &scene[scene.size()-2*sizeof(short)],
+                        2*sizeof(short));
+            readInto(scene, 3*counts[0]*sizeof(float)
+                            + 3*counts[1]*sizeof(short));
+            break;
+        }
+        default:
+            std::fprintf(stderr, "StandInVisualizer: unexpected scene "
+                         "command %u\n", (unsigned)command);
+            std::exit(1);
+        }
+    }
+}
+
+static void logScene(FILE* log, unsigned char transport, unsigned char slot,
+                     unsigned char isDelta,
+                     const std::vector<unsigned char>& scene) {
+    const unsigned char tag[3] = {transport, slot, isDelta};
+    const unsigned n = (unsigned)scene.size();
+    std::fwrite(tag, 1, 3, log);
+    std::fwrite(&n, sizeof(unsigned), 1, log);
+    if (n) std::fwrite(&scene[0], 1, n, log);
+    std::fflush(log);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || !std::getenv("SimTK_TEST_VISUALIZER_LOG"))
+        return 1;
+    inPipe  = std::atoi(argv[1]);
+    outPipe = std::atoi(argv[2]);
+    FILE* log = std::fopen(std::getenv("SimTK_TEST_VISUALIZER_LOG"), "wb");
+    if (!log)
+        return 1;
+
+    // Startup handshake: command, protocol version, Simbody version, and
+    // the simulator's executable name.
+    unsigned char buffer[256];
+    readData(buffer, 1);
+    if (buffer[0] != StartupHandshake || readUnsigned() != ProtocolVersion)
+        return 1;
+    readData(buffer, 3*sizeof(int));
+    readData(buffer, readUnsigned());
+    if (write(outPipe, &ReturnHandshake, 1) != 1
+        || write(outPipe, &ProtocolVersion, sizeof(unsigned))
+           != sizeof(unsigned))
+        return 1;
+
+    VisualizerSharedScene sharedMemory;
+    std::vector<unsigned char> scene;
+    while (true) {
+        readData(buffer, 1);
+        switch (buffer[0]) {
+        case SetMaxFrameRate:       readData(buffer, sizeof(float)); break;
+        case SetBackgroundColor:    readData(buffer, 3*sizeof(float)); break;
+        case SetBackgroundType:     readData(buffer, sizeof(short)); break;
+        case SetSystemUpDirection:  readData(buffer, 2); break;
+        case UseSharedMemory: {
+            const unsigned nameLength = readUnsigned();
+            std::vector<char> name(nameLength);
+            readData((unsigned char*)&name[0], nameLength);
+            const unsigned bytes = readUnsigned();
+            sharedMemory.attach(std::string(name.begin(), name.end()), bytes);
+            break;
+        }
+        case StartOfScene:
+            readScene(scene);
+            logScene(log, 0, 0, 0, scene);
+            break;
+        case SceneInSharedMemory: {
+            readData(buffer, 1);
+            const unsigned char slot = buffer[0];
+            const bool isDelta = sharedMemory.readScene(slot, sharedScene);
+            sharedSceneNext = &sharedScene[0];
+            readScene(scene);
+            sharedSceneNext = NULL;
+            logScene(log, 1, slot, isDelta, scene);
+            break;
+        }
+        case Shutdown:
+            logScene(log, EndOfLog, 0, 0, std::vector<unsigned char>());
+            std::fclose(log);
+            return 0;
+        default:
+            std::fprintf(stderr, "StandInVisualizer: unexpected command %u\n",
+                         (unsigned)buffer[0]);
+            return 1;
+        }
+    }
+}
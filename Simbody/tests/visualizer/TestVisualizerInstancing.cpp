@@ -0,0 +1,182 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that simbody-visualizer draws a scene the same way with instanced
+ * drawing of the predefined meshes as without it. The visualizer is compiled
+ * in here without its main(), and the scene is rendered into an offscreen
+ * framebuffer of a surfaceless EGL context, so no window system is needed.
+ * If no such context can be created, or it doesn't support instancing, the
+ * test is skipped.
+ */
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#define SimTK_VISUALIZER_OFFSCREEN_TEST
+#include "../../Visualizer/simbody-visualizer/simbody-visualizer.cpp"
+
+#include "SimTKcommon/Testing.h"
+
+static const int Width = 400, Height = 300;
+
+// Make a current OpenGL context that renders into a Width x Height
+// framebuffer object. Returns false if that isn't possible here.
+static bool createOffscreenContext() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+            eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!getPlatformDisplay)
+        return false;
+    EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                            EGL_DEFAULT_DISPLAY, NULL);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)
+        || !eglBindAPI(EGL_OPENGL_API))
+        return false;
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR,
+                                          EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT
+        || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        return false;
+
+    GLuint framebuffer, renderbuffers[2];
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(2, renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, Width, Height);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24,
+                          Width, Height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, renderbuffers[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        return false;
+    viewWidth = Width;
+    viewHeight = Height;
+    return true;
+}
+
+// A scene of many predefined meshes of each kind, at two resolutions, some
+// of them mirrored and some drawn as points or wireframes, in the form
+// readNewScene() would have produced.
+static Scene* makeScene(int numMeshes) {
+    Scene* newScene = new Scene;
+    Random::Uniform random(-1, 1);
+    random.setSeed(3);
+    for (int i = 0; i < numMeshes; i++) {
+        const fRotation R(float(3*random.getValue()),
+                          fUnitVec3(float(random.getValue()),
+                                    float(random.getValue()), 1));
+        const fVec3 p(float(4*random.getValue()), float(2+random.getValue()),
+                      float(4*random.getValue()));
+        fVec3 scale;
+        for (int k = 0; k < 3; k++)
+            scale[k] = float(.2 + .1*random.getValue());
+        if (i % 17 == 0)
+            scale[1] = -scale[1];
+        fVec4 color(1);
+        for (int k = 0; k < 3; k++)
+            color[k] = float(.5 + .5*random.getValue());
+        const unsigned short meshIndex = (unsigned short)(i % 3);
+        const unsigned short resolution = (unsigned short)(i % 2);
+
+        short representation = DecorativeGeometry::DrawSurface;
+        if (i % 10 == 1)
+            representation = (i % 20 == 1 ? DecorativeGeometry::DrawWireframe
+                                          : DecorativeGeometry::DrawPoints);
+        RenderedMesh mesh(fTransform(R, p), scale, color, representation,
+                          meshIndex, resolution);
+        if (representation == DecorativeGeometry::DrawSurface)
+            newScene->solidMeshes.push_back(mesh);
+        else
+            newScene->drawnMeshes.push_back(mesh);
+        if ((int)meshes[meshIndex].size() <= resolution
+            || meshes[meshIndex][resolution] == NULL)
+            pendingCommands.push_back(
+                new PendingStandardMesh(meshIndex, resolution));
+    }
+    newScene->prepareInstances();
+    return newScene;
+}
+
+static vector<unsigned char> render(bool instancing, bool groundAndShadows) {
+    useInstancing = instancing;
+    showGround = showShadows = groundAndShadows;
+    scene->instanceDataLoaded = false;
+    renderScene();
+    glFinish();
+    vector<unsigned char> pixels(4*Width*Height);
+    glReadPixels(0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    return pixels;
+}
+
+void testInstancedMatchesSerial() {
+    pthread_mutex_init(&sceneLock, NULL);
+    pthread_cond_init(&sceneHasBeenDrawn, NULL);
+    scene = makeScene(300);
+    X_GC = fTransform(fRotation(-0.4f, XAxis), fVec3(0, 5, 10));
+
+    for (int groundAndShadows = 0; groundAndShadows < 2; groundAndShadows++) {
+        const vector<unsigned char> serial = render(false, groundAndShadows);
+        const vector<unsigned char> instanced = render(true, groundAndShadows);
+        int numDrawn = 0, maxDiff = 0;
+        for (int i = 0; i < Width*Height; i++) {
+            if (serial[4*i] != 255 || serial[4*i+1] != 255
+                || serial[4*i+2] != 255)
+                numDrawn++;
+            for (int k = 0; k < 4; k++)
+                maxDiff = std::max(maxDiff,
+                                   std::abs(serial[4*i+k]-instanced[4*i+k]));
+        }
+        cout << "  ground and shadows " << groundAndShadows << ": "
+             << numDrawn << " pixels drawn, max difference " << maxDiff
+             << endl;
+        // The scene must really have been drawn, and the two ways of drawing
+        // it may differ only by rounding.
+        SimTK_TEST(numDrawn > Width*Height/20);
+        SimTK_TEST(maxDiff <= 2);
+    }
+    useInstancing = true;
+}
+
+int main() {
+    if (!createOffscreenContext()) {
+        cout << "TestVisualizerInstancing: no offscreen OpenGL context;"
+                " skipped." << endl;
+        return 0;
+    }
+    initGLState();
+    if (!useInstancing) {
+        cout << "TestVisualizerInstancing: instanced drawing not supported;"
+                " skipped." << endl;
+        return 0;
+    }
+
+    SimTK_START_TEST("TestVisualizerInstancing");
+        SimTK_SUBTEST(testInstancedMatchesSerial);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,170 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Michael Sherman                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Test that scenes sent to the GUI through the two shared memory slots, in
+ * full or as deltas from the previous one, arrive exactly as they would have
+ * through the pipe. The Visualizer here launches StandInVisualizer, which
+ * is built as "simbody-visualizer" in this directory and logs every scene
+ * it receives.
+ */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using std::cout; using std::endl;
+
+using namespace SimTK;
+
+static const unsigned char EndOfLog = 0xff; // as in StandInVisualizer
+
+struct LoggedScene {
+    unsigned char               transport; // 0 for pipe, 1 for shared memory
+    unsigned char               slot;
+    bool                        isDelta;
+    std::vector<unsigned char>  scene;
+};
+
+// Read the stand-in's log, waiting for it to finish writing after the
+// Visualizer has told it to shut down. Returns false on a timeout.
+static bool readLog(const std::string& logName,
+                    std::vector<LoggedScene>& scenes) {
+    for (int tries=0; tries < 1000; ++tries) {
+        scenes.clear();
+        FILE* log = std::fopen(logName.c_str(), "rb");
+        if (log) {
+            LoggedScene rec;
+            unsigned char tag[3];
+            unsigned n;
+            while (std::fread(tag, 1, 3, log) == 3
+                   && std::fread(&n, sizeof(unsigned), 1, log) == 1) {
+                if (tag[0] == EndOfLog) {
+                    std::fclose(log);
+                    return true;
+                }
+                rec.transport = tag[0];
+                rec.slot      = tag[1];
+                rec.isDelta   = tag[2] != 0;
+                rec.scene.resize(n);
+                if (n && std::fread(&rec.scene[0], 1, n, log) != n)
+                    break;
+                scenes.push_back(rec);
+            }
+            std::fclose(log);
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+// Draw the same sequence of frames of a chain of pendulums, moving one body
+// at a time so that most frames differ from the last only in a few drawing
+// commands, and adding a decoration partway through so that the drawing
+// commands change. When using shared memory we pause now and then to let
+// the GUI catch up, so that both slots get used.
+static void drawFrames(bool useSharedMemory, std::vector<LoggedScene>& scenes)
+{
+    char logName[64];
+    std::sprintf(logName, "TestVisualizerTransport-%d-%d.log",
+                 (int)getpid(), (int)useSharedMemory);
+    setenv("SimTK_TEST_VISUALIZER_LOG", logName, 1);
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    body.addDecoration(Transform(), DecorativeSphere(.1));
+    body.addDecoration(Transform(), DecorativeBrick(Vec3(.05)).setColor(Red));
+    body.addDecoration(Transform(),
+        DecorativeMesh(PolygonalMesh::createSphereMesh(.2, 2)));
+    body.addDecoration(Transform(), DecorativeText("link"));
+    MobilizedBody parent = matter.Ground();
+    const int NBodies = 20;
+    for (int i=0; i < NBodies; ++i)
+        parent = MobilizedBody::Pin(parent, Transform(Vec3(0,-.3,0)),
+                                    body, Transform());
+
+    {   Visualizer viz(system);
+        viz.setShutdownWhenDestructed(true);
+        if (useSharedMemory)
+            SimTK_TEST(viz.setUseSharedMemoryTransport(true)
+                          .getUseSharedMemoryTransport());
+        State state = system.realizeTopology();
+        const int NFrames = 100;
+        for (int f=0; f < NFrames; ++f) {
+            matter.getMobilizedBody(MobilizedBodyIndex(1 + f%NBodies))
+                .setOneQ(state, 0, .01*f);
+            if (f == NFrames/2)
+                viz.addDecoration(MobilizedBodyIndex(0), Vec3(0),
+                    DecorativeLine(Vec3(0), Vec3(1,1,1)));
+            state.updTime() = .01*f;
+            system.realize(state, Stage::Position);
+            viz.drawFrameNow(state);
+            if (useSharedMemory && f%3 == 0)
+                usleep(5000);
+        }
+    }   // Visualizer sends Shutdown here.
+
+    SimTK_TEST(readLog(logName, scenes));
+    std::remove(logName);
+}
+
+void testSharedMemoryMatchesPipe() {
+    std::vector<LoggedScene> piped, shared;
+    drawFrames(false, piped);
+    drawFrames(true, shared);
+
+    SimTK_TEST(piped.size() == shared.size());
+    int numShared = 0, numDeltas = 0, slotUsed[2] = {0,0};
+    for (unsigned i=0; i < piped.size() && i < shared.size(); ++i) {
+        SimTK_TEST(piped[i].transport == 0);
+        SimTK_TEST(piped[i].scene == shared[i].scene);
+        if (shared[i].transport == 1) {
+            ++numShared;
+            numDeltas += shared[i].isDelta;
+            SimTK_TEST(shared[i].slot < 2);
+            ++slotUsed[shared[i].slot & 1];
+        }
+    }
+    cout << piped.size() << " scenes: " << numShared
+         << " through shared memory (" << slotUsed[0] << " in slot 0, "
+         << slotUsed[1] << " in slot 1), " << numDeltas << " as deltas."
+         << endl;
+
+    SimTK_TEST(numShared > 0);
+    SimTK_TEST(numDeltas > 0);
+    SimTK_TEST(slotUsed[0] > 0 && slotUsed[1] > 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestVisualizerTransport");
+        SimTK_SUBTEST(testSharedMemoryMatchesPipe);
+    SimTK_END_TEST();
+}